@@ -25,6 +25,7 @@ cmake \
 libssl-dev \
 libcurl4-openssl-dev \
 uuid-dev \
+zlib1g-dev \
 python-dev \
 lcov
 
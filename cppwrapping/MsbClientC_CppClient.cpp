@@ -0,0 +1,207 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MsbClientC_CppClient.hpp"
+
+#include <cstring>
+#include <new>
+#include <string>
+
+using namespace MsbClientC_CPPInt;
+
+namespace {
+
+// null terminated copy of a view, on the stack unless it is long
+class CString{
+
+private:
+	char small_[128];
+	std::string large_;
+	const char* str_;
+
+public:
+	explicit CString(std::string_view view) {
+		if (view.size() < sizeof(small_)) {
+			std::memcpy(small_, view.data(), view.size());
+			small_[view.size()] = 0;
+			str_ = small_;
+		} else {
+			large_.assign(view);
+			str_ = large_.c_str();
+		}
+	}
+
+	CString(const CString&) = delete;
+	CString& operator=(const CString&) = delete;
+
+	char* get() const noexcept { return const_cast<char*>(str_); }
+	char* getOrNull() const noexcept { return *str_ != 0 ? const_cast<char*>(str_) : nullptr; }
+};
+
+}
+
+std::string& MsbClientC_CPPInt::detail::publishBuffer() noexcept {
+	thread_local std::string buffer;
+	return buffer;
+}
+
+Client::Client(std::string_view url, std::string_view uuid, std::string_view token, std::string_view service_class,
+			   std::string_view name, std::string_view description, bool tls, std::string_view client_cert,
+			   std::string_view client_key, std::string_view ca_cert) {
+	CString u(url), i(uuid), t(token), c(service_class), n(name), d(description);
+	CString cc(client_cert), ck(client_key), ca(ca_cert);
+
+	client_ = msbClientNewClientURL(u.get(), nullptr, i.get(), t.get(), c.get(), n.get(), d.get(), tls, cc.getOrNull(),
+									ck.getOrNull(), ca.getOrNull());
+}
+
+Client& Client::operator=(Client&& other) noexcept {
+	if (this != &other) {
+		if (client_ != nullptr) msbClientDeleteClient(client_);
+		client_ = other.client_;
+		callbacks_ = std::move(other.callbacks_);
+		other.client_ = nullptr;
+	}
+	return *this;
+}
+
+Client::~Client() {
+	if (client_ != nullptr) msbClientDeleteClient(client_);
+}
+
+msbClient* Client::release() noexcept {
+	msbClient* c = client_;
+	client_ = nullptr;
+	return c;
+}
+
+int Client::RunClientStateMachine() noexcept {
+	return msbClientRunClientStateMachine(client_);
+}
+
+int Client::HaltClientStateMachine() noexcept {
+	return msbClientHaltClientStateMachine(client_);
+}
+
+int Client::Register() noexcept {
+	return msbClientRegister(client_);
+}
+
+bool Client::ConnectionReady() noexcept {
+	return msbClientConnectionReady(client_);
+}
+
+void Client::SetDebug(bool on_off) noexcept {
+	msbClientSetDebug(client_, on_off);
+}
+
+void Client::SetSockJSFraming(bool on_off) noexcept {
+	msbClientSetSockJSFraming(client_, on_off);
+}
+
+void Client::GenerateSockJSPath() noexcept {
+	msbClientGenerateSockJSPath(client_);
+}
+
+void Client::SetMaxMessageSize(std::uint32_t size) noexcept {
+	msbClientSetMaxMessageSize(client_, size);
+}
+
+void Client::FwdCompleteFunctionCall() noexcept {
+	msbClientFwdCompleteFunctionCall(client_);
+}
+
+bool Client::SetPublishWindow(std::uint32_t window) noexcept {
+	return msbClientSetPublishWindow(client_, window);
+}
+
+msbPublishStatistics Client::GetPublishStatistics() const noexcept {
+	msbPublishStatistics stats{};
+	msbClientGetPublishStatistics(client_, &stats);
+	return stats;
+}
+
+void Client::AddConfigParam(std::string_view cpId, PrimitiveType cpType, PrimitiveFormat cpFormat, void* value) {
+	msbClientAddConfigParam(client_, CString(cpId).get(), cpType, cpFormat, value);
+}
+
+void Client::AddFunction(std::string_view fId, std::string_view fName, std::string_view fDesc,
+						 void (* fPtr)(void*, void*, void*), PrimitiveType fType, PrimitiveFormat fFormat, bool isArray,
+						 void* contextPtr) {
+	msbClientAddFunction(client_, CString(fId).get(), CString(fName).get(), CString(fDesc).get(), fPtr, fType, fFormat,
+						 isArray, contextPtr);
+}
+
+void Client::AddEmptyFunction(std::string_view fId, std::string_view fName, std::string_view fDesc,
+							  void (* fPtr)(void*, void*, void*), void* contextPtr) {
+	msbClientAddEmptyFunction(client_, CString(fId).get(), CString(fName).get(), CString(fDesc).get(), fPtr,
+							  contextPtr);
+}
+
+void Client::AddResponseEventToFunction(std::string_view fId, std::string_view eId) {
+	msbClientAddResponseEventToFunction(client_, CString(fId).get(), CString(eId).get());
+}
+
+void Client::AddEvent(std::string_view eId, std::string_view eName, std::string_view eDesc, PrimitiveType eType,
+					  PrimitiveFormat eFormat, bool isArray) {
+	msbClientAddEvent(client_, CString(eId).get(), CString(eName).get(), CString(eDesc).get(), eType, eFormat, isArray);
+}
+
+void Client::AddEmptyEvent(std::string_view eId, std::string_view eName, std::string_view eDesc) {
+	msbClientAddEmptyEvent(client_, CString(eId).get(), CString(eName).get(), CString(eDesc).get());
+}
+
+void Client::PublishEmpty(std::string_view eId, MessagePriority priority, std::string_view corrId) noexcept {
+	if (client_ == nullptr) return;
+
+	// ids of 128 characters or more are copied to the heap, without memory the event isn't published
+	try {
+		msbClientPublishEmpty(client_, CString(eId).get(), priority, CString(corrId).getOrNull());
+	} catch (const std::bad_alloc&) {
+	}
+}
+
+void Client::Publish(std::string_view eId, MessagePriority priority, const void* data, std::size_t array_length,
+					 std::string_view corrId) noexcept {
+	if (client_ == nullptr) return;
+
+	try {
+		msbClientPublish(client_, CString(eId).get(), priority, const_cast<void*>(data), array_length,
+						 CString(corrId).getOrNull());
+	} catch (const std::bad_alloc&) {
+	}
+}
+
+void Client::PublishComplex(std::string_view eId, MessagePriority priority, json_object* pData,
+							std::string_view corrId) noexcept {
+	if (client_ == nullptr) return;
+
+	try {
+		msbClientPublishComplex(client_, CString(eId).get(), priority, pData, CString(corrId).getOrNull());
+	} catch (const std::bad_alloc&) {
+	}
+}
+
+void Client::PublishFromString(std::string_view eId, MessagePriority priority, std::string_view json,
+							   std::string_view corrId) noexcept {
+	if (client_ == nullptr) return;
+
+	try {
+		msbClientPublishJSON(client_, CString(eId).get(), priority, json.data(), json.size(),
+							 CString(corrId).getOrNull());
+	} catch (const std::bad_alloc&) {
+	}
+}
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_MSBCLIENTC_CPPCLIENT_HPP
+#define SRC_MSBCLIENTC_CPPCLIENT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <json-c/json.h>
+
+#include "MsbClientC_CppTraits.hpp"
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+extern "C" {
+#include "MsbClientC.h"
+}
+
+namespace MsbClientC_CPPInt{
+
+// what is known about a function call besides its parameters
+struct FunctionCall{
+	msbClient* client;
+	std::string_view functionId;/* empty unless FwdCompleteFunctionCall is set */
+	std::string_view correlationId;/* empty unless FwdCompleteFunctionCall is set, needed for response events */
+};
+
+// an event registered with the data type of T, see Client::AddEvent<T>
+template<typename T>
+class Event{
+
+private:
+	std::string id_;
+
+public:
+	explicit Event(std::string_view id) : id_(id) {}
+
+	const std::string& id() const noexcept { return id_; }
+};
+
+namespace detail{
+
+// json text of typed events is built here, the buffer is kept per thread
+std::string& publishBuffer() noexcept;
+
+struct CallbackBase{
+	virtual ~CallbackBase() = default;
+};
+
+template<typename F>
+struct CallableSignature : CallableSignature<decltype(&F::operator())>{};
+
+template<typename R, typename... A>
+struct CallableSignature<R(*)(A...)>{ using args = std::tuple<A...>; };
+
+template<typename R, typename... A>
+struct CallableSignature<R(*)(A...) noexcept>{ using args = std::tuple<A...>; };
+
+template<typename R, typename C, typename... A>
+struct CallableSignature<R(C::*)(A...)>{ using args = std::tuple<A...>; };
+
+template<typename R, typename C, typename... A>
+struct CallableSignature<R(C::*)(A...) const>{ using args = std::tuple<A...>; };
+
+template<typename R, typename C, typename... A>
+struct CallableSignature<R(C::*)(A...) noexcept>{ using args = std::tuple<A...>; };
+
+template<typename R, typename C, typename... A>
+struct CallableSignature<R(C::*)(A...) const noexcept>{ using args = std::tuple<A...>; };
+
+// the decoded parameter is the first argument unless that is the FunctionCall, void for functions without parameters
+template<typename Args>
+struct ParameterOf{ using type = void; };
+
+template<typename A, typename... Rest>
+struct ParameterOf<std::tuple<A, Rest...>>{
+	using type = std::conditional_t<std::is_same_v<std::decay_t<A>, FunctionCall>, void, std::decay_t<A>>;
+};
+
+// fills call from the data handed to a function callback and returns the json value of its parameter
+inline json_object* parseFunctionCall(void* inp, FunctionCall& call) noexcept {
+	json_object* parameters = static_cast<json_object*>(inp);
+	json_object* value = nullptr;
+	json_object* field = nullptr;
+
+	if (json_object_object_get_ex(parameters, "functionParameters", &field)) {
+		json_object* complete = parameters;
+		parameters = field;
+
+		if (json_object_object_get_ex(complete, "functionId", &field))
+			call.functionId = MsbTraits<std::string_view>::decode(field);
+		if (json_object_object_get_ex(complete, "correlationId", &field))
+			call.correlationId = MsbTraits<std::string_view>::decode(field);
+	}
+
+	json_object_object_get_ex(parameters, "dataObject", &value);
+	return value;
+}
+
+template<typename Arg, typename F>
+struct FunctionCallback : CallbackBase{
+	F f;
+
+	explicit FunctionCallback(F callback) : f(std::move(callback)) {}
+
+	// handed to the C library as function pointer, the callback object is its context
+	static void trampoline(void* client, void* inp, void* context) noexcept {
+		FunctionCallback* self = static_cast<FunctionCallback*>(context);
+		FunctionCall call{static_cast<msbClient*>(client), {}, {}};
+		json_object* value = parseFunctionCall(inp, call);
+
+		try {
+			if constexpr (std::is_void_v<Arg>) {
+				if constexpr (std::is_invocable_v<F&, const FunctionCall&>) self->f(call);
+				else self->f();
+			} else {
+				if constexpr (std::is_invocable_v<F&, Arg, const FunctionCall&>) self->f(MsbTraits<Arg>::decode(value), call);
+				else self->f(MsbTraits<Arg>::decode(value));
+			}
+		} catch (...) {
+			/* exceptions must not unwind through the C library */
+		}
+	}
+};
+
+}
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#define MSBCLIENTC_CPP_COROUTINES
+
+// a call of a function added by Client::AddFunction<T>, owning its data
+template<typename T>
+struct Call{
+	T value;
+	std::string functionId;/* empty unless FwdCompleteFunctionCall is set */
+	std::string correlationId;/* empty unless FwdCompleteFunctionCall is set, needed for response events */
+};
+
+template<>
+struct Call<void>{
+	std::string functionId;
+	std::string correlationId;
+};
+
+template<typename T>
+class CallAwaiter;
+
+namespace detail{
+
+// views would refer to a call which is gone when a queued call is awaited
+template<typename T>
+struct HoldsView : std::is_same<T, std::string_view>{};
+
+template<typename T>
+struct HoldsView<std::vector<T>> : HoldsView<T>{};
+
+template<typename T, std::size_t N>
+struct HoldsView<std::array<T, N>> : HoldsView<T>{};
+
+// calls of a function, queued until they are awaited
+template<typename T>
+struct CallQueue : CallbackBase{
+	std::mutex mutex;
+	std::deque<Call<T>> calls;
+	std::deque<CallAwaiter<T>*> waiting;
+
+	static void trampoline(void* client, void* inp, void* context) noexcept {
+		CallQueue* self = static_cast<CallQueue*>(context);
+		FunctionCall info{static_cast<msbClient*>(client), {}, {}};
+		json_object* value = parseFunctionCall(inp, info);
+		CallAwaiter<T>* awaiter = nullptr;
+
+		try {
+			Call<T> call;
+			if constexpr (!std::is_void_v<T>) call.value = MsbTraits<T>::decode(value);
+			call.functionId.assign(info.functionId);
+			call.correlationId.assign(info.correlationId);
+
+			std::lock_guard<std::mutex> lock(self->mutex);
+			if (self->waiting.empty()) {
+				self->calls.push_back(std::move(call));
+				return;
+			}
+
+			awaiter = self->waiting.front();
+			self->waiting.pop_front();
+			awaiter->call_.emplace(std::move(call));
+		} catch (...) {
+			return;
+		}
+
+		awaiter->handle_.resume();
+	}
+};
+
+}
+
+// resumes the awaiting coroutine with the next call of a function, see Client::nextCall
+template<typename T>
+class CallAwaiter{
+
+private:
+	friend struct detail::CallQueue<T>;
+
+	detail::CallQueue<T>* queue_;
+	std::optional<Call<T>> call_;
+	std::coroutine_handle<> handle_;
+
+public:
+	explicit CallAwaiter(detail::CallQueue<T>* queue) noexcept : queue_(queue) {}
+
+	CallAwaiter(const CallAwaiter&) = delete;
+	CallAwaiter& operator=(const CallAwaiter&) = delete;
+
+	bool await_ready() const noexcept { return false; }
+
+	bool await_suspend(std::coroutine_handle<> handle) {
+		std::lock_guard<std::mutex> lock(queue_->mutex);
+
+		if (!queue_->calls.empty()) {
+			call_.emplace(std::move(queue_->calls.front()));
+			queue_->calls.pop_front();
+			return false;
+		}
+
+		handle_ = handle;
+		queue_->waiting.push_back(this);
+		return true;
+	}
+
+	Call<T> await_resume() { return std::move(*call_); }
+};
+
+// a function added by Client::AddFunction<T>, whose calls are awaited by Client::nextCall
+template<typename T>
+class Function{
+
+private:
+	detail::CallQueue<T>* queue_;
+	std::string id_;
+
+public:
+	Function(detail::CallQueue<T>* queue, std::string_view id) : queue_(queue), id_(id) {}
+
+	const std::string& id() const noexcept { return id_; }
+	detail::CallQueue<T>* queue() const noexcept { return queue_; }
+};
+
+// resumes the awaiting coroutine once the event has been written to the socket (or answered, with a publish window) or
+// dropped, see Client::publishAsync
+class PublishAwaiter{
+
+private:
+	msbClient* client_;
+	std::string eventId_;
+	std::string json_;
+	std::string corrId_;
+	MessagePriority priority_;
+	msbPublishCompletion completion_;
+	std::coroutine_handle<> handle_;
+	PublishStatus status_ = MSB_PUBLISH_DROPPED;
+	// whichever of await_suspend and the completion comes second resumes (or doesn't suspend) the coroutine
+	std::atomic<bool> arrived_{false};
+
+	static void completed(void*, msbPublishCompletion* completion, PublishStatus status) noexcept {
+		PublishAwaiter* self = static_cast<PublishAwaiter*>(completion->context);
+		self->status_ = status;
+		if (self->arrived_.exchange(true, std::memory_order_acq_rel)) self->handle_.resume();
+	}
+
+public:
+	PublishAwaiter(msbClient* client, std::string_view eId, std::string json, MessagePriority priority,
+				   std::string_view corrId)
+			: client_(client), eventId_(eId), json_(std::move(json)), corrId_(corrId), priority_(priority),
+			  completion_{&completed, this} {}
+
+	PublishAwaiter(const PublishAwaiter&) = delete;
+	PublishAwaiter& operator=(const PublishAwaiter&) = delete;
+
+	bool await_ready() const noexcept { return client_ == nullptr; }
+
+	bool await_suspend(std::coroutine_handle<> handle) noexcept {
+		handle_ = handle;
+
+		/*
+		 * once queued, the completion may run on the state machine's thread before this returns, a refused message is
+		 * reported as dropped before -1 is returned, both times the coroutine just goes on
+		 */
+		if (msbClientPublishJSONWithCompletion(client_, eventId_.data(), priority_, json_.data(), json_.size(),
+											   corrId_.empty() ? nullptr : corrId_.data(), &completion_) != 0)
+			return false;
+
+		return !arrived_.exchange(true, std::memory_order_acq_rel);
+	}
+
+	// true if the event has been sent, or acknowledged by the broker with a publish window
+	bool await_resume() const noexcept { return status_ == MSB_PUBLISH_SENT || status_ == MSB_PUBLISH_ACKNOWLEDGED; }
+
+	PublishStatus status() const noexcept { return status_; }
+};
+#endif
+
+/*
+ * Owns an msbClient, can be moved but not copied. Strings are taken as views and only copied where the C library needs
+ * them null terminated (ids up to 127 characters on the stack), json text is published without being parsed.
+ */
+class Client{
+
+private:
+	msbClient* client_ = nullptr;
+	std::vector<std::unique_ptr<detail::CallbackBase>> callbacks_;
+
+public:
+	Client(std::string_view url, std::string_view uuid, std::string_view token, std::string_view service_class,
+		   std::string_view name, std::string_view description, bool tls = false, std::string_view client_cert = {},
+		   std::string_view client_key = {}, std::string_view ca_cert = {});
+	explicit Client(msbClient* client) noexcept : client_(client) {}
+
+	Client(const Client&) = delete;
+	Client& operator=(const Client&) = delete;
+
+	Client(Client&& other) noexcept : client_(other.client_), callbacks_(std::move(other.callbacks_)) {
+		other.client_ = nullptr;
+	}
+	Client& operator=(Client&& other) noexcept;
+
+	~Client();
+
+	msbClient* get() const noexcept { return client_; }
+	msbClient* release() noexcept;
+	explicit operator bool() const noexcept { return client_ != nullptr; }
+
+	int RunClientStateMachine() noexcept;
+	int HaltClientStateMachine() noexcept;
+	int Register() noexcept;
+	bool ConnectionReady() noexcept;
+	void SetDebug(bool on_off) noexcept;
+	void SetSockJSFraming(bool on_off) noexcept;
+	void GenerateSockJSPath() noexcept;
+	void SetMaxMessageSize(std::uint32_t size) noexcept;
+	void FwdCompleteFunctionCall() noexcept;
+	bool SetPublishWindow(std::uint32_t window) noexcept;
+	msbPublishStatistics GetPublishStatistics() const noexcept;
+
+	void AddConfigParam(std::string_view cpId, PrimitiveType cpType, PrimitiveFormat cpFormat, void* value);
+
+	void AddFunction(std::string_view fId, std::string_view fName, std::string_view fDesc, void(*fPtr)(void*, void*, void*),
+					 PrimitiveType fType, PrimitiveFormat fFormat, bool isArray, void* contextPtr);
+	void AddEmptyFunction(std::string_view fId, std::string_view fName, std::string_view fDesc,
+						  void(*fPtr)(void*, void*, void*), void* contextPtr);
+
+	/*
+	 * Adds a function calling a lambda, std::function or function pointer. The parameter is decoded into the type of its
+	 * first argument (see MsbTraits, e.g. double or std::vector<std::int32_t>), which also gives the data type of the
+	 * function. Accepted signatures are (), (T), (const FunctionCall&) and (T, const FunctionCall&). The callable is
+	 * kept by the client, exceptions thrown by it are swallowed.
+	 */
+	template<typename F>
+	void AddFunction(std::string_view fId, std::string_view fName, std::string_view fDesc, F&& callback) {
+		using Callable = std::decay_t<F>;
+		using Arg = typename detail::ParameterOf<typename detail::CallableSignature<Callable>::args>::type;
+		using Callback = detail::FunctionCallback<Arg, Callable>;
+
+		std::unique_ptr<Callback> c(new Callback(std::forward<F>(callback)));
+
+		if constexpr (std::is_void_v<Arg>) {
+			AddEmptyFunction(fId, fName, fDesc, &Callback::trampoline, c.get());
+		} else {
+			static_assert(MsbTraits<Arg>::supported, "function parameter type has no MsbTraits");
+			AddFunction(fId, fName, fDesc, &Callback::trampoline, MsbTraits<Arg>::type, MsbTraits<Arg>::format,
+						MsbTraits<Arg>::is_array, c.get());
+		}
+
+		callbacks_.push_back(std::move(c));
+	}
+
+	// adds a function calling a member function of object, which has to outlive the client
+	template<typename C, typename R, typename... A>
+	void AddFunction(std::string_view fId, std::string_view fName, std::string_view fDesc, C* object,
+					 R (C::*method)(A...)) {
+		AddFunction(fId, fName, fDesc, [object, method](A... a) { (object->*method)(std::forward<A>(a)...); });
+	}
+
+	void AddResponseEventToFunction(std::string_view fId, std::string_view eId);
+
+	void AddEvent(std::string_view eId, std::string_view eName, std::string_view eDesc, PrimitiveType eType,
+				  PrimitiveFormat eFormat, bool isArray);
+	void AddEmptyEvent(std::string_view eId, std::string_view eName, std::string_view eDesc);
+
+	/*
+	 * Adds an event with the data type and format of T (see MsbTraits), e.g. float, std::vector<double> or
+	 * std::array<std::int32_t, 3>. Publishing the returned event only accepts values of T.
+	 */
+	template<typename T>
+	Event<T> AddEvent(std::string_view eId, std::string_view eName, std::string_view eDesc) {
+		static_assert(MsbTraits<T>::supported, "event type has no MsbTraits");
+
+		AddEvent(eId, eName, eDesc, MsbTraits<T>::type, MsbTraits<T>::format, MsbTraits<T>::is_array);
+		return Event<T>(eId);
+	}
+
+	// events whose ids can't be copied for lack of memory aren't published
+	void PublishEmpty(std::string_view eId, MessagePriority priority, std::string_view corrId = {}) noexcept;
+	void Publish(std::string_view eId, MessagePriority priority, const void* data, std::size_t array_length = 0,
+				 std::string_view corrId = {}) noexcept;
+	void PublishComplex(std::string_view eId, MessagePriority priority, json_object* pData,
+						std::string_view corrId = {}) noexcept;
+	void PublishFromString(std::string_view eId, MessagePriority priority, std::string_view json,
+						   std::string_view corrId = {}) noexcept;
+
+	// serialises value with the encoder of T and publishes the json text, without a type switch at runtime
+	template<typename T>
+	void Publish(const Event<T>& event, const detail::Identity_t<T>& value, MessagePriority priority = MEDIUM,
+				 std::string_view corrId = {}) noexcept {
+		std::string& json = detail::publishBuffer();
+
+		try {
+			json.clear();
+			MsbTraits<T>::encode(json, value);
+		} catch (...) {
+			return;
+		}
+
+		PublishFromString(event.id(), priority, json, corrId);
+	}
+
+#ifdef MSBCLIENTC_CPP_COROUTINES
+	/*
+	 * Adds a function whose calls are awaited with nextCall instead of being handed to a callback. Calls arriving while
+	 * no coroutine waits are queued. The parameter type can't be a view, as queued calls outlive the received message.
+	 */
+	template<typename T>
+	Function<T> AddFunction(std::string_view fId, std::string_view fName, std::string_view fDesc) {
+		static_assert(!detail::HoldsView<T>::value, "function parameters which are awaited have to own their data");
+		using Queue = detail::CallQueue<T>;
+
+		std::unique_ptr<Queue> q(new Queue());
+		Function<T> function(q.get(), fId);
+
+		if constexpr (std::is_void_v<T>) {
+			AddEmptyFunction(fId, fName, fDesc, &Queue::trampoline, q.get());
+		} else {
+			static_assert(MsbTraits<T>::supported, "function parameter type has no MsbTraits");
+			AddFunction(fId, fName, fDesc, &Queue::trampoline, MsbTraits<T>::type, MsbTraits<T>::format,
+						MsbTraits<T>::is_array, q.get());
+		}
+
+		callbacks_.push_back(std::move(q));
+		return function;
+	}
+
+	/*
+	 * co_await client.nextCall(function) gives the next Call<T> of the function. Like publishAsync the coroutine is
+	 * resumed by the thread driving the client's state machine (its own thread or the thread of its msbClientGroup),
+	 * unless a call is already queued.
+	 */
+	template<typename T>
+	CallAwaiter<T> nextCall(const Function<T>& function) noexcept {
+		return CallAwaiter<T>(function.queue());
+	}
+
+	/*
+	 * co_await client.publishAsync(event, value) publishes the value and resumes once it has been written to the
+	 * socket, giving true, or dropped, giving false. The client has to outlive the awaiting coroutine.
+	 */
+	template<typename T>
+	PublishAwaiter publishAsync(const Event<T>& event, const detail::Identity_t<T>& value,
+								MessagePriority priority = MEDIUM, std::string_view corrId = {}) {
+		std::string json;
+		MsbTraits<T>::encode(json, value);
+
+		return PublishAwaiter(client_, event.id(), std::move(json), priority, corrId);
+	}
+#endif
+
+	// array events also take any contiguous range of their elements
+	template<typename T, typename E = typename MsbTraits<T>::element>
+	void Publish(const Event<T>& event, Span<const detail::Identity_t<E>> values, MessagePriority priority = MEDIUM,
+				 std::string_view corrId = {}) noexcept {
+		std::string& json = detail::publishBuffer();
+
+		try {
+			json.clear();
+			MsbTraits<Span<const E>>::encode(json, values);
+		} catch (...) {
+			return;
+		}
+
+		PublishFromString(event.id(), priority, json, corrId);
+	}
+};
+
+}
+#endif /* SRC_MSBCLIENTC_CPPCLIENT_HPP */
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MsbClientC_CppClient.hpp"
+#include <cstdio>
+#include <exception>
+
+#ifndef MSBCLIENTC_CPP_COROUTINES
+#error "the coroutine test needs C++20 with <coroutine>"
+#endif
+
+#define UUID "444488885555"
+#define NAME "nopollCClient"
+#define DESCRIPTION "bschr"
+#define CLASS "SmartObject"
+#define TOKEN "123456"
+
+using namespace MsbClientC_CPPInt;
+
+extern "C" void msbClientAutomatBegin(msbClient* client);
+extern "C" void msbClientAutomatEnd(msbClient* client);
+
+// starts right away and runs to its end, the awaiters decide where it suspends
+struct Task{
+	struct promise_type{
+		Task get_return_object() noexcept { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+struct Served{
+	bool called = false;
+	bool published = false;
+	bool sent = false;
+	std::int32_t value = 0;
+};
+
+// answers the next call of the function with the doubled parameter
+static Task serve(Client& client, const Function<std::int32_t>& function, const Event<std::int32_t>& event,
+				  Served& served) {
+	Call<std::int32_t> call = co_await client.nextCall(function);
+	served.value = call.value;
+	served.called = true;
+
+	served.sent = co_await client.publishAsync(event, call.value * 2);
+	served.published = true;
+}
+
+/* calls the registered callback the way the client does for an incoming call, without the socket */
+static void call(Client& client, const char* fId, const char* parameters) {
+	msbObjectFunction* f = (msbObjectFunction*) schll_getValuePointer(client.get()->msbObjectData->functionArray, fId);
+	json_object* p = json_tokener_parse(parameters);
+
+	f->callback(client.get(), p, f->contextPtr);
+	json_object_put(p);
+}
+
+static int failed = 0;
+
+static void check(bool condition, const char* description) {
+	printf("%s: %s\n", condition ? "pass" : "FAIL", description);
+	if (!condition) ++failed;
+}
+
+int main(int argc, char** argv){
+	Client client("ws://127.0.0.1:8085", UUID, TOKEN, CLASS, NAME, DESCRIPTION);
+	Function<std::int32_t> function = client.AddFunction<std::int32_t>("F", "Function", "beschreibung");
+	Event<std::int32_t> event = client.AddEvent<std::int32_t>("Ev", "Event", "beschreibung");
+
+	msbClientAutomatBegin(client.get());
+	msbClientEnableEventCache(client.get());
+
+	Served first;
+	serve(client, function, event, first);
+	check(!first.called, "coroutine waits for the call");
+
+	call(client, "F", "{\"dataObject\":21}");
+	check(first.called && first.value == 21, "call resumes the coroutine with its parameter");
+	check(!first.published && list_count_entries(client.get()->outgoing_data) == 1,
+		  "coroutine waits for the queued event");
+
+	msbClientAutomatEnd(client.get());
+	check(first.published && !first.sent, "event dropped at the end of the state machine resumes the coroutine");
+
+	msbClientAutomatBegin(client.get());
+	msbClientEnableEventCache(client.get());
+	client.get()->maxNumberDataOutgoing = 0;
+
+	Served second;
+	call(client, "F", "{\"dataObject\":5}");
+	serve(client, function, event, second);
+	check(second.called && second.value == 5, "queued call is taken without suspending");
+	check(second.published && !second.sent, "event refused by the full queue goes on without suspending");
+
+	msbClientAutomatEnd(client.get());
+
+	printf("%d check(s) failed\n", failed);
+
+	return failed == 0 ? 0 : 1;
+}
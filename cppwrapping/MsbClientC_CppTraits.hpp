@@ -0,0 +1,310 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_MSBCLIENTC_CPPTRAITS_HPP
+#define SRC_MSBCLIENTC_CPPTRAITS_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <json-c/json.h>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+extern "C" {
+#include "MsbClientC.h"
+}
+
+namespace MsbClientC_CPPInt{
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+template<typename T>
+using Span = std::span<T>;
+#else
+// stand-in for std::span until C++20, a pointer and a length
+template<typename T>
+class Span{
+
+private:
+	T* data_ = nullptr;
+	std::size_t size_ = 0;
+
+public:
+	constexpr Span() noexcept = default;
+	constexpr Span(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+	template<std::size_t N>
+	constexpr Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+	template<typename Container, typename = std::enable_if_t<
+			std::is_convertible_v<decltype(std::data(std::declval<Container&>())), T*> &&
+			!std::is_array_v<std::remove_reference_t<Container>>>>
+	constexpr Span(Container&& container) noexcept : data_(std::data(container)), size_(std::size(container)) {}
+
+	constexpr T* data() const noexcept { return data_; }
+	constexpr std::size_t size() const noexcept { return size_; }
+	constexpr bool empty() const noexcept { return size_ == 0; }
+	constexpr T& operator[](std::size_t i) const noexcept { return data_[i]; }
+	constexpr T* begin() const noexcept { return data_; }
+	constexpr T* end() const noexcept { return data_ + size_; }
+};
+#endif
+
+namespace detail{
+
+template<typename T>
+struct Identity{ using type = T; };
+
+template<typename T>
+using Identity_t = typename Identity<T>::type;
+
+template<typename I>
+void encodeInteger(std::string& out, I value) {
+	char buffer[24];
+	std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, r.ptr);
+}
+
+// shortest text that reads back as the same value, with a fraction like json-c so it isn't read as integer
+template<typename F>
+void encodeNumber(std::string& out, F value) {
+	if (!std::isfinite(value)) {
+		out += "null";
+		return;
+	}
+
+	char buffer[32];
+#if defined(__cpp_lib_to_chars)
+	char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+#else
+	char* end = buffer + std::snprintf(buffer, sizeof(buffer), "%.*g", std::is_same_v<F, float> ? 9 : 17, (double) value);
+#endif
+	out.append(buffer, end);
+
+	if (std::string_view(buffer, (std::size_t) (end - buffer)).find_first_of(".eE") == std::string_view::npos) out += ".0";
+}
+
+inline void encodeString(std::string& out, std::string_view value) {
+	static const char hex[] = "0123456789abcdef";
+
+	out += '"';
+	for (char c : value) {
+		switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\b': out += "\\b"; break;
+			case '\f': out += "\\f"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if ((unsigned char) c < 0x20) {
+					out += "\\u00";
+					out += hex[(unsigned char) c >> 4];
+					out += hex[(unsigned char) c & 0xf];
+				} else {
+					out += c;
+				}
+		}
+	}
+	out += '"';
+}
+
+}
+
+/*
+ * Maps a C++ type to the MSB data type and format of an event or function, decodes a json value of that type and
+ * encodes one as json text. Only the specializations below are supported, anything else fails to compile where it is
+ * used. Each type has its own encoder, so publishing doesn't go through the type switch of msbClientPublish, and floats
+ * are written as floats (msbClientPublish reads MSB_FLOAT data as double).
+ */
+template<typename T, typename = void>
+struct MsbTraits{
+	static constexpr bool supported = false;
+};
+
+template<>
+struct MsbTraits<bool>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_BOOL;
+	static constexpr PrimitiveFormat format = MSB_NONE;
+	static constexpr bool is_array = false;
+
+	static bool decode(json_object* value) noexcept { return json_object_get_boolean(value) != 0; }
+	static void encode(std::string& out, bool value) { out += value ? "true" : "false"; }
+};
+
+template<>
+struct MsbTraits<std::int32_t>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_INTEGER;
+	static constexpr PrimitiveFormat format = MSB_INT32;
+	static constexpr bool is_array = false;
+
+	static std::int32_t decode(json_object* value) noexcept { return json_object_get_int(value); }
+	static void encode(std::string& out, std::int32_t value) { detail::encodeInteger(out, value); }
+};
+
+template<>
+struct MsbTraits<std::int64_t>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_INTEGER;
+	static constexpr PrimitiveFormat format = MSB_INT64;
+	static constexpr bool is_array = false;
+
+	static std::int64_t decode(json_object* value) noexcept { return json_object_get_int64(value); }
+	static void encode(std::string& out, std::int64_t value) { detail::encodeInteger(out, value); }
+};
+
+template<>
+struct MsbTraits<float>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_NUMBER;
+	static constexpr PrimitiveFormat format = MSB_FLOAT;
+	static constexpr bool is_array = false;
+
+	static float decode(json_object* value) noexcept { return (float) json_object_get_double(value); }
+	static void encode(std::string& out, float value) { detail::encodeNumber(out, value); }
+};
+
+template<>
+struct MsbTraits<double>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_NUMBER;
+	static constexpr PrimitiveFormat format = MSB_DOUBLE;
+	static constexpr bool is_array = false;
+
+	static double decode(json_object* value) noexcept { return json_object_get_double(value); }
+	static void encode(std::string& out, double value) { detail::encodeNumber(out, value); }
+};
+
+// refers to the parsed message, so it is only valid during the callback
+template<>
+struct MsbTraits<std::string_view>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_STRING;
+	static constexpr PrimitiveFormat format = MSB_NONE;
+	static constexpr bool is_array = false;
+
+	static std::string_view decode(json_object* value) noexcept {
+		const char* str = json_object_get_string(value);
+		return str != nullptr ? std::string_view(str, (std::size_t) json_object_get_string_len(value)) : std::string_view();
+	}
+	static void encode(std::string& out, std::string_view value) { detail::encodeString(out, value); }
+};
+
+template<>
+struct MsbTraits<std::string>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MSB_STRING;
+	static constexpr PrimitiveFormat format = MSB_NONE;
+	static constexpr bool is_array = false;
+
+	static std::string decode(json_object* value) { return std::string(MsbTraits<std::string_view>::decode(value)); }
+	static void encode(std::string& out, const std::string& value) { detail::encodeString(out, value); }
+};
+
+namespace detail{
+
+template<typename T>
+void encodeArray(std::string& out, const T* values, std::size_t n) {
+	out += '[';
+	for (std::size_t i = 0; i < n; ++i) {
+		if (i > 0) out += ',';
+		MsbTraits<T>::encode(out, values[i]);
+	}
+	out += ']';
+}
+
+}
+
+template<typename T>
+struct MsbTraits<std::vector<T>, std::enable_if_t<MsbTraits<T>::supported && !MsbTraits<T>::is_array>>{
+	using element = T;
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MsbTraits<T>::type;
+	static constexpr PrimitiveFormat format = MsbTraits<T>::format;
+	static constexpr bool is_array = true;
+
+	static std::vector<T> decode(json_object* value) {
+		std::size_t n = json_object_is_type(value, json_type_array) ? json_object_array_length(value) : 0;
+		std::vector<T> ret;
+		ret.reserve(n);
+
+		for (std::size_t i = 0; i < n; ++i) ret.push_back(MsbTraits<T>::decode(json_object_array_get_idx(value, i)));
+
+		return ret;
+	}
+
+	static void encode(std::string& out, const std::vector<T>& values) {
+		if constexpr (std::is_same_v<T, bool>) {
+			out += '[';
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				if (i > 0) out += ',';
+				MsbTraits<bool>::encode(out, values[i]);
+			}
+			out += ']';
+		} else {
+			detail::encodeArray(out, values.data(), values.size());
+		}
+	}
+};
+
+// surplus elements of the call are dropped, missing ones are value initialised
+template<typename T, std::size_t N>
+struct MsbTraits<std::array<T, N>, std::enable_if_t<MsbTraits<T>::supported && !MsbTraits<T>::is_array>>{
+	using element = T;
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MsbTraits<T>::type;
+	static constexpr PrimitiveFormat format = MsbTraits<T>::format;
+	static constexpr bool is_array = true;
+
+	static std::array<T, N> decode(json_object* value) {
+		std::size_t n = json_object_is_type(value, json_type_array) ? json_object_array_length(value) : 0;
+		std::array<T, N> ret{};
+
+		for (std::size_t i = 0; i < n && i < N; ++i) ret[i] = MsbTraits<T>::decode(json_object_array_get_idx(value, i));
+
+		return ret;
+	}
+
+	static void encode(std::string& out, const std::array<T, N>& values) { detail::encodeArray(out, values.data(), N); }
+};
+
+// publishing only, a span can't outlive the data it refers to
+template<typename T>
+struct MsbTraits<Span<T>, std::enable_if_t<MsbTraits<std::remove_const_t<T>>::supported &&
+										 !MsbTraits<std::remove_const_t<T>>::is_array>>{
+	static constexpr bool supported = true;
+	static constexpr PrimitiveType type = MsbTraits<std::remove_const_t<T>>::type;
+	static constexpr PrimitiveFormat format = MsbTraits<std::remove_const_t<T>>::format;
+	static constexpr bool is_array = true;
+
+	static void encode(std::string& out, Span<T> values) { detail::encodeArray(out, values.data(), values.size()); }
+};
+
+}
+#endif /* SRC_MSBCLIENTC_CPPTRAITS_HPP */
@@ -21,7 +21,7 @@ using namespace MsbClientC_CPPInt;
 MsbClient::MsbClient(std::string URL, std::string objUUID, std::string objToken, std::string objClass,
 					 std::string objName, std::string objDesc,
 					 bool tls, std::string client_cert, std::string client_key, std::string ca_cert) {
-	this->msbClientInstanz = msbClientNewClientURL((char*) URL.c_str(), (char*) objUUID.c_str(),
+	this->msbClientInstanz = msbClientNewClientURL((char*) URL.c_str(), NULL, (char*) objUUID.c_str(),
 													(char*) objToken.c_str(), (char*) objClass.c_str(),
 													(char*) objName.c_str(),
 													(char*) objDesc.c_str(), tls, (char*) client_cert.c_str(),
@@ -36,7 +36,7 @@ MsbClient::MsbClient(bool useIPv6, std::string targetAdr, std::string targetPort
 					 std::string objDesc, bool tls, std::string client_cert, std::string client_key,
 					 std::string ca_cert) {
 	this->msbClientInstanz = msbClientNewClient(useIPv6, (char*) targetAdr.c_str(), (char*) targetPort.c_str(),
-												 (char*) targetHostname.c_str(), (char*) targetPath.c_str(),
+												 (char*) targetHostname.c_str(), (char*) targetPath.c_str(), NULL,
 												 (char*) objUUID.c_str(),
 												 (char*) objToken.c_str(), (char*) objClass.c_str(),
 												 (char*) objName.c_str(), (char*) objDesc.c_str(), tls,
@@ -50,8 +50,12 @@ MsbClient::~MsbClient() {
 	msbClientDeleteClient(this->msbClientInstanz);
 }
 
+msbClient* MsbClient::GetInstance() {
+	return this->msbClientInstanz;
+}
+
 void MsbClient::Initialise() {
-	msbClientInitialise(this->msbClientInstanz);
+	msbClientInitialise(this->msbClientInstanz, false);
 }
 
 void MsbClient::Connect() {
@@ -40,6 +40,8 @@ public:
 	
 	virtual ~MsbClient();
 
+	msbClient* GetInstance();
+
 	volatile const int* dataOutInterfaceFlag;
 
 	void Initialise();
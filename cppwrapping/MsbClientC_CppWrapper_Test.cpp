@@ -15,8 +15,11 @@
  */
 
 #include "MsbClientC_CppWrapper.hpp"
+#include "MsbClientC_CppClient.hpp"
 #include "json.h"
 #include "cstring"
+#include <chrono>
+#include <string>
 
 #define UUID "444488885555"
 #define NAME "nopollCClient"
@@ -32,7 +35,9 @@
 
 using namespace MsbClientC_CPPInt;
 
-void testFunction(void* inp, void* context){
+extern "C" void msbClientAutomatBegin(msbClient* client);
+
+void testFunction(void* msbClient, void* inp, void* context){
     json_object* obj = json_object_object_get((json_object*)inp, "functionParameters"); //nötig, wenn der gesamte Funktionsaufruf durchgeleitet wird. Ist FwdCompleteFunctionCall nicht aktiv, reicht json_object* obj = (json_object*)inp;
 
     int32_t int_obj;
@@ -42,11 +47,11 @@ void testFunction(void* inp, void* context){
     printf("testFunction gerufen: %i\n", int_obj);
 }
 
-void testFunctionEmpty(void* inp, void* context){
+void testFunctionEmpty(void* msbClient, void* inp, void* context){
 	printf("testFunctionEmpty gerufen\n");
 }
 
-void testFunctionComplex(void* inp, void* context){
+void testFunctionComplex(void* msbClient, void* inp, void* context){
     json_object* obj = json_object_object_get((json_object*)inp, "functionParameters"); //nötig, wenn der gesamte Funktionsaufruf durchgeleitet wird. Ist FwdCompleteFunctionCall nicht aktiv, reicht json_object* obj = (json_object*)inp;
 
     int32_t int_obj;
@@ -59,7 +64,7 @@ void testFunctionComplex(void* inp, void* context){
 
 }
 
-void testFunctionFromString(void* inp, void* context){
+void testFunctionFromString(void* msbClient, void* inp, void* context){
     MsbClient* client = (MsbClient*)context;
 
     json_object* obj = json_object_object_get((json_object*)inp, "functionParameters"); //nötig, wenn der gesamte Funktionsaufruf durchgeleitet wird. Ist FwdCompleteFunctionCall nicht aktiv, reicht json_object* obj = (json_object*)inp;
@@ -78,7 +83,104 @@ void testFunctionFromString(void* inp, void* context){
     client->Publish((std::string)"Ev1", MEDIUM, &antwort, 0, (char*)json_object_get_string(json_object_object_get(obj, "correlationId"))); //ResponseEvent Ev1 schmeißen, correlationId aus dem Funktionsaufruf durchreichen
 }
 
-int main(){
+/* both wrappers publish into a client which isn't connected, its outgoing queue is emptied after every message */
+static void prepareBenchmarkClient(msbClient* client) {
+	msbClientAddEmptyEvent(client, (char*) "BenchmarkEventEmpty", (char*) "Benchmark", (char*) "beschreibung");
+	msbClientAddEvent(client, (char*) "BenchmarkEventInteger", (char*) "Benchmark", (char*) "beschreibung", MSB_INTEGER, MSB_INT32, false);
+	msbClientAddEventFromString(client, (char*) "BenchmarkEventComplex", (char*) "Benchmark", (char*) "beschreibung",
+								(char*) "{\"dataObject\":{\"type\":\"object\"}}", false);
+	msbClientAutomatBegin(client);
+	msbClientEnableEventCache(client);
+}
+
+template<typename F>
+static double benchmarkLoop(msbClient* client, int rounds, F publish) {
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < rounds; ++i) {
+		publish();
+		list_pop(client->outgoing_data, 0, 1);
+	}
+
+	std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+	return d.count() / rounds;
+}
+
+static double benchmark_sum = 0;
+
+static void benchmarkFunctionRaw(void* msbClient, void* inp, void* context){
+	json_object* values = json_object_object_get((json_object*)inp, "dataObject");
+	int n = values != NULL ? (int) json_object_array_length(values) : 0;
+
+	for (int i = 0; i < n; ++i) benchmark_sum += json_object_get_double(json_object_array_get_idx(values, i));
+}
+
+/* calls the registered callback the way the client does for an incoming call, without the socket */
+static double benchmarkCall(msbClient* client, const char* fId, json_object* parameters, int rounds) {
+	msbObjectFunction* f = (msbObjectFunction*) schll_getValuePointer(client->msbObjectData->functionArray, fId);
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < rounds; ++i) f->callback(client, parameters, f->contextPtr);
+
+	std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+	return d.count() / rounds;
+}
+
+static int benchmark(int rounds) {
+	MsbClient legacy("ws://127.0.0.1:8085", UUID, TOKEN, CLASS, NAME, DESCRIPTION, 0, "", "", "");
+	Client modern("ws://127.0.0.1:8085", UUID, TOKEN, CLASS, NAME, DESCRIPTION);
+
+	legacy.AddEvent("BenchmarkEventArray", "Benchmark", "beschreibung", MSB_NUMBER, MSB_DOUBLE, true);
+	Event<std::vector<double>> array = modern.AddEvent<std::vector<double>>("BenchmarkEventArray", "Benchmark", "beschreibung");
+
+	prepareBenchmarkClient(legacy.GetInstance());
+	prepareBenchmarkClient(modern.get());
+
+	std::string payload = "{\"values\":[";
+	while (payload.size() < 1000) payload += "123.456,";
+	payload += "0]}";
+
+	const std::string corrId = "benchmark-correlation-id-0123456789";
+	int32_t value = 42;
+
+	printf("wrapper benchmark: %i rounds, ns per message (legacy / string_view)\n", rounds);
+
+	double l = benchmarkLoop(legacy.GetInstance(), rounds, [&] { legacy.PublishEmpty("BenchmarkEventEmpty", HIGH, corrId); });
+	double m = benchmarkLoop(modern.get(), rounds, [&] { modern.PublishEmpty("BenchmarkEventEmpty", HIGH, corrId); });
+	printf("  PublishEmpty             %10.0f %10.0f\n", l, m);
+
+	l = benchmarkLoop(legacy.GetInstance(), rounds, [&] { legacy.Publish("BenchmarkEventInteger", HIGH, &value, 0, corrId); });
+	m = benchmarkLoop(modern.get(), rounds, [&] { modern.Publish("BenchmarkEventInteger", HIGH, &value, 0, corrId); });
+	printf("  Publish int32            %10.0f %10.0f\n", l, m);
+
+	l = benchmarkLoop(legacy.GetInstance(), rounds, [&] { legacy.PublishFromString("BenchmarkEventComplex", HIGH, payload, corrId); });
+	m = benchmarkLoop(modern.get(), rounds, [&] { modern.PublishFromString("BenchmarkEventComplex", HIGH, payload, corrId); });
+	printf("  PublishFromString 1 KiB  %10.0f %10.0f\n", l, m);
+
+	std::vector<double> values(64);
+	for (size_t i = 0; i < values.size(); ++i) values[i] = i * 0.25;
+
+	l = benchmarkLoop(legacy.GetInstance(), rounds, [&] { legacy.Publish("BenchmarkEventArray", HIGH, values.data(), values.size(), corrId); });
+	m = benchmarkLoop(modern.get(), rounds, [&] { modern.Publish(array, values, HIGH, corrId); });
+	printf("  Publish double[64]       %10.0f %10.0f (void* / Event<std::vector<double>>)\n", l, m);
+
+	legacy.AddFunction("BenchmarkFunction", "Benchmark", "beschreibung", &benchmarkFunctionRaw, MSB_NUMBER, MSB_DOUBLE, true, NULL);
+	modern.AddFunction("BenchmarkFunction", "Benchmark", "beschreibung", [](const std::vector<double>& values) {
+		for (double v : values) benchmark_sum += v;
+	});
+
+	json_object* parameters = json_tokener_parse("{\"dataObject\":[1.5,2.5,3.5,4.5,5.5,6.5,7.5,8.5]}");
+	l = benchmarkCall(legacy.GetInstance(), "BenchmarkFunction", parameters, rounds);
+	m = benchmarkCall(modern.get(), "BenchmarkFunction", parameters, rounds);
+	printf("  function call double[8]  %10.0f %10.0f (json-c by hand / typed callback)\n", l, m);
+	json_object_put(parameters);
+
+	return 0;
+}
+
+int main(int argc, char** argv){
+
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) return benchmark(argc > 2 ? atoi(argv[2]) : 100000);
 
 	MsbClient* msbClient = new MsbClient( "ws://172.21.5.70:8085", UUID, TOKEN, CLASS, NAME, DESCRIPTION, 0, std::string(""), "", "");
 	msbClient->GenerateSockJSPath();
@@ -21,12 +21,29 @@
 * @brief Msb C Client functions
 */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "MsbClientC.h"
 
 #include <uuid/uuid.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <limits.h>
 #include "websocket/websocket.h"
+#include "codec/msgpack.h"
+#include "MsbClientC_internal.h"
+
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 #include "rest/schll.c"
+#include "rest/mpool.c"
 #include "rest/einfl.c"
 
 /**
@@ -186,6 +203,56 @@ const char* msbObjectSelfDescription(const msbObject* object);
  */
 msbObject* msbObjectCreateObject(char* uuid, char* token, char* service_class, char* name, char* description);
 
+/**
+ * @brief Internal function for taking memory out of an Msb object arena
+ *
+ * @param arena pointer to arena
+ * @param size number of bytes
+ *
+ * @return pointer to zeroed memory, valid until the arena is released
+ */
+void* msbObjectArenaAlloc(msbObjectArena* arena, size_t size);
+
+/**
+ * @brief Internal function for duplicating a string into an Msb object arena
+ *
+ * @param arena pointer to arena
+ * @param str string to duplicate, can be null
+ *
+ * @return duplicated string, null if str is null
+ */
+char* msbObjectArenaStrdup(msbObjectArena* arena, const char* str);
+
+/**
+ * @brief Internal function for replacing a string kept in an Msb object arena
+ *
+ * @param arena pointer to arena
+ * @param former string to replace, can be null
+ * @param size bytes the former string can take, updated if new memory is taken
+ * @param str new string, can be null
+ *
+ * @return former if str fits into it or can't be duplicated, the duplicated string otherwise
+ */
+char* msbObjectArenaStrreplace(msbObjectArena* arena, char* former, size_t* size, const char* str);
+
+/**
+ * @brief Internal function for releasing all chunks of an Msb object arena
+ *
+ * @param arena pointer to arena
+ */
+void msbObjectArenaRelease(msbObjectArena* arena);
+
+/**
+ * @brief Internal function for letting an Msb object arena take all further memory from a region
+ *
+ * @param arena pointer to arena
+ * @param region memory aligned to 16 bytes, has to outlive the arena
+ * @param size size of the region in bytes
+ *
+ * @return false if the region is too small
+ */
+bool msbObjectArenaUseRegion(msbObjectArena* arena, void* region, size_t size);
+
 /**
  * @brief Internal function for getting an IPv4 out of an address
  *
@@ -276,6 +343,21 @@ void msbClientAutomatThread(msbClient* client);
 DWORD WINAPI msbClientAutomatThread(msbClient*);
 #endif
 
+/**
+ * @brief Internal function for completing the oldest event message waiting for the answer of the broker
+ *
+ * @param client Pointer to Msb client
+ * @param status MSB_PUBLISH_ACKNOWLEDGED or MSB_PUBLISH_REJECTED
+ */
+static void msbClientAcknowledgePublish(msbClient* client, PublishStatus status);
+
+/**
+ * @brief Internal function for waking up the client group thread hosting the client, if any
+ *
+ * @param client Pointer to Msb client
+ */
+void msbClientWake(msbClient* client);
+
 /**
  * @brief Internal function for sending a text over the websocket connection
  *
@@ -287,6 +369,118 @@ DWORD WINAPI msbClientAutomatThread(msbClient*);
  */
 int msbClientSendText(msbClient* client, const char* msg, size_t msg_length);
 
+/** size of the fragments a streamed event is sent in */
+#define MSB_STREAM_FRAGMENT_SIZE 65536
+
+/** kinds of the entries in the outgoing queue: a complete event message, or the envelope of a streamed event */
+#define MSB_OUTGOING_MESSAGE 0
+#define MSB_OUTGOING_STREAM 1
+
+/**
+ * @brief Internal function for sending a fragment of a text message over the websocket connection
+ *
+ * @param client Pointer to Msb client
+ * @param fragment Pointer to the fragment
+ * @param length Fragment length
+ * @param first Flag for the first fragment of the message
+ * @param last Flag for the last fragment of the message
+ *
+ * @return 0 if the fragment has been sent
+ */
+static int msbClientSendFragment(msbClient* client, const char* fragment, size_t length, bool first, bool last);
+
+/**
+ * @brief Internal function for sending the next fragment of the streamed event, the last one completes the event
+ *
+ * @param client Pointer to Msb client
+ *
+ * @return true if a fragment has been sent
+ */
+static bool msbClientStreamStep(msbClient* client);
+
+/**
+ * @brief Internal function for queueing a message received over the websocket connection
+ *
+ * The queue takes over the payload of the transport if possible, otherwise it's copied. Binary frames are decoded by
+ * the codec.
+ *
+ * @param client Pointer to Msb client
+ * @param incoming_data Queue of incoming messages
+ *
+ * @return true if a message has been queued
+ */
+static bool msbClientReceive(msbClient* client, list_list* incoming_data);
+
+/**
+ * @brief Internal function for putting a received message into the queue of incoming messages, decoding binary frames
+ *
+ * Also the handler of the websocket layer in callback mode, see msbClientSetReceiveMode.
+ *
+ * @param context Pointer to Msb client
+ * @param msg Payload of the message
+ * @param length Length of the payload
+ * @param binary Flag for a binary frame
+ * @param ref Reference keeping the payload valid until it's handed to wsReleaseMsg, NULL if it has to be copied
+ *
+ * @return true if the message has been queued
+ */
+static bool msbClientQueueReceived(void* context, char* msg, size_t length, bool binary, void* ref);
+
+/**
+ * @brief Internal function for waiting on the connection instead of sleeping in callback mode
+ *
+ * @param client Pointer to Msb client
+ * @param timeout_us Maximum time to wait in µs
+ *
+ * @return false if the state machine thread has to sleep instead
+ */
+static bool msbClientWaitIncoming(msbClient* client, uint32_t timeout_us);
+
+/**
+ * @brief Internal function for receiving a message if the queue of incoming messages has room for it
+ *
+ * A full queue either pauses reading until it's down to the low watermark (backpressure) or the message is read and
+ * discarded.
+ *
+ * @param client Pointer to Msb client
+ * @param incoming_data Queue of incoming messages
+ *
+ * @return true if a message has been queued
+ */
+static bool msbClientReceiveIfRoom(msbClient* client, list_list* incoming_data);
+
+/**
+ * @brief Internal function for removing the first message from the queue of incoming messages
+ *
+ * @param client Pointer to Msb client
+ *
+ * @return list operation value
+ */
+static list_return_value msbClientPopIncoming(msbClient* client);
+
+/**
+ * @brief Internal function for processing incoming messages within the receive budget of a state machine cycle
+ *
+ * Works off the queue and reads further messages from the connection whenever it runs empty, until no message is
+ * left, the message or time budget is used up, a message can't be processed yet or the state has changed.
+ *
+ * @param client Pointer to Msb client
+ * @param incoming_data Queue of incoming messages
+ * @param received Pointer to a flag which is set if a message has been read from the connection
+ *
+ * @return number of messages processed
+ */
+static uint32_t msbClientProcessIncoming(msbClient* client, list_list* incoming_data, bool* received);
+
+/**
+ * @brief Internal function for getting the stage of the calling thread, which is created by its first call
+ *
+ * @param client Pointer to Msb client
+ *
+ * @return Pointer to the stage, NULL if it couldn't be created
+ */
+static msbPublishStage* msbClientThreadStage(msbClient* client);
+
 const char* messageTypes[11] = {
         "IO",
         "NIO",
@@ -321,13 +515,48 @@ int getMsgType(const unsigned char* inh) {
 
 }
 
+/* a SockJS message is a json array holding one json string, it is unwrapped in place since it only gets shorter */
+static void msbClientUnframeSockJS(char* inh) {
+
+    size_t l = strlen(inh);
+
+    if (l < 5 || strncmp(inh, "a[\"", 3) != 0 || strcmp(inh + l - 2, "\"]") != 0) return;
+
+    const char* r = inh + 3;
+    const char* end = inh + l - 2;
+    char* w = inh;
+
+    while (r < end) {
+        if (r[0] == '\\' && r + 1 < end) {
+            char c = 0;
+
+            switch (r[1]) {
+                case '"': case '\\': case '/': c = r[1]; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                default: break;
+            }
+
+            if (c != 0) {
+                *w++ = c;
+                r += 2;
+                continue;
+            }
+        }
+
+        *w++ = *r++;
+    }
+
+    *w = 0;
+}
+
 int msbMsgFunction(msbClient* client, char* inh) {
 
     if (inh == NULL) return 0;
 
-    bool free_inh_flag;
-    free_inh_flag = false;
-
     if (client->sockJs_framing) {
         if(strncmp(inh, "o", 1) == 0){
             if (client->debug) client->debugFunction("Msb message function: SockJS open frame\n");
@@ -342,25 +571,16 @@ int msbMsgFunction(msbClient* client, char* inh) {
         }else if(strncmp(inh, "a[", 2) == 0) {
             if (client->debug) client->debugFunction("Msb message function: SockJS regular message\n");
 
-            char* tmp;
-            tmp = NULL;
-
-            if (!string_replace(inh, "a[\"", "", &tmp)) {
-                if (!string_replace(tmp, "\"]", "", &inh)) {
-                    free(tmp);
-                    if (!string_replace(inh, "\\\"", "\"", &tmp)) {
-                        free(inh);
-                        inh = tmp;
-                        free_inh_flag = true;
-                    }
-                }
-            }
+            msbClientUnframeSockJS(inh);
         }
     }
 
     if (client->debug) client->debugFunction("Msb message function: Incoming message: %s\n", inh);
 
     if (strncmp(inh, "ping", 4) == 0) {
+        /* no text frame may go between the fragments of a streamed event, the ping stays queued until its end */
+        if (client->stream != NULL) return -1;
+
         if (client->debug) client->debugFunction("Msb message function: Received Ping, sending pong\n");
 
         int ret;
@@ -368,7 +588,6 @@ int msbMsgFunction(msbClient* client, char* inh) {
 
         ret = msbClientSendText(client, pong, strlen(pong));
 
-        if(free_inh_flag) free(inh);
         return ret;
     }
 
@@ -384,23 +603,32 @@ int msbMsgFunction(msbClient* client, char* inh) {
     if (mtyp == 2) {
         client->currentStatusAutomat = CONNECTED;
         msbClientRegister(client);
-        if(free_inh_flag) free(inh);
         return 0;
     }else if (mtyp == 3) {
         client->currentStatusAutomat = REGISTERED;
-        if(free_inh_flag) free(inh);
+        return 0;
+    }else if (mtyp == 4) {
+        msbClientAcknowledgePublish(client, MSB_PUBLISH_ACKNOWLEDGED);
+        return 0;
+    }else if (mtyp == 9 || mtyp == 10) {
+        msbClientAcknowledgePublish(client, MSB_PUBLISH_REJECTED);
         return 0;
     }else if (mtyp != -1) {
-        if(free_inh_flag) free(inh);
         return 0;
     }
 
-    char* tmp;
-    tmp = NULL;
-    string_replace(inh, "\\/", "/", &tmp);
+    char* r = inh;
+    char* w = inh;
 
-    if(free_inh_flag) free(inh);
-    inh = tmp;
+    while (*r != 0) {
+        if (r[0] == '\\' && r[1] == '/') {
+            *w++ = '/';
+            r += 2;
+        } else {
+            *w++ = *r++;
+        }
+    }
+    *w = 0;
 
     char* in = &inh[2];
 
@@ -413,6 +641,7 @@ int msbMsgFunction(msbClient* client, char* inh) {
 
             if (schll_getValue(client->msbObjectData->functionArray, (void**) &function,
                                json_object_get_string(json_object_object_get(jobj, "functionId"))) != SCHLL_OK) {
+                json_object_put(jobj);
                 break;
             }
 
@@ -422,7 +651,7 @@ int msbMsgFunction(msbClient* client, char* inh) {
                 function->callback(client, (void*) json_object_object_get(jobj, "functionParameters"), function->contextPtr);
             }
 
-            free(jobj);
+            json_object_put(jobj);
             break;
         }
         case 'K': {
@@ -496,8 +725,6 @@ int msbMsgFunction(msbClient* client, char* inh) {
             break;
     }
 
-    free(inh);
-
     return 0;
 
 }
@@ -541,378 +768,1695 @@ if (corrId == NULL){\
 }\
 json_object_object_add(root, "correlationId", json_object_new_string(corrId));\
 
-#define publish_send_and_close \
-if(client->outgoing_data != NULL){\
-    json_object_object_add(root, "dataObject", dataJ);\
-    char* msg = string_combine("E ", json_object_to_json_string(root));\
-    /*pthread_mutex_lock(&client->outgoing_data->mutex);*/\
-    if ((client->currentStatusAutomat == REGISTERED || client->dataOutCache == 1) &&\
-        list_count_entries(client->outgoing_data) < client->maxNumberDataOutgoing) { \
-        if (strlen(msg) < client->maxMessageSize) { \
-            list_add(client->outgoing_data, msg, 1, strlen(msg) + 1);\
-        }\
-    }\
-    /*pthread_mutex_unlock(&client->outgoing_data->mutex);*/\
-    free(msg);\
-    free(root);\
-}
-
-//pthread_mutex_lock(&client->mutex);
-//pthread_mutex_unlock(&client->mutex);\
-
-#define publish_send_and_close_WIN32 \
-if(client->outgoing_data != NULL){\
-json_object_object_add(root, "dataObject", dataJ);\
-char* msg = string_combine("E ", json_object_to_json_string(root));\
-DWORD dwWaitResult = WaitForSingleObject(\
-        client->mutex,\
-        INFINITE);\
-if(dwWaitResult == WAIT_OBJECT_0){\
-if ((client->currentStatusAutomat == REGISTERED || client->dataOutCache == 1) &&\
-list_count_entries(client->outgoing_data) < client->maxNumberDataOutgoing) { \
-if (strlen(msg) < client->maxMessageSize) { \
-list_add(client->outgoing_data, msg, 1, strlen(msg) + 1);\
- }}\
-}\
-ReleaseMutex(client->mutex);\
-#endif\
-free(msg);\
-free(root);\
-}
+char* msbClientEventMessage(msbClient* client, json_object* root, size_t* length) {
 
-void msbClientPublish(msbClient* client, char* eId, MessagePriority mp, void* data, size_t arr_l, char* corrId) {
+    const char* json = json_object_to_json_string(root);
+    size_t l = strlen(json);
 
-    publish_entry
-    publish_common_inf
+    char* msg = (char*) mpool_alloc(client->buffer_pool, l + 3);
 
-#ifdef _WIN32
-    publish_make_correlation_id_WIN32
-#else
-    publish_make_correlation_id
-#endif
+    if (msg == NULL) return NULL;
 
-    switch (ev->type) {
-        case MSB_ARRAY:
-            if (arr_l <= 0) {
-                client->debugFunction("msbClientPublish: Event is of type array, but arraylength is invalid. arr_l = %i\n",
-                       (int) arr_l);
-                return;
-            }
+    memcpy(msg, "E ", 2);
+    memcpy(msg + 2, json, l + 1);
 
-            size_t i;
-            i = 0;
+    *length = l + 2;
 
-            dataJ = json_object_new_array();
-            switch (ev->array_subtype) {
-                case MSB_INTEGER:
-                    if (ev->array_subformat == MSB_INT32) {
-                        int32_t (*arr_p)[arr_l] = data;
-                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int((*arr_p)[i]));
-                    } else if (ev->array_subformat == MSB_INT64) {
-                        int64_t (*arr_p)[arr_l] = data;
-                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int64((*arr_p)[i]));
-                    }
-                    break;
-                case MSB_NUMBER:
-                    if (ev->format == MSB_FLOAT || ev->format == MSB_DOUBLE) {
-                        double (*arr_p)[arr_l] = data;
-                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_double((*arr_p)[i]));
-                    } else if (ev->format == MSB_BYTE) {
-                        int32_t (*arr_p)[arr_l] = data;
-                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int((*arr_p)[i]));
-                    }
-                    break;
-                case MSB_BOOL: {
-                    json_bool (*arr_p)[arr_l] = data;
-                    for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_boolean((*arr_p)[i]));
-                    }
-                    break;
-                case MSB_STRING: {
-                    char* (*arr_p)[arr_l] = data;
-                    for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_string((*arr_p)[i]));
-                    }
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case MSB_INTEGER:
-            if (ev->format == MSB_INT32)
-                dataJ = json_object_new_int(*(int32_t*) data);
-            else if (ev->format == MSB_INT64)
-                dataJ = json_object_new_int64(*(int64_t*) data);
-            break;
-        case MSB_NUMBER:
-            if (ev->format == MSB_FLOAT || ev->format == MSB_DOUBLE)
-                dataJ = json_object_new_double(*(double*) data);
-            else if (ev->format == MSB_BYTE)
-                dataJ = json_object_new_int(*(int32_t*) data);
-            break;
-        case MSB_BOOL:
-            dataJ = json_object_new_boolean(*(json_bool*) data);
-            break;
-        case MSB_STRING:
-            dataJ = json_object_new_string((char*) data);
-            break;
-        default:
-            break;
+    return msg;
+}
+
+/* adds the data object to root and queues the event message, root is released in any case */
+static int msbClientQueueJSON(msbClient* client, msbObjectEvent* ev, json_object* root, json_object* dataJ) {
+    int ret = -1;
+
+    if (client->outgoing_data == NULL) {
+        json_object_put(dataJ);
+        json_object_put(root);
+        return -1;
     }
 
+    json_object_object_add(root, "dataObject", dataJ);
+
 #ifdef _WIN32
-    publish_send_and_close_WIN32
-#else
-    publish_send_and_close
+    if (WaitForSingleObject(client->mutex, INFINITE) == WAIT_OBJECT_0) {
+#endif
+    if (client->currentStatusAutomat == REGISTERED || client->dataOutCache == 1) {
+        size_t msg_l;
+        char* msg = msbClientEventMessage(client, root, &msg_l);
+        if (msg != NULL) ret = msbClientQueueEvent(client, ev, msg, msg_l, NULL, MSB_OUTGOING_MESSAGE);
+        if (ret == 0) msbClientWake(client);
+    }
+#ifdef _WIN32
+    ReleaseMutex(client->mutex);
+    }
 #endif
+
+    json_object_put(root);
+
+    return ret;
 }
 
-void msbClientPublishEmpty(msbClient* client, char* eId, MessagePriority mp, char* corrId) {
+static void msbClientCompletePublish(msbClient* client, void* completion, PublishStatus status) {
+    msbPublishCompletion* c = (msbPublishCompletion*) completion;
 
-    publish_entry
-    publish_common_inf
+    if (c != NULL && c->callback != NULL) c->callback(client, c, status);
+}
 
-#ifdef _WIN32
-    publish_make_correlation_id_WIN32
-    publish_send_and_close_WIN32
-#else
-    publish_make_correlation_id
-    publish_send_and_close
-#endif
+static uint64_t msbClientTimeUs(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
 }
 
-void msbClientPublishComplex(msbClient* client, char* eId, MessagePriority mp, json_object* obj, char* corrId) {
+/* the broker answers event messages in the order they have been sent, so the answer belongs to the oldest one */
+static void msbClientAcknowledgePublish(msbClient* client, PublishStatus status) {
+    msbPublishStatistics* stats = &client->publish_statistics;
 
-    publish_entry
-    publish_common_inf
+    if (client->in_flight == NULL || stats->in_flight == 0) return;
 
-#ifdef _WIN32
-    publish_make_correlation_id_WIN32
-#else
-    publish_make_correlation_id
-#endif
+    msbPublishInFlight* f = &client->in_flight[client->in_flight_first];
+    uint64_t latency = msbClientTimeUs() - f->sent;
+    uint32_t l = latency > UINT32_MAX ? UINT32_MAX : (uint32_t) latency;
+    msbPublishCompletion* completion = f->completion;
 
-    dataJ = obj;
+    client->in_flight_first = (client->in_flight_first + 1) % client->in_flight_window;
+    stats->in_flight--;
 
-#ifdef _WIN32
-    publish_send_and_close_WIN32
-#else
-    publish_send_and_close
-#endif
+    if (status == MSB_PUBLISH_ACKNOWLEDGED)
+        stats->acknowledged++;
+    else
+        stats->rejected++;
+
+    if (stats->acknowledged + stats->rejected == 1 || l < stats->latency_min) stats->latency_min = l;
+    if (l > stats->latency_max) stats->latency_max = l;
+    stats->latency_sum += l;
+
+    msbClientCompletePublish(client, completion, status);
 }
 
-void msbClientPublishFromString(msbClient* client, char* eId, MessagePriority mp, char* string, char* corrId) {
+/* the completions of the event messages in flight report them as dropped, their answers aren't waited for anymore */
+static void msbClientLoseInFlight(msbClient* client) {
+    msbPublishStatistics* stats = &client->publish_statistics;
 
-    json_object* obj = json_tokener_parse(string);
+    while (client->in_flight != NULL && stats->in_flight > 0) {
+        msbPublishCompletion* completion = client->in_flight[client->in_flight_first].completion;
 
-    msbClientPublishComplex(client, eId, mp, obj, corrId);
+        client->in_flight_first = (client->in_flight_first + 1) % client->in_flight_window;
+        stats->in_flight--;
+        stats->lost++;
 
+        msbClientCompletePublish(client, completion, MSB_PUBLISH_DROPPED);
+    }
 }
 
-int msbClientRunClientStateMachine(msbClient* client) {
-    client->force_exit = false;
-#ifndef _WIN32
-    pthread_attr_init(&(client->thread_attr));
-    return pthread_create(&(client->thread), &(client->thread_attr), (void*) msbClientAutomatThread, client);
-#else
-    client->thread = CreateThread(NULL, 0, msbClientAutomatThread, client, 0, NULL);
-#endif
-}
+/* a lost answer must not hold back the publish window until the connection is lost */
+static void msbClientExpireInFlight(msbClient* client) {
+    msbPublishStatistics* stats = &client->publish_statistics;
 
-int msbClientHaltClientStateMachine(msbClient* client) {
-    client->force_exit = true;
-#ifndef _WIN32
-    pthread_join(client->thread, NULL);
-    return pthread_attr_destroy(&(client->thread_attr));
-#endif
+    if (client->in_flight == NULL || stats->in_flight == 0 || client->in_flight_timeout == 0) return;
+
+    if (msbClientTimeUs() - client->in_flight[client->in_flight_first].sent < client->in_flight_timeout) return;
+
+    stats->timeouts++;
+    msbClientLoseInFlight(client);
 }
 
-#ifndef _WIN32
-void msbClientAutomatThread(msbClient* client) {
-#else
-    DWORD WINAPI msbClientAutomatThread(msbClient* client){
-#endif
+/* answers to event messages sent over a lost connection won't come anymore */
+static void msbClientLosePublishes(msbClient* client) {
 
-    wsData* ws;
-    ws = client->websocketData;
+    /* a fragmented message can't be resumed on another connection */
+    if (client->stream != NULL) {
+        msbPublishStream* stream = client->stream;
+        client->stream = NULL;
+        client->stream_pending = 0;
+        client->stream_pending_last = false;
+        msbClientCompletePublish(client, &stream->completion, MSB_PUBLISH_DROPPED);
+    }
 
-    client->currentStatusAutomat = CREATED;
+    msbClientLoseInFlight(client);
+}
+
+/* with a publish window the completion waits for the answer of the broker */
+static void msbClientSentPublish(msbClient* client, void* completion) {
+    if (client->in_flight != NULL) {
+        msbPublishStatistics* stats = &client->publish_statistics;
+        msbPublishInFlight* f =
+                &client->in_flight[(client->in_flight_first + stats->in_flight) % client->in_flight_window];
+
+        f->completion = (msbPublishCompletion*) completion;
+        f->sent = msbClientTimeUs();
+        stats->in_flight++;
+        stats->sent++;
+    } else {
+        msbClientCompletePublish(client, completion, MSB_PUBLISH_SENT);
+    }
+}
+
+/* the SockJS frame is a json array holding the message as json string: quotes, backslashes, line breaks, carriage
+ * returns and tabs are escaped by a backslash, other control characters as \u00XX; without buffer only the escaped
+ * length is counted */
+static size_t msbClientEscapeSockJS(char* frame, const char* msg, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    size_t i, j = 0;
+
+    for (i = 0; i < length; ++i) {
+        unsigned char c = (unsigned char) msg[i];
+
+        if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t') {
+            if (frame != NULL) {
+                frame[j] = '\\';
+                frame[j + 1] = c == '\n' ? 'n' : c == '\r' ? 'r' : c == '\t' ? 't' : (char) c;
+            }
+            j += 2;
+        } else if (c < 0x20) {
+            if (frame != NULL) {
+                memcpy(frame + j, "\\u00", 4);
+                frame[j + 4] = hex[c >> 4];
+                frame[j + 5] = hex[c & 0x0f];
+            }
+            j += 6;
+        } else {
+            if (frame != NULL) frame[j] = (char) c;
+            ++j;
+        }
+    }
+
+    return j;
+}
+
+static int msbClientSendFragment(msbClient* client, const char* fragment, size_t length, bool first, bool last) {
+
+    if (!client->sockJs_framing) return wsSendFragment(client->websocketData, first, last, fragment, length);
+
+    /* the json string is escaped fragment by fragment */
+    size_t j = 0;
+    char* frame = (char*) mpool_alloc(client->buffer_pool, msbClientEscapeSockJS(NULL, fragment, length) + 4);
+
+    if (frame == NULL) return -1;
+
+    if (first) {
+        frame[j++] = '[';
+        frame[j++] = '"';
+    }
+
+    j += msbClientEscapeSockJS(frame + j, fragment, length);
+
+    if (last) {
+        frame[j++] = '"';
+        frame[j++] = ']';
+    }
+
+    int ret = wsSendFragment(client->websocketData, first, last, frame, j);
+
+    mpool_free(client->buffer_pool, frame);
+
+    return ret;
+}
+
+static bool msbClientStreamStep(msbClient* client) {
+
+    msbPublishStream* stream = client->stream;
+    size_t length = client->stream_pending;
+    bool last = client->stream_pending_last;
+
+    if (client->stream_fragment == NULL) {
+        client->stream_fragment = (char*) malloc(MSB_STREAM_FRAGMENT_SIZE);
+        if (client->stream_fragment == NULL) return false;
+    }
+
+    /* a fragment that couldn't be sent has already been read, it's sent again before the next one is read */
+    if (length == 0) {
+        length = stream->read(stream->context, client->stream_fragment, MSB_STREAM_FRAGMENT_SIZE);
+        last = length == 0;
+
+        /* the last fragment closes the envelope */
+        if (last) {
+            client->stream_fragment[0] = '}';
+            length = 1;
+        } else if (length > MSB_STREAM_FRAGMENT_SIZE) {
+            length = MSB_STREAM_FRAGMENT_SIZE;
+        }
+    }
+
+    if (msbClientSendFragment(client, client->stream_fragment, length, false, last) != 0) {
+        client->stream_pending = length;
+        client->stream_pending_last = last;
+        return false;
+    }
+
+    client->stream_pending = 0;
+    client->stream_pending_last = false;
+
+    if (last) {
+        client->stream = NULL;
+        msbClientSentPublish(client, &stream->completion);
+    }
+
+    return true;
+}
+
+static int msbClientEnqueueEvent(msbClient* client, msbObjectEvent* ev, char* msg, size_t length,
+                                 msbPublishCompletion* completion, int kind) {
+
+    if (ev->overflowPolicy == MSB_OVERFLOW_COALESCE && completion == NULL) {
+        if (list_replaceTracked(client->outgoing_data, &ev->queuedEntry, (void*) msg, 0, length + 1, 1) == EINFL_OK) {
+            if (client->debug) client->debugFunction("Msb client queue event: Coalesced queued message of event %s\n", ev->eventId);
+            return 0;
+        }
+    }
+
+    if (list_count_entries(client->outgoing_data) >= client->maxNumberDataOutgoing) {
+        /* the first entry may be in transmission, so the oldest droppable message is the second one */
+        if (ev->overflowPolicy != MSB_OVERFLOW_DROP_OLDEST || list_count_entries(client->outgoing_data) < 2) {
+            if (client->debug) client->debugFunction("Msb client queue event: Outgoing queue full, dropping message of event %s\n", ev->eventId);
+            mpool_free(client->buffer_pool, msg);
+            msbClientCompletePublish(client, completion, MSB_PUBLISH_DROPPED);
+            return -1;
+        }
+
+        if (client->debug) client->debugFunction("Msb client queue event: Outgoing queue full, dropping oldest message\n");
+
+        void* dropped = NULL;
+        list_popTagged(client->outgoing_data, 1, 1, &dropped);
+        msbClientCompletePublish(client, dropped, MSB_PUBLISH_DROPPED);
+    }
+
+    list_return_value r;
+    list_entry** tracker = NULL;
+
+    /* a completion belongs to its message, so its entry is never replaced, and later messages are queued behind it */
+    if (ev->overflowPolicy == MSB_OVERFLOW_COALESCE) {
+        if (completion == NULL)
+            tracker = &ev->queuedEntry;
+        else
+            list_untrack(client->outgoing_data, &ev->queuedEntry);
+    }
+
+    r = list_addTagged(client->outgoing_data, (void*) msg, 0, length + 1, tracker, completion, kind);
+
+    if (r != EINFL_OK) {
+        mpool_free(client->buffer_pool, msg);
+        msbClientCompletePublish(client, completion, MSB_PUBLISH_DROPPED);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* stages of the clients the thread has published to, a thread publishing to more clients looks the others up */
+#define MSB_THREAD_STAGES 8
+
+typedef struct {
+    msbClient* client;
+    uint64_t serial;
+    msbPublishStage* stage;
+} msbClientThreadStageSlot;
+
+typedef struct {
+    msbClientThreadStageSlot slots[MSB_THREAD_STAGES];
+    unsigned int next;
+} msbClientThreadStages;
+
+static pthread_key_t msbClientThreadStagesKey;
+static pthread_once_t msbClientThreadStagesOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t msbClientSerialMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t msbClientSerial = 0;
+
+static void msbClientMakeThreadStagesKey(void) {
+    pthread_key_create(&msbClientThreadStagesKey, free);
+}
+
+static msbPublishStage* msbClientThreadStage(msbClient* client) {
+
+    msbClientThreadStages* stages = (msbClientThreadStages*) pthread_getspecific(msbClientThreadStagesKey);
+    unsigned int i;
+
+    if (stages == NULL) {
+        stages = (msbClientThreadStages*) calloc(1, sizeof(msbClientThreadStages));
+        if (stages == NULL) return NULL;
+        if (pthread_setspecific(msbClientThreadStagesKey, stages) != 0) {
+            free(stages);
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < MSB_THREAD_STAGES; ++i)
+        if (stages->slots[i].client == client && stages->slots[i].serial == client->serial) return stages->slots[i].stage;
+
+    /* the stage of a slot that has been taken over by another client is still in the client's list */
+    pthread_t self = pthread_self();
+    msbPublishStage* stage;
+
+    pthread_mutex_lock(&client->stage_mutex);
+
+    for (stage = client->stages; stage != NULL && !pthread_equal(stage->owner, self); stage = stage->next);
+
+    if (stage == NULL) {
+        stage = (msbPublishStage*) calloc(1, sizeof(msbPublishStage));
+
+        if (stage != NULL) {
+            stage->messages = (msbStagedMessage*) malloc(client->stage_capacity * sizeof(msbStagedMessage));
+            stage->merging = (msbStagedMessage*) malloc(client->stage_capacity * sizeof(msbStagedMessage));
+        }
+
+        if (stage == NULL || stage->messages == NULL || stage->merging == NULL) {
+            if (stage != NULL) {
+                free(stage->messages);
+                free(stage->merging);
+                free(stage);
+            }
+            pthread_mutex_unlock(&client->stage_mutex);
+            return NULL;
+        }
+
+        stage->capacity = client->stage_capacity;
+        stage->owner = self;
+        pthread_mutex_init(&stage->mutex, NULL);
+
+        /* appended, so older stages of the thread are merged first */
+        msbPublishStage** last = (msbPublishStage**) &client->stages;
+        while (*last != NULL) last = &(*last)->next;
+        *last = stage;
+    }
+
+    pthread_mutex_unlock(&client->stage_mutex);
+
+    msbClientThreadStageSlot* slot = &stages->slots[stages->next];
+    stages->next = (stages->next + 1) % MSB_THREAD_STAGES;
+
+    slot->client = client;
+    slot->serial = client->serial;
+    slot->stage = stage;
+
+    return stage;
+}
+
+int msbClientQueueEvent(msbClient* client, msbObjectEvent* ev, char* msg, size_t length, msbPublishCompletion* completion,
+                        int kind) {
+
+    if (length >= client->maxMessageSize) {
+        mpool_free(client->buffer_pool, msg);
+        return -1;
+    }
+
+    if (client->stage_capacity == 0) return msbClientEnqueueEvent(client, ev, msg, length, completion, kind);
+
+    msbPublishStage* stage = msbClientThreadStage(client);
+
+    if (stage == NULL) return msbClientEnqueueEvent(client, ev, msg, length, completion, kind);
+
+    pthread_mutex_lock(&stage->mutex);
+
+    if (stage->count >= stage->capacity) {
+        pthread_mutex_unlock(&stage->mutex);
+        if (client->debug) client->debugFunction("Msb client queue event: Stage full, dropping message of event %s\n", ev->eventId);
+        mpool_free(client->buffer_pool, msg);
+        msbClientCompletePublish(client, completion, MSB_PUBLISH_DROPPED);
+        return -1;
+    }
+
+    msbStagedMessage* m = &stage->messages[stage->count];
+    m->ev = ev;
+    m->msg = msg;
+    m->length = length;
+    m->completion = completion;
+    m->kind = kind;
+    stage->count++;
+
+    pthread_mutex_unlock(&stage->mutex);
+
+    return 0;
+}
+
+uint32_t msbClientMergeStaged(msbClient* client) {
+
+    msbPublishStage* stage;
+    uint32_t merged = 0;
+
+    if (client->stages == NULL) return 0;
+
+    pthread_mutex_lock(&client->stage_mutex);
+
+    for (stage = client->stages; stage != NULL; stage = stage->next) {
+        if (stage->count == 0) continue;
+
+        /* the publishing thread goes on staging into the other array while this one is queued */
+        pthread_mutex_lock(&stage->mutex);
+        msbStagedMessage* batch = stage->messages;
+        uint32_t count = stage->count, i;
+        stage->messages = stage->merging;
+        stage->merging = batch;
+        stage->count = 0;
+        pthread_mutex_unlock(&stage->mutex);
+
+        /* a refused message has been freed and its completion reports it as dropped */
+        for (i = 0; i < count; ++i)
+            msbClientEnqueueEvent(client, batch[i].ev, batch[i].msg, batch[i].length, batch[i].completion,
+                                  batch[i].kind);
+
+        merged += count;
+    }
+
+    pthread_mutex_unlock(&client->stage_mutex);
+
+    return merged;
+}
+
+/* event messages of clients with static memory or given as json text are written straight into a pool buffer, without json-c */
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t used;
+    bool overflow;
+} msbClientWriter;
+
+static void msbClientWriterPut(msbClientWriter* w, const char* str, size_t length) {
+
+    if (w->overflow || w->used + length >= w->size) {
+        w->overflow = true;
+        return;
+    }
+
+    memcpy(w->buffer + w->used, str, length);
+    w->used += length;
+    w->buffer[w->used] = 0;
+}
+
+static void msbClientWriterFormat(msbClientWriter* w, const char* format, ...) {
+
+    if (w->overflow) return;
+
+    va_list args;
+    va_start(args, format);
+    int l = vsnprintf(w->buffer + w->used, w->size - w->used, format, args);
+    va_end(args);
+
+    if (l < 0 || w->used + (size_t) l >= w->size)
+        w->overflow = true;
+    else
+        w->used += (size_t) l;
+}
+
+static void msbClientWriterString(msbClientWriter* w, const char* str) {
+
+    if (str == NULL) {
+        msbClientWriterPut(w, "null", 4);
+        return;
+    }
+
+    msbClientWriterPut(w, "\"", 1);
+
+    const char* s = str;
+
+    for (; *str != 0 && !w->overflow; ++str) {
+        unsigned char c = (unsigned char) *str;
+
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        msbClientWriterPut(w, s, (size_t) (str - s));
+        s = str + 1;
+
+        switch (c) {
+            case '"': msbClientWriterPut(w, "\\\"", 2); break;
+            case '\\': msbClientWriterPut(w, "\\\\", 2); break;
+            case '\n': msbClientWriterPut(w, "\\n", 2); break;
+            case '\r': msbClientWriterPut(w, "\\r", 2); break;
+            case '\t': msbClientWriterPut(w, "\\t", 2); break;
+            default: msbClientWriterFormat(w, "\\u%04x", c); break;
+        }
+    }
+
+    msbClientWriterPut(w, s, (size_t) (str - s));
+    msbClientWriterPut(w, "\"", 1);
+}
+
+static void msbClientWriterDouble(msbClientWriter* w, double d) {
+
+    if (!isfinite(d)) {
+        msbClientWriterPut(w, "null", 4);
+        return;
+    }
+
+    size_t start = w->used;
+
+    msbClientWriterFormat(w, "%.17g", d);
+
+    /* like json-c, doubles keep a fraction so they aren't read back as integers */
+    if (!w->overflow && strpbrk(w->buffer + start, ".eE") == NULL) msbClientWriterPut(w, ".0", 2);
+}
+
+static void msbClientWriterValue(msbClientWriter* w, msbObjectEvent* ev, bool array, void* data, size_t i) {
+
+    PrimitiveType type = array ? ev->array_subtype : ev->type;
+    PrimitiveFormat format = array ? ev->array_subformat : ev->format;
+
+    switch (type) {
+        case MSB_INTEGER:
+            if (format == MSB_INT64)
+                msbClientWriterFormat(w, "%" PRId64, ((int64_t*) data)[i]);
+            else
+                msbClientWriterFormat(w, "%" PRId32, ((int32_t*) data)[i]);
+            break;
+        case MSB_NUMBER:
+            if (format == MSB_BYTE)
+                msbClientWriterFormat(w, "%" PRId32, ((int32_t*) data)[i]);
+            else
+                msbClientWriterDouble(w, ((double*) data)[i]);
+            break;
+        case MSB_BOOL:
+            if (((json_bool*) data)[i])
+                msbClientWriterPut(w, "true", 4);
+            else
+                msbClientWriterPut(w, "false", 5);
+            break;
+        case MSB_STRING:
+            msbClientWriterString(w, array ? ((char**) data)[i] : (char*) data);
+            break;
+        default:
+            msbClientWriterPut(w, "null", 4);
+            break;
+    }
+}
+
+/* either data (as msbClientPublish) or json text, which is inserted as it is, gives the data object */
+static int msbClientPublishDirect(msbClient* client, char* eId, MessagePriority mp, void* data, size_t arr_l,
+                                  const char* json, size_t json_length, char* corrId, msbPublishCompletion* completion,
+                                  bool streamed) {
+
+    msbObjectEvent* ev;
+    if (schll_getValue(client->msbObjectData->eventArray, (void**) &ev, eId) != SCHLL_OK) return -1;
+
+    if (client->outgoing_data == NULL || (client->currentStatusAutomat != REGISTERED && client->dataOutCache != 1))
+        return -1;
+
+    if (data != NULL && ev->type == MSB_ARRAY && arr_l <= 0) {
+        client->debugFunction("msbClientPublish: Event is of type array, but arraylength is invalid. arr_l = %i\n",
+                              (int) arr_l);
+        return -1;
+    }
+
+    char corr_uuid[37] = {0};
+    if (corrId == NULL) {
+#ifdef _WIN32
+        GUID uuid_gen;
+        CoCreateGuid(&uuid_gen);
+        sprintf_s(corr_uuid, "%08lx-%04hx-%04hx-%02hhx%02hhx-%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx",
+                  uuid_gen.Data1, uuid_gen.Data2, uuid_gen.Data3,
+                  uuid_gen.Data4[0], uuid_gen.Data4[1], uuid_gen.Data4[2], uuid_gen.Data4[3],
+                  uuid_gen.Data4[4], uuid_gen.Data4[5], uuid_gen.Data4[6], uuid_gen.Data4[7]);
+#else
+        uuid_t uuid_t;
+        uuid_generate(uuid_t);
+        uuid_unparse(uuid_t, corr_uuid);
+#endif
+        corrId = corr_uuid;
+    }
+
+    char tBuff[30] = {0};
+    getDateTime(tBuff);
+
+    msbClientWriter w;
+    w.size = client->maxMessageSize;
+
+    /* json text or no data at all gives a tight bound, which keeps the pool buffer small */
+    if (json != NULL || data == NULL) {
+        size_t bound = 160 + json_length + 6 * (strlen(ev->eventId) + strlen(corrId) +
+                                                strlen(client->msbObjectData->objectInfo.service_uuid));
+        if (bound < w.size) w.size = bound;
+    }
+
+    w.used = 0;
+    w.overflow = false;
+    w.buffer = (char*) mpool_alloc(client->buffer_pool, w.size + 1);
+
+    if (w.buffer == NULL) {
+        if (client->debug) client->debugFunction("Msb client publish: No free message buffer, dropping message of event %s\n", eId);
+        return -1;
+    }
+
+    msbClientWriterPut(&w, "E {\"eventId\":", 13);
+    msbClientWriterString(&w, ev->eventId);
+    msbClientWriterPut(&w, ",\"uuid\":", 8);
+    msbClientWriterString(&w, client->msbObjectData->objectInfo.service_uuid);
+    msbClientWriterFormat(&w, ",\"priority\":%d,\"postDate\":", (int) mp);
+    msbClientWriterString(&w, tBuff);
+    msbClientWriterPut(&w, ",\"correlationId\":", 17);
+    msbClientWriterString(&w, corrId);
+    msbClientWriterPut(&w, ",\"dataObject\":", 14);
+
+    /* the data object of a stream follows in fragments, so the envelope is left open */
+    if (streamed) {
+    } else if (json != NULL) {
+        msbClientWriterPut(&w, json, json_length);
+    } else if (data == NULL) {
+        msbClientWriterPut(&w, "null", 4);
+    } else if (ev->type == MSB_ARRAY) {
+        size_t i;
+
+        msbClientWriterPut(&w, "[", 1);
+        for (i = 0; i < arr_l; ++i) {
+            if (i > 0) msbClientWriterPut(&w, ",", 1);
+            msbClientWriterValue(&w, ev, true, data, i);
+        }
+        msbClientWriterPut(&w, "]", 1);
+    } else {
+        msbClientWriterValue(&w, ev, false, data, 0);
+    }
+
+    if (!streamed) msbClientWriterPut(&w, "}", 1);
+
+    if (w.overflow) {
+        if (client->debug) client->debugFunction("Msb client publish: Message of event %s exceeds the maximum message size\n", eId);
+        mpool_free(client->buffer_pool, w.buffer);
+        return -1;
+    }
+
+    if (msbClientQueueEvent(client, ev, w.buffer, w.used, completion, streamed ? MSB_OUTGOING_STREAM : MSB_OUTGOING_MESSAGE) != 0)
+        return -1;
+
+    msbClientWake(client);
+    return 0;
+}
+
+/* FNV-1a */
+static uint64_t msbClientFilterHashBytes(uint64_t hash, const void* bytes, size_t length) {
+    const unsigned char* p = (const unsigned char*) bytes;
+    size_t i;
+
+    for (i = 0; i < length; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static uint64_t msbClientFilterHash(msbObjectEvent* ev, void* data, size_t arr_l) {
+    bool array = ev->type == MSB_ARRAY;
+    PrimitiveType type = array ? ev->array_subtype : ev->type;
+    PrimitiveFormat format = array ? ev->array_subformat : ev->format;
+    size_t n = array ? arr_l : 1, i;
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (i = 0; i < n; ++i) {
+        switch (type) {
+            case MSB_INTEGER:
+                if (format == MSB_INT64)
+                    hash = msbClientFilterHashBytes(hash, (int64_t*) data + i, sizeof(int64_t));
+                else
+                    hash = msbClientFilterHashBytes(hash, (int32_t*) data + i, sizeof(int32_t));
+                break;
+            case MSB_NUMBER:
+                if (format == MSB_BYTE)
+                    hash = msbClientFilterHashBytes(hash, (int32_t*) data + i, sizeof(int32_t));
+                else
+                    hash = msbClientFilterHashBytes(hash, (double*) data + i, sizeof(double));
+                break;
+            case MSB_BOOL: {
+                unsigned char b = ((json_bool*) data)[i] != 0;
+                hash = msbClientFilterHashBytes(hash, &b, 1);
+                break;
+            }
+            case MSB_STRING: {
+                const char* str = array ? ((char**) data)[i] : (const char*) data;
+                if (str != NULL) hash = msbClientFilterHashBytes(hash, str, strlen(str));
+                hash = msbClientFilterHashBytes(hash, "", 1);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return hash;
+}
+
+/* reference of an event filter before a value passed it, restored if the value couldn't be queued */
+typedef struct {
+    uint64_t passed;/* time the value became the reference, 0 if it hasn't */
+    uint64_t published;
+    double number;
+    uint64_t hash;
+} msbClientFilterReference;
+
+/* report by exception: true if the value doesn't differ enough from the last published one of the event; a value
+ * passing the filter becomes the reference right away, so publishers of the same event decide one after the other */
+static bool msbClientFilterValue(msbClient* client, msbObjectEvent* ev, void* data, size_t arr_l,
+                                 msbClientFilterReference* reference) {
+
+    reference->passed = 0;
+
+    if (ev->filter == MSB_FILTER_NONE || data == NULL) return false;
+
+    /* a value which can't be queued isn't published, so it mustn't become the reference */
+    if (client->outgoing_data == NULL || (client->currentStatusAutomat != REGISTERED && client->dataOutCache != 1))
+        return false;
+
+    pthread_mutex_lock(&client->filter_mutex);
+
+    uint64_t now = msbClientTimeUs();
+    uint64_t hash = ev->filter_hash;
+
+    /* the time tells a reference apart from the ones of other publishers, see msbClientFilterRevert */
+    if (now <= ev->filter_published) now = ev->filter_published + 1;
+
+    double number = ev->filter_number;
+    bool changed;
+
+    if (ev->filter != MSB_FILTER_ON_CHANGE && (ev->type == MSB_INTEGER || ev->type == MSB_NUMBER)) {
+        double value;
+
+        if (ev->type == MSB_INTEGER)
+            value = ev->format == MSB_INT64 ? (double) *(int64_t*) data : (double) *(int32_t*) data;
+        else
+            value = ev->format == MSB_BYTE ? (double) *(int32_t*) data : *(double*) data;
+
+        double band = ev->deadband;
+        if (ev->filter == MSB_FILTER_DEADBAND_PERCENT) band *= fabs(ev->filter_number) / 100;
+
+        /* written this way round, NaN counts as a change */
+        changed = ev->filter_published == 0 || !(fabs(value - ev->filter_number) <= band);
+        number = value;
+    } else {
+        hash = msbClientFilterHash(ev, data, arr_l);
+
+        changed = ev->filter_published == 0 || hash != ev->filter_hash;
+    }
+
+    if (!changed && (ev->filter_heartbeat == 0 || now - ev->filter_published < ev->filter_heartbeat)) {
+        ++client->events_filtered;
+        pthread_mutex_unlock(&client->filter_mutex);
+        return true;
+    }
+
+    reference->passed = now;
+    reference->published = ev->filter_published;
+    reference->number = ev->filter_number;
+    reference->hash = ev->filter_hash;
+
+    ev->filter_published = now;
+    ev->filter_number = number;
+    ev->filter_hash = hash;
+
+    pthread_mutex_unlock(&client->filter_mutex);
+
+    return false;
+}
+
+/* the value couldn't be queued, the reference goes back unless a later value has passed the filter meanwhile */
+static void msbClientFilterRevert(msbClient* client, msbObjectEvent* ev, const msbClientFilterReference* reference) {
+
+    if (reference->passed == 0) return;
+
+    pthread_mutex_lock(&client->filter_mutex);
+
+    if (ev->filter_published == reference->passed) {
+        ev->filter_published = reference->published;
+        ev->filter_number = reference->number;
+        ev->filter_hash = reference->hash;
+    }
+
+    pthread_mutex_unlock(&client->filter_mutex);
+}
+
+void msbClientPublish(msbClient* client, char* eId, MessagePriority mp, void* data, size_t arr_l, char* corrId) {
+
+    msbObjectEvent* filtered;
+    msbClientFilterReference reference;
+
+    if (schll_getValue(client->msbObjectData->eventArray, (void**) &filtered, eId) != SCHLL_OK) return;
+    if (msbClientFilterValue(client, filtered, data, arr_l, &reference)) return;
+
+    if (client->static_memory) {
+        if (msbClientPublishDirect(client, eId, mp, data, arr_l, NULL, 0, corrId, NULL, false) != 0)
+            msbClientFilterRevert(client, filtered, &reference);
+        return;
+    }
+
+
+    publish_entry
+    publish_common_inf
+
+#ifdef _WIN32
+    publish_make_correlation_id_WIN32
+#else
+    publish_make_correlation_id
+#endif
+
+    switch (ev->type) {
+        case MSB_ARRAY:
+            if (arr_l <= 0) {
+                client->debugFunction("msbClientPublish: Event is of type array, but arraylength is invalid. arr_l = %i\n",
+                       (int) arr_l);
+                msbClientFilterRevert(client, filtered, &reference);
+                return;
+            }
+
+            size_t i;
+            i = 0;
+
+            dataJ = json_object_new_array();
+            switch (ev->array_subtype) {
+                case MSB_INTEGER:
+                    if (ev->array_subformat == MSB_INT32) {
+                        int32_t (*arr_p)[arr_l] = data;
+                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int((*arr_p)[i]));
+                    } else if (ev->array_subformat == MSB_INT64) {
+                        int64_t (*arr_p)[arr_l] = data;
+                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int64((*arr_p)[i]));
+                    }
+                    break;
+                case MSB_NUMBER:
+                    if (ev->array_subformat == MSB_FLOAT || ev->array_subformat == MSB_DOUBLE) {
+                        double (*arr_p)[arr_l] = data;
+                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_double((*arr_p)[i]));
+                    } else if (ev->array_subformat == MSB_BYTE) {
+                        int32_t (*arr_p)[arr_l] = data;
+                        for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_int((*arr_p)[i]));
+                    }
+                    break;
+                case MSB_BOOL: {
+                    json_bool (*arr_p)[arr_l] = data;
+                    for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_boolean((*arr_p)[i]));
+                    }
+                    break;
+                case MSB_STRING: {
+                    char* (*arr_p)[arr_l] = data;
+                    for (; i < arr_l; ++i) json_object_array_add(dataJ, json_object_new_string((*arr_p)[i]));
+                    }
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case MSB_INTEGER:
+            if (ev->format == MSB_INT32)
+                dataJ = json_object_new_int(*(int32_t*) data);
+            else if (ev->format == MSB_INT64)
+                dataJ = json_object_new_int64(*(int64_t*) data);
+            break;
+        case MSB_NUMBER:
+            if (ev->format == MSB_FLOAT || ev->format == MSB_DOUBLE)
+                dataJ = json_object_new_double(*(double*) data);
+            else if (ev->format == MSB_BYTE)
+                dataJ = json_object_new_int(*(int32_t*) data);
+            break;
+        case MSB_BOOL:
+            dataJ = json_object_new_boolean(*(json_bool*) data);
+            break;
+        case MSB_STRING:
+            dataJ = json_object_new_string((char*) data);
+            break;
+        default:
+            break;
+    }
+
+    if (msbClientQueueJSON(client, ev, root, dataJ) != 0) msbClientFilterRevert(client, filtered, &reference);
+}
+
+void msbClientPublishEmpty(msbClient* client, char* eId, MessagePriority mp, char* corrId) {
+
+    /* the envelope alone doesn't need json-c */
+    msbClientPublishDirect(client, eId, mp, NULL, 0, NULL, 0, corrId, NULL, false);
+}
+
+void msbClientPublishComplex(msbClient* client, char* eId, MessagePriority mp, json_object* obj, char* corrId) {
+
+    publish_entry
+    publish_common_inf
+
+#ifdef _WIN32
+    publish_make_correlation_id_WIN32
+#else
+    publish_make_correlation_id
+#endif
+
+    dataJ = obj;
+
+    msbClientQueueJSON(client, ev, root, dataJ);
+}
+
+void msbClientPublishFromString(msbClient* client, char* eId, MessagePriority mp, char* string, char* corrId) {
+
+    json_object* obj = json_tokener_parse(string);
+
+    msbClientPublishComplex(client, eId, mp, obj, corrId);
+
+}
+
+void msbClientPublishJSON(msbClient* client, char* eId, MessagePriority mp, const char* json, size_t length, char* corrId) {
+
+    if (json == NULL || length == 0) {
+        msbClientPublishEmpty(client, eId, mp, corrId);
+        return;
+    }
+
+    msbClientPublishDirect(client, eId, mp, NULL, 0, json, length, corrId, NULL, false);
+}
+
+int msbClientPublishJSONWithCompletion(msbClient* client, char* eId, MessagePriority mp, const char* json, size_t length,
+                                       char* corrId, msbPublishCompletion* completion) {
+
+    if (json == NULL || length == 0) return msbClientPublishDirect(client, eId, mp, NULL, 0, NULL, 0, corrId, completion, false);
+
+    return msbClientPublishDirect(client, eId, mp, NULL, 0, json, length, corrId, completion, false);
+}
+
+int msbClientPublishStream(msbClient* client, char* eId, MessagePriority mp, msbPublishStream* stream, char* corrId) {
+
+    if (client == NULL || stream == NULL || stream->read == NULL || client->static_memory) return -1;
+
+    return msbClientPublishDirect(client, eId, mp, NULL, 0, NULL, 0, corrId, &stream->completion, true);
+}
+
+#ifndef _WIN32
+static bool msbClientThreadConfigValid(const msbThreadConfig* config) {
+
+    if (config->policy == MSB_SCHED_FIFO || config->policy == MSB_SCHED_RR) {
+        int policy = config->policy == MSB_SCHED_FIFO ? SCHED_FIFO : SCHED_RR;
+
+        if (config->priority < sched_get_priority_min(policy) || config->priority > sched_get_priority_max(policy))
+            return false;
+    } else if (config->policy != MSB_SCHED_DEFAULT && config->policy != MSB_SCHED_OTHER) {
+        return false;
+    }
+
+#ifndef __linux__
+    if (config->cpu_mask != 0) return false;
+#endif
+
+    return config->stack_size == 0 || config->stack_size >= PTHREAD_STACK_MIN;
+}
+
+/* index >= 0 pins the thread to the index-th CPU of the mask, counting round, -1 allows all CPUs of the mask */
+static int msbClientThreadAttributes(pthread_attr_t* attr, const msbThreadConfig* config, int index) {
+
+    int r = pthread_attr_init(attr);
+
+    if (r == 0 && config->stack_size > 0) r = pthread_attr_setstacksize(attr, config->stack_size);
+
+    if (r == 0 && config->policy != MSB_SCHED_DEFAULT) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+
+        int policy = SCHED_OTHER;
+        if (config->policy == MSB_SCHED_FIFO) policy = SCHED_FIFO;
+        if (config->policy == MSB_SCHED_RR) policy = SCHED_RR;
+        if (policy != SCHED_OTHER) param.sched_priority = config->priority;
+
+        r = pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+        if (r == 0) r = pthread_attr_setschedpolicy(attr, policy);
+        if (r == 0) r = pthread_attr_setschedparam(attr, &param);
+    }
+
+#ifdef __linux__
+    if (r == 0 && config->cpu_mask != 0) {
+        cpu_set_t cpus;
+        int cpu, count = 0, selected = -1;
+
+        for (cpu = 0; cpu < 64; ++cpu)
+            if (config->cpu_mask & ((uint64_t) 1 << cpu)) ++count;
+        if (index >= 0) index %= count;
+
+        CPU_ZERO(&cpus);
+        for (cpu = 0; cpu < 64; ++cpu) {
+            if (!(config->cpu_mask & ((uint64_t) 1 << cpu))) continue;
+            if (index < 0 || ++selected == index) CPU_SET(cpu, &cpus);
+        }
+
+        r = pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+    }
+#endif
+
+    if (r != 0) pthread_attr_destroy(attr);
+
+    return r;
+}
+
+/* names are limited to 15 characters, the index of a group thread replaces the end of a longer name */
+static void msbClientThreadName(pthread_t thread, const msbThreadConfig* config, int index) {
+#ifdef __linux__
+    char name[16];
+
+    if (config->name[0] == 0) return;
+
+    if (index < 0) {
+        snprintf(name, sizeof(name), "%.15s", config->name);
+    } else {
+        char suffix[12];
+        int l = snprintf(suffix, sizeof(suffix), "-%d", index);
+        snprintf(name, sizeof(name), "%.*s%s", 15 - l, config->name, suffix);
+    }
+
+    pthread_setname_np(thread, name);
+#endif
+}
+#endif
+
+bool msbClientSetThreadConfig(msbClient* client, const msbThreadConfig* config) {
+
+    if (client == NULL || config == NULL || client->thread_running || client->group_slot != NULL) return false;
+
+#ifndef _WIN32
+    if (!msbClientThreadConfigValid(config)) return false;
+#else
+    if (config->policy != MSB_SCHED_DEFAULT) return false;
+#endif
+
+    client->thread_config = *config;
+    client->thread_config.name[sizeof(client->thread_config.name) - 1] = 0;
+
+    return true;
+}
+
+int msbClientRunClientStateMachine(msbClient* client) {
+    if (client->thread_running || client->group_slot != NULL) {
+        if (client->debug) client->debugFunction("Msb client state machine: Already running\n");
+        return -1;
+    }
+
+    client->force_exit = false;
+#ifndef _WIN32
+    int r = msbClientThreadAttributes(&(client->thread_attr), &client->thread_config, -1);
+    if (r != 0) {
+        if (client->debug) client->debugFunction("Msb client state machine: Invalid thread configuration (%i)\n", r);
+        return r;
+    }
+
+    r = pthread_create(&(client->thread), &(client->thread_attr), (void*) msbClientAutomatThread, client);
+    client->thread_running = (r == 0);
+
+    if (r == 0) {
+        msbClientThreadName(client->thread, &client->thread_config, -1);
+    } else {
+        if (client->debug) client->debugFunction("Msb client state machine: Thread could not be created (%i)\n", r);
+        pthread_attr_destroy(&(client->thread_attr));
+    }
+
+    return r;
+#else
+    client->thread = CreateThread(NULL, client->thread_config.stack_size, msbClientAutomatThread, client, 0, NULL);
+    client->thread_running = (client->thread != NULL);
+    if (client->thread_running && client->thread_config.cpu_mask != 0)
+        SetThreadAffinityMask(client->thread, (DWORD_PTR) client->thread_config.cpu_mask);
+    return client->thread_running ? 0 : -1;
+#endif
+}
+
+int msbClientHaltClientStateMachine(msbClient* client) {
+    client->force_exit = true;
+    client->thread_running = false;
+#ifndef _WIN32
+    pthread_join(client->thread, NULL);
+    return pthread_attr_destroy(&(client->thread_attr));
+#endif
+}
+
+#ifdef __linux__
+
+typedef struct msbClientGroupThread msbClientGroupThread;
+
+typedef struct msbClientGroupSlot msbClientGroupSlot;
+
+struct msbClientGroupSlot {
+    msbClient* client;
+    msbClientGroupThread* thread;
+    msbClientGroupSlot* next_retired;
+
+    int poll_fd;/* descriptor registered in the epoll set of the thread, -1 if the client is polled */
+    uint64_t due;/* time of the next cycle in µs */
+    bool busy;
+    bool removed;
+    bool wake;/* set by msbClientWake from any thread, only accessed atomically */
+};
+
+struct msbClientGroupThread {
+    msbClientGroup* group;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+
+    int epfd;
+    int wakefd;
+    volatile bool force_exit;
+
+    msbClientGroupSlot** slots;
+    uint32_t count;
+    uint32_t capacity;
+
+    msbClientGroupSlot* stepping;/* slot whose state machine is running, the lock isn't held meanwhile */
+    pthread_cond_t stepped;/* signalled whenever a state machine cycle has ended */
+
+    msbClientGroupSlot* retired;/* removed slots, an event fetched or a cycle planned before the removal may still point to them */
+};
+
+struct msbClientGroup {
+    msbClientGroupThread* threads;
+    uint32_t thread_count;
+
+    uint32_t tick_interval;/* may be changed while the threads run, only accessed atomically */
+};
+
+static uint64_t msbClientGroupNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void msbClientGroupSignal(msbClientGroupThread* t) {
+    uint64_t v = 1;
+    ssize_t r = write(t->wakefd, &v, sizeof(v));
+    (void) r;
+}
+
+static void msbClientGroupFreeRetired(msbClientGroupThread* t) {
+    while (t->retired != NULL) {
+        msbClientGroupSlot* slot = t->retired;
+        t->retired = slot->next_retired;
+        free(slot);
+    }
+}
+
+/* registers the connection of a client, as soon as its transport provides a descriptor */
+static void msbClientGroupWatch(msbClientGroupThread* t, msbClientGroupSlot* slot) {
+    int fd = wsGetPollFd(slot->client->websocketData);
+    if (fd == slot->poll_fd) return;
+
+    if (slot->poll_fd >= 0) epoll_ctl(t->epfd, EPOLL_CTL_DEL, slot->poll_fd, NULL);
+    slot->poll_fd = -1;
+
+    if (fd < 0) return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = slot;
+
+    if (epoll_ctl(t->epfd, EPOLL_CTL_ADD, fd, &ev) == 0) slot->poll_fd = fd;
+}
+
+static void* msbClientGroupLoop(void* arg) {
+    msbClientGroupThread* t = (msbClientGroupThread*) arg;
+    struct epoll_event events[64];
+    msbClientGroupSlot** due = NULL;
+    uint32_t due_capacity = 0;
+    uint32_t i;
+
+    while (!t->force_exit) {
+        uint64_t now = msbClientGroupNow();
+        uint64_t timeout = __atomic_load_n(&t->group->tick_interval, __ATOMIC_RELAXED);
+
+        pthread_mutex_lock(&t->mutex);
+        for (i = 0; i < t->count && timeout > 0; ++i) {
+            msbClientGroupSlot* slot = t->slots[i];
+            if (slot->busy || __atomic_load_n(&slot->wake, __ATOMIC_RELAXED) || slot->due <= now)
+                timeout = 0;
+            else if (slot->due - now < timeout)
+                timeout = slot->due - now;
+        }
+        pthread_mutex_unlock(&t->mutex);
+
+        int n = epoll_wait(t->epfd, events, 64, (int) ((timeout + 999) / 1000));
+
+        pthread_mutex_lock(&t->mutex);
+
+        int e;
+        for (e = 0; e < n; ++e) {
+            if (events[e].data.ptr == t) {
+                uint64_t v;
+                ssize_t r = read(t->wakefd, &v, sizeof(v));
+                (void) r;
+            } else {
+                ((msbClientGroupSlot*) events[e].data.ptr)->busy = true;
+            }
+        }
+
+        if (t->count > due_capacity) {
+            msbClientGroupSlot** d = (msbClientGroupSlot**) realloc(due, t->capacity * sizeof(msbClientGroupSlot*));
+            if (d != NULL) {
+                due = d;
+                due_capacity = t->capacity;
+            }
+        }
+
+        now = msbClientGroupNow();
+
+        /* the clients due are stepped without the lock, so they may be added and removed meanwhile, even by callbacks */
+        uint32_t count = 0;
+        for (i = 0; i < t->count && count < due_capacity; ++i) {
+            msbClientGroupSlot* slot = t->slots[i];
+            /* a wake arriving after the flag has been taken is kept for the next round */
+            bool woken = __atomic_exchange_n(&slot->wake, false, __ATOMIC_ACQUIRE);
+            if (!slot->busy && !woken && slot->due > now) continue;
+
+            due[count++] = slot;
+        }
+
+        pthread_mutex_unlock(&t->mutex);
+
+        for (i = 0; i < count; ++i) {
+            msbClientGroupSlot* slot = due[i];
+
+            pthread_mutex_lock(&t->mutex);
+            if (slot->removed) {
+                pthread_mutex_unlock(&t->mutex);
+                continue;
+            }
+            t->stepping = slot;
+            pthread_mutex_unlock(&t->mutex);
+
+            uint32_t delay_us;
+            bool busy = msbClientAutomatStep(slot->client, &delay_us);
+
+            pthread_mutex_lock(&t->mutex);
+            t->stepping = NULL;
+            bool removed = slot->removed;
+
+            if (!removed) {
+                slot->busy = busy;
+                msbClientGroupWatch(t, slot);
+
+                if (delay_us == 0)
+                    delay_us = slot->poll_fd >= 0 ? __atomic_load_n(&t->group->tick_interval, __ATOMIC_RELAXED)
+                                                  : slot->client->pause_automat;
+                slot->due = now + delay_us;
+            }
+
+            pthread_cond_broadcast(&t->stepped);
+            pthread_mutex_unlock(&t->mutex);
+
+            /* a client removed by a callback of its own cycle is ended once the cycle is over */
+            if (removed) msbClientAutomatEnd(slot->client);
+        }
+
+        pthread_mutex_lock(&t->mutex);
+        msbClientGroupFreeRetired(t);
+        pthread_mutex_unlock(&t->mutex);
+    }
+
+    free(due);
+
+    return NULL;
+}
+
+msbClientGroup* msbClientGroupNew(uint32_t threads) {
+    return msbClientGroupNewConfigured(threads, NULL);
+}
+
+msbClientGroup* msbClientGroupNewConfigured(uint32_t threads, const msbThreadConfig* config) {
+
+    if (threads == 0 || (config != NULL && !msbClientThreadConfigValid(config))) return NULL;
+
+    msbClientGroup* ret = (msbClientGroup*) calloc(1, sizeof(msbClientGroup));
+    if (ret == NULL) return NULL;
+
+    ret->tick_interval = 100000;
+    ret->threads = (msbClientGroupThread*) calloc(threads, sizeof(msbClientGroupThread));
+    if (ret->threads == NULL) {
+        free(ret);
+        return NULL;
+    }
+
+    for (; ret->thread_count < threads; ++ret->thread_count) {
+        msbClientGroupThread* t = &ret->threads[ret->thread_count];
+
+        t->group = ret;
+        t->epfd = epoll_create1(EPOLL_CLOEXEC);
+        t->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = t;
+
+        pthread_mutex_init(&t->mutex, NULL);
+        pthread_cond_init(&t->stepped, NULL);
+
+        pthread_attr_t attr;
+        bool attributes = config == NULL || msbClientThreadAttributes(&attr, config, (int) ret->thread_count) == 0;
+
+        if (!attributes || t->epfd < 0 || t->wakefd < 0 || epoll_ctl(t->epfd, EPOLL_CTL_ADD, t->wakefd, &ev) != 0 ||
+            pthread_create(&t->thread, config != NULL ? &attr : NULL, msbClientGroupLoop, t) != 0) {
+            if (attributes && config != NULL) pthread_attr_destroy(&attr);
+            if (t->epfd >= 0) close(t->epfd);
+            if (t->wakefd >= 0) close(t->wakefd);
+            pthread_mutex_destroy(&t->mutex);
+            pthread_cond_destroy(&t->stepped);
+            msbClientGroupDelete(ret);
+            return NULL;
+        }
+
+        if (config != NULL) {
+            pthread_attr_destroy(&attr);
+            msbClientThreadName(t->thread, config, (int) ret->thread_count);
+        }
+    }
+
+    return ret;
+}
+
+void msbClientGroupDelete(msbClientGroup* group) {
+
+    if (group == NULL) return;
+
+    uint32_t i;
+    for (i = 0; i < group->thread_count; ++i) {
+        msbClientGroupThread* t = &group->threads[i];
+
+        while (t->count > 0) msbClientGroupRemove(group, t->slots[t->count - 1]->client);
+
+        t->force_exit = true;
+        msbClientGroupSignal(t);
+        pthread_join(t->thread, NULL);
+
+        msbClientGroupFreeRetired(t);
+        close(t->epfd);
+        close(t->wakefd);
+        pthread_mutex_destroy(&t->mutex);
+        pthread_cond_destroy(&t->stepped);
+        free(t->slots);
+    }
+
+    free(group->threads);
+    free(group);
+}
+
+void msbClientGroupSetTickInterval(msbClientGroup* group, uint32_t interval) {
+    __atomic_store_n(&group->tick_interval, interval, __ATOMIC_RELAXED);
+}
+
+bool msbClientGroupAdd(msbClientGroup* group, msbClient* client) {
+
+    if (group == NULL || client == NULL || client->group_slot != NULL || client->thread_running) return false;
+
+    msbClientGroupThread* t = &group->threads[0];
+    uint32_t i;
+    for (i = 1; i < group->thread_count; ++i)
+        if (group->threads[i].count < t->count) t = &group->threads[i];
+
+    msbClientGroupSlot* slot = (msbClientGroupSlot*) calloc(1, sizeof(msbClientGroupSlot));
+    if (slot == NULL) return false;
+
+    slot->client = client;
+    slot->thread = t;
+    slot->poll_fd = -1;
+
+    pthread_mutex_lock(&t->mutex);
+
+    if (t->count == t->capacity) {
+        uint32_t capacity = t->capacity ? t->capacity * 2 : 16;
+        msbClientGroupSlot** slots = (msbClientGroupSlot**) realloc(t->slots, capacity * sizeof(msbClientGroupSlot*));
+        if (slots == NULL) {
+            pthread_mutex_unlock(&t->mutex);
+            free(slot);
+            return false;
+        }
+        t->slots = slots;
+        t->capacity = capacity;
+    }
+
+    client->force_exit = false;
+    client->group_slot = slot;
+    msbClientAutomatBegin(client);
+
+    t->slots[t->count++] = slot;
+
+    pthread_mutex_unlock(&t->mutex);
+
+    msbClientWake(client);
+
+    if (client->debug) client->debugFunction("Msb client group: Added client to thread %u\n", (uint32_t) (t - group->threads));
+
+    return true;
+}
+
+bool msbClientGroupRemove(msbClientGroup* group, msbClient* client) {
+
+    if (group == NULL || client == NULL || client->group_slot == NULL) return false;
+
+    msbClientGroupSlot* slot = (msbClientGroupSlot*) client->group_slot;
+    msbClientGroupThread* t = slot->thread;
+    uint32_t i;
+
+    pthread_mutex_lock(&t->mutex);
+
+    /* a cycle running on the group thread is waited for, unless the client is removed by a callback of that cycle */
+    bool own_cycle = pthread_equal(pthread_self(), t->thread) != 0;
+    while (t->stepping == slot && !own_cycle) pthread_cond_wait(&t->stepped, &t->mutex);
+    own_cycle = own_cycle && t->stepping == slot;
+
+    for (i = 0; i < t->count; ++i) {
+        if (t->slots[i] == slot) {
+            t->slots[i] = t->slots[--t->count];
+            break;
+        }
+    }
+
+    if (slot->poll_fd >= 0) epoll_ctl(t->epfd, EPOLL_CTL_DEL, slot->poll_fd, NULL);
+    client->group_slot = NULL;
+    client->force_exit = true;
+    slot->removed = true;
+
+    slot->next_retired = t->retired;
+    t->retired = slot;
+
+    pthread_mutex_unlock(&t->mutex);
+
+    if (!own_cycle) msbClientAutomatEnd(client);
+
+    return true;
+}
+
+void msbClientWake(msbClient* client) {
+    msbClientGroupSlot* slot = (msbClientGroupSlot*) client->group_slot;
+    if (slot == NULL) return;
+
+    /* published before the signal, the thread sees it once it has been woken */
+    __atomic_store_n(&slot->wake, true, __ATOMIC_RELEASE);
+    msbClientGroupSignal(slot->thread);
+}
+
+#else
+
+msbClientGroup* msbClientGroupNew(uint32_t threads) {
+    return NULL;
+}
+
+msbClientGroup* msbClientGroupNewConfigured(uint32_t threads, const msbThreadConfig* config) {
+    return NULL;
+}
+
+void msbClientGroupDelete(msbClientGroup* group) {
+}
+
+void msbClientGroupSetTickInterval(msbClientGroup* group, uint32_t interval) {
+}
+
+bool msbClientGroupAdd(msbClientGroup* group, msbClient* client) {
+    return false;
+}
+
+bool msbClientGroupRemove(msbClientGroup* group, msbClient* client) {
+    return false;
+}
+
+void msbClientWake(msbClient* client) {
+}
+
+#endif
+
+void msbClientAutomatBegin(msbClient* client) {
+    client->currentStatusAutomat = CREATED;
+
+    /* with static memory the lists are already there */
+    if (client->static_memory) return;
 
     client->incoming_data = list_makeListPointer();
     client->outgoing_data = list_makeListPointer();
 
+    client->incoming_data->pool = client->buffer_pool;
+    client->outgoing_data->pool = client->buffer_pool;
+}
+
+bool msbClientAutomatStep(msbClient* client, uint32_t* delay_us) {
+
     list_list* incoming_data = client->incoming_data;
     list_list* outgoing_data = client->outgoing_data;
 
-    while (!client->force_exit) {
-        if (client->debug && client->statusAutomatChange != client->currentStatusAutomat) {
-            if (client->currentStatusAutomat <= CLOSED && client->statusAutomatChange <= CLOSED)
-                client->debugFunction("Msb client state machine: Status change: From %s to %s\n", integer_to_state[client->statusAutomatChange],
-                       integer_to_state[client->currentStatusAutomat]);
-            else
-                client->debugFunction("Msb client state machine: Status change: From %i to %i\n", client->statusAutomatChange, client->currentStatusAutomat);
-        }
+    bool received = false, sent = false;
+
+    *delay_us = 0;
+
+    if (client->debug && client->statusAutomatChange != client->currentStatusAutomat) {
+        if (client->currentStatusAutomat <= CLOSED && client->statusAutomatChange <= CLOSED)
+            client->debugFunction("Msb client state machine: Status change: From %s to %s\n", integer_to_state[client->statusAutomatChange],
+                   integer_to_state[client->currentStatusAutomat]);
+        else
+            client->debugFunction("Msb client state machine: Status change: From %i to %i\n", client->statusAutomatChange, client->currentStatusAutomat);
+    }
 
-        client->statusAutomatChange = client->currentStatusAutomat;
+    client->statusAutomatChange = client->currentStatusAutomat;
 
-        switch (client->currentStatusAutomat) {
-            case CREATED: {
-                client->currentStatusAutomat = INITIALISED;
-                msbClientInitialise(client, client->nopoll_debug);
-                usleep(1000000);
+    if (outgoing_data != NULL) msbClientMergeStaged(client);
+
+    switch (client->currentStatusAutomat) {
+        case CREATED: {
+            client->currentStatusAutomat = INITIALISED;
+            msbClientInitialise(client, client->nopoll_debug);
+            *delay_us = 1000000;
+            break;
+        }
+        case INITIALISED: {
+            client->currentStatusAutomat = CONNECTING;
+            msbClientConnect(client);
+            *delay_us = 100000;
+            break;
+        }
+        case CONNECTING: {
+            if (msbClientConnectionReady(client)) {
+                //if(!client->sockJs_framing)
+                //msbClientRegister(client);
+                client->currentStatusAutomat = CONNECTED;
+            }else {
+                msbClientConnect(client);
+            }
+            *delay_us = 100000;
+            break;
+        }
+        case CONNECTED: {
+            //Verbindung iO?
+            if (!msbClientConnectionReady(client)) {
+                if (client->flag_reconnect == 1)
+                    client->currentStatusAutomat = CONNECTING;
+                else
+                    client->currentStatusAutomat = UNCONNECTED;
+                msbClientLosePublishes(client);
                 break;
             }
-            case INITIALISED: {
-                client->currentStatusAutomat = CONNECTING;
-                msbClientConnect(client);
-                usleep(100000);
+
+            if (msbClientReceiveIfRoom(client, incoming_data)) received = true;
+
+            if (list_count_entries(incoming_data) > 0) {
+                msbClientProcessIncoming(client, incoming_data, &received);
                 break;
             }
-            case CONNECTING: {
-                if (msbClientConnectionReady(client)) {
-                    //if(!client->sockJs_framing)
-                    //msbClientRegister(client);
-                    client->currentStatusAutomat = CONNECTED;
-                }else {
-                    msbClientConnect(client);
-                }
-                usleep(100000);
+        }
+        case REGISTERED: {
+            //Verbindung iO?
+            if (!msbClientConnectionReady(client)) {
+                if (client->flag_reconnect == 1)
+                    client->currentStatusAutomat = CONNECTING;
+                else
+                    client->currentStatusAutomat = UNCONNECTED;
+                msbClientLosePublishes(client);
                 break;
             }
-            case CONNECTED: {
-                //Verbindung iO?
-                if (!msbClientConnectionReady(client)) {
-                    if (client->flag_reconnect == 1)
-                        client->currentStatusAutomat = CONNECTING;
+
+            if (msbClientReceiveIfRoom(client, incoming_data)) received = true;
+
+            msbClientExpireInFlight(client);
+
+            /* with a publish window, further event messages wait for the answers to the ones in flight */
+            if (client->stream != NULL) {
+                sent = msbClientStreamStep(client);
+            } else if (list_count_entries(outgoing_data) > 0 &&
+                (client->in_flight == NULL || client->publish_statistics.in_flight < client->in_flight_window)) {
+                char* ab = list_getValueFirstPointer(outgoing_data);
+                size_t ab_length = strlen(ab);
+                /* the envelope of a streamed event is left open after "dataObject":, its tag is the stream */
+                bool streamed = list_getKindFirst(outgoing_data) == MSB_OUTGOING_STREAM;
+                int ret = streamed ? msbClientSendFragment(client, ab, ab_length, true, false)
+                                   : msbClientSendText(client, ab, ab_length);
+                if (ret == 0) {
+                    void* completion = NULL;
+                    sent = true;
+                    list_popTagged(outgoing_data, 0, 1, &completion);
+                    if (streamed)
+                        client->stream = (msbPublishStream*) completion; /* the completion is the stream's first member */
                     else
-                        client->currentStatusAutomat = UNCONNECTED;
-                    break;
+                        msbClientSentPublish(client, completion);
                 }
+            }
 
-                if (list_count_entries(incoming_data) < client->maxNumberDataIncoming) {
-                    char* msg = wsGetMsgContent(client->websocketData);
-                    if(msg != NULL){
-/*#ifndef _WIN32
-                        pthread_mutex_lock(&client->incoming_data->mutex);
-#else
-                        DWORD dwWaitResult = WaitForSingleObject(client->mutex, INFINITE);
-if(dwWaitResult == WAIT_OBJECT_0){
-#endif*/
-                        list_add(incoming_data, msg, 1, strlen(msg) + 1);/*
-#ifndef _WIN32
-                        pthread_mutex_unlock(&client->incoming_data->mutex);
-#else
-                        ReleaseMutex(client->mutex);
-#endif*/
-                    }
-                } else
-                    wsGetMsgContent(
-                            client->websocketData); //falls der Puffer für eingehende Nachrichten voll ist, wird der Eingangsspeicher ohne neue Ablage abgerufen
-
-                if (list_count_entries(incoming_data) > 0) {
-                    if (msbMsgFunction(client, (char*) list_getValueFirstPointer(incoming_data)) == 0) {
-/*#ifndef _WIN32
-                        pthread_mutex_lock(&client->mutex);
-#else
-                        DWORD dwWaitResult = WaitForSingleObject(client->mutex, INFINITE);
-if(dwWaitResult == WAIT_OBJECT_0){
-#endif*/
-                        list_pop(incoming_data, 0, 1);
-/*#ifndef _WIN32
-                        pthread_mutex_unlock(&client->mutex);
-#else
-                        ReleaseMutex(client->mutex);
-#endif*/
-                    }
-                    break;
+            if (client->interval_heartbeat > 0) {
+                uint64_t now = msbClientTimeUs();
+
+                if (now - client->last_heartbeat >= client->interval_heartbeat) {
+                    wsPing(client->websocketData);
+                    client->last_heartbeat = now;
                 }
             }
-            case REGISTERED: {
-                //Verbindung iO?
-                if (!msbClientConnectionReady(client)) {
-                    if (client->flag_reconnect == 1)
-                        client->currentStatusAutomat = CONNECTING;
-                    else
-                        client->currentStatusAutomat = UNCONNECTED;
-                    break;
-                }
 
-                if (list_count_entries(incoming_data) < client->maxNumberDataIncoming) {
-                    char* msg = wsGetMsgContent(client->websocketData);
-                    if(msg != NULL){
-/*#ifndef _WIN32
-                        pthread_mutex_lock(&client->mutex);
-#else
-                        DWORD dwWaitResult = WaitForSingleObject(client->mutex, INFINITE);
-if(dwWaitResult == WAIT_OBJECT_0){
-#endif*/
-                        list_add(incoming_data, msg, 1, strlen(msg) + 1);
-/*#ifndef _WIN32
-                        pthread_mutex_unlock(&client->mutex);
-#else
-                        ReleaseMutex(client->mutex);
-#endif*/
-                    }
-                } else
-                    wsGetMsgContent(client->websocketData);
-
-                if (list_count_entries(outgoing_data) > 0) {
-                    char* ab = list_getValueFirstPointer(outgoing_data);
-                    if (msbClientSendText(client, ab, strlen(ab)) == 0) {
-/*#ifndef _WIN32
-                        pthread_mutex_lock(&client->mutex);
-#else
-                        DWORD dwWaitResult = WaitForSingleObject(client->mutex, INFINITE);
-if(dwWaitResult == WAIT_OBJECT_0){
-#endif*/
-                        list_pop(outgoing_data, 0, 1);
-/*#ifndef _WIN32
-                        pthread_mutex_unlock(&client->mutex);
+            msbClientProcessIncoming(client, incoming_data, &received);
+
+            break;
+        }
+        case UNCONNECTED:
+            break;
+        case ERROR:
+            break;
+        case CLOSED:
+            break;
+        default:
+            break;
+    }
+
+    return received || list_count_entries(incoming_data) > 0 ||
+           (sent && client->currentStatusAutomat == REGISTERED &&
+            (client->stream != NULL || (list_count_entries(outgoing_data) > 0 &&
+             (client->in_flight == NULL || client->publish_statistics.in_flight < client->in_flight_window))));
+}
+
+void msbClientAutomatEnd(msbClient* client) {
+    void* completion = NULL;
+
+    msbClientLosePublishes(client);
+    msbClientMergeStaged(client);
+
+    /* messages which are still queued won't be sent anymore */
+    while (list_popTagged(client->outgoing_data, 0, 1, &completion) == EINFL_OK) {
+        msbClientCompletePublish(client, completion, MSB_PUBLISH_DROPPED);
+        completion = NULL;
+    }
+
+    /* payloads taken over from the transport go back to it */
+    while (msbClientPopIncoming(client) == EINFL_OK);
+
+    if (!client->static_memory) {
+        /* empty lists are left to the caller by list_deleteList */
+        if (list_deleteList(client->incoming_data, 1) == EINFL_NO_ENTRIES) free(client->incoming_data);
+        if (list_deleteList(client->outgoing_data, 1) == EINFL_NO_ENTRIES) free(client->outgoing_data);
+        client->incoming_data = NULL;
+        client->outgoing_data = NULL;
+    }
+
+    msbClientDisconnect(client);
+    msbClientDeinitialise(client);
+    client->currentStatusAutomat = CLOSED;
+}
+
+#ifndef _WIN32
+void msbClientAutomatThread(msbClient* client) {
 #else
-                        ReleaseMutex(client->mutex);
-#endif*/
-                    }
-                }
+    DWORD WINAPI msbClientAutomatThread(msbClient* client){
+#endif
 
-                if (list_count_entries(incoming_data) > 0) {
-                    if (msbMsgFunction(client, list_getValueFirstPointer(incoming_data)) == 0) {
-/*#ifndef _WIN32
-                        pthread_mutex_lock(&client->mutex);
-#else
-                        DWORD dwWaitResult = WaitForSingleObject(client->mutex, INFINITE);
-if(dwWaitResult == WAIT_OBJECT_0){
-#endif*/
-                        list_pop(incoming_data, 0, 1);
-/*#ifndef _WIN32
-                        pthread_mutex_unlock(&client->mutex);
-#else
-                        ReleaseMutex(client->mutex);
-#endif*/
-                    }
-                }
+    msbClientAutomatBegin(client);
 
-                break;
-            }
-            case UNCONNECTED:
-                break;
-            case ERROR:
-                break;
-            case CLOSED:
-                break;
-            default:
-                break;
-        }
+    while (!client->force_exit) {
+        uint32_t delay_us;
+        msbClientAutomatStep(client, &delay_us);
+
+        if (msbClientWaitIncoming(client, delay_us + client->pause_automat)) continue;
 #ifndef _WIN32
-        usleep(client->pause_automat);
+        usleep(delay_us + client->pause_automat);
 #else
-        Sleep(client->pause_automat / 1000);
+        Sleep((delay_us + client->pause_automat) / 1000);
 #endif
     }
 
-    list_deleteList(incoming_data, 1);
-    list_deleteList(outgoing_data, 1);
-
-    msbClientDisconnect(client);
-    msbClientDeinitialise(client);
-    client->currentStatusAutomat = CLOSED;
+    msbClientAutomatEnd(client);
 #ifndef _WIN32
     /*if (&(client->thread) != NULL)
         pthread_exit(NULL);
@@ -982,6 +2526,11 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
     ret->maxNumberDataIncoming = 100;
     ret->maxNumberDataOutgoing = 100;
 
+    ret->receive_budget = 64;
+    ret->receive_budget_time = 2000;
+
+    ret->in_flight_timeout = 10000000;
+
     ret->dataOutInterface = NULL;
     ret->dataOutInterfaceFlag = 0;
 
@@ -992,6 +2541,8 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
 
     ret->msbObjectData = msbObjectCreateObject(uuid, token, service_class, name, description);
 
+    ret->buffer_pool = mpool_makePoolPointer(MPOOL_MAX_CACHED);
+
     ret->currentStatusAutomat = CREATED;
     ret->statusAutomatChange = CREATED;
     ret->force_exit = false;
@@ -1002,6 +2553,7 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
     ret->interval_reconnect = 10000000; //intervall zwischen wiederverbindungen in µs
 
     ret->sockJs_framing = false;
+    ret->codec = &msbCodecJSON;
 
     ret->fwdCompleteFunctionCallData = false;
 
@@ -1015,6 +2567,12 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
 
     wsData* wsdebug = ret->websocketData;
 
+    pthread_mutex_init(&ret->stage_mutex, NULL);
+    pthread_mutex_init(&ret->filter_mutex, NULL);
+    pthread_mutex_lock(&msbClientSerialMutex);
+    ret->serial = ++msbClientSerial;
+    pthread_mutex_unlock(&msbClientSerialMutex);
+
 #ifndef _WIN32
     pthread_mutex_init(&ret->mutex, NULL);
 #else
@@ -1027,6 +2585,189 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
     return ret;
 }
 
+bool msbClientSetTransport(msbClient* client, MsbTransport transport) {
+
+    if (client == NULL) return false;
+
+    enum wsTransport t = transport == MSB_TRANSPORT_NATIVE ? WS_TRANSPORT_NATIVE : WS_TRANSPORT_NOPOLL;
+
+    return wsSetTransport(client->websocketData, t) == 0;
+}
+
+static int msbCodecMessagePackEncode(const char* msg, size_t length, msbCodecBuffer* frame) {
+
+    /* only messages of the protocol are encoded, others like the answer to a SockJS heartbeat stay text */
+    if (length < 3 || msg[0] < 'A' || msg[0] > 'Z' || msg[1] != ' ') return 0;
+
+    if (!msbCodecBufferReserve(frame, 1)) return -1;
+    frame->data[frame->used++] = msg[0];
+
+    return msgpackFromJSON(msg + 2, length - 2, frame) == 0 ? 1 : 0;
+}
+
+static int msbCodecMessagePackDecode(const char* frame, size_t length, msbCodecBuffer* msg) {
+
+    if (length < 2 || frame[0] < 'A' || frame[0] > 'Z') return -1;
+
+    if (!msbCodecBufferReserve(msg, 2)) return -1;
+    msg->data[msg->used++] = frame[0];
+    msg->data[msg->used++] = ' ';
+
+    return msgpackToJSON((const unsigned char*) frame + 1, length - 1, msg);
+}
+
+const msbCodec msbCodecJSON = {"json", NULL, NULL};
+
+const msbCodec msbCodecMessagePack = {"msgpack", &msbCodecMessagePackEncode, &msbCodecMessagePackDecode};
+
+bool msbCodecBufferReserve(msbCodecBuffer* buffer, size_t length) {
+
+    if (buffer == NULL || buffer->used > buffer->size) return false;
+
+    if (buffer->size - buffer->used >= length) return true;
+
+    size_t size = buffer->size > 0 ? buffer->size : 256;
+
+    while (size - buffer->used < length) {
+        if (size > SIZE_MAX / 2) return false;
+        size *= 2;
+    }
+
+    char* data = (char*) realloc(buffer->data, size);
+    if (data == NULL) return false;
+
+    buffer->data = data;
+    buffer->size = size;
+
+    return true;
+}
+
+bool msbClientSetIncomingBackpressure(msbClient* client, bool enable, uint32_t low_watermark) {
+
+    if (client == NULL || (enable && low_watermark >= client->maxNumberDataIncoming)) return false;
+
+    client->incoming_low_watermark = low_watermark;
+    client->incoming_backpressure = enable;
+    client->incoming_paused = false;
+
+    return true;
+}
+
+bool msbClientSetReceiveBudget(msbClient* client, uint32_t messages, uint32_t time_us) {
+
+    if (client == NULL || messages == 0) return false;
+
+    client->receive_budget = messages;
+    client->receive_budget_time = time_us;
+
+    return true;
+}
+
+void msbClientGetReceiveStatistics(msbClient* client, msbReceiveStatistics* statistics) {
+
+    if (client == NULL || statistics == NULL) return;
+
+    *statistics = client->receive_statistics;
+}
+
+bool msbClientSetReceiveMode(msbClient* client, MsbReceiveMode mode) {
+
+    if (client == NULL || (mode != MSB_RECEIVE_POLLING && mode != MSB_RECEIVE_CALLBACK)) return false;
+
+    client->receive_mode = mode;
+    wsSetOnMsg(client->websocketData, mode == MSB_RECEIVE_CALLBACK ? &msbClientQueueReceived : NULL, client);
+
+    return true;
+}
+
+bool msbClientSetCodec(msbClient* client, const msbCodec* codec) {
+
+    if (client == NULL || codec == NULL || client->thread_running || client->group_slot != NULL) return false;
+
+    if ((codec->encode != NULL || codec->decode != NULL) && (client->sockJs_framing || client->static_memory))
+        return false;
+
+    client->codec = codec;
+
+    return true;
+}
+
+bool msbClientSetPublishStaging(msbClient* client, uint32_t capacity) {
+
+    if (client == NULL || client->thread_running || client->group_slot != NULL || client->static_memory) return false;
+
+    pthread_once(&msbClientThreadStagesOnce, msbClientMakeThreadStagesKey);
+
+    client->stage_capacity = capacity;
+    mpool_setThreadCached(client->buffer_pool, capacity > 0);
+
+    return true;
+}
+
+#define MSB_STATIC_ALIGN(x) (((x) + 15) & ~(size_t) 15)
+
+bool msbClientUseStaticMemory(msbClient* client, void* region, size_t size, size_t max_message_size) {
+
+    if (client == NULL || region == NULL || ((uintptr_t) region & 15) != 0) return false;
+
+    if (client->static_memory || client->incoming_data != NULL || client->outgoing_data != NULL) return false;
+
+    if (client->codec->encode != NULL || client->codec->decode != NULL || client->stage_capacity > 0) return false;
+
+    if (client->buffer_pool == NULL || client->buffer_pool->hits + client->buffer_pool->misses > 0) return false;
+
+    unsigned int count = client->maxNumberDataIncoming + client->maxNumberDataOutgoing + 2;
+
+    size_t lists = MSB_STATIC_ALIGN(2 * sizeof(list_list));
+    size_t websocket = MSB_STATIC_ALIGN(wsStaticBuffersSize(max_message_size));
+    size_t messages = mpool_reserveSize(max_message_size + 1, count);
+    /* a SockJS frame escapes json text, whose only control characters are line breaks, carriage returns and tabs */
+    size_t frame = mpool_reserveSize(2 * max_message_size + 5, 1);
+    size_t entries = mpool_reserveSize(sizeof(list_entry), count);
+
+    if (websocket == 0 || messages == 0 || frame == 0 || entries == 0) return false;
+
+    size_t needed = lists + websocket + messages + frame + entries;
+
+    if (size <= needed) return false;
+
+    char* p = (char*) region;
+
+    if (wsSetStaticBuffers(client->websocketData, p + lists, max_message_size) != 0) return false;
+
+    list_list* in = (list_list*) p;
+    list_list* out = in + 1;
+
+    memset(p, 0, lists);
+    pthread_mutex_init(&in->mutex, NULL);
+    pthread_mutex_init(&out->mutex, NULL);
+    in->pool = client->buffer_pool;
+    out->pool = client->buffer_pool;
+
+    p += lists + websocket;
+    p += mpool_reserve(client->buffer_pool, p, max_message_size + 1, count);
+    p += mpool_reserve(client->buffer_pool, p, 2 * max_message_size + 5, 1);
+    p += mpool_reserve(client->buffer_pool, p, sizeof(list_entry), count);
+
+    /* whatever is left holds the self description */
+    msbObjectArenaUseRegion(&client->msbObjectData->arena, p, size - needed);
+
+    client->incoming_data = in;
+    client->outgoing_data = out;
+    client->maxMessageSize = (uint32_t) max_message_size;
+    client->static_memory = true;
+
+    /* the first localtime call loads the time zone from the heap, better now than on the first publish */
+    char tBuff[30] = {0};
+    getDateTime(tBuff);
+
+    if (client->debug)
+        client->debugFunction("Msb client use static memory: %lu bytes, %lu for the description\n",
+                              (unsigned long) size, (unsigned long) (size - needed));
+
+    return true;
+}
+
 void msbClientDeleteClient(msbClient* client) {
 
     if (client == NULL) return;
@@ -1035,6 +2776,28 @@ void msbClientDeleteClient(msbClient* client) {
 
     wsDataDestr(client->websocketData);
 
+    msbObjectDestroyObject(client->msbObjectData);
+
+    free(client->in_flight);
+    free(client->codec_buffer.data);
+    free(client->stream_fragment);
+
+    while (client->stages != NULL) {
+        msbPublishStage* stage = client->stages;
+        uint32_t i;
+
+        client->stages = stage->next;
+        for (i = 0; i < stage->count; ++i) mpool_free(client->buffer_pool, stage->messages[i].msg);
+        pthread_mutex_destroy(&stage->mutex);
+        free(stage->messages);
+        free(stage->merging);
+        free(stage);
+    }
+    pthread_mutex_destroy(&client->stage_mutex);
+    pthread_mutex_destroy(&client->filter_mutex);
+
+    mpool_deletePool(client->buffer_pool);
+
 #ifdef _WIN32
     CloseHandle(ret->mutex);
 #endif
@@ -1047,7 +2810,7 @@ void msbClientChangeURL(msbClient* client, char* url, char* origin, bool tls, ch
     if (client == NULL) return;
 
     //prüfung ob verbunden und disconnect?
-    wsDataDestr(client->websocketData);
+    wsData* former = client->websocketData;
 
     char* stdProt = "ws";
     char* stdAdr = NULL;
@@ -1077,6 +2840,9 @@ void msbClientChangeURL(msbClient* client, char* url, char* origin, bool tls, ch
     client->websocketData = wsDataConstr(0, address, port, address, path, origin, tls, client_cert,
                                          client_key, ca_cert, client->debugFunction);
 
+    wsCopySettings(client->websocketData, former);
+    wsDataDestr(former);
+
     if (stdProt != NULL)
         if (strcmp(proto, stdProt) != 0)
             free(proto);
@@ -1095,19 +2861,19 @@ void msbClientChangeAddress(msbClient* client, bool ipv6, char* address, char* p
 
     if (client == NULL) return;
 
-    wsDataDestr(client->websocketData);
+    wsData* former = client->websocketData;
 
     client->websocketData = wsDataConstr(ipv6, address, port, hostname, path, origin, tls, client_cert,
                                          client_key, ca_cert, client->debugFunction);
+
+    wsCopySettings(client->websocketData, former);
+    wsDataDestr(former);
 }
 
-#define if_free_duplicate(former, newer)            \
-    if(former != NULL && newer != NULL){            \
-        if(strcpy(former, newer)){                  \
-            free(former);                           \
-            former = string_duplicate(newer);       \
-        }                                           \
-    }
+/* a string that doesn't fit into the former one is taken from the arena, the former stays there until the client is
+ * deleted */
+#define if_free_duplicate(former, newer)                                                        \
+    former = msbObjectArenaStrreplace(&client->msbObjectData->arena, former, &former##_size, newer);
 
 void msbClientChangeSelfDescription(msbClient* client, char* uuid, char* token, char* service_class, char* name, char* description){
 
@@ -1175,17 +2941,30 @@ void msbClientSetSockJSFraming(msbClient* client, bool on_off) {
 }
 
 void msbClientSetMaxMessageSize(msbClient* client, uint32_t size) {
+    /* the static buffers have been sized for the former maximum */
+    if (client->static_memory && size > client->maxMessageSize) return;
+
     client->maxMessageSize = size;
 }
 
 void msbClientSetEventCacheSize(msbClient* client, uint32_t size) {
+    /* the static region holds the queue entries of the former size */
+    if (client->static_memory && size > client->maxNumberDataIncoming) return;
+
     client->maxNumberDataIncoming = size;
 }
 
 void msbClientSetFunctionCacheSize(msbClient* client, uint32_t size) {
+    if (client->static_memory && size > client->maxNumberDataOutgoing) return;
+
     client->maxNumberDataOutgoing = size;
 }
 
+void msbClientSetCompression(msbClient* client, bool on_off, uint8_t window_bits, bool context_takeover,
+                             uint32_t threshold) {
+    wsSetCompression(client->websocketData, on_off, window_bits, context_takeover, threshold);
+}
+
 bool msbClientAssignTLSCerts(msbClient* client, const char* client_certificate, const char* client_key,
                              const char* ca_certificate) {
 
@@ -1323,10 +3102,12 @@ void msbClientAddEmptyFunction(msbClient* client, char* fId, char* fName, char*
 
 void msbClientAddFunctionFromString(msbClient* client, char* fId, char* fName, char* fDesc, void(*fPtr)(void*, void*, void*),
                                     char* dataFormat, void* contextPtr) {
-    json_object* obj = json_object_new_object();
-    obj = json_tokener_parse(dataFormat);
+    json_object* obj = json_tokener_parse(dataFormat);
 
-    if (obj != NULL) addComplexFunction(client->msbObjectData, fId, fName, fDesc, fPtr, obj, contextPtr);
+    if (obj != NULL) {
+        addComplexFunction(client->msbObjectData, fId, fName, fDesc, fPtr, obj, contextPtr);
+        json_object_put(obj);
+    }
 }
 
 void msbClientAddComplexFunction(msbClient* client, char* fId, char* fName, char* fDesc, void(*fPtr)(void*, void*, void*),
@@ -1370,9 +3151,190 @@ void msbClientAddComplexEvent(msbClient* client, char* eId, char* eName, char* e
 
 /* EXPERIMENTAL */
 void msbClientRemoveEvent(msbClient* client, char* eId) {
+    msbObjectEvent* ev;
+
+    if (client->outgoing_data != NULL &&
+        schll_getValue(client->msbObjectData->eventArray, (void**) &ev, eId) == SCHLL_OK) {
+        list_untrack(client->outgoing_data, &ev->queuedEntry);
+    }
+
     removeEvent(client->msbObjectData, eId);
 }
 
+void msbClientSetEventOverflowPolicy(msbClient* client, char* eId, OverflowPolicy policy) {
+    msbObjectEvent* ev;
+
+    if (client == NULL || eId == NULL) return;
+
+    if (schll_getValue(client->msbObjectData->eventArray, (void**) &ev, eId) != SCHLL_OK) return;
+
+    if (ev->overflowPolicy == MSB_OVERFLOW_COALESCE && policy != MSB_OVERFLOW_COALESCE && client->outgoing_data != NULL)
+        list_untrack(client->outgoing_data, &ev->queuedEntry);
+
+    ev->overflowPolicy = policy;
+}
+
+void msbClientSetEventFilter(msbClient* client, char* eId, EventFilter filter, double deadband, uint32_t heartbeat_in_s) {
+    msbObjectEvent* ev;
+
+    if (client == NULL || eId == NULL) return;
+
+    if (schll_getValue(client->msbObjectData->eventArray, (void**) &ev, eId) != SCHLL_OK) return;
+
+    pthread_mutex_lock(&client->filter_mutex);
+
+    ev->filter = filter;
+    ev->deadband = deadband > 0 ? deadband : 0;
+    ev->filter_heartbeat = (uint64_t) heartbeat_in_s * 1000000;
+    ev->filter_published = 0;
+
+    pthread_mutex_unlock(&client->filter_mutex);
+}
+
+static bool msbClientReceive(msbClient* client, list_list* incoming_data) {
+
+    size_t length = 0;
+    bool binary = false;
+    void* ref = NULL;
+    char* msg = wsTakeMsg(client->websocketData, &length, &binary, &ref);
+
+    if (msg == NULL) return false;
+
+    return msbClientQueueReceived(client, msg, length, binary, ref);
+}
+
+static bool msbClientQueueReceived(void* context, char* msg, size_t length, bool binary, void* ref) {
+
+    msbClient* client = (msbClient*) context;
+    list_list* incoming_data = client->incoming_data;
+
+    if (binary && client->codec->decode != NULL) {
+        client->codec_buffer.used = 0;
+
+        int decoded = client->codec->decode(msg, length, &client->codec_buffer);
+
+        wsReleaseMsg(client->websocketData, ref);
+        ref = NULL;
+
+        if (decoded != 0) {
+            if (client->debug)
+                client->debugFunction("Msb client receive: %s codec can't decode binary frame of length %zu\n",
+                                      client->codec->name, length);
+            return false;
+        }
+
+        msg = client->codec_buffer.data;
+        length = client->codec_buffer.used;
+    }
+
+    /* the entry keeps the payload until msbClientPopIncoming hands it back, without copying it */
+    if (ref != NULL) {
+        if (list_addTagged(incoming_data, msg, 0, 0, NULL, ref, 0) == EINFL_OK) return true;
+
+        wsReleaseMsg(client->websocketData, ref);
+        return false;
+    }
+
+    return list_add(incoming_data, msg, 1, length + 1) == EINFL_OK;
+}
+
+static bool msbClientReceiveIfRoom(msbClient* client, list_list* incoming_data) {
+
+    uint32_t queued = list_count_entries(incoming_data);
+
+    if (client->incoming_backpressure) {
+        if (client->incoming_paused) {
+            if (queued > client->incoming_low_watermark) return false;
+
+            client->incoming_paused = false;
+            if (client->debug) client->debugFunction("Msb client receive: Incoming queue down to %u, reading resumed\n", queued);
+        }
+
+        if (queued >= client->maxNumberDataIncoming) {
+            client->incoming_paused = true;
+            client->incoming_pauses++;
+            if (client->debug) client->debugFunction("Msb client receive: Incoming queue full, reading paused\n");
+            return false;
+        }
+    } else if (queued >= client->maxNumberDataIncoming) {
+        /* the message is read anyway, which keeps the connection going */
+        if (wsGetMsgContent(client->websocketData) != NULL) {
+            client->incoming_dropped++;
+            if (client->debug) client->debugFunction("Msb client receive: Incoming queue full, dropping message\n");
+        }
+        return false;
+    }
+
+    return msbClientReceive(client, incoming_data);
+}
+
+static uint32_t msbClientProcessIncoming(msbClient* client, list_list* incoming_data, bool* received) {
+
+    statusAutomat state = client->currentStatusAutomat;
+    uint64_t deadline = client->receive_budget_time > 0 ? msbClientTimeUs() + client->receive_budget_time : 0;
+    uint32_t processed = 0;
+    bool exhausted = false;
+
+    while (list_count_entries(incoming_data) > 0) {
+        if (msbMsgFunction(client, (char*) list_getValueFirstPointer(incoming_data)) != 0) break;
+
+        msbClientPopIncoming(client);
+        processed++;
+
+        if (client->currentStatusAutomat != state) break;
+
+        if (processed >= client->receive_budget || (deadline != 0 && msbClientTimeUs() >= deadline)) {
+            exhausted = true;
+            break;
+        }
+
+        if (list_count_entries(incoming_data) == 0 && msbClientReceiveIfRoom(client, incoming_data)) *received = true;
+    }
+
+    if (processed == 0) return 0;
+
+    msbReceiveStatistics* statistics = &client->receive_statistics;
+    uint32_t bucket = 0;
+
+    while (bucket < MSB_RECEIVE_BUCKETS - 1 && (processed >> (bucket + 1)) > 0) bucket++;
+
+    statistics->wakeups++;
+    statistics->messages += processed;
+    statistics->per_wakeup[bucket]++;
+    if (processed > statistics->max_per_wakeup) statistics->max_per_wakeup = processed;
+    if (exhausted) statistics->budget_exhausted++;
+
+    return processed;
+}
+
+static bool msbClientWaitIncoming(msbClient* client, uint32_t timeout_us) {
+
+    if (client->receive_mode != MSB_RECEIVE_CALLBACK ||
+        (client->currentStatusAutomat != CONNECTED && client->currentStatusAutomat != REGISTERED))
+        return false;
+
+    uint32_t queued = list_count_entries(client->incoming_data);
+
+    /* a full queue is worked off first, like msbClientReceiveIfRoom does */
+    if (queued >= client->maxNumberDataIncoming || client->incoming_paused) return false;
+
+    return wsDispatchMsgs(client->websocketData, timeout_us, client->maxNumberDataIncoming - queued) >= 0;
+}
+
+static list_return_value msbClientPopIncoming(msbClient* client) {
+
+    if (client->incoming_data == NULL || client->incoming_data->first_entry == NULL) return EINFL_NO_ENTRIES;
+
+    list_entry* first = client->incoming_data->first_entry;
+
+    void* ref = first->tag;
+    list_return_value ret = list_pop(client->incoming_data, 0, ref == NULL);
+
+    wsReleaseMsg(client->websocketData, ref);
+
+    return ret;
+}
+
 int msbClientSendText(msbClient* client, const char* msg, size_t msg_length) {
 
     if (client == NULL) return -1;
@@ -1404,23 +3366,33 @@ int msbClientSendText(msbClient* client, const char* msg, size_t msg_length) {
         msg[j++] = 0x5d;
         msg[j] = 0;*/
 
-        char* msg_t;
+        size_t j = 0;
+        char* frame = (char*) mpool_alloc(client->buffer_pool, msbClientEscapeSockJS(NULL, msg, msg_length) + 5);
 
-        if (!string_replace((char*)msg, "\"", "\\\"", &msg_t)) {
-            char* tmp_msg1 = string_combine("[\"", msg_t);
-            char* tmp_msg2 = string_combine(tmp_msg1, "\"]");
+        if (frame == NULL) return -1;
 
-            ret = wsSend(client->websocketData, tmp_msg2, strlen(tmp_msg2));
+        frame[j++] = '[';
+        frame[j++] = '"';
+        j += msbClientEscapeSockJS(frame + j, msg, msg_length);
+        frame[j++] = '"';
+        frame[j++] = ']';
+        frame[j] = 0;
 
-            if(tmp_msg1 != NULL) free(tmp_msg1);
+        ret = wsSend(client->websocketData, frame, j);
 
-            if(tmp_msg2 != NULL) free(tmp_msg2);
+        mpool_free(client->buffer_pool, frame);
 
-        } else {
-            ret = -1;
-        }
+    } else if (client->codec->encode != NULL) {
+        client->codec_buffer.used = 0;
 
-        if(msg_t != NULL) free(msg_t);
+        int encoded = client->codec->encode(msg, msg_length, &client->codec_buffer);
+
+        if (encoded > 0)
+            ret = wsSendBinary(client->websocketData, client->codec_buffer.data, client->codec_buffer.used);
+        else if (encoded == 0)
+            ret = wsSend(client->websocketData, msg, msg_length);
+        else
+            ret = -1;
 
     } else
         ret = wsSend(client->websocketData, msg, msg_length);
@@ -1433,6 +3405,10 @@ void msbClientSetStateMachineCyclePause(msbClient* client, uint16_t pause_in_ms)
     client->pause_automat = pause_in_ms * (uint16_t) 1000;
 }
 
+void msbClientSetHeartbeatInterval(msbClient* client, uint16_t interval_in_ms) {
+    client->interval_heartbeat = interval_in_ms * (uint32_t) 1000;
+}
+
 void msbClientSetReconnectInterval(msbClient* client, uint16_t interval_in_ms) {
     client->interval_reconnect = interval_in_ms * (uint16_t) 1000;
 }
@@ -1445,8 +3421,68 @@ void msbClientDisableHostnameVerification(msbClient* client) {
     wsSetTLSVerification(client->websocketData, 0);
 }
 
+void msbClientEnableTLSSessionResumption(msbClient* client) {
+    wsSetTLSSessionResumption(client->websocketData, true);
+}
+
+void msbClientDisableTLSSessionResumption(msbClient* client) {
+    wsSetTLSSessionResumption(client->websocketData, false);
+}
+
+void msbClientGetTLSHandshakes(msbClient* client, uint32_t* handshakes, uint32_t* resumed) {
+    wsGetTLSHandshakes(client->websocketData, handshakes, resumed);
+}
+
+void msbClientGetBufferPoolStatistics(msbClient* client, uint64_t* hits, uint64_t* misses, uint64_t* oversized) {
+
+    if (client == NULL || client->buffer_pool == NULL) return;
+
+    pthread_mutex_lock(&client->buffer_pool->mutex);
+
+    if (hits != NULL) *hits = __atomic_load_n(&client->buffer_pool->hits, __ATOMIC_RELAXED);
+    if (misses != NULL) *misses = client->buffer_pool->misses;
+    if (oversized != NULL) *oversized = client->buffer_pool->oversized;
+
+    pthread_mutex_unlock(&client->buffer_pool->mutex);
+}
+
+bool msbClientSetPublishWindow(msbClient* client, uint32_t window) {
+
+    /* the ring is used by the state machine without lock */
+    if (client == NULL || client->thread_running || client->group_slot != NULL) return false;
+
+    if (client->publish_statistics.in_flight > 0) return false;
+
+    msbPublishInFlight* ring = NULL;
+
+    if (window > 0) {
+        ring = (msbPublishInFlight*) calloc(window, sizeof(msbPublishInFlight));
+        if (ring == NULL) return false;
+    }
+
+    free(client->in_flight);
+
+    client->in_flight = ring;
+    client->in_flight_window = window;
+    client->in_flight_first = 0;
+
+    return true;
+}
+
+void msbClientSetPublishTimeout(msbClient* client, uint32_t timeout_in_ms) {
+    client->in_flight_timeout = timeout_in_ms * (uint64_t) 1000;
+}
+
+void msbClientGetPublishStatistics(msbClient* client, msbPublishStatistics* statistics) {
+
+    if (client == NULL || statistics == NULL) return;
+
+    *statistics = client->publish_statistics;
+}
+
 bool msbClientConnectionReady(msbClient* client) {
-    return wsIsConnectionReady(client->websocketData, 1000000);
+    /* a client group thread must not block on a single connection */
+    return wsIsConnectionReady(client->websocketData, client->group_slot != NULL ? 0 : 1000000);
 }
 
 void msbClientEnableReconnect(msbClient* client) {
@@ -147,6 +147,141 @@ schll_return_value schll_getValue(const schll_list* list, void** value, const ch
  */
 void* schll_getValuePointer(const schll_list* list, const char* name);
 
+/**
+ * @brief Internal function for appending an entry allocated by the caller to a linked list
+ *
+ * The list neither copies nor frees the entry, its name or its value.
+ *
+ * @param list Pointer to a list
+ * @param entry Entry with name and value set
+ *
+ * @return linked list operation value
+ */
+schll_return_value schll_linkEntry(schll_list* list, schll_entry* entry);
+
+/**
+ * @brief Internal function for taking an entry allocated by the caller out of a linked list
+ *
+ * @param list Pointer to a list
+ * @param name Name of the entry
+ * @param entry Pointer to put the unlinked entry into, can be null
+ *
+ * @return linked list operation value
+ */
+schll_return_value schll_unlinkEntry(schll_list* list, const char* name, schll_entry** entry);
+
+#define MPOOL_SIZE_CLASSES 6 /**< number of buffer size classes, 64 B to 64 KiB in steps of four */
+#define MPOOL_MAX_CACHED 64 /**< default maximum number of free buffers kept per size class */
+#define MPOOL_THREAD_CACHED 32 /**< maximum number of free buffers a thread keeps per size class, see mpool_setThreadCached */
+
+/**
+ * @brief header in front of every pool buffer
+ */
+typedef struct mpool_buffer {
+	struct mpool_buffer* next;/**< next free buffer of the size class, only used while the buffer is free */
+	size_t size_class;/**< size class of the buffer, MPOOL_SIZE_CLASSES for oversized buffers */
+} mpool_buffer;
+
+/**
+ * @brief pool of size-classed buffers
+ */
+typedef struct mpool {
+	mpool_buffer* free_buffers[MPOOL_SIZE_CLASSES];/**< free buffers of each size class */
+	unsigned int number_free[MPOOL_SIZE_CLASSES];/**< number of free buffers of each size class */
+	unsigned int max_cached;/**< maximum number of free buffers kept per size class */
+	uint64_t hits;/**< allocations served by a free buffer, of the pool or of a thread cache, counted atomically */
+	uint64_t misses;/**< allocations of a size class which had to take a new buffer from the heap */
+	uint64_t oversized;/**< allocations larger than the largest size class, taken from the heap */
+	bool no_heap;/**< buffers are only taken from reserved memory, see mpool_reserve */
+	bool thread_cached;/**< buffers are passed through caches of the threads, see mpool_setThreadCached */
+	pthread_mutex_t mutex;/**< mutex for safe data access and exchange */
+} mpool;
+
+/**
+ * @brief Internal function for creating a buffer pool
+ *
+ * @param max_cached maximum number of free buffers kept per size class
+ *
+ * @return Created pool
+ */
+mpool* mpool_makePoolPointer(unsigned int max_cached);
+
+/**
+ * @brief Internal function for deleting a buffer pool and its free buffers
+ *
+ * Buffers still in use must not be given back afterwards.
+ *
+ * @param pool Pointer to a pool
+ */
+void mpool_deletePool(mpool* pool);
+
+/**
+ * @brief Internal function for taking a buffer out of a pool
+ *
+ * @param pool Pointer to a pool, if null the buffer is taken from the heap
+ * @param size Number of bytes needed
+ *
+ * @return Pointer to the buffer, contents are undefined
+ */
+void* mpool_alloc(mpool* pool, size_t size);
+
+/**
+ * @brief Internal function for taking a zeroed buffer out of a pool
+ *
+ * @param pool Pointer to a pool, if null the buffer is taken from the heap
+ * @param size Number of bytes needed
+ *
+ * @return Pointer to the zeroed buffer
+ */
+void* mpool_calloc(mpool* pool, size_t size);
+
+/**
+ * @brief Internal function for giving a buffer back to its pool
+ *
+ * @param pool Pointer to the pool the buffer was taken from, null if it was taken from the heap
+ * @param ptr Pointer to the buffer, can be null
+ */
+void mpool_free(mpool* pool, void* ptr);
+
+/**
+ * @brief Internal function for getting the memory needed by mpool_reserve
+ *
+ * @param buffer_size Number of bytes of each buffer
+ * @param count Number of buffers
+ *
+ * @return Number of bytes, 0 if buffer_size is larger than the largest size class
+ */
+size_t mpool_reserveSize(size_t buffer_size, unsigned int count);
+
+/**
+ * @brief Internal function for putting buffers carved out of caller's memory into a pool
+ *
+ * Afterwards the pool doesn't use the heap anymore. Allocations fail if no reserved buffer is free, reserved buffers are
+ * never free'd.
+ *
+ * @param pool Pointer to a pool
+ * @param memory Memory of at least mpool_reserveSize bytes, aligned to 16 bytes
+ * @param buffer_size Number of bytes of each buffer
+ * @param count Number of buffers
+ *
+ * @return Number of bytes of memory used
+ */
+size_t mpool_reserve(mpool* pool, void* memory, size_t buffer_size, unsigned int count);
+
+/**
+ * @brief Internal function for letting every thread keep free buffers of a pool in a cache of its own
+ *
+ * A thread takes buffers out of its cache and gives them back into it without locking the pool. A thread running out
+ * of buffers of a size class moves half of its maximum out of the pool at once, a thread whose cache overflows moves
+ * half of it back, so the pool is locked once per MPOOL_THREAD_CACHED / 2 buffers. Meant for buffers allocated and
+ * free'd by different threads at high rates; hits count the buffers taken out of a cache then. The caches are shared
+ * by all pools using the heap and free'd when their thread exits. Pools with reserved memory aren't cached.
+ *
+ * @param pool Pointer to a pool
+ * @param enable Flag for the thread caches
+ */
+void mpool_setThreadCached(mpool* pool, bool enable);
+
 /**
  * @brief return value enum for list
  */
@@ -164,6 +299,9 @@ typedef enum list_return_value {
 typedef struct list_entry {
     void* value;/**< pointer to value */
 	struct list_entry* next_entry;/**< pointer to next entry */
+	struct list_entry** tracker;/**< optional external reference to this entry, reset to NULL when the entry is removed */
+	void* tag;/**< optional data of the list's owner kept with the value, never free'd by the list */
+	int kind;/**< kind of the value given by the list's owner, tells e.g. what the tag points to */
 } list_entry;
 
 /**
@@ -171,8 +309,10 @@ typedef struct list_entry {
  */
 typedef struct list_list {
 	struct list_entry* first_entry;/**< pointer to first entry */
+	struct list_entry* last_entry;/**< pointer to last entry, entries are appended without walking the list */
 	unsigned int number_entries;/**< number of entries in the list */
 	pthread_mutex_t mutex;/**< mutex for safe data access and exchange */
+	mpool* pool;/**< optional pool for entries and copied values, values free'd by the list have to come from it */
 } list_list;
 
 /**
@@ -213,6 +353,65 @@ list_return_value list_deleteList(list_list* list, int free_value);
  */
 list_return_value list_add(list_list* list, void* value, int copy_value, size_t value_size);
 
+/**
+ * @brief Internal function for adding a value to a list and keeping an external reference to its entry
+ *
+ * The reference is reset to NULL as soon as the entry is popped from the list, so it can be used as an index
+ * for replacing the value in place later on.
+ *
+ * @param list Pointer to a list
+ * @param value Pointer to value
+ * @param copy_value flag whether the value has to be copied or not
+ * @param value_size size of the value
+ * @param tracker Pointer to the external reference
+ *
+ * @return list operation value
+ */
+list_return_value list_addTracked(list_list* list, void* value, int copy_value, size_t value_size, list_entry** tracker);
+
+/**
+ * @brief Internal function for adding a value with a tag to a list, optionally keeping an external reference to its entry
+ *
+ * @param list Pointer to a list
+ * @param value Pointer to value
+ * @param copy_value flag whether the value has to be copied or not
+ * @param value_size size of the value
+ * @param tracker Pointer to the external reference, may be NULL
+ * @param tag Data kept with the value, handed back by list_popTagged
+ * @param kind Kind of the value, handed back by list_getKindFirst
+ *
+ * @return list operation value
+ */
+list_return_value list_addTagged(list_list* list, void* value, int copy_value, size_t value_size, list_entry** tracker,
+                                 void* tag, int kind);
+
+/**
+ * @brief Internal function for replacing the value of a tracked entry in place
+ *
+ * The first entry of the list is never replaced, because it may be in use by the reader of the list.
+ *
+ * @param list Pointer to a list
+ * @param tracker Pointer to the external reference of the entry
+ * @param value Pointer to the new value
+ * @param copy_value flag whether the value has to be copied or not
+ * @param value_size size of the value
+ * @param free_value flag whether the former value has to be free'd or not
+ *
+ * @return list operation value, EINFL_NO_ENTRY if there is no replaceable entry
+ */
+list_return_value list_replaceTracked(list_list* list, list_entry** tracker, void* value, int copy_value,
+                                      size_t value_size, int free_value);
+
+/**
+ * @brief Internal function for releasing an external reference to a list entry
+ *
+ * @param list Pointer to a list
+ * @param tracker Pointer to the external reference
+ *
+ * @return list operation value
+ */
+list_return_value list_untrack(list_list* list, list_entry** tracker);
+
 /**
  * @brief Internal function for popping a value from a list
  *
@@ -224,6 +423,18 @@ list_return_value list_add(list_list* list, void* value, int copy_value, size_t
  */
 list_return_value list_pop(list_list* list, unsigned int index, int free_value);
 
+/**
+ * @brief Internal function for popping a value from a list and getting its tag
+ *
+ * @param list Pointer to a list
+ * @param index index of the value
+ * @param free_value flag whether the value has to be free'd or not
+ * @param tag pointer in which the tag of the entry shall be put, may be NULL
+ *
+ * @return list operation value
+ */
+list_return_value list_popTagged(list_list* list, unsigned int index, int free_value, void** tag);
+
 /**
  * @brief Internal function for getting a value from a list
  *
@@ -274,6 +485,15 @@ void* list_getValuePointer(list_list* list, unsigned int index);
  */
 void* list_getValueFirstPointer(list_list* list);
 
+/**
+ * @brief Internal function for getting the kind of the first value of a list
+ *
+ * @param list Pointer to a list
+ *
+ * @return kind given to list_addTagged, 0 if the list is empty
+ */
+int list_getKindFirst(list_list* list);
+
 /**
  * @brief Internal function for getting the last value from a list
  *
@@ -317,6 +537,52 @@ typedef enum {
 	MSB_NONE/**< data has no format */
 } PrimitiveFormat;
 
+/**
+ * @brief policy for handling a new event message when the outgoing queue is full
+ */
+typedef enum {
+	MSB_OVERFLOW_DROP_NEWEST,/**< the new message is dropped (default) */
+	MSB_OVERFLOW_DROP_OLDEST,/**< the oldest queued message is dropped to make room for the new one */
+	MSB_OVERFLOW_COALESCE/**< a still queued message of the same event is replaced by the new one */
+} OverflowPolicy;
+
+/**
+ * @brief report by exception: filtering of the values published by msbClientPublish, see msbClientSetEventFilter
+ */
+typedef enum {
+	MSB_FILTER_NONE,/**< every value is published (default) */
+	MSB_FILTER_ON_CHANGE,/**< only values differing from the last published one */
+	MSB_FILTER_DEADBAND_ABSOLUTE,/**< numbers differing by more than the deadband from the last published one */
+	MSB_FILTER_DEADBAND_PERCENT/**< numbers differing by more than deadband percent of the last published one */
+} EventFilter;
+
+/**
+ * @brief outcome of a message published with a completion
+ */
+typedef enum {
+	MSB_PUBLISH_SENT,/**< the message has been written to the socket */
+	MSB_PUBLISH_DROPPED,/**< the message has been dropped from the outgoing queue, the queue has been closed or the acknowledgement has been lost with the connection */
+	MSB_PUBLISH_ACKNOWLEDGED,/**< the broker has acknowledged the message (IO_PUBLISHED), only with a publish window */
+	MSB_PUBLISH_REJECTED/**< the broker couldn't forward the message (NIO_EVENT_FORWARDING_ERROR), only with a publish window */
+} PublishStatus;
+
+/**
+ * @brief completion of a single published message, owned by the caller until its callback has been called
+ */
+typedef struct msbPublishCompletion {
+	void (*callback)(void* client, struct msbPublishCompletion* completion, PublishStatus status);/**< called once when the message has been sent or dropped */
+	void* context;/**< pointer to context data for the callback */
+} msbPublishCompletion;
+
+/**
+ * @brief data object of an event which is read in pieces while it's sent, see msbClientPublishStream
+ */
+typedef struct msbPublishStream {
+	msbPublishCompletion completion;/**< called once the event has been sent or dropped, the callback may be NULL */
+	size_t (*read)(void* context, char* buffer, size_t size);/**< writes up to size bytes of the json text of the data object into buffer and returns their number, 0 at its end */
+	void* context;/**< pointer to context data for read */
+} msbPublishStream;
+
 /**
  * @brief msb event structure
  */
@@ -335,6 +601,16 @@ typedef struct {
 	PrimitiveFormat array_subformat;/**< sub dataformat of the event if main type is Array */
 
 	int atId;/**< the @ id of the event used in the self-description (necessary for referencing) */
+
+	OverflowPolicy overflowPolicy;/**< handling of new messages of this event when the outgoing queue is full */
+	list_entry* queuedEntry;/**< entry of the latest queued message of this event, only tracked when coalescing */
+
+	EventFilter filter;/**< filtering of the values published by msbClientPublish */
+	double deadband;/**< absolute or percent deadband of the filter */
+	uint64_t filter_heartbeat;/**< interval in µs after which an unchanged value is published anyway, 0 for never */
+	uint64_t filter_published;/**< time of the last value that passed the filter in µs, 0 before the first one */
+	double filter_number;/**< last value that passed a deadband filter */
+	uint64_t filter_hash;/**< hash of the last value that passed a change filter */
 } msbObjectEvent;
 
 /**
@@ -381,12 +657,41 @@ typedef struct {
 	char* service_class;/**< class of the Msb Service (either APPLICATION or SMART_OBJECT */
 	char* service_name;/**< name of the Msb Service */
 	char* service_description;/**< description of the Msb Service */
+	size_t service_uuid_size;/**< bytes the uuid can take without new memory, including the terminator */
+	size_t service_token_size;/**< bytes the token can take without new memory, including the terminator */
+	size_t service_class_size;/**< bytes the class can take without new memory, including the terminator */
+	size_t service_name_size;/**< bytes the name can take without new memory, including the terminator */
+	size_t service_description_size;/**< bytes the description can take without new memory, including the terminator */
 } msbObjectInfo;
 
+/**
+ * @brief chunk of an Msb object arena, the chunk's memory follows the header
+ */
+typedef struct msbObjectArenaChunk {
+	struct msbObjectArenaChunk* next;/**< pointer to the next (older) chunk */
+	size_t size;/**< usable bytes of the chunk */
+	size_t used;/**< bytes of the chunk handed out so far */
+} msbObjectArenaChunk;
+
+/**
+ * @brief arena holding the strings and descriptors of an Msb object
+ *
+ * Memory is only handed out, never given back one by one. Everything is free'd at once when the object is destroyed.
+ */
+typedef struct {
+	msbObjectArenaChunk* chunks;/**< chunk currently filled, older chunks are linked behind it */
+	size_t chunk_size;/**< usable size of a regular chunk */
+	size_t used;/**< bytes handed out in total */
+	size_t allocated;/**< bytes taken from the heap in total */
+	unsigned int number_chunks;/**< number of chunks */
+	void* region;/**< static memory region the arena is confined to, null if chunks are taken from the heap */
+} msbObjectArena;
+
 /**
  * @brief Self-description structure
  */
 typedef struct {
+	msbObjectArena arena;/**< arena holding the lists, descriptors and strings of the Msb object */
 	schll_list* functionArray;/**< linked list of the Service's functions */
 	schll_list* eventArray;/**< linked list of the Service's events */
 	schll_list* configParamArray;/**< linked list of the Service's configuration parameters */
@@ -419,6 +724,137 @@ typedef enum {
     CLOSED/**< client is closed */
 } statusAutomat;
 
+/**
+ * @brief event message which has been sent and waits for its acknowledgement
+ */
+typedef struct {
+	msbPublishCompletion* completion;/**< completion of the message, may be NULL */
+	uint64_t sent;/**< time the message has been sent in µs */
+} msbPublishInFlight;
+
+/**
+ * @brief event message staged by a publishing thread
+ */
+typedef struct {
+	msbObjectEvent* ev;/**< event of the message */
+	char* msg;/**< message, taken from the buffer pool */
+	size_t length;/**< length of the message */
+	msbPublishCompletion* completion;/**< completion of the message, may be NULL */
+	int kind;/**< kind of the message in the outgoing queue, see msbClientQueueEvent */
+} msbStagedMessage;
+
+/**
+ * @brief event messages a publishing thread has staged for the outgoing queue, see msbClientSetPublishStaging
+ */
+typedef struct msbPublishStage {
+	msbStagedMessage* messages;/**< staged messages in publishing order */
+	msbStagedMessage* merging;/**< messages being merged into the outgoing queue, swapped with messages */
+	uint32_t capacity;/**< maximum number of staged messages */
+	volatile uint32_t count;/**< number of staged messages */
+	pthread_t owner;/**< publishing thread */
+	pthread_mutex_t mutex;/**< mutex between the publishing thread and the merging one */
+	struct msbPublishStage* next;/**< stage of the next publishing thread */
+} msbPublishStage;
+
+/**
+ * @brief acknowledgement statistics of published events, see msbClientSetPublishWindow
+ */
+typedef struct {
+	uint64_t sent;/**< event messages written to the socket while tracked */
+	uint64_t acknowledged;/**< event messages acknowledged by the broker */
+	uint64_t rejected;/**< event messages the broker couldn't forward */
+	uint64_t lost;/**< sent event messages whose acknowledgement has been lost with the connection or has timed out */
+	uint64_t timeouts;/**< times the acknowledgement of the oldest event message hasn't come in time, see msbClientSetPublishTimeout */
+	uint32_t in_flight;/**< event messages waiting for their acknowledgement */
+	uint32_t latency_min;/**< shortest time between sending and acknowledgement in µs */
+	uint32_t latency_max;/**< longest time between sending and acknowledgement in µs */
+	uint64_t latency_sum;/**< sum of the times between sending and acknowledgement in µs, divided by acknowledged + rejected it gives the mean */
+} msbPublishStatistics;
+
+#define MSB_RECEIVE_BUCKETS 8 /**< number of buckets of msbReceiveStatistics.per_wakeup */
+
+/**
+ * @brief statistics of the incoming messages processed per cycle of the state machine, see msbClientSetReceiveBudget
+ */
+typedef struct {
+	uint64_t wakeups;/**< cycles which processed at least one incoming message */
+	uint64_t messages;/**< incoming messages processed */
+	uint32_t max_per_wakeup;/**< most incoming messages processed in one cycle */
+	uint64_t budget_exhausted;/**< cycles which stopped at the message or time budget instead of running out of messages */
+	uint64_t per_wakeup[MSB_RECEIVE_BUCKETS];/**< cycles by messages processed: 1, 2-3, 4-7, ..., the last one 128 and more */
+} msbReceiveStatistics;
+
+/**
+ * @brief websocket transport of the Msb client
+ */
+typedef enum {
+	MSB_TRANSPORT_NOPOLL,/**< websocket connection by libnopoll (default) */
+	MSB_TRANSPORT_NATIVE/**< in-tree RFC 6455 client on a non-blocking socket (Linux only) */
+} MsbTransport;
+
+/**
+ * @brief how the state machine thread of the Msb client learns about incoming messages, see msbClientSetReceiveMode
+ */
+typedef enum {
+	MSB_RECEIVE_POLLING,/**< the thread sleeps pause_automat between its cycles and reads the connection in them (default) */
+	MSB_RECEIVE_CALLBACK/**< the thread waits on the connection instead of sleeping, the websocket layer hands messages over as they arrive */
+} MsbReceiveMode;
+
+/**
+ * @brief scheduling policy of the threads of the library
+ */
+typedef enum {
+	MSB_SCHED_DEFAULT,/**< policy and priority inherited from the creating thread (default) */
+	MSB_SCHED_OTHER,/**< SCHED_OTHER, the normal time sharing */
+	MSB_SCHED_FIFO,/**< SCHED_FIFO real time scheduling, needs CAP_SYS_NICE */
+	MSB_SCHED_RR/**< SCHED_RR real time scheduling, needs CAP_SYS_NICE */
+} MsbSchedPolicy;
+
+/**
+ * @brief configuration of the threads the library creates, see msbClientSetThreadConfig and msbClientGroupNewConfigured
+ *
+ * A zeroed configuration gives the defaults.
+ */
+typedef struct {
+	uint64_t cpu_mask;/**< CPUs 0 to 63 the thread may run on, bit i for CPU i, 0 for all (Linux only) */
+	MsbSchedPolicy policy;/**< scheduling policy */
+	int priority;/**< priority of MSB_SCHED_FIFO and MSB_SCHED_RR, 1 to 99 on Linux */
+	size_t stack_size;/**< stack size in bytes, 0 for the default of the platform */
+	char name[16];/**< name of the thread, shown by ps and debuggers (Linux only), empty for none */
+} msbThreadConfig;
+
+/**
+ * @brief growable buffer the message codecs write to, see msbCodecBufferReserve
+ */
+typedef struct {
+	char* data;/**< content */
+	size_t used;/**< bytes in data */
+	size_t size;/**< size of data */
+} msbCodecBuffer;
+
+/**
+ * @brief message codec between the MSB protocol and the websocket frames, see msbClientSetCodec
+ *
+ * Messages of the MSB protocol are a letter, a blank and a json text, e.g. E {"uuid":...}. A codec may send them as
+ * binary frames in another encoding; text frames are always handed over unchanged.
+ */
+typedef struct {
+	const char* name;/**< name of the codec */
+	int (*encode)(const char* msg, size_t length, msbCodecBuffer* frame);/**< encodes the null terminated message into frame (used is 0 on entry), returns 1 to send frame as binary frame, 0 to send the message unchanged as text frame, -1 on failure; NULL to send everything as text */
+	int (*decode)(const char* frame, size_t length, msbCodecBuffer* msg);/**< decodes a received binary frame into a null terminated message in msg (used is 0 on entry, the termination isn't counted), returns 0 on success, -1 for an invalid frame; NULL to take binary frames as text */
+} msbCodec;
+
+/**
+ * @brief codec of the MSB protocol, json text frames (default)
+ */
+extern const msbCodec msbCodecJSON;
+
+/**
+ * @brief MessagePack codec: binary frames made of the letter of the message followed by the MessagePack encoding of
+ * its json text, which has to be supported by the broker
+ */
+extern const msbCodec msbCodecMessagePack;
+
 /**
  * @brief Msb client main structure
  */
@@ -430,6 +866,8 @@ typedef struct {
 
 	list_list* incoming_data;/**< internal list for incoming function calls */
 	list_list* outgoing_data;/**< internal list for outgoing events */
+	mpool* buffer_pool;/**< pool of the message buffers and entries of the incoming and outgoing lists */
+	bool static_memory;/**< queues, buffers and model storage live in a region given by msbClientUseStaticMemory */
 
 	volatile char* dataOutInterface;/**< exchange point for outgoing messages */
 	volatile int dataOutInterfaceFlag;/**< exchange point flag for outgoing messages */
@@ -450,6 +888,7 @@ typedef struct {
 	statusAutomat statusAutomatChange;/**< former status of state machine */
 	bool force_exit;/**< exit flag for state machine */
 	uint32_t pause_automat;/**< pause for state machine cycle */
+	msbThreadConfig thread_config;/**< configuration of the state machine thread */
 
 #ifndef _WIN32
 	pthread_t thread;/**< thread for state machine */
@@ -461,15 +900,55 @@ typedef struct {
 #endif // !_WIN32
 
 	uint32_t interval_reconnect;/**< interval for automatic reconnect attempt */
+	uint32_t interval_heartbeat;/**< interval between websocket pings while registered in µs, 0 for none */
+	uint64_t last_heartbeat;/**< time of the last websocket ping in µs */
+
+	msbPublishInFlight* in_flight;/**< ring of sent event messages waiting for their acknowledgement, NULL if not tracked */
+	uint32_t in_flight_window;/**< maximum number of unacknowledged event messages */
+	uint32_t in_flight_first;/**< index of the oldest unacknowledged event message in the ring */
+	uint64_t in_flight_timeout;/**< time after which unacknowledged event messages count as lost in µs, 0 for no limit */
+	msbPublishStatistics publish_statistics;/**< acknowledgement statistics of published events */
+	volatile uint64_t events_filtered;/**< values of msbClientPublish suppressed by event filters */
+	pthread_mutex_t filter_mutex;/**< mutex for the filter state of the events, taken by every publishing thread */
+
+	bool incoming_backpressure;/**< stop reading from the connection while the incoming queue is full, see msbClientSetIncomingBackpressure */
+	bool incoming_paused;/**< reading is paused until the incoming queue is down to the low watermark */
+	uint32_t incoming_low_watermark;/**< number of queued incoming messages at which reading resumes */
+	volatile uint64_t incoming_pauses;/**< times reading has been paused by backpressure */
+	volatile uint64_t incoming_dropped;/**< received messages discarded because the incoming queue was full, without backpressure */
+	uint32_t receive_budget;/**< maximum number of incoming messages processed per cycle of the state machine */
+	uint32_t receive_budget_time;/**< time after which a cycle stops processing incoming messages in µs, 0 for no limit */
+	msbReceiveStatistics receive_statistics;/**< incoming messages processed per cycle of the state machine */
+	MsbReceiveMode receive_mode;/**< how the state machine thread waits for incoming messages */
+
+	msbPublishStage* volatile stages;/**< stages of the publishing threads, merged into the outgoing queue by the state machine */
+	uint32_t stage_capacity;/**< maximum number of messages staged per publishing thread, 0 without staging */
+	uint64_t serial;/**< number of the client, tells it apart from deleted clients at the same address */
+	pthread_mutex_t stage_mutex;/**< mutex for adding and merging stages */
+
+	msbPublishStream* stream;/**< event whose data object is being sent in fragments, other messages wait for it */
+	char* stream_fragment;/**< buffer of the fragments, allocated with the first stream */
+	size_t stream_pending;/**< length of the fragment in stream_fragment which couldn't be sent yet, 0 if none */
+	bool stream_pending_last;/**< the pending fragment is the last one */
 
 	bool flag_reconnect;/**< flag for automatic reconnect */
 	bool sockJs_framing;/**< flag for sockjs message framing */
+	const msbCodec* codec;/**< message codec, msbCodecJSON by default */
+	msbCodecBuffer codec_buffer;/**< encoded or decoded message of the state machine thread */
 
 	int (*debugFunction)(const char* format, ... );/**< pointer to debug output function */
 	bool debug;/**< flag for debug output activation */
 
+	bool thread_running;/**< flag, if the state machine runs in its own thread */
+	void* group_slot;/**< slot of the client group hosting the state machine, NULL if it runs in its own thread */
+
 } msbClient;
 
+/**
+ * @brief Group of Msb clients whose state machines share a fixed pool of event loop threads (Linux only)
+ */
+typedef struct msbClientGroup msbClientGroup;
+
 /**
  * @brief Create an Msb client
  *
@@ -516,6 +995,78 @@ msbClient* msbClientNewClient(bool ipv6, char* address, char* port, char* hostna
 							   char* uuid, char* token, char* service_class, char* name, char* description,
 							   bool tls, char* client_cert, char* client_key, char* ca_cert);
 
+/**
+ * @brief Let an Msb client take its memory from a static region instead of the heap
+ *
+ * Has to be called right after creating the client, before any event, function or configuration parameter is added
+ * and before the state machine is started. The incoming and outgoing queues, their message buffers, the websocket
+ * buffers and the storage of the self description are carved out of the region, so publishing events with
+ * msbClientPublish or msbClientPublishEmpty and receiving messages don't allocate once the client is registered.
+ * Connecting, registering and dispatching function calls or configuration changes still use the heap.
+ * The native transport is selected, websocket compression is not available and the maximum message size can't be
+ * raised. Changing the address afterwards brings back heap buffers for the websocket.
+ *
+ * @param client Pointer to Msb client
+ * @param region Memory for the client, aligned to 16 bytes, has to outlive the client
+ * @param size Size of the region in bytes
+ * @param max_message_size Maximum size of a message in bytes (below 32 KiB)
+ *
+ * @return false if the region is too small or the client can't use static memory anymore
+ */
+bool msbClientUseStaticMemory(msbClient* client, void* region, size_t size, size_t max_message_size);
+
+/**
+ * @brief Select the websocket transport of an Msb client
+ *
+ * Has to be called right after creating the client, before the state machine is started.
+ *
+ * @param client Pointer to Msb client
+ * @param transport Websocket transport (MSB_TRANSPORT_NOPOLL is default)
+ *
+ * @return false if the transport is not available on this platform
+ */
+bool msbClientSetTransport(msbClient* client, MsbTransport transport);
+
+/**
+ * @brief Select the message codec of an Msb client
+ *
+ * Has to be called before the state machine is started. Codecs with binary frames can't be combined with SockJS
+ * framing or static memory.
+ *
+ * @param client Pointer to Msb client
+ * @param codec Codec, e.g. &msbCodecMessagePack, has to outlive the client
+ *
+ * @return false if the codec can't be used with this client
+ */
+bool msbClientSetCodec(msbClient* client, const msbCodec* codec);
+
+/**
+ * @brief Let every publishing thread stage its event messages instead of queueing them one by one
+ *
+ * Each thread publishing to the client gets a stage of its own, which only it and the state machine lock, and
+ * message buffers are passed through caches of the threads (see mpool_setThreadCached). The state machine merges the
+ * stages into the outgoing queue at the start of every cycle, keeping the order of each thread's messages, and applies
+ * the overflow policies then: completions of dropped messages are called on the thread driving the state machine. A
+ * publish fails if the thread's stage is full. Has to be called before the state machine is started, not available
+ * with static memory.
+ *
+ * @param client Pointer to Msb client
+ * @param capacity Maximum number of messages staged per thread, 0 to queue directly (default)
+ *
+ * @return false if staging can't be used with this client
+ */
+bool msbClientSetPublishStaging(msbClient* client, uint32_t capacity);
+
+/**
+ * @brief Make room for length further bytes in a codec buffer
+ *
+ * @param buffer Pointer to the buffer
+ * @param length Number of bytes to be appended
+ *
+ * @return false if the buffer couldn't be grown
+ */
+bool msbCodecBufferReserve(msbCodecBuffer* buffer, size_t length);
+
 /**
  * @brief Delete an Msb Client
  *
@@ -526,6 +1077,8 @@ void msbClientDeleteClient(msbClient* client);
 /**
  * @brief Change the target url of an existing Msb Client
  *
+ * The settings of the connection, including static buffers (see msbClientUseStaticMemory), are taken over.
+ *
  * @param client Pointer to Msb client
  * @param url URL to MSB
  * @param origin for websocket header, usually NULL is okay
@@ -539,6 +1092,8 @@ void msbClientChangeURL(msbClient* client, char* url, char* origin, bool tls, ch
 /**
  * @brief Change the target address of an existing Msb Client
  *
+ * The settings of the connection, including static buffers (see msbClientUseStaticMemory), are taken over.
+ *
  * @param client Pointer to Msb client
  * @param ipv6 Use IPv6 (>0) or not (0)
  * @param address MSB address (use either targetAddr or targetHostname)
@@ -556,6 +1111,9 @@ void msbClientChangeAddress(msbClient* client, bool ipv6, char* address, char* p
 /**
  * @brief Change the self description of a client
  *
+ * A string that fits into the memory of the former one replaces it in place, only a longer one takes new memory of the
+ * client's arena (or static memory region).
+ *
  * @param client Pointer to Msb client
  * @param uuid Service UUID
  * @param token Service token
@@ -647,10 +1205,28 @@ void msbClientDeinitialise(msbClient* client);
 /**
  * @brief Start Msb client thread
  *
+ * A state machine which is already running (in its own thread or in a group) is not started twice.
+ *
  * @param client Pointer to Msb client
+ *
+ * @return 0 if the thread has been started, != 0 otherwise
  */
 int msbClientRunClientStateMachine(msbClient* client);
 
+/**
+ * @brief Configure the thread msbClientRunClientStateMachine creates for the state machine
+ *
+ * Affinity, scheduling policy and stack size are set before the thread starts, the name right after. Has to be called
+ * before the state machine is started. If the thread can't be created with the configuration, e.g. real time
+ * scheduling without the permission, msbClientRunClientStateMachine fails.
+ *
+ * @param client Pointer to Msb client
+ * @param config Configuration, copied
+ *
+ * @return false if the state machine is running or the configuration is invalid
+ */
+bool msbClientSetThreadConfig(msbClient* client, const msbThreadConfig* config);
+
 /**
  * @brief Stop Msb client thread
  *
@@ -658,6 +1234,74 @@ int msbClientRunClientStateMachine(msbClient* client);
  */
 int msbClientHaltClientStateMachine(msbClient* client);
 
+/**
+ * @brief Create a client group
+ *
+ * Every thread of the group waits on one epoll set for the connections of its clients and runs their state
+ * machines. Clients using MSB_TRANSPORT_NATIVE are woken by incoming data, other clients are polled every
+ * pause_automat.
+ *
+ * @param threads Number of event loop threads
+ *
+ * @return Created group, NULL on error or if client groups are not supported on this platform
+ */
+msbClientGroup* msbClientGroupNew(uint32_t threads);
+
+/**
+ * @brief Create a client group whose threads are configured
+ *
+ * Like msbClientGroupNew. With affinity, thread i of the group is pinned to the i-th CPU of the mask (counting round),
+ * so every event loop gets a CPU of its own. Names get the index of the thread appended.
+ *
+ * @param threads Number of event loop threads
+ * @param config Configuration of the threads, NULL for the defaults
+ *
+ * @return Created group, NULL on error (e.g. missing permission for real time scheduling), an invalid configuration or
+ * if client groups are not supported on this platform
+ */
+msbClientGroup* msbClientGroupNewConfigured(uint32_t threads, const msbThreadConfig* config);
+
+/**
+ * @brief Delete a client group, stopping the state machines of all remaining clients
+ *
+ * @param group Pointer to client group
+ */
+void msbClientGroupDelete(msbClientGroup* group);
+
+/**
+ * @brief Set the interval for housekeeping of idle clients in the group (default 100 ms)
+ *
+ * @param group Pointer to client group
+ * @param interval Interval in µs
+ */
+void msbClientGroupSetTickInterval(msbClientGroup* group, uint32_t interval);
+
+/**
+ * @brief Start the state machine of a client on the thread of the group with the fewest clients
+ *
+ * Use instead of msbClientRunClientStateMachine.
+ *
+ * @param group Pointer to client group
+ * @param client Pointer to Msb client
+ *
+ * @return true if the client has been added
+ */
+bool msbClientGroupAdd(msbClientGroup* group, msbClient* client);
+
+/**
+ * @brief Stop the state machine of a client and remove it from its group
+ *
+ * The client must not be used for publishing while it is removed. Waits for a cycle of the client's state machine that
+ * is running on the group thread. Callbacks of the group's clients may remove clients too, a client removed by a
+ * callback of its own state machine is stopped once the cycle has ended.
+ *
+ * @param group Pointer to client group
+ * @param client Pointer to Msb client
+ *
+ * @return true if the client has been removed
+ */
+bool msbClientGroupRemove(msbClientGroup* group, msbClient* client);
+
 /**
  * @brief Add a configuration parameter to the self description
  *
@@ -852,9 +1496,42 @@ msbClientAddComplexEvent(msbClient* client, char* eId, char* eName, char* eDesc,
  */
 void msbClientRemoveEvent(msbClient* client, char* eId);
 
+/**
+ * @brief Set the policy for publishing an event while the outgoing queue is full
+ *
+ * With MSB_OVERFLOW_COALESCE only the latest value of the event is kept: a new message replaces a still queued
+ * message of the same event in place, without searching the queue.
+ *
+ * @param client Pointer to Msb client
+ * @param eId Event id
+ * @param policy Overflow policy (MSB_OVERFLOW_DROP_NEWEST is default)
+ */
+void msbClientSetEventOverflowPolicy(msbClient* client, char* eId, OverflowPolicy policy);
+
+/**
+ * @brief Filter the values msbClientPublish publishes for an event (report by exception)
+ *
+ * Values are compared with the last published one before anything is serialised, suppressed ones are only counted in
+ * events_filtered. Deadbands apply to single integers and numbers, the filtered value moves with every published one;
+ * other events, including arrays, are published on change. With a heartbeat, a value is published anyway once the
+ * interval has passed since the last one. Values published while the client can't queue messages, or refused by a
+ * full queue, don't count. Publishing threads take their decisions one after the other, so values of the same event
+ * may be published from several threads.
+ *
+ * @param client Pointer to Msb client
+ * @param eId Event id
+ * @param filter Filter (MSB_FILTER_NONE is default)
+ * @param deadband Deadband, absolute or in percent of the last published value
+ * @param heartbeat_in_s Interval in seconds after which an unchanged value is published, 0 for never
+ */
+void msbClientSetEventFilter(msbClient* client, char* eId, EventFilter filter, double deadband, uint32_t heartbeat_in_s);
+
 /**
  * @brief Publish an event
  *
+ * data is read as int32_t or int64_t for integers, as double for numbers of format MSB_FLOAT and MSB_DOUBLE,
+ * as int32_t for MSB_BYTE, as json_bool for booleans and as char* for strings.
+ *
  * @param client Pointer to Msb client
  * @param eId Id of the event that shall be used
  * @param priority Message priority
@@ -886,6 +1563,162 @@ void msbClientPublishEmpty(msbClient* client, char* eId, MessagePriority priorit
  */
 void msbClientPublishFromString(msbClient* client, char* eId, MessagePriority priority, char* pData, char* corrId);
 
+/**
+ * @brief Publish an event whose data object is given as json text
+ *
+ * Unlike msbClientPublishFromString the text is neither parsed nor needs to be null terminated, it is copied once into
+ * the message as it is. The caller has to make sure it is valid json.
+ *
+ * @param client Pointer to Msb client
+ * @param eId Id of the event that shall be used
+ * @param priority Message priority
+ * @param json Data to be sent as json text
+ * @param length Length of the json text in bytes
+ * @param corrId Correlation Id as a string. May be left empty, then the client will generate its own. Use for response events.
+ */
+void msbClientPublishJSON(msbClient* client, char* eId, MessagePriority priority, const char* json, size_t length, char* corrId);
+
+/**
+ * @brief Publish an event whose data object is given as json text and get notified when it has been sent
+ *
+ * Works like msbClientPublishJSON. If the message has been queued, the callback of the completion is called exactly
+ * once: on the thread driving the client's state machine after the message has been written to the socket (or has
+ * been acknowledged, see msbClientSetPublishWindow), when the state machine ends or a full queue refuses a message
+ * merged from a publish stage, or on the publishing thread if the message is dropped to make room for another one. Messages with
+ * a completion aren't coalesced into queued ones, but may be replaced by later messages of the same event, the
+ * completion then reports the replacing message.
+ *
+ * @param client Pointer to Msb client
+ * @param eId Id of the event that shall be used
+ * @param priority Message priority
+ * @param json Data to be sent as json text
+ * @param length Length of the json text in bytes
+ * @param corrId Correlation Id as a string. May be left empty, then the client will generate its own. Use for response events.
+ * @param completion Completion to be called, has to stay valid until then
+ *
+ * @return 0 if the message has been queued, -1 otherwise. If a full outgoing queue (or publish stage, see
+ * msbClientSetPublishStaging) refused the message, the callback has been called with MSB_PUBLISH_DROPPED before -1 is
+ * returned, for an unknown event or an oversized message it isn't called.
+ */
+int msbClientPublishJSONWithCompletion(msbClient* client, char* eId, MessagePriority priority, const char* json,
+									   size_t length, char* corrId, msbPublishCompletion* completion);
+
+/**
+ * @brief Publish an event whose data object is read in pieces while it is sent, e.g. a camera image or a trace
+ *
+ * Only the envelope of the event is queued. Once it's its turn, the message is sent as fragmented websocket message:
+ * the state machine calls read for a fragment of at most 64 KiB per cycle until read returns 0, so neither the data
+ * object nor the message is held in memory and maxMessageSize doesn't apply. Other messages wait until the last
+ * fragment has been sent. The completion reports the event like msbClientPublishJSONWithCompletion, read isn't called
+ * anymore once the event has been dropped. Streamed events are sent as text frames without compression, whatever the
+ * codec, and aren't available with static memory.
+ *
+ * @param client Pointer to Msb client
+ * @param eId Id of the event that shall be used
+ * @param priority Message priority
+ * @param stream Stream of the data object, called on the thread driving the client's state machine, has to stay valid
+ * until its completion has been called
+ * @param corrId Correlation Id as a string. May be left empty, then the client will generate its own. Use for response events.
+ *
+ * @return 0 if the event has been queued, -1 otherwise (then read isn't called, the callback only if a full queue
+ * refused the envelope, like in msbClientPublishJSONWithCompletion)
+ */
+int msbClientPublishStream(msbClient* client, char* eId, MessagePriority priority, msbPublishStream* stream, char* corrId);
+
+/**
+ * @brief Stop reading from the connection while the queue of incoming messages is full
+ *
+ * Without backpressure, messages arriving while the queue is full (see maxNumberDataIncoming) are read and discarded,
+ * counted in incoming_dropped. With backpressure the state machine stops reading instead and resumes once the queue
+ * has been worked off down to the low watermark; meanwhile the socket buffers fill up and TCP flow control slows the
+ * broker down. Websocket pings aren't answered while reading is paused.
+ *
+ * @param client Pointer to Msb client
+ * @param enable Flag for backpressure
+ * @param low_watermark Number of queued messages at which reading resumes, below maxNumberDataIncoming
+ *
+ * @return false if the low watermark isn't below maxNumberDataIncoming
+ */
+bool msbClientSetIncomingBackpressure(msbClient* client, bool enable, uint32_t low_watermark);
+
+/**
+ * @brief Set how many incoming messages one cycle of the state machine reads and processes
+ *
+ * A cycle works off the queued messages and reads further ones from the connection until it runs out of messages,
+ * has processed the given number of them or has used up the given time; only then it waits for the next cycle. The
+ * default is 64 messages and 2 ms. A budget of one message gives the former behaviour of one message per cycle.
+ *
+ * @param client Pointer to Msb client
+ * @param messages Maximum number of messages per cycle, at least 1
+ * @param time_us Time after which a cycle stops processing messages in µs, 0 for no limit
+ *
+ * @return false if the message budget is 0
+ */
+bool msbClientSetReceiveBudget(msbClient* client, uint32_t messages, uint32_t time_us);
+
+/**
+ * @brief Get the statistics of the incoming messages processed per cycle of the state machine
+ *
+ * @param client Pointer to Msb client
+ * @param statistics Pointer to the statistics to be filled
+ */
+void msbClientGetReceiveStatistics(msbClient* client, msbReceiveStatistics* statistics);
+
+/**
+ * @brief Select how the state machine thread of an Msb client waits for incoming messages
+ *
+ * With MSB_RECEIVE_CALLBACK the thread started by msbClientRunClientStateMachine waits on the connection instead of
+ * sleeping pause_automat between its cycles. The websocket layer hands every message to the incoming queue as soon as
+ * it has been received (with libnopoll read by the thread once poll reports the socket readable) and the thread processes it
+ * right away. A function call is then answered without waiting for the rest of the pause, so pause_automat may be
+ * raised to save wakeups of an idle client; it still bounds the time until queued events are sent. The mode has no
+ * effect on clients of a client group, which are woken by their connections anyway.
+ *
+ * @param client Pointer to Msb client
+ * @param mode Receive mode (MSB_RECEIVE_POLLING is default)
+ *
+ * @return true if the mode has been set
+ */
+bool msbClientSetReceiveMode(msbClient* client, MsbReceiveMode mode);
+
+/**
+ * @brief Track the acknowledgements of published events and limit the number of unacknowledged ones
+ *
+ * The broker answers every event message in order with IO_PUBLISHED or an NIO_*_EVENT_FORWARDING_ERROR. With a window,
+ * at most that many event messages are sent without answer, further ones stay in the outgoing queue. Completions then
+ * report the answer (MSB_PUBLISH_ACKNOWLEDGED or MSB_PUBLISH_REJECTED) instead of MSB_PUBLISH_SENT, and
+ * MSB_PUBLISH_DROPPED if the connection is lost or the timeout (see msbClientSetPublishTimeout) passes before. Has to be
+ * set before the state machine is started, it is refused while the client's thread runs or the client is part of a
+ * client group.
+ *
+ * @param client Pointer to Msb client
+ * @param window Maximum number of unacknowledged event messages, 0 to stop tracking (default)
+ *
+ * @return true if the window has been set
+ */
+bool msbClientSetPublishWindow(msbClient* client, uint32_t window);
+
+/**
+ * @brief Set the time the broker gets for acknowledging an event message sent with a publish window
+ *
+ * A lost answer would otherwise hold back every further event message until the connection is lost. Once the oldest
+ * event message in flight has waited longer, all event messages in flight count as lost and their completions report
+ * MSB_PUBLISH_DROPPED. As answers aren't correlated by id, an answer arriving after its timeout is taken for the one
+ * of the next event message sent.
+ *
+ * @param client Pointer to Msb client
+ * @param timeout_in_ms Timeout in ms, 0 to wait until the connection is lost (default 10000)
+ */
+void msbClientSetPublishTimeout(msbClient* client, uint32_t timeout_in_ms);
+
+/**
+ * @brief Get the acknowledgement statistics of published events, which are only gathered with a publish window
+ *
+ * @param client Pointer to Msb client
+ * @param statistics Pointer to the statistics to be filled
+ */
+void msbClientGetPublishStatistics(msbClient* client, msbPublishStatistics* statistics);
+
 /**
  * @brief Publish a complex event with data put in over a json object
  *
@@ -900,8 +1733,12 @@ void msbClientPublishComplex(msbClient* client, char* eId, MessagePriority prior
 /**
  * @brief Set Heartbeat interval
  *
+ * While the client is registered, the state machine sends a websocket ping whenever the interval has passed since the
+ * last one, so idle connections are kept open by proxies and broken ones are noticed. Pings are checked once per cycle
+ * and aren't sent before the client has registered.
+ *
  * @param client Pointer to Msb client
- * @param interval_in_ms Heartbeat interval in milliseconds
+ * @param interval_in_ms Heartbeat interval in milliseconds, 0 for no pings (default)
  */
 void msbClientSetHeartbeatInterval(msbClient* client, uint16_t interval_in_ms);
 
@@ -927,6 +1764,41 @@ void msbClientEnableHostnameVerification(msbClient* client);
  */
 void msbClientDisableHostnameVerification(msbClient* client);
 
+/**
+ * @brief Enable TLS session resumption on reconnects (default, native transport only)
+ *
+ * @param client Pointer to Msb client
+ */
+void msbClientEnableTLSSessionResumption(msbClient* client);
+
+/**
+ * @brief Disable TLS session resumption, every reconnect performs a full handshake
+ *
+ * @param client Pointer to Msb client
+ */
+void msbClientDisableTLSSessionResumption(msbClient* client);
+
+/**
+ * @brief Get the number of TLS handshakes of the client
+ *
+ * @param client Pointer to Msb client
+ * @param handshakes Pointer to the number of handshakes
+ * @param resumed Pointer to the number of handshakes which resumed a former session
+ */
+void msbClientGetTLSHandshakes(msbClient* client, uint32_t* handshakes, uint32_t* resumed);
+
+/**
+ * @brief Get the statistics of the client's message buffer pool
+ *
+ * The hit rate of the pool is hits / (hits + misses + oversized).
+ *
+ * @param client Pointer to Msb client
+ * @param hits Pointer to the number of buffers reused out of the pool
+ * @param misses Pointer to the number of buffers which had to be taken from the heap
+ * @param oversized Pointer to the number of messages larger than the largest size class (64 KiB), taken from the heap
+ */
+void msbClientGetBufferPoolStatistics(msbClient* client, uint64_t* hits, uint64_t* misses, uint64_t* oversized);
+
 /**
  * @brief Test if connection is ready
  *
@@ -973,6 +1845,8 @@ void msbClientDisableEventCache(msbClient* client);
 /**
  * @brief Set event cache size
  *
+ * With static memory (see msbClientUseStaticMemory) the size can't be raised anymore.
+ *
  * @param client Pointer to Msb client
  * @param size Size of event cache
  */
@@ -981,11 +1855,27 @@ void msbClientSetEventCacheSize(msbClient* client, uint32_t size);
 /**
  * @brief Set function cache size
  *
+ * With static memory (see msbClientUseStaticMemory) the size can't be raised anymore.
+ *
  * @param client Pointer to Msb client
  * @param size Size of function cache
  */
 void msbClientSetFunctionCacheSize(msbClient* client, uint32_t size);
 
+/**
+ * @brief Configure permessage-deflate (RFC 7692) compression of the websocket connection
+ *
+ * The extension is offered on the next connect and only used if the server accepts it.
+ *
+ * @param client Pointer to Msb client
+ * @param on_off compression flag
+ * @param window_bits LZ77 window size of the client (9 - 15)
+ * @param context_takeover true to keep the compression context between messages
+ * @param threshold messages shorter than threshold bytes are sent uncompressed
+ */
+void msbClientSetCompression(msbClient* client, bool on_off, uint8_t window_bits, bool context_takeover,
+                             uint32_t threshold);
+
 /**
  * @brief Set a common callback function for all function calls
  *
@@ -0,0 +1,94 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file MsbClientC_internal.h
+* @brief header file for the internal functions of the Msb client used by its tests and benchmarks, not installed
+*/
+
+#ifndef SRC_MSBCLIENTC_INTERNAL_H_
+#define SRC_MSBCLIENTC_INTERNAL_H_
+
+#include "MsbClientC.h"
+
+/**
+ * @brief Internal function for destroying an Msb object, releasing its arena in one go
+ *
+ * @param object pointer to Msb object
+ */
+void msbObjectDestroyObject(msbObject* object);
+
+/**
+ * @brief Internal function for preparing the state machine of a client
+ *
+ * @param client Pointer to Msb client
+ */
+void msbClientAutomatBegin(msbClient* client);
+
+/**
+ * @brief Internal function for running one cycle of the state machine
+ *
+ * @param client Pointer to Msb client
+ * @param delay_us Set to the time the state machine has to wait before the next cycle (in µs)
+ *
+ * @return true if messages are waiting to be processed in the next cycle
+ */
+bool msbClientAutomatStep(msbClient* client, uint32_t* delay_us);
+
+/**
+ * @brief Internal function for shutting down the state machine of a client
+ *
+ * @param client Pointer to Msb client
+ */
+void msbClientAutomatEnd(msbClient* client);
+
+/**
+ * @brief Internal function for serialising an event message into a buffer of the client's buffer pool
+ *
+ * @param client Pointer to Msb client
+ * @param root Json object of the event message
+ * @param length Pointer to put the message length into
+ *
+ * @return Pointer to the message, null on allocation failure
+ */
+char* msbClientEventMessage(msbClient* client, json_object* root, size_t* length);
+
+/**
+ * @brief Internal function for putting an event message into the outgoing queue, according to the event's overflow policy
+ *
+ * @param client Pointer to Msb client
+ * @param ev Pointer to the event
+ * @param msg Pointer to message taken from the client's buffer pool, the queue takes it over in any case
+ * @param length Message length
+ * @param completion Completion of the message, may be NULL
+ * @param kind MSB_OUTGOING_STREAM for the envelope of a streamed event, whose completion is its msbPublishStream,
+ * MSB_OUTGOING_MESSAGE otherwise
+ *
+ * @return 0 if the message has been queued, != 0 if it has been dropped
+ */
+int msbClientQueueEvent(msbClient* client, msbObjectEvent* ev, char* msg, size_t length, msbPublishCompletion* completion,
+                        int kind);
+
+/**
+ * @brief Internal function for merging the messages staged by the publishing threads into the outgoing queue
+ *
+ * @param client Pointer to Msb client
+ *
+ * @return Number of merged messages, including dropped ones
+ */
+uint32_t msbClientMergeStaged(msbClient* client);
+
+#endif /* SRC_MSBCLIENTC_INTERNAL_H_ */
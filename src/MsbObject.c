@@ -29,6 +29,7 @@
 #include "rest/helpers.h"
 
 #include "MsbClientC.h"
+#include "MsbClientC_internal.h"
 
 /**
  * @brief Internal function for getting primitive type as string, all lower case
@@ -66,6 +67,170 @@ const char* getDataObjectTypeUC(PrimitiveType pt);
  */
 const char* getDataObjectFormatUC(PrimitiveFormat pf);
 
+#define MSB_OBJECT_ARENA_CHUNK_SIZE 16384
+#define MSB_OBJECT_ARENA_ALIGNMENT 16
+#define MSB_OBJECT_ARENA_HEADER_SIZE \
+    ((sizeof(msbObjectArenaChunk) + MSB_OBJECT_ARENA_ALIGNMENT - 1) & ~(size_t) (MSB_OBJECT_ARENA_ALIGNMENT - 1))
+
+static msbObjectArenaChunk* msbObjectArenaNewChunk(msbObjectArena* arena, size_t size) {
+
+    if (arena->region != NULL) return NULL;
+
+    msbObjectArenaChunk* chunk = (msbObjectArenaChunk*) calloc(1, MSB_OBJECT_ARENA_HEADER_SIZE + size);
+
+    if (chunk == NULL) return NULL;
+
+    chunk->size = size;
+
+    arena->allocated += MSB_OBJECT_ARENA_HEADER_SIZE + size;
+    arena->number_chunks++;
+
+    return chunk;
+}
+
+static void* msbObjectArenaTake(msbObjectArena* arena, size_t size, size_t alignment) {
+
+    msbObjectArenaChunk* chunk = arena->chunks;
+    size_t offset = 0;
+
+    if (chunk != NULL) offset = (chunk->used + alignment - 1) & ~(alignment - 1);
+
+    if (chunk == NULL || offset + size > chunk->size) {
+        if (arena->chunk_size == 0) arena->chunk_size = MSB_OBJECT_ARENA_CHUNK_SIZE;
+
+        if (size > arena->chunk_size / 4 && chunk != NULL) {
+            /* large blocks get a chunk of their own behind the current one, which keeps being filled */
+            msbObjectArenaChunk* large = msbObjectArenaNewChunk(arena, size);
+
+            if (large == NULL) return NULL;
+
+            large->used = size;
+            large->next = chunk->next;
+            chunk->next = large;
+            arena->used += size;
+
+            return (char*) large + MSB_OBJECT_ARENA_HEADER_SIZE;
+        }
+
+        chunk = msbObjectArenaNewChunk(arena, size > arena->chunk_size ? size : arena->chunk_size);
+
+        if (chunk == NULL) return NULL;
+
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        offset = 0;
+    }
+
+    arena->used += offset + size - chunk->used;
+    chunk->used = offset + size;
+
+    return (char*) chunk + MSB_OBJECT_ARENA_HEADER_SIZE + offset;
+}
+
+void* msbObjectArenaAlloc(msbObjectArena* arena, size_t size) {
+
+    if (arena == NULL || size == 0) return NULL;
+
+    return msbObjectArenaTake(arena, size, MSB_OBJECT_ARENA_ALIGNMENT);
+}
+
+char* msbObjectArenaStrdup(msbObjectArena* arena, const char* str) {
+
+    if (arena == NULL || str == NULL) return NULL;
+
+    size_t l = strlen(str) + 1;
+    char* ret = (char*) msbObjectArenaTake(arena, l, 1);
+
+    if (ret != NULL) memcpy(ret, str, l);
+
+    return ret;
+}
+
+char* msbObjectArenaStrreplace(msbObjectArena* arena, char* former, size_t* size, const char* str) {
+
+    if (arena == NULL || size == NULL || str == NULL) return former;
+
+    size_t l = strlen(str) + 1;
+
+    /* the arena can't give memory back, reusing the former string keeps repeated changes from growing it */
+    if (former != NULL && l <= *size) {
+        memmove(former, str, l);
+        return former;
+    }
+
+    char* ret = msbObjectArenaStrdup(arena, str);
+
+    if (ret == NULL) return former;
+
+    *size = l;
+
+    return ret;
+}
+
+void msbObjectArenaRelease(msbObjectArena* arena) {
+
+    if (arena == NULL) return;
+
+    msbObjectArenaChunk* chunk = arena->chunks;
+
+    while (chunk != NULL) {
+        msbObjectArenaChunk* t = chunk->next;
+        if ((void*) chunk != arena->region) free(chunk);
+        chunk = t;
+    }
+
+    arena->region = NULL;
+    arena->chunks = NULL;
+    arena->used = 0;
+    arena->allocated = 0;
+    arena->number_chunks = 0;
+}
+
+bool msbObjectArenaUseRegion(msbObjectArena* arena, void* region, size_t size) {
+
+    if (arena == NULL || region == NULL || size <= MSB_OBJECT_ARENA_HEADER_SIZE) return false;
+
+    /* chunks taken so far stay where they are, everything new comes out of the region */
+    memset(region, 0, size);
+
+    msbObjectArenaChunk* chunk = (msbObjectArenaChunk*) region;
+    chunk->size = size - MSB_OBJECT_ARENA_HEADER_SIZE;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+
+    arena->chunks = chunk;
+    arena->region = region;
+    arena->allocated += size;
+    arena->number_chunks++;
+
+    return true;
+}
+
+/* node and descriptor share one arena block, so a lookup touches the name and the value it hands out together */
+static void msbObjectArenaLink(msbObject* object, schll_list* list, char* name, const void* value, size_t value_size) {
+
+    schll_entry* entry = (schll_entry*) msbObjectArenaAlloc(&object->arena, sizeof(schll_entry) + value_size);
+
+    if (entry == NULL) return;
+
+    entry->name = name;
+    entry->value = entry + 1;
+    memcpy(entry->value, value, value_size);
+
+    schll_linkEntry(list, entry);
+}
+
+static void msbObjectFunctionRelease(msbObjectFunction* f) {
+
+    json_object_put(f->dataFormat);
+    f->dataFormat = NULL;
+
+    if (f->responseEventAtIds != NULL && list_deleteList(f->responseEventAtIds, 0) == EINFL_NO_ENTRIES)
+        free(f->responseEventAtIds);
+
+    f->responseEventAtIds = NULL;
+}
+
 void changeConfigParamValueInternal(msbObjectConfigParam* c, void* value){
 
     switch (c->type) {
@@ -97,8 +262,11 @@ void changeConfigParamValueInternal(msbObjectConfigParam* c, void* value){
 void addConfigParam(msbObject* object, char* cpName, PrimitiveType cpType, PrimitiveFormat cpFormat, void* value) {
     msbObjectConfigParam c;
 
-    c.name = (char*) calloc(1, strlen(cpName) + 1);
-    strcpy(c.name, cpName);
+    if (object == NULL || cpName == NULL) return;
+
+    if (schll_getValuePointer(object->configParamArray, cpName) != NULL) return;
+
+    c.name = msbObjectArenaStrdup(&object->arena, cpName);
 
     if (c.name == NULL) return;
 
@@ -107,7 +275,7 @@ void addConfigParam(msbObject* object, char* cpName, PrimitiveType cpType, Primi
 
     changeConfigParamValueInternal(&c, value);
 
-    schll_addEntry(object->configParamArray, cpName, 0, &c, 1, sizeof(msbObjectConfigParam));
+    msbObjectArenaLink(object, object->configParamArray, c.name, &c, sizeof(msbObjectConfigParam));
 }
 
 void removeConfigParam(msbObject* object, char* cpName) {
@@ -116,7 +284,7 @@ void removeConfigParam(msbObject* object, char* cpName) {
 
     if (object->configParamArray == NULL) return;
 
-    schll_removeEntry(object->configParamArray, cpName, 1, 0);
+    schll_unlinkEntry(object->configParamArray, cpName, NULL);
 }
 
 void changeConfigParamValue(msbObject* object, char* cpName, void* value) {
@@ -134,15 +302,13 @@ addFunction(msbObject* object, char* fId, char* fName, char* fDesc, void (*fPtr)
 
     msbObjectFunction f;
 
-    f.functionId = (char*) calloc(1, strlen(fId) + 1);
-    f.name = (char*) calloc(1, strlen(fName) + 1);
-    f.description = (char*) calloc(1, strlen(fDesc) + 1);
+    if (schll_getValuePointer(object->functionArray, fId) != NULL) return;
 
-    if (f.functionId == NULL || f.name == NULL || f.description == NULL) return;
+    f.functionId = msbObjectArenaStrdup(&object->arena, fId);
+    f.name = msbObjectArenaStrdup(&object->arena, fName);
+    f.description = msbObjectArenaStrdup(&object->arena, fDesc);
 
-    strcpy(f.functionId, fId);
-    strcpy(f.name, fName);
-    strcpy(f.description, fDesc);
+    if (f.functionId == NULL || f.name == NULL || f.description == NULL) return;
 
     f.callback = fPtr;
     f.contextPtr = contextPtr;
@@ -175,7 +341,7 @@ addFunction(msbObject* object, char* fId, char* fName, char* fDesc, void (*fPtr)
     f.atId = object->function_atId_counter++;
     f.responseEventAtIds = NULL;
 
-    schll_addEntry(object->functionArray, f.functionId, 0, &f, 1, sizeof(msbObjectFunction));
+    msbObjectArenaLink(object, object->functionArray, f.functionId, &f, sizeof(msbObjectFunction));
 }
 
 void addComplexFunction(msbObject* object, char* fId, char* fName, char* fDesc, void (*fPtr)(void*, void*, void*),
@@ -183,15 +349,13 @@ void addComplexFunction(msbObject* object, char* fId, char* fName, char* fDesc,
 
     msbObjectFunction f;
 
-    f.functionId = (char*) calloc(1, strlen(fId) + 1);
-    f.name = (char*) calloc(1, strlen(fName) + 1);
-    f.description = (char*) calloc(1, strlen(fDesc) + 1);
+    if (schll_getValuePointer(object->functionArray, fId) != NULL) return;
 
-    if (f.functionId == NULL || f.name == NULL || f.description == NULL) return;
+    f.functionId = msbObjectArenaStrdup(&object->arena, fId);
+    f.name = msbObjectArenaStrdup(&object->arena, fName);
+    f.description = msbObjectArenaStrdup(&object->arena, fDesc);
 
-    strcpy(f.functionId, fId);
-    strcpy(f.name, fName);
-    strcpy(f.description, fDesc);
+    if (f.functionId == NULL || f.name == NULL || f.description == NULL) return;
 
     f.dataFormat = json_object_get(fFormat);
     f.atId = object->function_atId_counter++;
@@ -201,7 +365,7 @@ void addComplexFunction(msbObject* object, char* fId, char* fName, char* fDesc,
 
     f.responseEventAtIds = NULL;
 
-    schll_addEntry(object->functionArray, f.functionId, 0, &f, 1, sizeof(msbObjectFunction));
+    msbObjectArenaLink(object, object->functionArray, f.functionId, &f, sizeof(msbObjectFunction));
 }
 
 void addEmptyFunction(msbObject* object, char* fId, char* fName, char* fDesc, void (* fPtr)(void*, void*, void*),
@@ -211,13 +375,19 @@ void addEmptyFunction(msbObject* object, char* fId, char* fName, char* fDesc, vo
     dFormatRoot = json_object_new_object();
 
     addComplexFunction(object, fId, fName, fDesc, fPtr, dFormatRoot, contextPtr);
+
+    json_object_put(dFormatRoot);
 }
 
 void removeFunction(msbObject* object, char* fId) {
 
     if (object == NULL || fId == NULL) return;
 
-    schll_removeEntry(object->functionArray, fId, 0, 1);
+    schll_entry* entry;
+
+    if (schll_unlinkEntry(object->functionArray, fId, &entry) != SCHLL_OK) return;
+
+    msbObjectFunctionRelease((msbObjectFunction*) entry->value);
 }
 
 void addResponseEventToFunction(msbObject* object, char* fId, char* eId) {
@@ -264,15 +434,13 @@ void addEvent(msbObject* object, char* eId, char* eName, char* eDesc, PrimitiveT
               PrimitiveFormat eFormat, bool isArray) {
     msbObjectEvent e;
 
-    e.eventId = (char*) calloc(1, strlen(eId) + 1);
-    e.name = (char*) calloc(1, strlen(eName) + 1);
-    e.description = (char*) calloc(1, strlen(eDesc) + 1);
+    if (schll_getValuePointer(object->eventArray, eId) != NULL) return;
 
-    if (e.eventId == NULL || e.name == NULL || e.description == NULL) return;
+    e.eventId = msbObjectArenaStrdup(&object->arena, eId);
+    e.name = msbObjectArenaStrdup(&object->arena, eName);
+    e.description = msbObjectArenaStrdup(&object->arena, eDesc);
 
-    strcpy(e.eventId, eId);
-    strcpy(e.name, eName);
-    strcpy(e.description, eDesc);
+    if (e.eventId == NULL || e.name == NULL || e.description == NULL) return;
 
     json_object* dFormatRoot;
     dFormatRoot = json_object_new_object();
@@ -314,21 +482,29 @@ void addEvent(msbObject* object, char* eId, char* eName, char* eDesc, PrimitiveT
 
     e.atId = object->event_atId_counter++;
 
-    schll_addEntry(object->eventArray, e.eventId, 0, &e, 1, sizeof(msbObjectEvent));
+    e.overflowPolicy = MSB_OVERFLOW_DROP_NEWEST;
+    e.queuedEntry = NULL;
+
+    e.filter = MSB_FILTER_NONE;
+    e.deadband = 0;
+    e.filter_heartbeat = 0;
+    e.filter_published = 0;
+    e.filter_number = 0;
+    e.filter_hash = 0;
+
+    msbObjectArenaLink(object, object->eventArray, e.eventId, &e, sizeof(msbObjectEvent));
 }
 
 void addComplexEvent(msbObject* object, char* eId, char* eName, char* eDesc, json_object* eFormat, bool isArray) {
     msbObjectEvent e;
 
-    e.eventId = (char*) calloc(1, strlen(eId) + 1);
-    e.name = (char*) calloc(1, strlen(eName) + 1);
-    e.description = (char*) calloc(1, strlen(eDesc) + 1);
+    if (schll_getValuePointer(object->eventArray, eId) != NULL) return;
 
-    if (e.eventId == NULL || e.name == NULL || e.description == NULL) return;
+    e.eventId = msbObjectArenaStrdup(&object->arena, eId);
+    e.name = msbObjectArenaStrdup(&object->arena, eName);
+    e.description = msbObjectArenaStrdup(&object->arena, eDesc);
 
-    strcpy(e.eventId, eId);
-    strcpy(e.name, eName);
-    strcpy(e.description, eDesc);
+    if (e.eventId == NULL || e.name == NULL || e.description == NULL) return;
 
     e.dataFormat = json_object_get(eFormat);
 
@@ -338,7 +514,17 @@ void addComplexEvent(msbObject* object, char* eId, char* eName, char* eDesc, jso
     e.array_subformat = MSB_NONE;
     e.atId = object->event_atId_counter++;
 
-    schll_addEntry(object->eventArray, e.eventId, 0, &e, 1, sizeof(msbObjectEvent));
+    e.overflowPolicy = MSB_OVERFLOW_DROP_NEWEST;
+    e.queuedEntry = NULL;
+
+    e.filter = MSB_FILTER_NONE;
+    e.deadband = 0;
+    e.filter_heartbeat = 0;
+    e.filter_published = 0;
+    e.filter_number = 0;
+    e.filter_hash = 0;
+
+    msbObjectArenaLink(object, object->eventArray, e.eventId, &e, sizeof(msbObjectEvent));
 }
 
 void addEmptyEvent(msbObject* object, char* eId, char* eName, char* eDesc) {
@@ -346,6 +532,8 @@ void addEmptyEvent(msbObject* object, char* eId, char* eName, char* eDesc) {
     dFormatRoot = json_object_new_object();
 
     addComplexEvent(object, eId, eName, eDesc, dFormatRoot, false);
+
+    json_object_put(dFormatRoot);
 }
 
 void removeEvent(msbObject* object, char* eId) {
@@ -391,7 +579,10 @@ void removeEvent(msbObject* object, char* eId) {
         }
     }
 
-    schll_removeEntry(object->eventArray, eId, 0, 1);
+    if (schll_unlinkEntry(object->eventArray, eId, NULL) != SCHLL_OK) return;
+
+    json_object_put(e->dataFormat);
+    e->dataFormat = NULL;
 }
 
 const char* msbObjectSelfDescription(const msbObject* object) {
@@ -434,7 +625,7 @@ const char* msbObjectSelfDescription(const msbObject* object) {
         if (f->description != NULL) {
             json_object_object_add(froot, "description", json_object_new_string(f->description));
         }
-        json_object_object_add(froot, "dataFormat", f->dataFormat);
+        json_object_object_add(froot, "dataFormat", json_object_get(f->dataFormat));
 
         json_object* respArray = json_object_new_array();
 
@@ -469,7 +660,7 @@ const char* msbObjectSelfDescription(const msbObject* object) {
         if (e->description != NULL) {
             json_object_object_add(eroot, "description", json_object_new_string(e->description));
         }
-        json_object_object_add(eroot, "dataFormat", e->dataFormat);
+        json_object_object_add(eroot, "dataFormat", json_object_get(e->dataFormat));
 
         entry = entry->next_entry;
     }
@@ -526,20 +717,47 @@ msbObject* msbObjectCreateObject(char* uuid, char* token, char* service_class, c
     msbObject* ret = (msbObject*) calloc(1, 1 * sizeof(msbObject));
 
     if (ret != NULL) {
-        ret->objectInfo.service_uuid = string_duplicate(uuid);
-        ret->objectInfo.service_token = string_duplicate(token);
-        ret->objectInfo.service_class = string_duplicate(service_class);
-        ret->objectInfo.service_name = string_duplicate(name);
-        ret->objectInfo.service_description = string_duplicate(description);
-
-        ret->eventArray = schll_MakeListPointer();
-        ret->functionArray = schll_MakeListPointer();
-        ret->configParamArray = schll_MakeListPointer();
+        ret->arena.chunk_size = MSB_OBJECT_ARENA_CHUNK_SIZE;
+
+        ret->eventArray = (schll_list*) msbObjectArenaAlloc(&ret->arena, sizeof(schll_list));
+        ret->functionArray = (schll_list*) msbObjectArenaAlloc(&ret->arena, sizeof(schll_list));
+        ret->configParamArray = (schll_list*) msbObjectArenaAlloc(&ret->arena, sizeof(schll_list));
+
+        if (ret->eventArray == NULL || ret->functionArray == NULL || ret->configParamArray == NULL) {
+            msbObjectArenaRelease(&ret->arena);
+            free(ret);
+            return NULL;
+        }
+
+        msbObjectInfo* i = &ret->objectInfo;
+
+        i->service_uuid = msbObjectArenaStrreplace(&ret->arena, NULL, &i->service_uuid_size, uuid);
+        i->service_token = msbObjectArenaStrreplace(&ret->arena, NULL, &i->service_token_size, token);
+        i->service_class = msbObjectArenaStrreplace(&ret->arena, NULL, &i->service_class_size, service_class);
+        i->service_name = msbObjectArenaStrreplace(&ret->arena, NULL, &i->service_name_size, name);
+        i->service_description = msbObjectArenaStrreplace(&ret->arena, NULL, &i->service_description_size, description);
     }
 
     return ret;
 }
 
+void msbObjectDestroyObject(msbObject* object) {
+
+    if (object == NULL) return;
+
+    schll_entry* entry;
+
+    for (entry = object->functionArray->first_entry; entry != NULL; entry = entry->next_entry)
+        msbObjectFunctionRelease((msbObjectFunction*) entry->value);
+
+    for (entry = object->eventArray->first_entry; entry != NULL; entry = entry->next_entry)
+        json_object_put(((msbObjectEvent*) entry->value)->dataFormat);
+
+    msbObjectArenaRelease(&object->arena);
+
+    free(object);
+}
+
 const char* getDataObjectType(PrimitiveType pt) {
     switch (pt) {
         case MSB_INTEGER:
@@ -0,0 +1,595 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file msgpack.c
+* @brief source file for the transcoding between json text and MessagePack
+*/
+
+#include "msgpack.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <math.h>
+
+#define MSGPACK_MAX_DEPTH 64
+
+typedef struct {
+    const char* p;
+    const char* end;
+    msbCodecBuffer* out;
+} msgpackReader;
+
+static int msgpackValue(msgpackReader* r, int depth);
+
+static int msgpackJSONValue(const unsigned char** p, const unsigned char* end, msbCodecBuffer* out, int depth);
+
+static int msgpackPut(msbCodecBuffer* out, const char* bytes, size_t length) {
+    if (!msbCodecBufferReserve(out, length)) return -1;
+
+    memcpy(out->data + out->used, bytes, length);
+    out->used += length;
+
+    return 0;
+}
+
+/* type byte followed by size bytes of value, big endian */
+static int msgpackPutBig(msbCodecBuffer* out, uint8_t type, uint64_t value, size_t size) {
+    if (!msbCodecBufferReserve(out, 1 + size)) return -1;
+
+    unsigned char* d = (unsigned char*) out->data + out->used;
+    size_t i;
+
+    d[0] = type;
+    for (i = 0; i < size; ++i)
+        d[1 + i] = (unsigned char) (value >> (8 * (size - 1 - i)));
+
+    out->used += 1 + size;
+
+    return 0;
+}
+
+/* the length of strings and containers is known once they are written, so a 5 byte placeholder is put at start and
+ * shrunk to the smallest header afterwards */
+static int msgpackPlaceholder(msbCodecBuffer* out, size_t* start) {
+    if (!msbCodecBufferReserve(out, 5)) return -1;
+
+    *start = out->used;
+    out->used += 5;
+
+    return 0;
+}
+
+static void msgpackFixHead(msbCodecBuffer* out, size_t start, uint64_t count, uint8_t fix, uint64_t fix_limit,
+                           uint8_t type8, uint8_t type16, uint8_t type32) {
+    unsigned char head[5];
+    size_t head_length, i;
+    uint64_t size;
+
+    if (count < fix_limit) {
+        head[0] = (unsigned char) (fix | count);
+        head_length = 1;
+        size = 0;
+    } else if (type8 != 0 && count < 0x100) {
+        head[0] = type8;
+        size = 1;
+    } else if (count < 0x10000) {
+        head[0] = type16;
+        size = 2;
+    } else {
+        head[0] = type32;
+        size = 4;
+    }
+
+    for (i = 0; i < size; ++i)
+        head[1 + i] = (unsigned char) (count >> (8 * (size - 1 - i)));
+    head_length = 1 + size;
+
+    memmove(out->data + start + head_length, out->data + start + 5, out->used - start - 5);
+    memcpy(out->data + start, head, head_length);
+    out->used -= 5 - head_length;
+}
+
+static void msgpackSkip(msgpackReader* r) {
+    while (r->p < r->end && (*r->p == ' ' || *r->p == '\t' || *r->p == '\n' || *r->p == '\r'))
+        ++r->p;
+}
+
+static int msgpackHex4(const char* p, const char* end) {
+    int value = 0, i;
+
+    if (end - p < 4) return -1;
+
+    for (i = 0; i < 4; ++i) {
+        char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return -1;
+    }
+
+    return value;
+}
+
+static int msgpackString(msgpackReader* r) {
+    size_t start;
+
+    if (msgpackPlaceholder(r->out, &start) != 0) return -1;
+
+    ++r->p;
+
+    for (;;) {
+        const char* run = r->p;
+
+        while (r->p < r->end && *r->p != '"' && *r->p != '\\' && (unsigned char) *r->p >= 0x20)
+            ++r->p;
+        if (r->p > run && msgpackPut(r->out, run, (size_t) (r->p - run)) != 0) return -1;
+
+        if (r->p == r->end || (unsigned char) *r->p < 0x20) return -1;
+        if (*r->p++ == '"') break;
+
+        if (r->p == r->end) return -1;
+
+        char c = *r->p++;
+        char utf8[4];
+        size_t utf8_length = 1;
+
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                utf8[0] = c;
+                break;
+            case 'b':
+                utf8[0] = '\b';
+                break;
+            case 'f':
+                utf8[0] = '\f';
+                break;
+            case 'n':
+                utf8[0] = '\n';
+                break;
+            case 'r':
+                utf8[0] = '\r';
+                break;
+            case 't':
+                utf8[0] = '\t';
+                break;
+            case 'u': {
+                long cp = msgpackHex4(r->p, r->end);
+                if (cp < 0) return -1;
+                r->p += 4;
+
+                if (cp >= 0xDC00 && cp <= 0xDFFF) return -1;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (r->end - r->p < 6 || r->p[0] != '\\' || r->p[1] != 'u') return -1;
+                    long low = msgpackHex4(r->p + 2, r->end);
+                    if (low < 0xDC00 || low > 0xDFFF) return -1;
+                    r->p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                if (cp < 0x80) {
+                    utf8[0] = (char) cp;
+                } else if (cp < 0x800) {
+                    utf8[0] = (char) (0xC0 | (cp >> 6));
+                    utf8[1] = (char) (0x80 | (cp & 0x3F));
+                    utf8_length = 2;
+                } else if (cp < 0x10000) {
+                    utf8[0] = (char) (0xE0 | (cp >> 12));
+                    utf8[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    utf8[2] = (char) (0x80 | (cp & 0x3F));
+                    utf8_length = 3;
+                } else {
+                    utf8[0] = (char) (0xF0 | (cp >> 18));
+                    utf8[1] = (char) (0x80 | ((cp >> 12) & 0x3F));
+                    utf8[2] = (char) (0x80 | ((cp >> 6) & 0x3F));
+                    utf8[3] = (char) (0x80 | (cp & 0x3F));
+                    utf8_length = 4;
+                }
+                break;
+            }
+            default:
+                return -1;
+        }
+
+        if (msgpackPut(r->out, utf8, utf8_length) != 0) return -1;
+    }
+
+    msgpackFixHead(r->out, start, r->out->used - start - 5, 0xa0, 32, 0xd9, 0xda, 0xdb);
+
+    return 0;
+}
+
+static int msgpackInteger(msbCodecBuffer* out, const char* text) {
+    errno = 0;
+
+    if (text[0] == '-') {
+        long long v = strtoll(text, NULL, 10);
+        if (errno == ERANGE) return 1;
+
+        if (v >= -32) return msgpackPutBig(out, (uint8_t) v, 0, 0);
+        if (v >= INT8_MIN) return msgpackPutBig(out, 0xd0, (uint64_t) v, 1);
+        if (v >= INT16_MIN) return msgpackPutBig(out, 0xd1, (uint64_t) v, 2);
+        if (v >= INT32_MIN) return msgpackPutBig(out, 0xd2, (uint64_t) v, 4);
+        return msgpackPutBig(out, 0xd3, (uint64_t) v, 8);
+    }
+
+    unsigned long long v = strtoull(text, NULL, 10);
+    if (errno == ERANGE) return 1;
+
+    if (v < 0x80) return msgpackPutBig(out, (uint8_t) v, 0, 0);
+    if (v <= UINT8_MAX) return msgpackPutBig(out, 0xcc, v, 1);
+    if (v <= UINT16_MAX) return msgpackPutBig(out, 0xcd, v, 2);
+    if (v <= UINT32_MAX) return msgpackPutBig(out, 0xce, v, 4);
+    return msgpackPutBig(out, 0xcf, v, 8);
+}
+
+static int msgpackNumber(msgpackReader* r) {
+    const char* start = r->p;
+    bool integer = true;
+
+    if (r->p < r->end && *r->p == '-') ++r->p;
+    if (r->p == r->end || *r->p < '0' || *r->p > '9') return -1;
+    if (*r->p == '0') ++r->p;
+    else
+        while (r->p < r->end && *r->p >= '0' && *r->p <= '9') ++r->p;
+
+    if (r->p < r->end && *r->p == '.') {
+        integer = false;
+        ++r->p;
+        if (r->p == r->end || *r->p < '0' || *r->p > '9') return -1;
+        while (r->p < r->end && *r->p >= '0' && *r->p <= '9') ++r->p;
+    }
+
+    if (r->p < r->end && (*r->p == 'e' || *r->p == 'E')) {
+        integer = false;
+        ++r->p;
+        if (r->p < r->end && (*r->p == '+' || *r->p == '-')) ++r->p;
+        if (r->p == r->end || *r->p < '0' || *r->p > '9') return -1;
+        while (r->p < r->end && *r->p >= '0' && *r->p <= '9') ++r->p;
+    }
+
+    char text[64];
+    size_t length = (size_t) (r->p - start);
+
+    if (length >= sizeof(text)) return -1;
+    memcpy(text, start, length);
+    text[length] = 0;
+
+    if (integer) {
+        int ret = msgpackInteger(r->out, text);
+        if (ret <= 0) return ret;
+    }
+
+    /* floats which are exact in single precision take 5 bytes instead of 9 */
+    double d = strtod(text, NULL);
+    float f = (float) d;
+
+    if ((double) f == d) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return msgpackPutBig(r->out, 0xca, bits, 4);
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return msgpackPutBig(r->out, 0xcb, bits, 8);
+}
+
+static int msgpackLiteral(msgpackReader* r, const char* literal, uint8_t type) {
+    size_t length = strlen(literal);
+
+    if ((size_t) (r->end - r->p) < length || memcmp(r->p, literal, length) != 0) return -1;
+    r->p += length;
+
+    return msgpackPutBig(r->out, type, 0, 0);
+}
+
+static int msgpackContainer(msgpackReader* r, int depth, bool map) {
+    size_t start;
+    uint64_t count = 0;
+
+    if (msgpackPlaceholder(r->out, &start) != 0) return -1;
+
+    ++r->p;
+    msgpackSkip(r);
+
+    if (r->p < r->end && *r->p == (map ? '}' : ']')) {
+        ++r->p;
+    } else {
+        for (;;) {
+            if (map) {
+                msgpackSkip(r);
+                if (r->p == r->end || *r->p != '"' || msgpackString(r) != 0) return -1;
+                msgpackSkip(r);
+                if (r->p == r->end || *r->p != ':') return -1;
+                ++r->p;
+            }
+
+            if (msgpackValue(r, depth + 1) != 0) return -1;
+            ++count;
+
+            msgpackSkip(r);
+            if (r->p == r->end) return -1;
+            if (*r->p == ',') {
+                ++r->p;
+                continue;
+            }
+            if (*r->p != (map ? '}' : ']')) return -1;
+            ++r->p;
+            break;
+        }
+    }
+
+    if (map)
+        msgpackFixHead(r->out, start, count, 0x80, 16, 0, 0xde, 0xdf);
+    else
+        msgpackFixHead(r->out, start, count, 0x90, 16, 0, 0xdc, 0xdd);
+
+    return 0;
+}
+
+static int msgpackValue(msgpackReader* r, int depth) {
+    if (depth > MSGPACK_MAX_DEPTH) return -1;
+
+    msgpackSkip(r);
+    if (r->p == r->end) return -1;
+
+    switch (*r->p) {
+        case '{':
+            return msgpackContainer(r, depth, true);
+        case '[':
+            return msgpackContainer(r, depth, false);
+        case '"':
+            return msgpackString(r);
+        case 't':
+            return msgpackLiteral(r, "true", 0xc3);
+        case 'f':
+            return msgpackLiteral(r, "false", 0xc2);
+        case 'n':
+            return msgpackLiteral(r, "null", 0xc0);
+        default:
+            return msgpackNumber(r);
+    }
+}
+
+int msgpackFromJSON(const char* json, size_t length, msbCodecBuffer* out) {
+    msgpackReader r = {json, json + length, out};
+
+    if (msgpackValue(&r, 0) != 0) return -1;
+
+    msgpackSkip(&r);
+
+    return r.p == r.end ? 0 : -1;
+}
+
+static uint64_t msgpackGetBig(const unsigned char* p, size_t size) {
+    uint64_t value = 0;
+    size_t i;
+
+    for (i = 0; i < size; ++i)
+        value = (value << 8) | p[i];
+
+    return value;
+}
+
+static int msgpackPrint(msbCodecBuffer* out, const char* format, ...) {
+    char text[40];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (length < 0 || (size_t) length >= sizeof(text)) return -1;
+
+    return msgpackPut(out, text, (size_t) length);
+}
+
+/* shortest text which reads back to the same value, with a fraction so it stays a double in json-c */
+static int msgpackDouble(msbCodecBuffer* out, double d, bool single) {
+    char text[40];
+
+    if (!isfinite(d)) return msgpackPut(out, "null", 4);
+
+    if (single) {
+        snprintf(text, sizeof(text), "%.7g", d);
+        if ((float) strtod(text, NULL) != (float) d) snprintf(text, sizeof(text), "%.9g", d);
+    } else {
+        snprintf(text, sizeof(text), "%.15g", d);
+        if (strtod(text, NULL) != d) snprintf(text, sizeof(text), "%.17g", d);
+    }
+
+    if (strpbrk(text, ".eE") == NULL) strcat(text, ".0");
+
+    return msgpackPut(out, text, strlen(text));
+}
+
+static int msgpackJSONString(const unsigned char** p, const unsigned char* end, msbCodecBuffer* out, uint64_t length) {
+    if ((uint64_t) (end - *p) < length) return -1;
+
+    const unsigned char* s = *p;
+    const unsigned char* s_end = s + length;
+    *p = s_end;
+
+    if (msgpackPut(out, "\"", 1) != 0) return -1;
+
+    while (s < s_end) {
+        const unsigned char* run = s;
+
+        while (s < s_end && *s != '"' && *s != '\\' && *s >= 0x20)
+            ++s;
+        if (s > run && msgpackPut(out, (const char*) run, (size_t) (s - run)) != 0) return -1;
+        if (s == s_end) break;
+
+        int ret;
+        switch (*s) {
+            case '"':
+                ret = msgpackPut(out, "\\\"", 2);
+                break;
+            case '\\':
+                ret = msgpackPut(out, "\\\\", 2);
+                break;
+            case '\n':
+                ret = msgpackPut(out, "\\n", 2);
+                break;
+            case '\r':
+                ret = msgpackPut(out, "\\r", 2);
+                break;
+            case '\t':
+                ret = msgpackPut(out, "\\t", 2);
+                break;
+            default:
+                ret = msgpackPrint(out, "\\u%04x", *s);
+                break;
+        }
+        if (ret != 0) return -1;
+        ++s;
+    }
+
+    return msgpackPut(out, "\"", 1);
+}
+
+static int msgpackJSONContainer(const unsigned char** p, const unsigned char* end, msbCodecBuffer* out, int depth,
+                                uint64_t count, bool map) {
+    uint64_t i;
+
+    /* every element takes at least a byte, which bounds the count of broken frames */
+    if (count > (uint64_t) (end - *p)) return -1;
+
+    if (msgpackPut(out, map ? "{" : "[", 1) != 0) return -1;
+
+    for (i = 0; i < count; ++i) {
+        if (i > 0 && msgpackPut(out, ",", 1) != 0) return -1;
+
+        if (map) {
+            if (*p == end) return -1;
+
+            unsigned char b = **p;
+            uint64_t length;
+
+            if (b >= 0xa0 && b <= 0xbf) {
+                length = b & 0x1f;
+                *p += 1;
+            } else if (b >= 0xd9 && b <= 0xdb) {
+                size_t size = (size_t) 1 << (b - 0xd9);
+                if ((size_t) (end - *p) < 1 + size) return -1;
+                length = msgpackGetBig(*p + 1, size);
+                *p += 1 + size;
+            } else {
+                return -1;
+            }
+
+            if (msgpackJSONString(p, end, out, length) != 0 || msgpackPut(out, ":", 1) != 0) return -1;
+        }
+
+        if (msgpackJSONValue(p, end, out, depth + 1) != 0) return -1;
+    }
+
+    return msgpackPut(out, map ? "}" : "]", 1);
+}
+
+static int msgpackJSONValue(const unsigned char** p, const unsigned char* end, msbCodecBuffer* out, int depth) {
+    if (depth > MSGPACK_MAX_DEPTH || *p == end) return -1;
+
+    unsigned char b = *(*p)++;
+    size_t size;
+
+    if (b <= 0x7f) return msgpackPrint(out, "%u", b);
+    if (b >= 0xe0) return msgpackPrint(out, "%i", (int) (int8_t) b);
+    if (b <= 0x8f) return msgpackJSONContainer(p, end, out, depth, b & 0x0f, true);
+    if (b <= 0x9f) return msgpackJSONContainer(p, end, out, depth, b & 0x0f, false);
+    if (b <= 0xbf) return msgpackJSONString(p, end, out, b & 0x1f);
+
+    switch (b) {
+        case 0xc0:
+            return msgpackPut(out, "null", 4);
+        case 0xc2:
+            return msgpackPut(out, "false", 5);
+        case 0xc3:
+            return msgpackPut(out, "true", 4);
+        case 0xca:
+        case 0xcb:
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3:
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+        case 0xdc:
+        case 0xdd:
+        case 0xde:
+        case 0xdf:
+            break;
+        default:
+            /* bin, ext and reserved types have no json text */
+            return -1;
+    }
+
+    if (b == 0xca) size = 4;
+    else if (b == 0xcb) size = 8;
+    else if (b >= 0xcc && b <= 0xd3) size = (size_t) 1 << ((b - 0xcc) & 3);
+    else if (b >= 0xd9 && b <= 0xdb) size = (size_t) 1 << (b - 0xd9);
+    else size = (b & 1) ? 4 : 2;
+
+    if ((size_t) (end - *p) < size) return -1;
+
+    uint64_t value = msgpackGetBig(*p, size);
+    *p += size;
+
+    if (b == 0xca) {
+        uint32_t bits = (uint32_t) value;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return msgpackDouble(out, f, true);
+    }
+    if (b == 0xcb) {
+        double d;
+        memcpy(&d, &value, sizeof(d));
+        return msgpackDouble(out, d, false);
+    }
+    if (b <= 0xcf) return msgpackPrint(out, "%" PRIu64, value);
+    if (b <= 0xd3) {
+        int shift = (int) (64 - 8 * size);
+        return msgpackPrint(out, "%" PRId64, (int64_t) (value << shift) >> shift);
+    }
+    if (b <= 0xdb) return msgpackJSONString(p, end, out, value);
+    if (b <= 0xdd) return msgpackJSONContainer(p, end, out, depth, value, false);
+
+    return msgpackJSONContainer(p, end, out, depth, value, true);
+}
+
+int msgpackToJSON(const unsigned char* data, size_t length, msbCodecBuffer* out) {
+    const unsigned char* p = data;
+
+    if (msgpackJSONValue(&p, data + length, out, 0) != 0 || p != data + length) return -1;
+
+    if (!msbCodecBufferReserve(out, 1)) return -1;
+    out->data[out->used] = 0;
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file msgpack.h
+* @brief header file for the transcoding between json text and MessagePack
+*/
+
+#ifndef SRC_CODEC_MSGPACK_H_
+#define SRC_CODEC_MSGPACK_H_
+
+#include <stddef.h>
+#include "../MsbClientC.h"
+
+/* appends the MessagePack encoding of the json text (length bytes, followed by a null termination) to out,
+ * returns -1 if the text isn't valid json or out can't be grown */
+int msgpackFromJSON(const char* json, size_t length, msbCodecBuffer* out);
+
+/* appends the json text of the MessagePack encoded value to out and terminates it (not counted in used),
+ * returns -1 if the data isn't a single value representable in json or out can't be grown */
+int msgpackToJSON(const unsigned char* data, size_t length, msbCodecBuffer* out);
+
+#endif /* SRC_CODEC_MSGPACK_H_ */
@@ -78,93 +78,163 @@ list_return_value list_deleteList(list_list* list, int free_value) {
         list_entry* t;
         t = p->next_entry;
 
+        if (p->tracker != NULL) {
+            *(p->tracker) = NULL;
+        }
+
         if (free_value) {
-            free(p->value);
+            mpool_free(list->pool, p->value);
         }
 
-        free(p);
+        mpool_free(list->pool, p);
         p = t;
     }
 
-    free(list);
-
     pthread_mutex_unlock(&list->mutex);
 
+    free(list);
+
     return EINFL_OK;
 
 }
 
 list_return_value list_add(list_list* list, void* value, int copy_value, size_t value_size) {
 
+    return list_addTracked(list, value, copy_value, value_size, NULL);
+
+}
+
+list_return_value list_addTracked(list_list* list, void* value, int copy_value, size_t value_size, list_entry** tracker) {
+
+    return list_addTagged(list, value, copy_value, value_size, tracker, NULL, 0);
+
+}
+
+list_return_value list_addTagged(list_list* list, void* value, int copy_value, size_t value_size, list_entry** tracker,
+                                 void* tag, int kind) {
+
     if(list == NULL) return EINFL_LIST_NULL;
 
     if(value == NULL) return EINFL_NULL_VALUE;
 
     pthread_mutex_lock(&list->mutex);
 
-    if(list->number_entries == 0){
-        list->first_entry = calloc(1, sizeof(list_entry));
+    list_entry* n;
+    n = (list_entry*) mpool_calloc(list->pool, sizeof(list_entry));
 
-        list->first_entry->value = (void*)value;
-        list->first_entry->next_entry = NULL;
+    /* a pool without heap may run dry, the list stays untouched then */
+    if (n != NULL && copy_value) {
+        void* v = mpool_alloc(list->pool, value_size);
 
-        if (copy_value) {
-            list->first_entry->value = (char*) calloc(value_size, 1);
-            memcpy(list->first_entry->value, value, value_size);
+        if (v != NULL) {
+            memcpy(v, value, value_size);
+        } else {
+            mpool_free(list->pool, n);
+            n = NULL;
         }
+
+        value = v;
+    }
+
+    if (n == NULL) {
+        pthread_mutex_unlock(&list->mutex);
+        return EINFL_NULL_VALUE;
+    }
+
+    n->value = (void*)value;
+    n->next_entry = NULL;
+    n->tag = tag;
+    n->kind = kind;
+
+    if(list->number_entries == 0){
+        list->first_entry = n;
     }else{
-        list_entry* p;
-        p = list->first_entry;//->next_entry;
+        list->last_entry->next_entry = n;
+    }
 
-        unsigned int i;
-        for(i = 0; i < list->number_entries-1; ++i){
-            p = p->next_entry;
-        }
+    list->last_entry = n;
 
-        p->next_entry = (list_entry*) calloc(1, sizeof(list_entry));
+    if (tracker != NULL) {
+        if (*tracker != NULL) (*tracker)->tracker = NULL;
 
-        p->next_entry->value = (void*)value;
-        p->next_entry->next_entry = NULL;
+        n->tracker = tracker;
+        *tracker = n;
+    }
 
-        if (copy_value) {
-            p->next_entry->value = (char*) calloc(value_size, 1);
-            memcpy(p->next_entry->value, value, value_size);
-        }
+    list->number_entries++;
+
+    pthread_mutex_unlock(&list->mutex);
+
+    return EINFL_OK;
+
+}
+
+list_return_value list_replaceTracked(list_list* list, list_entry** tracker, void* value, int copy_value,
+                                      size_t value_size, int free_value) {
+
+    if (list == NULL) return EINFL_LIST_NULL;
+
+    if (tracker == NULL || value == NULL) return EINFL_NULL_VALUE;
+
+    pthread_mutex_lock(&list->mutex);
+
+    list_entry* p;
+    p = *tracker;
+
+    if (p == NULL) {
+        pthread_mutex_unlock(&list->mutex);
+        return EINFL_NO_ENTRY;
     }
 
+    if (p == list->first_entry || p->tag != NULL) {
+        /* the first entry may currently be read (e.g. sent) and a tag belongs to the value, such entries are released
+         * instead of replaced */
+        p->tracker = NULL;
+        *tracker = NULL;
 
+        pthread_mutex_unlock(&list->mutex);
+        return EINFL_NO_ENTRY;
+    }
 
-/*
-    if(list->first_entry == NULL){
-        list->first_entry = calloc(1, sizeof(list_entry));
+    void* v;
+    v = value;
 
-        list->first_entry->value = (void*)value;
-        list->first_entry->next_entry = NULL;
+    if (copy_value) {
+        v = mpool_alloc(list->pool, value_size);
 
-        if (copy_value) {
-            list->first_entry->value = (char*) calloc(value_size, 1);
-            memcpy(list->first_entry->value, value, value_size);
+        /* a pool without heap may run dry, the entry keeps its value then */
+        if (v == NULL) {
+            pthread_mutex_unlock(&list->mutex);
+            return EINFL_NULL_VALUE;
         }
-    }else{
-        list_entry* p;
-        p = list->first_entry;
 
-        while(p->next_entry != NULL){
-            p = p->next_entry;
-        }
+        memcpy(v, value, value_size);
+    }
 
-        p->next_entry = (list_entry*) calloc(1, sizeof(list_entry));
+    if (free_value) {
+        mpool_free(list->pool, p->value);
+    }
 
-        p->next_entry->value = (void*)value;
-        p->next_entry->next_entry = NULL;
+    p->value = v;
 
-        if (copy_value) {
-            p->next_entry->value = (char*) calloc(value_size, 1);
-            memcpy(p->next_entry->value, value, value_size);
-        }
-    }*/
+    pthread_mutex_unlock(&list->mutex);
 
-    list->number_entries++;
+    return EINFL_OK;
+
+}
+
+list_return_value list_untrack(list_list* list, list_entry** tracker) {
+
+    if (list == NULL) return EINFL_LIST_NULL;
+
+    if (tracker == NULL) return EINFL_NULL_VALUE;
+
+    pthread_mutex_lock(&list->mutex);
+
+    if (*tracker != NULL) {
+        (*tracker)->tracker = NULL;
+        *tracker = NULL;
+    }
 
     pthread_mutex_unlock(&list->mutex);
 
@@ -174,6 +244,12 @@ list_return_value list_add(list_list* list, void* value, int copy_value, size_t
 
 list_return_value list_pop(list_list* list, unsigned int index, int free_value) {
 
+    return list_popTagged(list, index, free_value, NULL);
+
+}
+
+list_return_value list_popTagged(list_list* list, unsigned int index, int free_value, void** tag) {
+
     if (list == NULL) return EINFL_LIST_NULL;
 
     if (list->first_entry == NULL) return EINFL_NO_ENTRIES;
@@ -183,20 +259,31 @@ list_return_value list_pop(list_list* list, unsigned int index, int free_value)
     list_entry* p;
 
     if(index == 0){
+        if (tag != NULL && list->number_entries > 0) *tag = list->first_entry->tag;
+
         if(list->number_entries > 1){
             p = list->first_entry->next_entry;
 
+            if(list->first_entry->tracker != NULL){
+                *(list->first_entry->tracker) = NULL;
+            }
             if(free_value){
-                free(list->first_entry->value);
+                mpool_free(list->pool, list->first_entry->value);
             }
-            free(list->first_entry);
+            mpool_free(list->pool, list->first_entry);
 
             list->first_entry = p;
         }else if(list->number_entries == 1){
+            if(list->first_entry->tracker != NULL){
+                *(list->first_entry->tracker) = NULL;
+            }
             if(free_value){
-                free(list->first_entry->value);
+                mpool_free(list->pool, list->first_entry->value);
             }
-            free(list->first_entry);
+            mpool_free(list->pool, list->first_entry);
+
+            list->first_entry = NULL;
+            list->last_entry = NULL;
         }else{
 
         }
@@ -213,10 +300,15 @@ list_return_value list_pop(list_list* list, unsigned int index, int free_value)
         }
 
         vorg->next_entry = p->next_entry;
+        if (list->last_entry == p) list->last_entry = vorg;
+        if (tag != NULL) *tag = p->tag;
+        if(p->tracker != NULL){
+            *(p->tracker) = NULL;
+        }
         if(free_value){
-            free(p->value);
+            mpool_free(list->pool, p->value);
         }
-        free(p);
+        mpool_free(list->pool, p);
     }
 
     list->number_entries--;
@@ -295,6 +387,20 @@ void* list_getValueFirstPointer(list_list* list) {
 
 }
 
+int list_getKindFirst(list_list* list) {
+
+    if (list == NULL) return 0;
+
+    pthread_mutex_lock(&list->mutex);
+
+    int kind = list->first_entry != NULL ? list->first_entry->kind : 0;
+
+    pthread_mutex_unlock(&list->mutex);
+
+    return kind;
+
+}
+
 void* list_getValueLastPointer(list_list* list) {
 
     return list_getValuePointer(list, (list_count_entries(list) - 1));
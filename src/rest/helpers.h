@@ -135,6 +135,7 @@ static inline int gettimeofday(struct timeval * tp, struct timezone * tzp)
 
 static inline void getDateTime(char buffer[]) {
 	long millisec = 0;
+	struct tm tm_buffer;
 	struct tm* tm_info;
 	struct timeval tv;
 	gettimeofday(&tv, NULL);
@@ -145,7 +146,13 @@ static inline void getDateTime(char buffer[]) {
 		tv.tv_sec++;
 	}
 
+#ifdef _WIN32
 	tm_info = localtime(&tv.tv_sec);
+#else
+	/* unlike localtime, localtime_r neither reloads the time zone each call nor shares its result between threads */
+	time_t seconds = tv.tv_sec;
+	tm_info = localtime_r(&seconds, &tm_buffer);
+#endif
 	strftime(buffer, 30, "%Y-%m-%dT%H:%M:%S:::::%z", tm_info);
 	sprintf(&buffer[19], ".%03li", millisec);
 	buffer[23] = buffer[24];
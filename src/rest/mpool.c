@@ -0,0 +1,334 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+
+/**
+* @file mpool.c
+* @brief size-classed buffer pool implementation
+*/
+
+#define MPOOL_HEADER_SIZE ((sizeof(mpool_buffer) + 15) & ~(size_t) 15)
+
+static size_t mpool_classSize(size_t size_class) {
+
+    return (size_t) 64 << (2 * size_class);
+
+}
+
+static size_t mpool_sizeClass(size_t size) {
+
+    size_t c = 0;
+
+    while (c < MPOOL_SIZE_CLASSES && mpool_classSize(c) < size) ++c;
+
+    return c;
+
+}
+
+/* free buffers of a thread, any buffer of a size class fits every pool using the heap */
+typedef struct {
+    mpool_buffer* free_buffers[MPOOL_SIZE_CLASSES];
+    unsigned int number_free[MPOOL_SIZE_CLASSES];
+} mpool_threadCache;
+
+static pthread_key_t mpool_threadCacheKey;
+static pthread_once_t mpool_threadCacheOnce = PTHREAD_ONCE_INIT;
+
+static void mpool_deleteThreadCache(void* ptr) {
+
+    mpool_threadCache* cache = (mpool_threadCache*) ptr;
+    size_t c;
+
+    for (c = 0; c < MPOOL_SIZE_CLASSES; ++c) {
+        while (cache->free_buffers[c] != NULL) {
+            mpool_buffer* b = cache->free_buffers[c];
+            cache->free_buffers[c] = b->next;
+            free(b);
+        }
+    }
+
+    free(cache);
+
+}
+
+static void mpool_makeThreadCacheKey(void) {
+
+    pthread_key_create(&mpool_threadCacheKey, mpool_deleteThreadCache);
+
+}
+
+static mpool_threadCache* mpool_getThreadCache(void) {
+
+    mpool_threadCache* cache = (mpool_threadCache*) pthread_getspecific(mpool_threadCacheKey);
+
+    if (cache == NULL) {
+        cache = (mpool_threadCache*) calloc(1, sizeof(mpool_threadCache));
+        if (cache != NULL && pthread_setspecific(mpool_threadCacheKey, cache) != 0) {
+            free(cache);
+            cache = NULL;
+        }
+    }
+
+    return cache;
+
+}
+
+static mpool_buffer* mpool_allocCached(mpool* pool, mpool_threadCache* cache, size_t c) {
+
+    if (cache->free_buffers[c] == NULL) {
+        pthread_mutex_lock(&pool->mutex);
+
+        while (pool->free_buffers[c] != NULL && cache->number_free[c] < MPOOL_THREAD_CACHED / 2) {
+            mpool_buffer* b = pool->free_buffers[c];
+            pool->free_buffers[c] = b->next;
+            pool->number_free[c]--;
+
+            b->next = cache->free_buffers[c];
+            cache->free_buffers[c] = b;
+            cache->number_free[c]++;
+        }
+
+        if (cache->free_buffers[c] == NULL) pool->misses++;
+
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    mpool_buffer* b = cache->free_buffers[c];
+
+    if (b == NULL) return (mpool_buffer*) malloc(MPOOL_HEADER_SIZE + mpool_classSize(c));
+
+    cache->free_buffers[c] = b->next;
+    cache->number_free[c]--;
+
+    /* counted without the pool's lock, the other counts of hits are atomic as well */
+    __atomic_add_fetch(&pool->hits, 1, __ATOMIC_RELAXED);
+
+    return b;
+
+}
+
+static void mpool_freeCached(mpool* pool, mpool_threadCache* cache, mpool_buffer* b, size_t c) {
+
+    b->next = cache->free_buffers[c];
+    cache->free_buffers[c] = b;
+
+    if (++cache->number_free[c] <= MPOOL_THREAD_CACHED) return;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (cache->number_free[c] > MPOOL_THREAD_CACHED / 2) {
+        b = cache->free_buffers[c];
+        cache->free_buffers[c] = b->next;
+        cache->number_free[c]--;
+
+        if (pool->number_free[c] < pool->max_cached) {
+            b->next = pool->free_buffers[c];
+            pool->free_buffers[c] = b;
+            pool->number_free[c]++;
+        } else {
+            free(b);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+}
+
+void mpool_setThreadCached(mpool* pool, bool enable) {
+
+    if (pool == NULL) return;
+
+    pthread_once(&mpool_threadCacheOnce, mpool_makeThreadCacheKey);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->thread_cached = enable && !pool->no_heap;
+    pthread_mutex_unlock(&pool->mutex);
+
+}
+
+mpool* mpool_makePoolPointer(unsigned int max_cached) {
+
+    mpool* ret;
+    ret = (mpool*) calloc(1, sizeof(mpool));
+
+    if (ret == NULL) return NULL;
+
+    ret->max_cached = max_cached;
+    pthread_mutex_init(&ret->mutex, NULL);
+
+    return ret;
+
+}
+
+void mpool_deletePool(mpool* pool) {
+
+    if (pool == NULL) return;
+
+    size_t c;
+
+    for (c = 0; c < MPOOL_SIZE_CLASSES && !pool->no_heap; ++c) {
+        mpool_buffer* b = pool->free_buffers[c];
+
+        while (b != NULL) {
+            mpool_buffer* t = b->next;
+            free(b);
+            b = t;
+        }
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+
+}
+
+void* mpool_alloc(mpool* pool, size_t size) {
+
+    if (pool == NULL) return malloc(size);
+
+    size_t c = mpool_sizeClass(size);
+    mpool_buffer* b = NULL;
+    mpool_threadCache* cache = NULL;
+
+    if (c < MPOOL_SIZE_CLASSES && pool->thread_cached) cache = mpool_getThreadCache();
+
+    if (cache != NULL) {
+        b = mpool_allocCached(pool, cache, c);
+    } else if (c < MPOOL_SIZE_CLASSES) {
+        pthread_mutex_lock(&pool->mutex);
+
+        size_t f = c;
+
+        /* without heap a free buffer of a larger class is better than none */
+        do {
+            b = pool->free_buffers[f];
+        } while (b == NULL && pool->no_heap && ++f < MPOOL_SIZE_CLASSES);
+
+        if (b != NULL) {
+            pool->free_buffers[f] = b->next;
+            pool->number_free[f]--;
+            __atomic_add_fetch(&pool->hits, 1, __ATOMIC_RELAXED);
+            c = f;
+        } else {
+            pool->misses++;
+        }
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        if (b == NULL && !pool->no_heap) b = (mpool_buffer*) malloc(MPOOL_HEADER_SIZE + mpool_classSize(c));
+    } else {
+        pthread_mutex_lock(&pool->mutex);
+        pool->oversized++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        if (!pool->no_heap) b = (mpool_buffer*) malloc(MPOOL_HEADER_SIZE + size);
+    }
+
+    if (b == NULL) return NULL;
+
+    b->next = NULL;
+    b->size_class = c;
+
+    return (char*) b + MPOOL_HEADER_SIZE;
+
+}
+
+void* mpool_calloc(mpool* pool, size_t size) {
+
+    void* ret = mpool_alloc(pool, size);
+
+    if (ret != NULL) memset(ret, 0, size);
+
+    return ret;
+
+}
+
+void mpool_free(mpool* pool, void* ptr) {
+
+    if (ptr == NULL) return;
+
+    if (pool == NULL) {
+        free(ptr);
+        return;
+    }
+
+    mpool_buffer* b = (mpool_buffer*) ((char*) ptr - MPOOL_HEADER_SIZE);
+    size_t c = b->size_class;
+    mpool_threadCache* cache = NULL;
+
+    if (c < MPOOL_SIZE_CLASSES && pool->thread_cached) cache = mpool_getThreadCache();
+
+    if (cache != NULL) {
+        mpool_freeCached(pool, cache, b, c);
+        return;
+    }
+
+    if (c < MPOOL_SIZE_CLASSES) {
+        pthread_mutex_lock(&pool->mutex);
+
+        if (pool->number_free[c] < pool->max_cached || pool->no_heap) {
+            b->next = pool->free_buffers[c];
+            pool->free_buffers[c] = b;
+            pool->number_free[c]++;
+            b = NULL;
+        }
+
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    free(b);
+
+}
+
+size_t mpool_reserveSize(size_t buffer_size, unsigned int count) {
+
+    size_t c = mpool_sizeClass(buffer_size);
+
+    if (c >= MPOOL_SIZE_CLASSES) return 0;
+
+    return (MPOOL_HEADER_SIZE + mpool_classSize(c)) * count;
+
+}
+
+size_t mpool_reserve(mpool* pool, void* memory, size_t buffer_size, unsigned int count) {
+
+    if (pool == NULL || memory == NULL) return 0;
+
+    size_t c = mpool_sizeClass(buffer_size);
+
+    if (c >= MPOOL_SIZE_CLASSES) return 0;
+
+    size_t step = MPOOL_HEADER_SIZE + mpool_classSize(c);
+    unsigned int i;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    for (i = 0; i < count; ++i) {
+        mpool_buffer* b = (mpool_buffer*) ((char*) memory + i * step);
+
+        b->size_class = c;
+        b->next = pool->free_buffers[c];
+        pool->free_buffers[c] = b;
+        pool->number_free[c]++;
+    }
+
+    pool->no_heap = true;
+    pool->thread_cached = false;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return step * count;
+
+}
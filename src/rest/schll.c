@@ -230,6 +230,67 @@ void* schll_getValuePointer(const schll_list* list, const char* name){
 
 }
 
+schll_return_value schll_linkEntry(schll_list* list, schll_entry* entry){
+
+	if(list == NULL) return SCHLL_MAP_NULL;
+
+	if(entry == NULL || entry->name == NULL) return SCHLL_NAME_MISSING;
+
+	entry->name_l = strlen(entry->name)+1;
+	entry->next_entry = NULL;
+
+	schll_entry** p = &(list->first_entry);
+
+	while(*p != NULL) {
+		if ((*p)->name_l == entry->name_l) {
+			if (strncmp((*p)->name, entry->name, entry->name_l) == 0) {
+				return SCHLL_SCHLL_EXISTS;
+			}
+		}
+
+		p = &((*p)->next_entry);
+	}
+
+	*p = entry;
+	list->number_entries++;
+
+	return SCHLL_OK;
+}
+
+schll_return_value schll_unlinkEntry(schll_list* list, const char* name, schll_entry** entry){
+
+	if(list == NULL) return SCHLL_MAP_NULL;
+
+	if(name == NULL) return SCHLL_NAME_MISSING;
+
+	if(list->first_entry == NULL) return SCHLL_NO_ENTRIES;
+
+	size_t l;
+	l = strlen(name)+1;
+
+	schll_entry** p = &(list->first_entry);
+
+	while(*p != NULL) {
+		if ((*p)->name_l == l) {
+			if (strncmp((*p)->name, name, l) == 0) {
+				schll_entry* t = *p;
+
+				*p = t->next_entry;
+				t->next_entry = NULL;
+				list->number_entries--;
+
+				if(entry != NULL) *entry = t;
+
+				return SCHLL_OK;
+			}
+		}
+
+		p = &((*p)->next_entry);
+	}
+
+	return SCHLL_NO_ENTRY;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,319 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file deflate.c
+* @brief source file for permessage-deflate (RFC 7692) functions
+*/
+
+#include "deflate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* every compressed message ends with an empty stored block, which is not transmitted (RFC 7692 7.2.1) */
+static const unsigned char wsDeflateTail[4] = {0x00, 0x00, 0xff, 0xff};
+
+static uint8_t wsDeflateClampWindowBits(unsigned int bits) {
+    if (bits < WS_DEFLATE_MIN_WINDOW_BITS) return WS_DEFLATE_MIN_WINDOW_BITS;
+    if (bits > WS_DEFLATE_MAX_WINDOW_BITS) return WS_DEFLATE_MAX_WINDOW_BITS;
+    return (uint8_t) bits;
+}
+
+void wsDeflateConfigure(wsDeflate* d, bool on_off, uint8_t window_bits, bool context_takeover, size_t threshold) {
+    wsDeflateReset(d);
+
+    d->enabled = on_off;
+    d->negotiated = false;
+
+    d->client_max_window_bits = wsDeflateClampWindowBits(window_bits);
+    d->server_max_window_bits = d->client_max_window_bits;
+    d->client_no_context_takeover = !context_takeover;
+    d->server_no_context_takeover = !context_takeover;
+
+    d->threshold = threshold;
+}
+
+char* wsDeflateOffer(const wsDeflate* d) {
+    if (!d->enabled) return NULL;
+
+    char* ret = (char*) calloc(1, 160);
+    if (ret == NULL) return NULL;
+
+    int l = sprintf(ret, "%s; client_max_window_bits=%u", WS_DEFLATE_EXTENSION_NAME, d->client_max_window_bits);
+
+    if (d->server_max_window_bits < WS_DEFLATE_MAX_WINDOW_BITS)
+        l += sprintf(&ret[l], "; server_max_window_bits=%u", d->server_max_window_bits);
+
+    if (d->client_no_context_takeover)
+        l += sprintf(&ret[l], "; client_no_context_takeover");
+
+    if (d->server_no_context_takeover)
+        sprintf(&ret[l], "; server_no_context_takeover");
+
+    return ret;
+}
+
+static const char* wsDeflateSkipSpaces(const char* p, const char* end) {
+    while (p < end && isspace((unsigned char) *p)) ++p;
+    return p;
+}
+
+static bool wsDeflateParamIs(const char* p, size_t l, const char* name) {
+    return l >= strlen(name) && strncmp(p, name, strlen(name)) == 0 &&
+           (l == strlen(name) || p[strlen(name)] == '=' || isspace((unsigned char) p[strlen(name)]));
+}
+
+static int wsDeflateParamValue(const char* p, size_t l) {
+    const char* eq = memchr(p, '=', l);
+    if (eq == NULL) return -1;
+
+    ++eq;
+    while (eq < p + l && (isspace((unsigned char) *eq) || *eq == '"')) ++eq;
+
+    return atoi(eq);
+}
+
+int wsDeflateAccept(wsDeflate* d, const char* extensions) {
+    d->negotiated = false;
+
+    if (extensions == NULL) return 0;
+
+    const char* ext = strstr(extensions, WS_DEFLATE_EXTENSION_NAME);
+    if (ext == NULL) return 0;
+
+    /* an extension the client hasn't offered fails the connection (RFC 6455 9.1) */
+    if (!d->enabled) return -1;
+
+    const char* end = strchr(ext, ',');
+    if (end == NULL) end = ext + strlen(ext);
+
+    const char* p = ext + strlen(WS_DEFLATE_EXTENSION_NAME);
+
+    bool client_no_context_takeover = false, server_no_context_takeover = false;
+    int client_bits = d->client_max_window_bits, server_bits = WS_DEFLATE_MAX_WINDOW_BITS;
+
+    while (p < end) {
+        p = wsDeflateSkipSpaces(p, end);
+        if (p < end && *p == ';') p = wsDeflateSkipSpaces(p + 1, end);
+        if (p >= end) break;
+
+        const char* q = p;
+        while (q < end && *q != ';') ++q;
+
+        size_t l = (size_t) (q - p);
+        while (l > 0 && isspace((unsigned char) p[l - 1])) --l;
+
+        if (wsDeflateParamIs(p, l, "client_no_context_takeover")) {
+            client_no_context_takeover = true;
+        } else if (wsDeflateParamIs(p, l, "server_no_context_takeover")) {
+            server_no_context_takeover = true;
+        } else if (wsDeflateParamIs(p, l, "client_max_window_bits")) {
+            client_bits = wsDeflateParamValue(p, l);
+        } else if (wsDeflateParamIs(p, l, "server_max_window_bits")) {
+            server_bits = wsDeflateParamValue(p, l);
+        } else {
+            return -1;
+        }
+
+        p = q;
+    }
+
+    /* the server may only lower the client's window, and it must be usable by zlib */
+    if (client_bits < WS_DEFLATE_MIN_WINDOW_BITS || client_bits > d->client_max_window_bits) return -1;
+    if (server_bits < 8 || server_bits > WS_DEFLATE_MAX_WINDOW_BITS) return -1;
+
+    d->negotiated_client_max_window_bits = (uint8_t) client_bits;
+    d->negotiated_client_no_context_takeover = d->client_no_context_takeover || client_no_context_takeover;
+    d->negotiated_server_no_context_takeover = server_no_context_takeover;
+
+    d->negotiated = true;
+
+    return 0;
+}
+
+int wsDeflateCompress(wsDeflate* d, const char* in, size_t in_length, unsigned char** out, size_t* out_length) {
+    *out = NULL;
+    *out_length = 0;
+
+    if (!d->negotiated || in_length < d->threshold) {
+        d->raw_bytes_sent += in_length;
+        d->wire_bytes_sent += in_length;
+        d->messages_uncompressed++;
+        return 0;
+    }
+
+    if (!d->deflater_initialised) {
+        memset(&d->deflater, 0, sizeof(z_stream));
+        if (deflateInit2(&d->deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -d->negotiated_client_max_window_bits, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+            return -1;
+        d->deflater_initialised = true;
+    }
+
+    size_t cap = deflateBound(&d->deflater, (uLong) in_length) + sizeof(wsDeflateTail) + 8;
+    unsigned char* buf = (unsigned char*) malloc(cap);
+    if (buf == NULL) return -1;
+
+    d->deflater.next_in = (Bytef*) in;
+    d->deflater.avail_in = (uInt) in_length;
+
+    size_t used = 0;
+    int ret;
+
+    do {
+        if (used == cap) {
+            unsigned char* tmp = (unsigned char*) realloc(buf, cap * 2);
+            if (tmp == NULL) {
+                free(buf);
+                deflateReset(&d->deflater);
+                return -1;
+            }
+            buf = tmp;
+            cap *= 2;
+        }
+
+        d->deflater.next_out = buf + used;
+        d->deflater.avail_out = (uInt) (cap - used);
+
+        ret = deflate(&d->deflater, Z_SYNC_FLUSH);
+
+        used = cap - d->deflater.avail_out;
+    } while (ret == Z_OK && (d->deflater.avail_in > 0 || d->deflater.avail_out == 0));
+
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        free(buf);
+        deflateReset(&d->deflater);
+        return -1;
+    }
+
+    if (used >= sizeof(wsDeflateTail) && memcmp(&buf[used - sizeof(wsDeflateTail)], wsDeflateTail, sizeof(wsDeflateTail)) == 0)
+        used -= sizeof(wsDeflateTail);
+
+    if (used >= in_length) {
+        /* no gain, the peer never sees this data, so the compressor must not reference it later on */
+        free(buf);
+        deflateReset(&d->deflater);
+
+        d->raw_bytes_sent += in_length;
+        d->wire_bytes_sent += in_length;
+        d->messages_uncompressed++;
+        return 0;
+    }
+
+    if (d->negotiated_client_no_context_takeover) deflateReset(&d->deflater);
+
+    d->raw_bytes_sent += in_length;
+    d->wire_bytes_sent += used;
+    d->messages_compressed++;
+
+    *out = buf;
+    *out_length = used;
+
+    return 1;
+}
+
+int wsDeflateDecompress(wsDeflate* d, const unsigned char* in, size_t in_length, char** out, size_t* out_length,
+                        size_t max_length) {
+    *out = NULL;
+    *out_length = 0;
+
+    if (!d->inflater_initialised) {
+        memset(&d->inflater, 0, sizeof(z_stream));
+        if (inflateInit2(&d->inflater, -WS_DEFLATE_MAX_WINDOW_BITS) != Z_OK) return -1;
+        d->inflater_initialised = true;
+    }
+
+    size_t cap = in_length * 4 + 64;
+    if (max_length && cap > max_length + 1) cap = max_length + 1;
+
+    char* buf = (char*) malloc(cap);
+    if (buf == NULL) return -1;
+
+    size_t used = 0;
+    bool ended = false;
+    int pass;
+
+    for (pass = 0; pass < 2 && !ended; ++pass) {
+        d->inflater.next_in = (Bytef*) (pass == 0 ? in : wsDeflateTail);
+        d->inflater.avail_in = (uInt) (pass == 0 ? in_length : sizeof(wsDeflateTail));
+
+        while (d->inflater.avail_in > 0) {
+            if (used + 1 >= cap) {
+                if (max_length && cap > max_length) {
+                    free(buf);
+                    inflateReset(&d->inflater);
+                    return -1;
+                }
+
+                size_t ncap = cap * 2;
+                if (max_length && ncap > max_length + 1) ncap = max_length + 1;
+
+                char* tmp = (char*) realloc(buf, ncap);
+                if (tmp == NULL) {
+                    free(buf);
+                    inflateReset(&d->inflater);
+                    return -1;
+                }
+                buf = tmp;
+                cap = ncap;
+            }
+
+            d->inflater.next_out = (Bytef*) (buf + used);
+            d->inflater.avail_out = (uInt) (cap - used - 1);
+
+            int ret = inflate(&d->inflater, Z_SYNC_FLUSH);
+
+            used = cap - 1 - d->inflater.avail_out;
+
+            if (ret == Z_STREAM_END) {
+                /* a final block ends the message, the inflater takes no more input and the next message starts a new stream */
+                inflateReset(&d->inflater);
+                ended = true;
+                break;
+            }
+
+            if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                free(buf);
+                inflateReset(&d->inflater);
+                return -1;
+            }
+        }
+    }
+
+    buf[used] = 0;
+
+    if (!ended && d->negotiated_server_no_context_takeover) inflateReset(&d->inflater);
+
+    d->wire_bytes_received += in_length;
+    d->raw_bytes_received += used;
+
+    *out = buf;
+    *out_length = used;
+
+    return 0;
+}
+
+void wsDeflateReset(wsDeflate* d) {
+    if (d->deflater_initialised) deflateEnd(&d->deflater);
+    if (d->inflater_initialised) inflateEnd(&d->inflater);
+
+    d->deflater_initialised = false;
+    d->inflater_initialised = false;
+    d->negotiated = false;
+}
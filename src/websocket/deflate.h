@@ -0,0 +1,76 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file deflate.h
+* @brief header file for permessage-deflate (RFC 7692) functions
+*/
+
+#ifndef SRC_WEBSOCKET_DEFLATE_H_
+#define SRC_WEBSOCKET_DEFLATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zlib.h>
+
+#define WS_DEFLATE_EXTENSION_NAME "permessage-deflate"
+#define WS_DEFLATE_MIN_WINDOW_BITS 9 /* zlib raw deflate does not support a window of 8 bits */
+#define WS_DEFLATE_MAX_WINDOW_BITS 15
+
+typedef struct {
+    bool enabled;
+    bool negotiated;
+
+    uint8_t client_max_window_bits;
+    uint8_t server_max_window_bits;
+    bool client_no_context_takeover;
+    bool server_no_context_takeover;
+
+    /* parameters agreed on with the server, the configured ones above are offered again on the next connection */
+    uint8_t negotiated_client_max_window_bits;
+    bool negotiated_client_no_context_takeover;
+    bool negotiated_server_no_context_takeover;
+
+    size_t threshold;
+
+    z_stream deflater;
+    bool deflater_initialised;
+    z_stream inflater;
+    bool inflater_initialised;
+
+    uint64_t raw_bytes_sent;
+    uint64_t wire_bytes_sent;
+    uint64_t raw_bytes_received;
+    uint64_t wire_bytes_received;
+    uint64_t messages_compressed;
+    uint64_t messages_uncompressed;
+} wsDeflate;
+
+void wsDeflateConfigure(wsDeflate* d, bool on_off, uint8_t window_bits, bool context_takeover, size_t threshold);
+
+char* wsDeflateOffer(const wsDeflate* d);
+
+int wsDeflateAccept(wsDeflate* d, const char* extensions);
+
+int wsDeflateCompress(wsDeflate* d, const char* in, size_t in_length, unsigned char** out, size_t* out_length);
+
+int wsDeflateDecompress(wsDeflate* d, const unsigned char* in, size_t in_length, char** out, size_t* out_length,
+                        size_t max_length);
+
+void wsDeflateReset(wsDeflate* d);
+
+#endif /* SRC_WEBSOCKET_DEFLATE_H_ */
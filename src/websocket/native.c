@@ -0,0 +1,1165 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file native.c
+* @brief source file for the native (epoll based) websocket transport
+*
+* RFC 6455 client framing on a non-blocking socket. Frames are sent with writev (header and masked payload), the
+* receive and send buffers are kept for the lifetime of the connection.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "native.h"
+#include "shared.h"
+
+#ifdef WS_NATIVE_AVAILABLE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/random.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/rand.h>
+#endif
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define WS_MAX_HEADER_LENGTH 14
+
+/* SHA-1 (RFC 3174), only used for Sec-WebSocket-Accept */
+static uint32_t wsNativeRol(uint32_t v, int s) {
+    return (v << s) | (v >> (32 - s));
+}
+
+static void wsNativeSha1Block(uint32_t h[5], const unsigned char* p) {
+    uint32_t w[80], a, b, c, d, e, f, k, t;
+    int i;
+
+    for (i = 0; i < 16; ++i)
+        w[i] = (uint32_t) p[4 * i] << 24 | (uint32_t) p[4 * i + 1] << 16 | (uint32_t) p[4 * i + 2] << 8 | p[4 * i + 3];
+    for (; i < 80; ++i)
+        w[i] = wsNativeRol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4];
+
+    for (i = 0; i < 80; ++i) {
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        t = wsNativeRol(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = wsNativeRol(b, 30); b = a; a = t;
+    }
+
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void wsNativeSha1(const unsigned char* data, size_t length, unsigned char digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    unsigned char block[64];
+    size_t i = 0;
+    int j;
+
+    for (; i + 64 <= length; i += 64) wsNativeSha1Block(h, data + i);
+
+    size_t rest = length - i;
+    memset(block, 0, sizeof(block));
+    memcpy(block, data + i, rest);
+    block[rest] = 0x80;
+
+    if (rest >= 56) {
+        wsNativeSha1Block(h, block);
+        memset(block, 0, sizeof(block));
+    }
+
+    uint64_t bits = (uint64_t) length * 8;
+    for (j = 0; j < 8; ++j) block[63 - j] = (unsigned char) (bits >> (8 * j));
+    wsNativeSha1Block(h, block);
+
+    for (j = 0; j < 5; ++j) {
+        digest[4 * j] = (unsigned char) (h[j] >> 24);
+        digest[4 * j + 1] = (unsigned char) (h[j] >> 16);
+        digest[4 * j + 2] = (unsigned char) (h[j] >> 8);
+        digest[4 * j + 3] = (unsigned char) h[j];
+    }
+}
+
+static void wsNativeBase64(const unsigned char* in, size_t length, char* out) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i;
+
+    for (i = 0; i + 2 < length; i += 3) {
+        *out++ = table[in[i] >> 2];
+        *out++ = table[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+        *out++ = table[((in[i + 1] & 0x0f) << 2) | (in[i + 2] >> 6)];
+        *out++ = table[in[i + 2] & 0x3f];
+    }
+
+    if (length - i == 1) {
+        *out++ = table[in[i] >> 2];
+        *out++ = table[(in[i] & 0x03) << 4];
+        *out++ = '=';
+        *out++ = '=';
+    } else if (length - i == 2) {
+        *out++ = table[in[i] >> 2];
+        *out++ = table[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+        *out++ = table[(in[i + 1] & 0x0f) << 2];
+        *out++ = '=';
+    }
+
+    *out = 0;
+}
+
+void wsNativeAcceptKey(const char* key, char accept[29]) {
+    char buffer[64 + sizeof(WS_GUID)];
+    unsigned char digest[20];
+
+    size_t l = strlen(key);
+    if (l > 64) l = 64;
+
+    memcpy(buffer, key, l);
+    memcpy(&buffer[l], WS_GUID, strlen(WS_GUID));
+
+    wsNativeSha1((unsigned char*) buffer, l + strlen(WS_GUID), digest);
+    wsNativeBase64(digest, sizeof(digest), accept);
+}
+
+/* masking keys and the handshake nonce have to be unpredictable (RFC 6455 5.3, 4.1), they are taken from the
+ * system's random source, which fills a small pool of bytes at a time; returns -1 if it has failed */
+static int wsNativeRandom(wsNative* n, unsigned char* out, size_t length) {
+    if (length > sizeof(n->random)) return -1;
+
+    if (sizeof(n->random) - n->random_used < length) {
+#ifdef WS_NATIVE_OPENSSL
+        if (RAND_bytes(n->random, (int) sizeof(n->random)) != 1) return -1;
+#else
+        size_t filled = 0;
+        while (filled < sizeof(n->random)) {
+            ssize_t r = getrandom(&n->random[filled], sizeof(n->random) - filled, 0);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) return -1;
+            filled += (size_t) r;
+        }
+#endif
+        n->random_used = 0;
+    }
+
+    memcpy(out, &n->random[n->random_used], length);
+    /* bytes handed out aren't kept in memory */
+    memset(&n->random[n->random_used], 0, length);
+    n->random_used += length;
+
+    return 0;
+}
+
+void wsNativeMask(unsigned char* dst, const unsigned char* src, size_t length, const unsigned char mask[4]) {
+    uint32_t m32;
+    memcpy(&m32, mask, 4);
+    uint64_t m64 = ((uint64_t) m32 << 32) | m32;
+
+    /* all block sizes are multiples of 4, so the mask stays aligned to the payload offset */
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128i m128 = _mm_set1_epi32((int) m32);
+    for (; i + 16 <= length; i += 16)
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_xor_si128(_mm_loadu_si128((const __m128i*) (src + i)), m128));
+#endif
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t v;
+        memcpy(&v, src + i, 8);
+        v ^= m64;
+        memcpy(dst + i, &v, 8);
+    }
+
+    for (; i < length; ++i) dst[i] = src[i] ^ mask[i & 3];
+}
+
+static void* wsNativeGrow(wsNative* n, void* buffer, size_t* size, size_t needed) {
+    if (*size >= needed) return buffer;
+    if (n->static_buffers) return NULL;
+
+    size_t s = *size ? *size : 256;
+    while (s < needed) s *= 2;
+
+    void* ret = realloc(buffer, s);
+    if (ret != NULL) *size = s;
+
+    return ret;
+}
+
+static void wsNativeCompact(wsNative* n) {
+    if (n->rx_start == 0) return;
+
+    memmove(n->rx, n->rx + n->rx_start, n->rx_used - n->rx_start);
+    n->rx_used -= n->rx_start;
+    n->rx_start = 0;
+}
+
+static bool wsNativeWatch(wsNative* n, uint32_t events) {
+    if (n->epoll_events == events) return true;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = n;
+
+    if (epoll_ctl(n->epfd, EPOLL_CTL_MOD, n->fd, &ev) != 0) return false;
+    n->epoll_events = events;
+
+    return true;
+}
+
+static bool wsNativeWait(wsNative* n, uint32_t events, int timeout_ms) {
+    if (!wsNativeWatch(n, events)) return false;
+
+    struct epoll_event ready;
+    int r;
+    do {
+        r = epoll_wait(n->epfd, &ready, 1, timeout_ms);
+    } while (r < 0 && errno == EINTR);
+
+    return r > 0;
+}
+
+/* returns the number of bytes, 0 if the socket would block, -1 on error or closed connection */
+static ssize_t wsNativeRead(wsNative* n, void* buffer, size_t length) {
+#ifdef WS_NATIVE_OPENSSL
+    if (n->ssl != NULL) {
+        int r = SSL_read(n->ssl, buffer, (int) length);
+        if (r > 0) return r;
+
+        int err = SSL_get_error(n->ssl, r);
+        return (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) ? 0 : -1;
+    }
+#endif
+
+    ssize_t r = recv(n->fd, buffer, length, 0);
+    if (r > 0) return r;
+
+    return (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) ? 0 : -1;
+}
+
+static ssize_t wsNativeWrite(wsNative* n, const void* buffer, size_t length) {
+#ifdef WS_NATIVE_OPENSSL
+    if (n->ssl != NULL) {
+        int r = SSL_write(n->ssl, buffer, (int) length);
+        if (r > 0) return r;
+
+        int err = SSL_get_error(n->ssl, r);
+        return (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) ? 0 : -1;
+    }
+#endif
+
+    ssize_t r = send(n->fd, buffer, length, MSG_NOSIGNAL);
+    if (r >= 0) return r;
+
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+}
+
+/* writes all buffers, waiting up to timeout_ms whenever the socket buffer is full; returns 0 once everything has been
+ * written, 1 if the socket stayed full and -1 on error, written tells how many bytes went out */
+static int wsNativeWriteAll(wsNative* n, struct iovec* iov, int iovcnt, int timeout_ms, size_t* written) {
+    *written = 0;
+
+    while (iovcnt > 0) {
+        if (iov[0].iov_len == 0) {
+            ++iov;
+            --iovcnt;
+            continue;
+        }
+
+        ssize_t w;
+
+#ifdef WS_NATIVE_OPENSSL
+        if (n->ssl != NULL) {
+            w = wsNativeWrite(n, iov[0].iov_base, iov[0].iov_len);
+        } else
+#endif
+        {
+            w = writev(n->fd, iov, iovcnt);
+            if (w < 0) w = (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+        }
+
+        if (w < 0) return -1;
+
+        if (w == 0) {
+            /* readable data must not end the wait, only room in the socket buffer (or an error) does */
+            if (timeout_ms > 0 && wsNativeWait(n, EPOLLOUT, timeout_ms)) continue;
+
+            /* woken by either, so the rest is written as soon as there is room */
+            wsNativeWatch(n, EPOLLIN | EPOLLOUT);
+            return 1;
+        }
+
+        *written += (size_t) w;
+
+        while (iovcnt > 0 && (size_t) w >= iov[0].iov_len) {
+            w -= iov[0].iov_len;
+            ++iov;
+            --iovcnt;
+        }
+
+        if (iovcnt > 0) {
+            iov[0].iov_base = (char*) iov[0].iov_base + w;
+            iov[0].iov_len -= w;
+        }
+    }
+
+    /* an open connection is watched for incoming data only, see wsNativePollFd */
+    wsNativeWatch(n, EPOLLIN);
+
+    return 0;
+}
+
+/* moves what hasn't been written of a frame to the start of tx; a TLS record has to be retried with the same bytes, and
+ * the deflate context already covers them, so a frame once started is always finished */
+static void wsNativeKeepPending(wsNative* n, const struct iovec* iov, int iovcnt, size_t written) {
+    unsigned char* to = n->tx;
+    int i;
+
+    for (i = 0; i < iovcnt; ++i) {
+        if (written >= iov[i].iov_len) {
+            written -= iov[i].iov_len;
+            continue;
+        }
+
+        size_t l = iov[i].iov_len - written;
+        memmove(to, (const unsigned char*) iov[i].iov_base + written, l);
+        to += l;
+        written = 0;
+    }
+
+    n->tx_pending = (size_t) (to - n->tx);
+}
+
+/* returns 0 if no frame is pending anymore, 1 if the socket is still full, -1 on error */
+static int wsNativeFlushPending(wsNative* n, int timeout_ms) {
+    if (n->tx_pending == 0) return 0;
+
+    struct iovec iov[1];
+    size_t written;
+
+    iov[0].iov_base = n->tx;
+    iov[0].iov_len = n->tx_pending;
+
+    int r = wsNativeWriteAll(n, iov, 1, timeout_ms, &written);
+    if (r < 0) return -1;
+
+    iov[0].iov_base = n->tx;
+    iov[0].iov_len = n->tx_pending;
+    wsNativeKeepPending(n, iov, 1, written);
+
+    return r;
+}
+
+static void wsNativeClose(wsNative* n) {
+    if (n->fd >= 0) {
+        if (n->epfd >= 0) epoll_ctl(n->epfd, EPOLL_CTL_DEL, n->fd, NULL);
+
+#ifdef WS_NATIVE_OPENSSL
+        if (n->ssl != NULL) {
+            if (n->state == WSN_OPEN) SSL_shutdown(n->ssl);
+            SSL_free(n->ssl);
+            n->ssl = NULL;
+        }
+#endif
+
+        close(n->fd);
+        n->fd = -1;
+    }
+
+    free(n->request);
+    n->request = NULL;
+
+    n->rx_start = 0;
+    n->rx_used = 0;
+    n->msg_fragmented = false;
+    n->tx_pending = 0;
+    n->epoll_events = 0;
+
+    n->state = WSN_CLOSED;
+}
+
+wsNative* wsNativeConstr(wsDeflate* deflate, int (*debugFunction_)(const char*, ...)) {
+    wsNative* ret = (wsNative*) calloc(1, sizeof(wsNative));
+    if (ret == NULL) return NULL;
+
+    ret->state = WSN_CLOSED;
+    ret->fd = -1;
+    ret->epfd = -1;
+    ret->tls_verify = true;
+    ret->tls_resumption = true;
+
+    ret->deflate = deflate;
+    ret->debugFunction = debugFunction_;
+    ret->random_used = sizeof(ret->random);
+
+    return ret;
+}
+
+void wsNativeDestr(wsNative* prey) {
+    if (prey == NULL) return;
+
+    wsNativeDeinitialise(prey);
+
+    if (!prey->static_buffers) {
+        free(prey->rx);
+        free(prey->msg);
+        free(prey->tx);
+    }
+    free(prey->msg_lent);
+    free(prey);
+}
+
+static size_t wsNativeStaticRxSize(size_t message_size) {
+    size_t s = message_size + WS_MAX_HEADER_LENGTH;
+
+    return s > WS_NATIVE_MAX_HANDSHAKE_SIZE ? s : WS_NATIVE_MAX_HANDSHAKE_SIZE;
+}
+
+size_t wsNativeStaticBuffersSize(size_t message_size) {
+    return wsNativeStaticRxSize(message_size) + (message_size + 1) + (message_size + WS_MAX_HEADER_LENGTH);
+}
+
+int wsNativeSetStaticBuffers(wsNative* n, void* memory, size_t message_size) {
+    if (n->state != WSN_CLOSED || memory == NULL) return -1;
+
+    if (!n->static_buffers) {
+        free(n->rx);
+        free(n->msg);
+        free(n->tx);
+    }
+
+    /* received frames, reassembled messages and sent frames never outgrow these, larger messages close the connection */
+    n->rx = (unsigned char*) memory;
+    n->rx_size = wsNativeStaticRxSize(message_size);
+    n->msg = (char*) n->rx + n->rx_size;
+    n->msg_size = message_size + 1;
+    n->tx = (unsigned char*) n->msg + n->msg_size;
+    n->tx_size = message_size + WS_MAX_HEADER_LENGTH;
+
+    n->rx_start = 0;
+    n->rx_used = 0;
+    n->msg_used = 0;
+    n->static_buffers = true;
+
+    return 0;
+}
+
+int wsNativeInitialise(wsNative* n, bool tls, const char* client_cert, const char* client_key, const char* ca_cert) {
+    if (n->epfd < 0) n->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (n->epfd < 0) return -1;
+
+    if (n->rx == NULL) {
+        n->rx = (unsigned char*) malloc(WS_NATIVE_RX_BUFFER_SIZE);
+        if (n->rx == NULL) return -1;
+        n->rx_size = WS_NATIVE_RX_BUFFER_SIZE;
+    }
+
+    n->flag_TLS = tls;
+    if (!tls) return 0;
+
+#ifdef WS_NATIVE_OPENSSL
+    if (n->ssl_ctx != NULL) return 0;
+
+    /* verification is set per connection, see wsNativeConnect */
+    n->ssl_ctx = wsSharedTLSContext(client_cert, client_key, ca_cert, true, n->debugFunction);
+
+    return n->ssl_ctx != NULL ? 0 : -1;
+#else
+    if (n->debugFunction != NULL)
+        n->debugFunction("Websocket: wsNativeInitialise: built without WS_NATIVE_OPENSSL, TLS not available\n");
+
+    return -1;
+#endif
+}
+
+void wsNativeDeinitialise(wsNative* n) {
+    wsNativeDisconnect(n);
+
+    if (n->epfd >= 0) close(n->epfd);
+    n->epfd = -1;
+
+#ifdef WS_NATIVE_OPENSSL
+    wsSharedTLSRelease(n->ssl_ctx);
+    n->ssl_ctx = NULL;
+
+    /* a session must not outlive the certificates it has been negotiated with */
+    if (n->ssl_session != NULL) SSL_SESSION_free(n->ssl_session);
+    n->ssl_session = NULL;
+#endif
+}
+
+int wsNativeConnect(wsNative* n, bool useIPv6, const char* address, const char* port, const char* hostname,
+                    const char* path, const char* origin) {
+    wsNativeClose(n);
+
+    if (n->epfd < 0) return -1;
+
+    struct addrinfo hints, *res, *ai;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = useIPv6 ? AF_INET6 : AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int r = getaddrinfo(address, port, &hints, &res);
+    if (r != 0) {
+        if (n->debugFunction != NULL)
+            n->debugFunction("Websocket: wsNativeConnect: resolving %s failed: %s\n", address, gai_strerror(r));
+        return -1;
+    }
+
+    int fd = -1;
+    for (ai = res; ai != NULL; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) continue;
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0 || errno == EINPROGRESS) break;
+
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+
+    if (fd < 0) return -1;
+
+    n->fd = fd;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLOUT;
+    ev.data.ptr = n;
+    epoll_ctl(n->epfd, EPOLL_CTL_ADD, fd, &ev);
+    n->epoll_events = EPOLLOUT;
+
+#ifdef WS_NATIVE_OPENSSL
+    if (n->flag_TLS) {
+        if (n->ssl_ctx == NULL || (n->ssl = SSL_new(n->ssl_ctx)) == NULL) {
+            wsNativeClose(n);
+            return -1;
+        }
+
+        SSL_set_fd(n->ssl, fd);
+        SSL_set_tlsext_host_name(n->ssl, hostname);
+
+        wsSharedTLSSessionSlot(n->ssl, &n->ssl_session);
+        if (n->tls_resumption && n->ssl_session != NULL && SSL_SESSION_is_resumable(n->ssl_session))
+            SSL_set_session(n->ssl, n->ssl_session);
+
+        if (n->tls_verify) {
+            SSL_set_verify(n->ssl, SSL_VERIFY_PEER, NULL);
+            SSL_set1_host(n->ssl, hostname);
+        } else {
+            SSL_set_verify(n->ssl, SSL_VERIFY_NONE, NULL);
+        }
+    }
+#endif
+
+    unsigned char nonce[16];
+    if (wsNativeRandom(n, nonce, sizeof(nonce)) != 0) {
+        if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeConnect: no random bytes for the key\n");
+        wsNativeClose(n);
+        return -1;
+    }
+    wsNativeBase64(nonce, sizeof(nonce), n->key);
+
+    char* offer = NULL;
+    if (n->deflate != NULL) {
+        wsDeflateReset(n->deflate);
+        offer = wsDeflateOffer(n->deflate);
+    }
+
+    n->request_length = strlen(path) + strlen(hostname) + strlen(port) + (origin ? strlen(origin) : 0) +
+                        (offer ? strlen(offer) : 0) + 256;
+    n->request = (char*) malloc(n->request_length);
+
+    if (n->request != NULL) {
+        n->request_length = (size_t) snprintf(n->request, n->request_length,
+                                              "GET %s HTTP/1.1\r\n"
+                                              "Host: %s:%s\r\n"
+                                              "Upgrade: websocket\r\n"
+                                              "Connection: Upgrade\r\n"
+                                              "Sec-WebSocket-Key: %s\r\n"
+                                              "Sec-WebSocket-Version: 13\r\n"
+                                              "%s%s%s"
+                                              "%s%s%s"
+                                              "\r\n",
+                                              path, hostname, port, n->key,
+                                              origin ? "Origin: " : "", origin ? origin : "", origin ? "\r\n" : "",
+                                              offer ? "Sec-WebSocket-Extensions: " : "", offer ? offer : "",
+                                              offer ? "\r\n" : "");
+    }
+    n->request_sent = 0;
+
+    free(offer);
+
+    if (n->request == NULL) {
+        wsNativeClose(n);
+        return -1;
+    }
+
+    n->state = WSN_CONNECTING;
+
+    return 0;
+}
+
+/* returns 1 on success, 0 if the response is incomplete, -1 if the upgrade was refused */
+static int wsNativeParseResponse(wsNative* n) {
+    char* end = memmem(n->rx, n->rx_used, "\r\n\r\n", 4);
+    if (end == NULL) return 0;
+
+    size_t header_length = (size_t) (end - (char*) n->rx) + 4;
+    char* header = strndup((char*) n->rx, header_length);
+    if (header == NULL) return -1;
+
+    n->rx_start = header_length;
+
+    if (strncmp(header, "HTTP/1.1 101", 12) != 0) {
+        if (n->debugFunction != NULL) {
+            char* eol = strstr(header, "\r\n");
+            if (eol != NULL) *eol = 0;
+            n->debugFunction("Websocket: wsNativeConnect: upgrade refused: %s\n", header);
+        }
+        free(header);
+        return -1;
+    }
+
+    char accept[29];
+    wsNativeAcceptKey(n->key, accept);
+
+    bool accepted = false;
+    int ret = 1;
+
+    char* line = strstr(header, "\r\n") + 2;
+    char* eol;
+    while ((eol = strstr(line, "\r\n")) != NULL && eol != line) {
+        *eol = 0;
+
+        char* value = strchr(line, ':');
+        if (value != NULL) {
+            *value++ = 0;
+            while (*value == ' ' || *value == '\t') ++value;
+
+            char* v_end = value + strlen(value);
+            while (v_end > value && (v_end[-1] == ' ' || v_end[-1] == '\t')) *--v_end = 0;
+
+            if (strcasecmp(line, "Sec-WebSocket-Accept") == 0) {
+                accepted = strcmp(value, accept) == 0;
+            } else if (strcasecmp(line, "Sec-WebSocket-Extensions") == 0) {
+                /* without a deflate context no extension has been offered */
+                if (n->deflate == NULL ? *value != 0 : wsDeflateAccept(n->deflate, value) != 0) ret = -1;
+            }
+        }
+
+        line = eol + 2;
+    }
+
+    free(header);
+
+    if (!accepted) {
+        if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeConnect: invalid Sec-WebSocket-Accept\n");
+        return -1;
+    }
+
+    return ret;
+}
+
+/* advances connect, TLS handshake and upgrade; returns 1 when open, 0 while waiting for events, -1 on failure */
+static int wsNativeProgress(wsNative* n, uint32_t* events) {
+    for (;;) {
+        switch (n->state) {
+            case WSN_CONNECTING: {
+                if (!wsNativeWait(n, EPOLLOUT, 0)) {
+                    *events = EPOLLOUT;
+                    return 0;
+                }
+
+                int err = 0;
+                socklen_t l = sizeof(err);
+                if (getsockopt(n->fd, SOL_SOCKET, SO_ERROR, &err, &l) != 0 || err != 0) return -1;
+
+#ifdef WS_NATIVE_OPENSSL
+                n->state = n->ssl != NULL ? WSN_TLS_HANDSHAKE : WSN_HTTP_REQUEST;
+#else
+                n->state = WSN_HTTP_REQUEST;
+#endif
+                break;
+            }
+            case WSN_TLS_HANDSHAKE: {
+#ifdef WS_NATIVE_OPENSSL
+                int r = SSL_connect(n->ssl);
+                if (r == 1) {
+                    n->tls_resumed = SSL_session_reused(n->ssl) == 1;
+                    n->tls_handshakes++;
+                    if (n->tls_resumed) n->tls_handshakes_resumed++;
+
+                    if (n->debugFunction != NULL)
+                        n->debugFunction("Websocket: wsNative: TLS handshake %s\n", n->tls_resumed ? "resumed" : "full");
+
+                    n->state = WSN_HTTP_REQUEST;
+                    break;
+                }
+
+                int err = SSL_get_error(n->ssl, r);
+                if (err == SSL_ERROR_WANT_READ) {
+                    *events = EPOLLIN;
+                    return 0;
+                }
+                if (err == SSL_ERROR_WANT_WRITE) {
+                    *events = EPOLLOUT;
+                    return 0;
+                }
+#endif
+                return -1;
+            }
+            case WSN_HTTP_REQUEST: {
+                ssize_t w = wsNativeWrite(n, n->request + n->request_sent, n->request_length - n->request_sent);
+                if (w < 0) return -1;
+                if (w == 0) {
+                    *events = EPOLLOUT;
+                    return 0;
+                }
+
+                n->request_sent += (size_t) w;
+                if (n->request_sent == n->request_length) {
+                    free(n->request);
+                    n->request = NULL;
+                    n->state = WSN_HTTP_RESPONSE;
+                }
+                break;
+            }
+            case WSN_HTTP_RESPONSE: {
+                if (n->rx_used >= WS_NATIVE_MAX_HANDSHAKE_SIZE) return -1;
+
+                ssize_t r = wsNativeRead(n, n->rx + n->rx_used, WS_NATIVE_MAX_HANDSHAKE_SIZE - n->rx_used);
+                if (r < 0) return -1;
+                if (r == 0) {
+                    *events = EPOLLIN;
+                    return 0;
+                }
+
+                n->rx_used += (size_t) r;
+
+                int h = wsNativeParseResponse(n);
+                if (h < 0) return -1;
+                if (h > 0) {
+                    n->state = WSN_OPEN;
+                    wsNativeWatch(n, EPOLLIN);
+                }
+                break;
+            }
+            case WSN_OPEN:
+                return 1;
+            default:
+                return -1;
+        }
+    }
+}
+
+bool wsNativeIsConnectionReady(wsNative* n, uint32_t timeout_in_us) {
+    if (n->state == WSN_OPEN) return true;
+    if (n->state == WSN_CLOSED) return false;
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (;;) {
+        uint32_t events = 0;
+        int r = wsNativeProgress(n, &events);
+
+        if (r > 0) return true;
+
+        if (r < 0) {
+            if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeIsConnectionReady: handshake failed\n");
+            wsNativeClose(n);
+            return false;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t elapsed = (int64_t) (now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+        if (elapsed >= (int64_t) timeout_in_us) return false;
+
+        if (!wsNativeWait(n, events, (int) ((timeout_in_us - elapsed + 999) / 1000))) return false;
+    }
+}
+
+bool wsNativeIsConnectionOK(wsNative* n) {
+    return n->state == WSN_OPEN;
+}
+
+int wsNativeSend(wsNative* n, uint8_t opcode, const char* payload, size_t length) {
+    return wsNativeSendFrame(n, opcode, true, payload, length);
+}
+
+int wsNativeSendFrame(wsNative* n, uint8_t opcode, bool fin, const char* payload, size_t length) {
+    if (n->state != WSN_OPEN) return -1;
+
+    /* the socket still hasn't taken the former frame, this one is not sent and may be tried again */
+    int pending = wsNativeFlushPending(n, WS_NATIVE_FLUSH_TIMEOUT_MS);
+    if (pending != 0) {
+        if (n->debugFunction != NULL)
+            n->debugFunction("Websocket: wsNativeSend: %s\n", pending < 0 ? "connection lost" : "socket full, would block");
+        if (pending < 0) wsNativeClose(n);
+        return -1;
+    }
+
+    /* taken before compressing, which can't be undone */
+    unsigned char mask[4];
+    if (wsNativeRandom(n, mask, sizeof(mask)) != 0) return -1;
+
+    unsigned char* compressed = NULL;
+    bool rsv1 = false;
+
+    /* fragmented messages are sent uncompressed, the frames are written before the end of the message is known */
+    if (fin && (opcode == WS_OPCODE_TEXT || opcode == WS_OPCODE_BINARY) && n->deflate != NULL) {
+        size_t compressed_length;
+        int c = wsDeflateCompress(n->deflate, payload, length, &compressed, &compressed_length);
+        if (c < 0) return -1;
+        if (c == 1) {
+            payload = (const char*) compressed;
+            length = compressed_length;
+            rsv1 = true;
+        }
+    }
+
+    unsigned char* tx = wsNativeGrow(n, n->tx, &n->tx_size, length + WS_MAX_HEADER_LENGTH);
+    if (tx == NULL) {
+        free(compressed);
+        return -1;
+    }
+    n->tx = tx;
+
+    unsigned char header[WS_MAX_HEADER_LENGTH];
+    size_t header_length;
+    int i;
+
+    header[0] = (unsigned char) ((fin ? 0x80 : 0) | (rsv1 ? 0x40 : 0) | opcode);
+
+    if (length < 126) {
+        header[1] = (unsigned char) (0x80 | length);
+        header_length = 2;
+    } else if (length < 65536) {
+        header[1] = 0x80 | 126;
+        header[2] = (unsigned char) (length >> 8);
+        header[3] = (unsigned char) length;
+        header_length = 4;
+    } else {
+        header[1] = 0x80 | 127;
+        for (i = 0; i < 8; ++i) header[2 + i] = (unsigned char) ((uint64_t) length >> (56 - 8 * i));
+        header_length = 10;
+    }
+
+    memcpy(&header[header_length], mask, 4);
+    header_length += 4;
+
+    /* the payload is masked behind a headroom, so TLS can send header and payload as one record */
+    wsNativeMask(n->tx + WS_MAX_HEADER_LENGTH, (const unsigned char*) payload, length, &header[header_length - 4]);
+    free(compressed);
+
+    struct iovec iov[2];
+    int iovcnt;
+
+    if (n->flag_TLS) {
+        memcpy(n->tx + WS_MAX_HEADER_LENGTH - header_length, header, header_length);
+        iov[0].iov_base = n->tx + WS_MAX_HEADER_LENGTH - header_length;
+        iov[0].iov_len = header_length + length;
+        iovcnt = 1;
+    } else {
+        iov[0].iov_base = header;
+        iov[0].iov_len = header_length;
+        iov[1].iov_base = n->tx + WS_MAX_HEADER_LENGTH;
+        iov[1].iov_len = length;
+        iovcnt = 2;
+    }
+
+    struct iovec frame[2];
+    size_t written;
+
+    memcpy(frame, iov, sizeof(frame));
+
+    int w = wsNativeWriteAll(n, iov, iovcnt, WS_NATIVE_FLUSH_TIMEOUT_MS, &written);
+    if (w < 0) {
+        if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeSend: connection lost\n");
+        wsNativeClose(n);
+        return -1;
+    }
+
+    /* the rest goes out before the next frame or with the next read, see wsNativeFlushPending */
+    if (w > 0) {
+        wsNativeKeepPending(n, frame, iovcnt, written);
+        if (n->debugFunction != NULL)
+            n->debugFunction("Websocket: wsNativeSend: socket full, %zu bytes pending\n", n->tx_pending);
+    }
+
+    return 0;
+}
+
+/* fails the connection on a protocol error of the server with a close frame carrying 1002 (RFC 6455 7.4.1) */
+static int wsNativeProtocolError(wsNative* n, const char* reason) {
+    const char status[2] = {0x03, (char) 0xEA};
+
+    if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeParseFrame: protocol error, %s\n", reason);
+    wsNativeSend(n, WS_OPCODE_CLOSE, status, sizeof(status));
+
+    return -1;
+}
+
+/* returns 1 if a message is complete, 2 if a frame was consumed, 0 if more data is needed, -1 on error */
+static int wsNativeParseFrame(wsNative* n) {
+    unsigned char* p = n->rx + n->rx_start;
+    size_t available = n->rx_used - n->rx_start;
+
+    if (available < 2) return 0;
+
+    bool fin = (p[0] & 0x80) != 0;
+    bool rsv1 = (p[0] & 0x40) != 0;
+    uint8_t opcode = (uint8_t) (p[0] & 0x0f);
+
+    /* servers must not mask, RSV2 and RSV3 are not negotiated */
+    if ((p[1] & 0x80) || (p[0] & 0x30)) return wsNativeProtocolError(n, "masked frame or RSV2/RSV3 set");
+
+    /* RSV1 marks the first frame of a compressed message only (RFC 7692 6.1) */
+    if (rsv1 && opcode != WS_OPCODE_TEXT && opcode != WS_OPCODE_BINARY)
+        return wsNativeProtocolError(n, "RSV1 on a continuation or control frame");
+
+    uint64_t length = p[1] & 0x7f;
+    size_t header_length = 2;
+    int i;
+
+    if (length == 126) {
+        if (available < 4) return 0;
+        length = (uint64_t) p[2] << 8 | p[3];
+        header_length = 4;
+    } else if (length == 127) {
+        if (available < 10) return 0;
+        length = 0;
+        for (i = 0; i < 8; ++i) length = length << 8 | p[2 + i];
+        header_length = 10;
+    }
+
+    /* control frames can't be fragmented and carry at most 125 bytes (RFC 6455 5.5) */
+    if ((opcode & 0x8) && (!fin || length > 125)) return wsNativeProtocolError(n, "fragmented or oversized control frame");
+
+    if (length > WS_NATIVE_MAX_MESSAGE_SIZE) return -1;
+
+    if (available < header_length + length) {
+        if (n->rx_start + header_length + length > n->rx_size) {
+            wsNativeCompact(n);
+
+            unsigned char* rx = wsNativeGrow(n, n->rx, &n->rx_size, header_length + (size_t) length);
+            if (rx == NULL) return -1;
+            n->rx = rx;
+        }
+        return 0;
+    }
+
+    const char* payload = (const char*) p + header_length;
+    n->rx_start += header_length + (size_t) length;
+
+    switch (opcode) {
+        case WS_OPCODE_PING:
+            wsNativeSend(n, WS_OPCODE_PONG, payload, (size_t) length);
+            return 2;
+        case WS_OPCODE_PONG:
+            return 2;
+        case WS_OPCODE_CLOSE:
+            wsNativeSend(n, WS_OPCODE_CLOSE, payload, length >= 2 ? 2 : 0);
+            return -1;
+        case WS_OPCODE_TEXT:
+        case WS_OPCODE_BINARY:
+            if (n->msg_fragmented) return wsNativeProtocolError(n, "new message inside a fragmented one");
+            if (rsv1 && (n->deflate == NULL || !n->deflate->negotiated))
+                return wsNativeProtocolError(n, "RSV1 without permessage-deflate");
+            n->msg_used = 0;
+            n->msg_compressed = rsv1;
+            n->msg_binary = opcode == WS_OPCODE_BINARY;
+            break;
+        case WS_OPCODE_CONTINUATION:
+            if (!n->msg_fragmented) return wsNativeProtocolError(n, "continuation without a fragmented message");
+            break;
+        default:
+            return wsNativeProtocolError(n, "unknown opcode");
+    }
+
+    if (n->msg_used + length + 1 > WS_NATIVE_MAX_MESSAGE_SIZE) return -1;
+
+    char* msg = wsNativeGrow(n, n->msg, &n->msg_size, n->msg_used + (size_t) length + 1);
+    if (msg == NULL) return -1;
+    n->msg = msg;
+
+    memcpy(n->msg + n->msg_used, payload, (size_t) length);
+    n->msg_used += (size_t) length;
+
+    n->msg_fragmented = !fin;
+    if (!fin) return 2;
+
+    if (n->msg_compressed) {
+        char* out;
+        size_t out_length;
+
+        if (wsDeflateDecompress(n->deflate, (unsigned char*) n->msg, n->msg_used, &out, &out_length,
+                                WS_NATIVE_MAX_MESSAGE_SIZE) != 0)
+            return -1;
+
+        if (n->static_buffers) {
+            free(out);
+            return -1;
+        }
+
+        free(n->msg);
+        n->msg = out;
+        n->msg_size = out_length + 1;
+        n->msg_used = out_length;
+    }
+
+    n->msg[n->msg_used] = 0;
+
+    return 1;
+}
+
+char* wsNativeGetMsgContent(wsNative* n) {
+    if (n->state != WSN_OPEN) return NULL;
+
+    if (wsNativeFlushPending(n, 0) < 0) {
+        if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeGetMsgContent: connection lost\n");
+        wsNativeClose(n);
+        return NULL;
+    }
+
+    bool read_done = false;
+
+    for (;;) {
+        int r = wsNativeParseFrame(n);
+
+        if (r == 1) return n->msg;
+        if (r == 2) {
+            if (n->state != WSN_OPEN) return NULL;
+            continue;
+        }
+
+        if (r < 0) {
+            if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeGetMsgContent: connection closed\n");
+            wsNativeClose(n);
+            return NULL;
+        }
+
+        /* at most one read per call, buffered frames are returned by the following calls */
+        if (read_done) return NULL;
+
+        if (n->rx_start == n->rx_used) {
+            n->rx_start = 0;
+            n->rx_used = 0;
+        } else if (n->rx_used == n->rx_size) {
+            wsNativeCompact(n);
+        }
+
+        ssize_t got = wsNativeRead(n, n->rx + n->rx_used, n->rx_size - n->rx_used);
+        if (got < 0) {
+            if (n->debugFunction != NULL) n->debugFunction("Websocket: wsNativeGetMsgContent: connection lost\n");
+            wsNativeClose(n);
+            return NULL;
+        }
+        if (got == 0) return NULL;
+
+        n->rx_used += (size_t) got;
+        read_done = true;
+    }
+}
+
+char* wsNativeLendMsg(wsNative* n) {
+    /* static buffers can't be replaced, and one lent buffer covers a reader handling a message at a time */
+    if (n->static_buffers || n->msg_lent != NULL || n->msg == NULL) return NULL;
+
+    n->msg_lent = n->msg;
+    n->msg_lent_size = n->msg_size;
+    n->msg = NULL;
+    n->msg_size = 0;
+    n->msg_used = 0;
+
+    return n->msg_lent;
+}
+
+void wsNativeReturnMsg(wsNative* n, char* msg) {
+    if (msg == NULL || msg != n->msg_lent) return;
+
+    /* the buffer is taken back for the next message, unless one has been grown in the meantime */
+    if (n->msg == NULL) {
+        n->msg = msg;
+        n->msg_size = n->msg_lent_size;
+    } else {
+        free(msg);
+    }
+
+    n->msg_lent = NULL;
+    n->msg_lent_size = 0;
+}
+
+void wsNativeDisconnect(wsNative* n) {
+    if (n->state == WSN_OPEN) {
+        const char status[2] = {0x03, (char) 0xE8}; /* 1000, normal closure */
+        wsNativeSend(n, WS_OPCODE_CLOSE, status, sizeof(status));
+    }
+
+    wsNativeClose(n);
+}
+
+int wsNativePollFd(wsNative* n) {
+    return n->epfd;
+}
+
+void wsNativeSetTLSVerification(wsNative* n, bool on_off) {
+    n->tls_verify = on_off;
+}
+
+void wsNativeSetTLSSessionResumption(wsNative* n, bool on_off) {
+    n->tls_resumption = on_off;
+}
+
+#endif /* WS_NATIVE_AVAILABLE */
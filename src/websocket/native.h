@@ -0,0 +1,157 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file native.h
+* @brief header file for the native (epoll based) websocket transport
+*/
+
+#ifndef SRC_WEBSOCKET_NATIVE_H_
+#define SRC_WEBSOCKET_NATIVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
+#include "deflate.h"
+
+#if defined(__linux__)
+#define WS_NATIVE_AVAILABLE
+#endif
+
+#define WS_NATIVE_RX_BUFFER_SIZE 16384
+#define WS_NATIVE_MAX_MESSAGE_SIZE 16777216
+#define WS_NATIVE_MAX_HANDSHAKE_SIZE 8192
+#define WS_NATIVE_FLUSH_TIMEOUT_MS 100
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+enum wsNativeState {
+    WSN_CLOSED,
+    WSN_CONNECTING,
+    WSN_TLS_HANDSHAKE,
+    WSN_HTTP_REQUEST,
+    WSN_HTTP_RESPONSE,
+    WSN_OPEN
+};
+
+typedef struct {
+
+    enum wsNativeState state;
+
+    int fd;
+    int epfd;
+    uint32_t epoll_events;
+
+    bool flag_TLS;
+    bool tls_verify;
+    bool tls_resumption;
+    bool tls_resumed;/* last handshake resumed a session */
+    uint32_t tls_handshakes;
+    uint32_t tls_handshakes_resumed;
+#ifdef WS_NATIVE_OPENSSL
+    SSL_CTX* ssl_ctx;
+    SSL* ssl;
+    SSL_SESSION* ssl_session;/* latest session of the endpoint, offered on reconnect */
+#endif
+
+    char key[25];
+    unsigned char random[64];/* bytes of the system's random source for masking keys and the handshake nonce */
+    size_t random_used;
+
+    char* request;/* upgrade request, while it is sent */
+    size_t request_length;
+    size_t request_sent;
+
+    unsigned char* rx;/* bytes read from the socket, parsed from rx_start to rx_used */
+    size_t rx_size;
+    size_t rx_start;
+    size_t rx_used;
+
+    char* msg;/* reassembled message, valid until the next wsNativeGetMsgContent call */
+    size_t msg_size;
+    size_t msg_used;
+    bool msg_compressed;
+    bool msg_fragmented;
+    bool msg_binary;/* the message started with a binary frame */
+    char* msg_lent;/* former msg buffer handed over by wsNativeLendMsg, until wsNativeReturnMsg */
+    size_t msg_lent_size;
+
+    unsigned char* tx;/* masked payload of the frame being sent */
+    size_t tx_size;
+    size_t tx_pending;/* bytes of a frame at the start of tx the full socket hasn't taken yet, written before the next frame */
+
+    bool static_buffers;/* rx, msg and tx are given by the caller, they are neither grown nor free'd */
+
+    wsDeflate* deflate;
+
+    int (*debugFunction)(const char* format, ...);
+
+} wsNative;
+
+wsNative* wsNativeConstr(wsDeflate* deflate, int (*debugFunction_)(const char*, ...));
+
+void wsNativeDestr(wsNative* prey);
+
+int wsNativeInitialise(wsNative* n, bool tls, const char* client_cert, const char* client_key, const char* ca_cert);
+
+void wsNativeDeinitialise(wsNative* n);
+
+int wsNativeConnect(wsNative* n, bool useIPv6, const char* address, const char* port, const char* hostname,
+                    const char* path, const char* origin);
+
+bool wsNativeIsConnectionReady(wsNative* n, uint32_t timeout_in_us);
+
+bool wsNativeIsConnectionOK(wsNative* n);
+
+int wsNativeSend(wsNative* n, uint8_t opcode, const char* payload, size_t length);
+
+/* a single frame, fin cleared for all but the last frame of a fragmented message */
+int wsNativeSendFrame(wsNative* n, uint8_t opcode, bool fin, const char* payload, size_t length);
+
+char* wsNativeGetMsgContent(wsNative* n);
+
+/* hands the buffer of the message returned last over to the caller, NULL if another one is still lent */
+char* wsNativeLendMsg(wsNative* n);
+
+void wsNativeReturnMsg(wsNative* n, char* msg);
+
+void wsNativeDisconnect(wsNative* n);
+
+int wsNativePollFd(wsNative* n);
+
+void wsNativeSetTLSVerification(wsNative* n, bool on_off);
+
+void wsNativeSetTLSSessionResumption(wsNative* n, bool on_off);
+
+size_t wsNativeStaticBuffersSize(size_t message_size);
+
+int wsNativeSetStaticBuffers(wsNative* n, void* memory, size_t message_size);
+
+void wsNativeMask(unsigned char* dst, const unsigned char* src, size_t length, const unsigned char mask[4]);
+
+void wsNativeAcceptKey(const char* key, char accept[29]);
+
+#endif /* SRC_WEBSOCKET_NATIVE_H_ */
@@ -0,0 +1,377 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file shared.c
+* @brief source file for the transport state shared by all websocket connections of a process
+*/
+
+#include "shared.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+
+static pthread_mutex_t wsSharedMutex = PTHREAD_MUTEX_INITIALIZER;
+#define wsSharedLock() pthread_mutex_lock(&wsSharedMutex)
+#define wsSharedUnlock() pthread_mutex_unlock(&wsSharedMutex)
+#else
+#include <windows.h>
+
+static SRWLOCK wsSharedMutex = SRWLOCK_INIT;
+#define wsSharedLock() AcquireSRWLockExclusive(&wsSharedMutex)
+#define wsSharedUnlock() ReleaseSRWLockExclusive(&wsSharedMutex)
+#endif
+
+static uint32_t wsSharedRefs = 0;
+static bool wsSharedLibraryUsed = false;/* nopoll_cleanup_library is due, once the last reference is gone */
+static noPollCtx* wsSharedCtx = NULL;
+
+#ifdef WS_NATIVE_OPENSSL
+typedef struct wsSharedTLSEntry {
+    char* client_cert;
+    char* client_key;
+    char* ca_cert;
+    bool verify;
+
+    SSL_CTX* ctx;
+    uint32_t refs;
+
+    struct wsSharedTLSEntry* next;
+} wsSharedTLSEntry;
+
+/* nopoll only hands the connection options to the context creator, so the options are mapped to their context */
+typedef struct wsSharedTLSBinding {
+    const noPollConnOpts* opts;
+    SSL_CTX* ctx;
+
+    struct wsSharedTLSBinding* next;
+} wsSharedTLSBinding;
+
+static wsSharedTLSEntry* wsSharedTLSEntries = NULL;
+static wsSharedTLSBinding* wsSharedTLSBindings = NULL;
+static int wsSharedTLSSessionIndex = -1;
+#endif
+
+/* nopoll only protects its contexts and connections, if mutex handlers are installed before the first context */
+#ifndef _WIN32
+static noPollPtr wsSharedMutexCreate() {
+    pthread_mutex_t* m = (pthread_mutex_t*) malloc(sizeof(pthread_mutex_t));
+    if (m != NULL) pthread_mutex_init(m, NULL);
+    return m;
+}
+
+static void wsSharedMutexDestroy(noPollPtr m) {
+    if (m == NULL) return;
+    pthread_mutex_destroy((pthread_mutex_t*) m);
+    free(m);
+}
+
+static void wsSharedMutexLock(noPollPtr m) {
+    if (m != NULL) pthread_mutex_lock((pthread_mutex_t*) m);
+}
+
+static void wsSharedMutexUnlock(noPollPtr m) {
+    if (m != NULL) pthread_mutex_unlock((pthread_mutex_t*) m);
+}
+#else
+static noPollPtr wsSharedMutexCreate() {
+    return CreateMutex(NULL, FALSE, NULL);
+}
+
+static void wsSharedMutexDestroy(noPollPtr m) {
+    if (m != NULL) CloseHandle((HANDLE) m);
+}
+
+static void wsSharedMutexLock(noPollPtr m) {
+    if (m != NULL) WaitForSingleObject((HANDLE) m, INFINITE);
+}
+
+static void wsSharedMutexUnlock(noPollPtr m) {
+    if (m != NULL) ReleaseMutex((HANDLE) m);
+}
+#endif
+
+#ifdef WS_NATIVE_OPENSSL
+static noPollPtr wsSharedTLSCreator(noPollCtx* ctx, noPollConn* conn, noPollConnOpts* opts, nopoll_bool is_client,
+                                    noPollPtr user_data) {
+    SSL_CTX* ret = NULL;
+    wsSharedTLSBinding* b;
+
+    wsSharedLock();
+    for (b = wsSharedTLSBindings; b != NULL; b = b->next) {
+        if (b->opts == opts) {
+            ret = b->ctx;
+            /* nopoll frees the context together with the connection */
+            SSL_CTX_up_ref(ret);
+            break;
+        }
+    }
+    wsSharedUnlock();
+
+    return ret;
+}
+#endif
+
+/* called with the lock held */
+static void wsSharedNopollPrepare() {
+    if (wsSharedLibraryUsed) return;
+
+    nopoll_thread_handlers(wsSharedMutexCreate, wsSharedMutexDestroy, wsSharedMutexLock, wsSharedMutexUnlock);
+    wsSharedLibraryUsed = true;
+}
+
+void wsSharedRef() {
+    wsSharedLock();
+    wsSharedRefs++;
+    wsSharedUnlock();
+}
+
+void wsSharedUnref() {
+    wsSharedLock();
+
+    if (wsSharedRefs > 0) wsSharedRefs--;
+
+    if (wsSharedRefs == 0) {
+        if (wsSharedCtx != NULL) nopoll_ctx_unref(wsSharedCtx);
+        wsSharedCtx = NULL;
+
+        if (wsSharedLibraryUsed) nopoll_cleanup_library();
+        wsSharedLibraryUsed = false;
+    }
+
+    wsSharedUnlock();
+}
+
+noPollCtx* wsSharedNopollCtx() {
+    wsSharedLock();
+
+    if (wsSharedCtx == NULL) {
+        wsSharedNopollPrepare();
+        wsSharedCtx = nopoll_ctx_new();
+#ifdef WS_NATIVE_OPENSSL
+        if (wsSharedCtx != NULL) nopoll_ctx_set_ssl_context_creator(wsSharedCtx, wsSharedTLSCreator, NULL);
+#endif
+    }
+
+    noPollCtx* ret = wsSharedCtx;
+
+    wsSharedUnlock();
+
+    return ret;
+}
+
+noPollCtx* wsSharedNopollCtxPrivate() {
+    wsSharedLock();
+
+    wsSharedNopollPrepare();
+    noPollCtx* ret = nopoll_ctx_new();
+#ifdef WS_NATIVE_OPENSSL
+    if (ret != NULL) nopoll_ctx_set_ssl_context_creator(ret, wsSharedTLSCreator, NULL);
+#endif
+
+    wsSharedUnlock();
+
+    return ret;
+}
+
+void wsSharedNopollCtxRelease(noPollCtx* ctx) {
+    if (ctx == NULL) return;
+
+    wsSharedLock();
+    bool shared = (ctx == wsSharedCtx);
+    wsSharedUnlock();
+
+    if (!shared) nopoll_ctx_unref(ctx);
+}
+
+uint32_t wsSharedTLSContexts() {
+    uint32_t ret = 0;
+
+#ifdef WS_NATIVE_OPENSSL
+    wsSharedTLSEntry* e;
+
+    wsSharedLock();
+    for (e = wsSharedTLSEntries; e != NULL; e = e->next) ++ret;
+    wsSharedUnlock();
+#endif
+
+    return ret;
+}
+
+#ifdef WS_NATIVE_OPENSSL
+static bool wsSharedEqual(const char* a, const char* b) {
+    if (a == NULL || b == NULL) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static char* wsSharedDuplicate(const char* s) {
+    if (s == NULL) return NULL;
+
+    char* ret = (char*) malloc(strlen(s) + 1);
+    if (ret != NULL) strcpy(ret, s);
+    return ret;
+}
+
+/* clients have to store sessions themselves, new ones (e.g. TLS 1.3 tickets after the handshake) arrive here */
+static int wsSharedTLSNewSession(SSL* ssl, SSL_SESSION* session) {
+    SSL_SESSION** slot = wsSharedTLSSessionIndex >= 0 ? (SSL_SESSION**) SSL_get_ex_data(ssl, wsSharedTLSSessionIndex) : NULL;
+    if (slot == NULL) return 0;
+
+    if (*slot != NULL) SSL_SESSION_free(*slot);
+    *slot = session;
+
+    return 1;
+}
+
+static void wsSharedTLSEntryFree(wsSharedTLSEntry* e) {
+    if (e->ctx != NULL) SSL_CTX_free(e->ctx);
+    free(e->client_cert);
+    free(e->client_key);
+    free(e->ca_cert);
+    free(e);
+}
+
+SSL_CTX* wsSharedTLSContext(const char* client_cert, const char* client_key, const char* ca_cert, bool verify,
+                            int (*debugFunction)(const char*, ...)) {
+    wsSharedTLSEntry* e;
+
+    wsSharedLock();
+
+    for (e = wsSharedTLSEntries; e != NULL; e = e->next) {
+        if (e->verify == verify && wsSharedEqual(e->client_cert, client_cert) &&
+            wsSharedEqual(e->client_key, client_key) && wsSharedEqual(e->ca_cert, ca_cert)) {
+            e->refs++;
+            wsSharedUnlock();
+            return e->ctx;
+        }
+    }
+
+    e = (wsSharedTLSEntry*) calloc(1, sizeof(wsSharedTLSEntry));
+    if (e == NULL) {
+        wsSharedUnlock();
+        return NULL;
+    }
+
+    e->client_cert = wsSharedDuplicate(client_cert);
+    e->client_key = wsSharedDuplicate(client_key);
+    e->ca_cert = wsSharedDuplicate(ca_cert);
+    e->verify = verify;
+    e->refs = 1;
+
+    e->ctx = SSL_CTX_new(TLS_client_method());
+    if (e->ctx == NULL) {
+        wsSharedTLSEntryFree(e);
+        wsSharedUnlock();
+        return NULL;
+    }
+
+    SSL_CTX_set_min_proto_version(e->ctx, TLS1_2_VERSION);
+    SSL_CTX_set_mode(e->ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    SSL_CTX_set_verify(e->ctx, verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, NULL);
+
+    SSL_CTX_set_session_cache_mode(e->ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(e->ctx, wsSharedTLSNewSession);
+    if (wsSharedTLSSessionIndex < 0) wsSharedTLSSessionIndex = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+
+    if (ca_cert != NULL) {
+        if (SSL_CTX_load_verify_locations(e->ctx, ca_cert, NULL) != 1) {
+            if (debugFunction != NULL)
+                debugFunction("Websocket: wsSharedTLSContext: loading ca certificate %s failed\n", ca_cert);
+            wsSharedTLSEntryFree(e);
+            wsSharedUnlock();
+            return NULL;
+        }
+    } else {
+        SSL_CTX_set_default_verify_paths(e->ctx);
+    }
+
+    if (client_cert != NULL && client_key != NULL) {
+        if (SSL_CTX_use_certificate_chain_file(e->ctx, client_cert) != 1 ||
+            SSL_CTX_use_PrivateKey_file(e->ctx, client_key, SSL_FILETYPE_PEM) != 1) {
+            if (debugFunction != NULL)
+                debugFunction("Websocket: wsSharedTLSContext: loading client certificate %s failed\n", client_cert);
+            wsSharedTLSEntryFree(e);
+            wsSharedUnlock();
+            return NULL;
+        }
+    }
+
+    e->next = wsSharedTLSEntries;
+    wsSharedTLSEntries = e;
+
+    wsSharedUnlock();
+
+    return e->ctx;
+}
+
+void wsSharedTLSRelease(SSL_CTX* ctx) {
+    wsSharedTLSEntry** e;
+
+    if (ctx == NULL) return;
+
+    wsSharedLock();
+
+    for (e = &wsSharedTLSEntries; *e != NULL; e = &(*e)->next) {
+        if ((*e)->ctx == ctx) {
+            if (--(*e)->refs == 0) {
+                wsSharedTLSEntry* prey = *e;
+                *e = prey->next;
+                wsSharedTLSEntryFree(prey);
+            }
+            break;
+        }
+    }
+
+    wsSharedUnlock();
+}
+
+void wsSharedTLSBind(noPollConnOpts* opts, SSL_CTX* ctx) {
+    wsSharedTLSBinding** b;
+
+    if (opts == NULL) return;
+
+    wsSharedLock();
+
+    for (b = &wsSharedTLSBindings; *b != NULL; b = &(*b)->next) {
+        if ((*b)->opts == opts) break;
+    }
+
+    if (*b != NULL && ctx != NULL) {
+        (*b)->ctx = ctx;
+    } else if (*b != NULL) {
+        wsSharedTLSBinding* prey = *b;
+        *b = prey->next;
+        free(prey);
+    } else if (ctx != NULL) {
+        wsSharedTLSBinding* n = (wsSharedTLSBinding*) calloc(1, sizeof(wsSharedTLSBinding));
+        if (n != NULL) {
+            n->opts = opts;
+            n->ctx = ctx;
+            n->next = wsSharedTLSBindings;
+            wsSharedTLSBindings = n;
+        }
+    }
+
+    wsSharedUnlock();
+}
+
+void wsSharedTLSSessionSlot(SSL* ssl, SSL_SESSION** slot) {
+    if (wsSharedTLSSessionIndex >= 0) SSL_set_ex_data(ssl, wsSharedTLSSessionIndex, slot);
+}
+#endif
@@ -0,0 +1,57 @@
+/****************************************************************************
+ * Copyright 2026 The msb-client-websocket-c contributors                   *
+ *																			*
+ * Licensed under the Apache License, Version 2.0 (the "License");			*
+ * you may not use this file except in compliance with the License.			*
+ * You may obtain a copy of the License at									*
+ *																			*
+ *		http://www.apache.org/licenses/LICENSE-2.0							*
+ *																			*
+ * Unless required by applicable law or agreed to in writing, software		*
+ * distributed under the License is distributed on an "AS IS" BASIS,		*
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.	*
+ * See the License for the specific language governing permissions and		*
+ * limitations under the License.											*
+ ****************************************************************************/
+
+/**
+* @file shared.h
+* @brief header file for the transport state shared by all websocket connections of a process
+*/
+
+#ifndef SRC_WEBSOCKET_SHARED_H_
+#define SRC_WEBSOCKET_SHARED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nopoll.h"
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
+/* every wsData holds a reference, the library state is released with the last one */
+void wsSharedRef();
+
+void wsSharedUnref();
+
+noPollCtx* wsSharedNopollCtx();
+
+noPollCtx* wsSharedNopollCtxPrivate();
+
+void wsSharedNopollCtxRelease(noPollCtx* ctx);
+
+uint32_t wsSharedTLSContexts();
+
+#ifdef WS_NATIVE_OPENSSL
+SSL_CTX* wsSharedTLSContext(const char* client_cert, const char* client_key, const char* ca_cert, bool verify,
+                            int (*debugFunction)(const char*, ...));
+
+void wsSharedTLSRelease(SSL_CTX* ctx);
+
+void wsSharedTLSBind(noPollConnOpts* opts, SSL_CTX* ctx);
+
+void wsSharedTLSSessionSlot(SSL* ssl, SSL_SESSION** slot);
+#endif
+
+#endif /* SRC_WEBSOCKET_SHARED_H_ */
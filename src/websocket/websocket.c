@@ -23,6 +23,37 @@
 
 #include "websocket.h"
 
+#ifndef _WIN32
+#include <poll.h>
+#else
+#define poll WSAPoll
+#endif
+
+#ifdef WS_NATIVE_AVAILABLE
+static wsNative* wsNativeData(wsData* data) {
+    if (data->native == NULL) data->native = wsNativeConstr(&data->deflate, data->debugFunction);
+    if (data->native != NULL) {
+        data->native->debugFunction = data->debugFunction;
+        wsNativeSetTLSVerification(data->native, data->tls_verify);
+        wsNativeSetTLSSessionResumption(data->native, data->tls_resumption);
+    }
+
+    return data->native;
+}
+#endif
+
+#ifdef WS_NATIVE_OPENSSL
+/* connections of every client with the same certificates and verification share one SSL context */
+static void wsTLSBind(wsData* data) {
+    SSL_CTX* ctx = wsSharedTLSContext(data->tls_client_cert, data->tls_client_key, data->tls_ca_cert,
+                                      data->tls_verify, data->debugFunction);
+
+    wsSharedTLSBind(data->wsOpts, ctx);
+    wsSharedTLSRelease(data->tls_ctx);
+    data->tls_ctx = ctx;
+}
+#endif
+
 void logHandler(noPollCtx * ctx, noPollDebugLevel level, const char * log_msg, noPollPtr user_data){
     wsData* ws = (wsData*)user_data;
     if (ws->debugFunction != NULL) ws->debugFunction("Redirected libnopoll msg: %s\n", log_msg);
@@ -74,6 +105,8 @@ wsData* wsDataConstr(bool _useIPv6,
     ret->status = WSD_CLEAR;
 
     ret->flag_TLS = tls;
+    ret->tls_verify = true;
+    ret->tls_resumption = true;
     if (ca_cert != NULL) ret->tls_ca_cert = string_duplicate(ca_cert);
     if (client_cert != NULL) ret->tls_client_cert = string_duplicate(client_cert);
     if (client_key != NULL) ret->tls_client_key = string_duplicate(client_key);
@@ -81,34 +114,113 @@ wsData* wsDataConstr(bool _useIPv6,
     ret->connData = wsConnDataConstr(_useIPv6, _targetAddr, _targetPort, _targetHostname, _targetPath, _origin);
     ret->debugFunction = debugFunction_;
 
+    wsSharedRef();
+
     return ret;
 }
 
 void wsDataDestr(wsData* prey) {
     if (prey->debugFunction != NULL) prey->debugFunction("Websocket: wsDataDestr\n");
 
+    /* the shared state may only be dropped, once this connection does not use it any more */
+    if (prey->status == WSD_CONNECTED) wsDisconnect(prey);
+    if (prey->status != WSD_CLEAR) wsDeinitialise(prey);
+
     wsConnDataDestr(prey->connData);
 
     free(prey->tls_ca_cert);
     free(prey->tls_client_cert);
     free(prey->tls_client_key);
 
-    wsCleanup();
+    wsDeflateReset(&prey->deflate);
+
+    if (prey->wsMsg != NULL) nopoll_msg_unref(prey->wsMsg);
+
+#ifdef WS_NATIVE_AVAILABLE
+    wsNativeDestr(prey->native);
+    prey->native = NULL;
+#endif
+
+    free(prey);
+
+    wsSharedUnref();
 }
 
 void wsPing(wsData* data) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        int ping = wsNativeSend(wsNativeData(data), WS_OPCODE_PING, NULL, 0);
+
+        if (data->debugFunction != NULL) data->debugFunction("Websocket: wsPing %i\n", ping == 0);
+        return;
+    }
+#endif
+
     nopoll_bool ping = nopoll_conn_send_ping(data->wsVerb);
 
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsPing %i\n", ping);
 }
 
 char* wsGetMsgContent(wsData* data) {
+    return wsGetMsg(data, NULL, NULL);
+}
+
+char* wsGetMsg(wsData* data, size_t* length, bool* binary) {
     char* payload;
     payload = NULL;
 
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        wsNative* n = wsNativeData(data);
+        payload = wsNativeGetMsgContent(n);
+
+        if (payload != NULL) {
+            if (length != NULL) *length = n->msg_used;
+            if (binary != NULL) *binary = n->msg_binary;
+
+            if (data->debugFunction != NULL) {
+                if (n->msg_binary)
+                    data->debugFunction("Websocket: wsGetMsgContent: Binary payload of length %li\n", n->msg_used);
+                else
+                    data->debugFunction("Websocket: wsGetMsgContent: Payload %s\n", payload);
+            }
+        }
+
+        return payload;
+    }
+#endif
+
+    void* ref = NULL;
+    payload = wsTakeMsg(data, length, binary, &ref);
+
+    /* the payload has to stay valid until the next call */
+    if (data->wsMsg != NULL) nopoll_msg_unref(data->wsMsg);
+    data->wsMsg = (noPollMsg*) ref;
+
+    return payload;
+}
+
+char* wsTakeMsg(wsData* data, size_t* length, bool* binary, void** ref) {
+    char* payload;
+    payload = NULL;
+    *ref = NULL;
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        payload = wsGetMsg(data, length, binary);
+        if (payload != NULL) *ref = wsNativeLendMsg(wsNativeData(data));
+
+        return payload;
+    }
+#endif
+
     noPollMsg* in = nopoll_conn_get_msg(data->wsVerb);
     if (in != NULL) {
         payload = (char*) nopoll_msg_get_payload(in);
+        *ref = in;
+
+        if (length != NULL) *length = (size_t) nopoll_msg_get_payload_size(in);
+        if (binary != NULL) *binary = nopoll_msg_opcode(in) == NOPOLL_BINARY_FRAME;
 
         if (data->debugFunction != NULL) data->debugFunction("Websocket: wsGetMsgContent: Payload %s\n", payload);
     }
@@ -116,6 +228,97 @@ char* wsGetMsgContent(wsData* data) {
     return payload;
 }
 
+void wsReleaseMsg(wsData* data, void* ref) {
+    if (ref == NULL) return;
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        wsNativeReturnMsg(wsNativeData(data), (char*) ref);
+        return;
+    }
+#endif
+
+    nopoll_msg_unref((noPollMsg*) ref);
+}
+
+/* hands a message read from the nopoll connection to the handler, which takes its own reference */
+static void wsNopollDeliverMsg(wsData* data, noPollMsg* msg) {
+    if (data->onMsg == NULL || !nopoll_msg_ref(msg)) return;
+
+    char* payload = (char*) nopoll_msg_get_payload(msg);
+
+    if (data->debugFunction != NULL) data->debugFunction("Websocket: wsNopollDeliverMsg: Payload %s\n", payload);
+
+    data->onMsg(data->onMsgContext, payload, (size_t) nopoll_msg_get_payload_size(msg),
+                nopoll_msg_opcode(msg) == NOPOLL_BINARY_FRAME, msg);
+}
+
+void wsSetOnMsg(wsData* data, wsOnMsgHandler handler, void* context) {
+    if (data->debugFunction != NULL) data->debugFunction("Websocket: wsSetOnMsg: callback mode %i\n", handler != NULL);
+
+    data->onMsg = handler;
+    data->onMsgContext = context;
+}
+
+static uint32_t wsDeliverMsgs(wsData* data, uint32_t max_msgs) {
+    uint32_t delivered = 0;
+
+    while (delivered < max_msgs) {
+#ifdef WS_NATIVE_AVAILABLE
+        if (data->transport == WS_TRANSPORT_NATIVE) {
+            size_t length = 0;
+            bool binary = false;
+            void* ref = NULL;
+            char* payload = wsTakeMsg(data, &length, &binary, &ref);
+
+            if (payload == NULL) break;
+
+            data->onMsg(data->onMsgContext, payload, length, binary, ref);
+            delivered++;
+            continue;
+        }
+#endif
+
+        /* what the loop of nopoll does with a readable connection, which can't be run on a context shared by clients */
+        noPollMsg* msg = nopoll_conn_get_msg(data->wsVerb);
+        if (msg == NULL) break;
+
+        wsNopollDeliverMsg(data, msg);
+        nopoll_msg_unref(msg);
+        delivered++;
+    }
+
+    return delivered;
+}
+
+/* frames buffered by the transport aren't seen by poll, they have been delivered before waiting */
+int wsDispatchMsgs(wsData* data, uint32_t timeout_in_us, uint32_t max_msgs) {
+    if (data->onMsg == NULL) return -1;
+
+    int fd = -1;
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) fd = data->native != NULL ? wsNativePollFd(data->native) : -1;
+    else
+#endif
+    if (data->wsVerb != NULL) fd = (int) nopoll_conn_socket(data->wsVerb);
+
+    if (fd < 0) return -1;
+
+    uint32_t delivered = wsDeliverMsgs(data, max_msgs);
+
+    if (delivered == 0 && max_msgs > 0 && timeout_in_us > 0) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, (int) ((timeout_in_us + 999) / 1000)) > 0) delivered = wsDeliverMsgs(data, max_msgs);
+    }
+
+    return (int) delivered;
+}
+
 void wsConnect(wsData* data) {
     //if(data->status != WSD_INITIALISED) return;
 
@@ -129,6 +332,23 @@ void wsConnect(wsData* data) {
         }
     }
 
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        if (wsNativeConnect(wsNativeData(data), data->connData->useIPv6, data->connData->targetAddr,
+                            data->connData->targetPort, data->connData->targetHostname, data->connData->targetPath,
+                            data->connData->origin) == 0 && wsIsConnectionReady(data, 100000)) {
+            data->status = WSD_CONNECTED;
+        }
+        return;
+    }
+#endif
+
+    /* nopoll neither sets nor reports RSV1, so permessage-deflate is never offered on this transport */
+    wsDeflateReset(&data->deflate);
+    if (data->deflate.enabled && data->debugFunction != NULL)
+        data->debugFunction("Websocket: wsConnect: %s not supported by nopoll, connecting uncompressed\n",
+                            WS_DEFLATE_EXTENSION_NAME);
+
     if (data->flag_TLS == 0) {
         if (data->connData->useIPv6) {
             data->wsVerb = (noPollConn*) nopoll_conn_new6(data->wsCtx, data->connData->targetAddr,
@@ -162,6 +382,14 @@ void wsDisconnect(wsData* data) {
 
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsDisconnect\n");
 
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        wsNativeDisconnect(wsNativeData(data));
+        data->status = WSD_DISCONNECTED;
+        return;
+    }
+#endif
+
     if(wsIsConnectionOK(data)) nopoll_conn_close(data->wsVerb);
 
     data->status = WSD_DISCONNECTED;
@@ -174,7 +402,18 @@ void wsInitialise(wsData* data, bool nopoll_debug) {
 
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsInitialise\n");
 
-    data->wsCtx = nopoll_ctx_new();
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        wsNative* n = wsNativeData(data);
+        if (n != NULL && wsNativeInitialise(n, data->flag_TLS, data->tls_client_cert, data->tls_client_key,
+                                            data->tls_ca_cert) == 0)
+            data->status = WSD_INITIALISED;
+        return;
+    }
+#endif
+
+    /* libnopoll logs per context, so only clients with nopoll debug output get a context of their own */
+    data->wsCtx = nopoll_debug ? wsSharedNopollCtxPrivate() : wsSharedNopollCtx();
     data->wsOpts = nopoll_conn_opts_new();
 
     if (!data->connData->origin) nopoll_conn_opts_add_origin_header (data->wsOpts, nopoll_false);
@@ -196,19 +435,50 @@ void wsDeinitialise(wsData* data) {
 
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsDeinitialise\n");
 
-    nopoll_ctx_unref(data->wsCtx);
-    wsCleanup();
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        if (data->native != NULL) wsNativeDeinitialise(data->native);
+        data->status = WSD_CLEAR;
+        return;
+    }
+#endif
+
+#ifdef WS_NATIVE_OPENSSL
+    wsSharedTLSBind(data->wsOpts, NULL);
+    wsSharedTLSRelease(data->tls_ctx);
+    data->tls_ctx = NULL;
+#endif
+
+    if (data->wsOpts != NULL) nopoll_conn_opts_free(data->wsOpts);
+    data->wsOpts = NULL;
+
+    wsSharedNopollCtxRelease(data->wsCtx);
+    data->wsCtx = NULL;
 
     data->status = WSD_CLEAR;
 }
 
-int wsSend(wsData* data, const char* nachricht, size_t length) {
-    uint32_t length_sent = (uint32_t) nopoll_conn_send_text(data->wsVerb, nachricht, (long) length);
+static int wsSendFrame(wsData* data, bool binary, const char* nachricht, size_t length) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        int ret = wsNativeSend(wsNativeData(data), binary ? WS_OPCODE_BINARY : WS_OPCODE_TEXT, nachricht, length);
+
+        if (data->debugFunction != NULL) {
+            data->debugFunction("Websocket: wsSend%s: message length %li, message \"%s\"\n", ret == 0 ? "" : " fail",
+                                length, binary ? "(binary)" : nachricht);
+        }
+
+        return ret;
+    }
+#endif
+
+    uint32_t length_sent = (uint32_t) (binary ? nopoll_conn_send_binary(data->wsVerb, nachricht, (long) length)
+                                              : nopoll_conn_send_text(data->wsVerb, nachricht, (long) length));
 
     if (length_sent == length) {
         if (data->debugFunction != NULL) {
             data->debugFunction("Websocket: wsSend: message length %li, message length sent %li, message \"%s\"\n",
-                                length, length_sent, nachricht);
+                                length, length_sent, binary ? "(binary)" : nachricht);
         }
 
         return 0;
@@ -219,21 +489,63 @@ int wsSend(wsData* data, const char* nachricht, size_t length) {
     if (length_sent == length || length_sent == 0) {
         if (data->debugFunction != NULL) {
             data->debugFunction("Websocket: wsSend: message length %li, message length sent %li, message \"%s\"\n",
-                                length, length_sent, nachricht);
+                                length, length_sent, binary ? "(binary)" : nachricht);
         }
 
         return 0;
     } else {
         if (data->debugFunction != NULL) {
             data->debugFunction("Websocket: wsSend fail: message length %li, message length sent %li, message \"%s\"\n",
-                                length, length_sent, nachricht);
+                                length, length_sent, binary ? "(binary)" : nachricht);
         }
 
         return -1;
     }
 }
 
+int wsSend(wsData* data, const char* nachricht, size_t length) {
+    return wsSendFrame(data, false, nachricht, length);
+}
+
+int wsSendBinary(wsData* data, const char* payload, size_t length) {
+    return wsSendFrame(data, true, payload, length);
+}
+
+int wsSendFragment(wsData* data, bool first, bool last, const char* payload, size_t length) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        int ret = wsNativeSendFrame(wsNativeData(data), first ? WS_OPCODE_TEXT : WS_OPCODE_CONTINUATION, last, payload,
+                                    length);
+
+        if (data->debugFunction != NULL) {
+            data->debugFunction("Websocket: wsSendFragment%s: fragment length %li, first %i, last %i\n",
+                                ret == 0 ? "" : " fail", length, first, last);
+        }
+
+        return ret;
+    }
+#endif
+
+    long length_sent = nopoll_conn_send_frame(data->wsVerb, last, nopoll_true,
+                                              first ? NOPOLL_TEXT_FRAME : NOPOLL_CONTINUATION_FRAME, (long) length,
+                                              (noPollPtr) payload, 0);
+
+    if (length_sent != (long) length && length_sent >= 0)
+        length_sent = nopoll_conn_flush_writes(data->wsVerb, 100000, (int) length_sent);
+
+    if (data->debugFunction != NULL) {
+        data->debugFunction("Websocket: wsSendFragment%s: fragment length %li, length sent %li, first %i, last %i\n",
+                            length_sent == (long) length ? "" : " fail", length, length_sent, first, last);
+    }
+
+    return length_sent == (long) length ? 0 : -1;
+}
+
 bool wsIsConnectionReady(wsData* data, uint32_t timeout_in_us) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) return wsNativeIsConnectionReady(wsNativeData(data), timeout_in_us);
+#endif
+
     nopoll_bool ready = nopoll_conn_wait_until_connection_ready(data->wsVerb, timeout_in_us);
 
     /*if (data->debugFunction != NULL) {
@@ -244,6 +556,10 @@ bool wsIsConnectionReady(wsData* data, uint32_t timeout_in_us) {
 }
 
 int wsIsConnectionOK(wsData* data) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) return wsNativeIsConnectionOK(wsNativeData(data));
+#endif
+
     nopoll_bool ok = nopoll_conn_is_ok(data->wsVerb);
 
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsIsConnectionOK: %i\n", ok);
@@ -261,6 +577,10 @@ void wsTLSInitialise(wsData* data) {
     nopoll_conn_opts_set_ssl_protocol((*data)->wsOpts, 6);
 #endif
     nopoll_conn_opts_set_reuse(data->wsOpts, nopoll_true);
+
+#ifdef WS_NATIVE_OPENSSL
+    wsTLSBind(data);
+#endif
 }
 
 /*zielkonfig = opts, v0 = clientzertifikat, v1 = privater schlüssel, v2 = kettenzertifikat, v3 = ca-zertifikat*/
@@ -276,10 +596,132 @@ int wsTLSCertificates(wsData* data) {
 void wsSetTLSVerification(wsData* data, bool on_off) {
     if (data->debugFunction != NULL) data->debugFunction("Websocket: wsSetTLSVerification: on_off %b\n", on_off);
 
+    /* kept for both transports, wsCopySettings and a later change of transport take it over */
+    data->tls_verify = on_off;
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE) {
+        wsNativeSetTLSVerification(wsNativeData(data), on_off);
+        return;
+    }
+#endif
+
     /*true für deaktivieren, false für aktivieren*/
-    nopoll_conn_opts_ssl_peer_verify(data->wsOpts, !on_off);
+    if (data->wsOpts != NULL) nopoll_conn_opts_ssl_peer_verify(data->wsOpts, !on_off);
+
+#ifdef WS_NATIVE_OPENSSL
+    if (data->tls_ctx != NULL) wsTLSBind(data);
+#endif
+}
+
+void wsSetTLSSessionResumption(wsData* data, bool on_off) {
+    if (data->debugFunction != NULL) data->debugFunction("Websocket: wsSetTLSSessionResumption: on_off %i\n", on_off);
+
+    data->tls_resumption = on_off;
+}
+
+/* nopoll creates and connects its SSL objects in one go, so only the native transport can offer a former session */
+void wsGetTLSHandshakes(wsData* data, uint32_t* handshakes, uint32_t* resumed) {
+    *handshakes = 0;
+    *resumed = 0;
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->native != NULL) {
+        *handshakes = data->native->tls_handshakes;
+        *resumed = data->native->tls_handshakes_resumed;
+    }
+#endif
+}
+
+void wsSetCompression(wsData* data, bool on_off, uint8_t window_bits, bool context_takeover, size_t threshold) {
+    if (data->debugFunction != NULL) {
+        data->debugFunction("Websocket: wsSetCompression: on_off %i, window_bits %u, context_takeover %i, threshold %lu\n",
+                            on_off, window_bits, context_takeover, (unsigned long) threshold);
+    }
+
+#ifdef WS_NATIVE_AVAILABLE
+    if (on_off && data->native != NULL && data->native->static_buffers) {
+        if (data->debugFunction != NULL)
+            data->debugFunction("Websocket: wsSetCompression: not available with static buffers\n");
+        return;
+    }
+#endif
+
+    wsDeflateConfigure(&data->deflate, on_off, window_bits, context_takeover, threshold);
+}
+
+int wsSetTransport(wsData* data, enum wsTransport transport) {
+    if (data->debugFunction != NULL) data->debugFunction("Websocket: wsSetTransport: transport %i\n", transport);
+
+#ifndef WS_NATIVE_AVAILABLE
+    if (transport == WS_TRANSPORT_NATIVE) {
+        if (data->debugFunction != NULL)
+            data->debugFunction("Websocket: wsSetTransport: native transport not available, using nopoll\n");
+        return -1;
+    }
+#else
+    if (transport != WS_TRANSPORT_NATIVE && data->native != NULL && data->native->static_buffers) {
+        if (data->debugFunction != NULL)
+            data->debugFunction("Websocket: wsSetTransport: static buffers need the native transport\n");
+        return -1;
+    }
+#endif
+
+    data->transport = transport;
+
+    return 0;
 }
 
-void wsCleanup() {
-    nopoll_cleanup_library();
+size_t wsStaticBuffersSize(size_t message_size) {
+#ifdef WS_NATIVE_AVAILABLE
+    return wsNativeStaticBuffersSize(message_size);
+#else
+    return 0;
+#endif
 }
+
+/* only the native transport works without the heap once connected, compression stays off */
+int wsSetStaticBuffers(wsData* data, void* memory, size_t message_size) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (wsSetTransport(data, WS_TRANSPORT_NATIVE) != 0) return -1;
+
+    wsNative* n = wsNativeData(data);
+    if (n == NULL) return -1;
+
+    wsDeflateConfigure(&data->deflate, false, WS_DEFLATE_MAX_WINDOW_BITS, true, 0);
+
+    return wsNativeSetStaticBuffers(n, memory, message_size);
+#else
+    if (data->debugFunction != NULL)
+        data->debugFunction("Websocket: wsSetStaticBuffers: native transport not available\n");
+
+    return -1;
+#endif
+}
+
+/* descriptor becoming readable when the connection needs attention, stable from wsInitialise to wsDeinitialise */
+int wsGetPollFd(wsData* data) {
+#ifdef WS_NATIVE_AVAILABLE
+    if (data->transport == WS_TRANSPORT_NATIVE && data->native != NULL) return wsNativePollFd(data->native);
+#endif
+
+    return -1;
+}
+
+void wsCopySettings(wsData* to, const wsData* from) {
+    to->transport = from->transport;
+    to->tls_verify = from->tls_verify;
+    to->tls_resumption = from->tls_resumption;
+    to->onMsg = from->onMsg;
+    to->onMsgContext = from->onMsgContext;
+
+    wsDeflateConfigure(&to->deflate, from->deflate.enabled, from->deflate.client_max_window_bits,
+                       !from->deflate.client_no_context_takeover, from->deflate.threshold);
+
+#ifdef WS_NATIVE_AVAILABLE
+    /* static buffers belong to the caller's region, the new connection takes them over */
+    if (from->native != NULL && from->native->static_buffers)
+        wsSetStaticBuffers(to, from->native->rx, from->native->msg_size - 1);
+#endif
+}
+
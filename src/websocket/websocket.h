@@ -28,6 +28,9 @@
 #include <stdbool.h>
 #include "nopoll.h"
 #include "../rest/helpers.h"
+#include "deflate.h"
+#include "native.h"
+#include "shared.h"
 
 typedef struct {
     bool useIPv6;
@@ -48,6 +51,11 @@ wsConnData* wsConnDataConstr(bool _useIPv6,
 
 void wsConnDataDestr(wsConnData* prey);
 
+enum wsTransport {
+    WS_TRANSPORT_NOPOLL,
+    WS_TRANSPORT_NATIVE
+};
+
 enum wsDataStatus {
     WSD_CLEAR,
     WSD_INITIALISED,
@@ -55,10 +63,17 @@ enum wsDataStatus {
     WSD_CONNECTED
 };
 
+/* receives every message in callback mode, see wsSetOnMsg; payload, length, binary and ref as returned by wsTakeMsg,
+ * the handler takes ref over in any case and returns false if it couldn't keep the message */
+typedef bool (*wsOnMsgHandler)(void* context, char* payload, size_t length, bool binary, void* ref);
+
 typedef struct {
 
     enum wsDataStatus status;
 
+    enum wsTransport transport;
+    wsNative* native;
+
     noPollCtx* wsCtx;
     noPollConn* wsVerb;
     noPollConnOpts* wsOpts;
@@ -66,9 +81,21 @@ typedef struct {
     wsConnData* connData;
 
     bool flag_TLS;
+    bool tls_verify;
+    bool tls_resumption;
     char* tls_client_cert;
     char* tls_client_key;
     char* tls_ca_cert;
+#ifdef WS_NATIVE_OPENSSL
+    SSL_CTX* tls_ctx;/* shared context bound to wsOpts */
+#endif
+
+    wsDeflate deflate;
+
+    noPollMsg* wsMsg;/* message of libnopoll returned last by wsGetMsg, released by the next call */
+
+    wsOnMsgHandler onMsg;/* handler of received messages in callback mode, NULL for polling with wsGetMsg */
+    void* onMsgContext;
 
     int (*debugFunction)(const char* format, ...);
 
@@ -89,6 +116,22 @@ void wsPing(wsData* data);
 
 char* wsGetMsgContent(wsData* data);
 
+/* like wsGetMsgContent, length and binary (may be NULL) tell the size of the payload and whether it came in a binary frame */
+char* wsGetMsg(wsData* data, size_t* length, bool* binary);
+
+/* like wsGetMsg, but the payload stays valid until ref is handed to wsReleaseMsg; ref is NULL if the payload couldn't be
+ * taken over and is only valid until the next call */
+char* wsTakeMsg(wsData* data, size_t* length, bool* binary, void** ref);
+
+void wsReleaseMsg(wsData* data, void* ref);
+
+/* callback mode: received messages are handed to the handler by wsDispatchMsgs, NULL goes back to polling */
+void wsSetOnMsg(wsData* data, wsOnMsgHandler handler, void* context);
+
+/* hands up to max_msgs received messages to the handler, waiting up to timeout_in_us for the connection to become
+ * readable if none has been received yet; returns the number of messages handed over, -1 if there is nothing to wait on */
+int wsDispatchMsgs(wsData* data, uint32_t timeout_in_us, uint32_t max_msgs);
+
 void wsConnect(wsData* data);
 
 void wsDisconnect(wsData* data);
@@ -99,6 +142,11 @@ void wsDeinitialise(wsData* data);
 
 int wsSend(wsData* data, const char* nachricht, size_t length);
 
+int wsSendBinary(wsData* data, const char* payload, size_t length);
+
+/* a fragment of a text message, no other message may be sent between its first and its last fragment */
+int wsSendFragment(wsData* data, bool first, bool last, const char* payload, size_t length);
+
 bool wsIsConnectionReady(wsData* data, uint32_t timeout_in_us);
 
 int wsIsConnectionOK(wsData* data);
@@ -109,7 +157,21 @@ int wsTLSCertificates(wsData* data);
 
 void wsSetTLSVerification(wsData* data, bool on_off);
 
-void wsCleanup();
+void wsSetTLSSessionResumption(wsData* data, bool on_off);
+
+void wsGetTLSHandshakes(wsData* data, uint32_t* handshakes, uint32_t* resumed);
+
+void wsSetCompression(wsData* data, bool on_off, uint8_t window_bits, bool context_takeover, size_t threshold);
+
+int wsSetTransport(wsData* data, enum wsTransport transport);
+
+int wsGetPollFd(wsData* data);
+
+size_t wsStaticBuffersSize(size_t message_size);
+
+int wsSetStaticBuffers(wsData* data, void* memory, size_t message_size);
+
+void wsCopySettings(wsData* to, const wsData* from);
 
 void logHandler(noPollCtx * ctx, noPollDebugLevel level, const char * log_msg, noPollPtr user_data);
 
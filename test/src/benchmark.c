@@ -0,0 +1,1092 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <malloc.h>
+#include <inttypes.h>
+#include <sched.h>
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
+#include "libMsbClientC.h"
+#include "MsbClientC_internal.h"
+#include "websocket/websocket.h"
+#include "mockbroker.h"
+
+#define BENCH_UUID "a209efb9-af3f-4d93-bad4-05215a983164"
+
+static double bench_wall_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench_cpu_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* builds an event envelope as sent by msbClientPublish, with a changing value and timestamp */
+static size_t bench_event_message(char* buffer, size_t size, uint32_t i){
+    return (size_t) snprintf(buffer, size,
+                             "E [{\"uuid\":\"%s\",\"eventId\":\"Ev%u\",\"priority\":1,"
+                             "\"postDate\":\"2026-10-19T08:%02u:%02u.%03uZ\",\"dataObject\":{\"temperature\":%u.%u,"
+                             "\"pressure\":%u,\"state\":\"RUNNING\"}}]",
+                             BENCH_UUID, i % 4, (i / 60000) % 60, (i / 1000) % 60, i % 1000, 20 + i % 7, i % 10,
+                             1000 + i % 13);
+}
+
+static void bench_deflate(uint32_t messages, uint8_t window_bits, bool context_takeover, size_t threshold){
+    wsDeflate client, server;
+    memset(&client, 0, sizeof(wsDeflate));
+    memset(&server, 0, sizeof(wsDeflate));
+
+    wsDeflateConfigure(&client, true, window_bits, context_takeover, threshold);
+    wsDeflateConfigure(&server, true, window_bits, context_takeover, threshold);
+
+    char* offer = wsDeflateOffer(&client);
+    wsDeflateAccept(&client, offer);
+    wsDeflateAccept(&server, offer);
+    free(offer);
+
+    char msg[512];
+    unsigned char* comp;
+    char* decomp;
+    size_t comp_length, decomp_length;
+    uint32_t i, errors = 0;
+
+    double cpu_compress = 0, cpu_decompress = 0, t;
+
+    for (i = 0; i < messages; ++i) {
+        size_t length = bench_event_message(msg, sizeof(msg), i);
+
+        t = bench_cpu_seconds();
+        int ret = wsDeflateCompress(&client, msg, length, &comp, &comp_length);
+        cpu_compress += bench_cpu_seconds() - t;
+
+        if (ret == 1) {
+            t = bench_cpu_seconds();
+            if (wsDeflateDecompress(&server, comp, comp_length, &decomp, &decomp_length, 0) != 0 ||
+                decomp_length != length || memcmp(decomp, msg, length) != 0)
+                ++errors;
+            cpu_decompress += bench_cpu_seconds() - t;
+
+            free(decomp);
+            free(comp);
+        }
+    }
+
+    printf("deflate  window %2u  takeover %i  threshold %4lu  | raw %9llu B  wire %9llu B  ratio %5.1f%%  "
+           "compressed %7llu  plain %7llu  | cpu compress %6.2f us/msg  decompress %6.2f us/msg  errors %u\n",
+           window_bits, context_takeover, (unsigned long) threshold,
+           (unsigned long long) client.raw_bytes_sent, (unsigned long long) client.wire_bytes_sent,
+           100.0 * client.wire_bytes_sent / client.raw_bytes_sent,
+           (unsigned long long) client.messages_compressed, (unsigned long long) client.messages_uncompressed,
+           1e6 * cpu_compress / messages, 1e6 * cpu_decompress / messages, errors);
+
+    wsDeflateReset(&client);
+    wsDeflateReset(&server);
+}
+
+/* event with an array of measurements, e.g. a waveform */
+static size_t bench_array_message(char* buffer, size_t size, uint32_t i){
+    size_t length = (size_t) snprintf(buffer, size, "E [{\"uuid\":\"%s\",\"eventId\":\"Samples\",\"priority\":1,"
+                                      "\"postDate\":\"2026-10-19T08:00:00.000Z\",\"dataObject\":[", BENCH_UUID);
+    uint32_t j;
+
+    for (j = 0; j < 64 && length < size; ++j)
+        length += (size_t) snprintf(buffer + length, size - length, "%s%g", j > 0 ? "," : "", (i + j) % 1000 / 7.0);
+    if (length < size) length += (size_t) snprintf(buffer + length, size - length, "]}]");
+
+    return length;
+}
+
+static void bench_codec(const msbCodec* codec, const char* shape, size_t (*message)(char*, size_t, uint32_t),
+                        uint32_t messages){
+    msbCodecBuffer frame = {NULL, 0, 0};
+    msbCodecBuffer decoded = {NULL, 0, 0};
+    char msg[2048];
+    uint64_t raw = 0, wire = 0;
+    uint32_t i, errors = 0;
+    double cpu_encode = 0, cpu_decode = 0, t;
+
+    for (i = 0; i < messages; ++i) {
+        size_t length = message(msg, sizeof(msg), i);
+        raw += length;
+
+        if (codec->encode == NULL) {
+            wire += length;
+            continue;
+        }
+
+        frame.used = 0;
+        t = bench_cpu_seconds();
+        int ret = codec->encode(msg, length, &frame);
+        cpu_encode += bench_cpu_seconds() - t;
+
+        if (ret != 1) {
+            wire += length;
+            ++errors;
+            continue;
+        }
+        wire += frame.used;
+
+        decoded.used = 0;
+        t = bench_cpu_seconds();
+        ret = codec->decode(frame.data, frame.used, &decoded);
+        cpu_decode += bench_cpu_seconds() - t;
+
+        if (ret != 0 || decoded.used != length || memcmp(decoded.data, msg, length) != 0) ++errors;
+    }
+
+    printf("codec %-8s %-7s | raw %9llu B  wire %9llu B  ratio %5.1f%%  | cpu encode %6.2f us/msg  decode %6.2f us/msg  "
+           "errors %u\n", codec->name, shape, (unsigned long long) raw, (unsigned long long) wire, 100.0 * wire / raw,
+           1e6 * cpu_encode / messages, 1e6 * cpu_decode / messages, errors);
+
+    free(frame.data);
+    free(decoded.data);
+}
+
+/* minimal websocket server for the transport benchmark: echoes every message, or counts them and answers "done" */
+typedef struct {
+    int listen_fd;
+    uint16_t port;
+    bool echo;
+    uint32_t expected;
+} bench_server;
+
+static bool bench_read_full(int fd, unsigned char* buffer, size_t length){
+    size_t got = 0;
+    while (got < length) {
+        ssize_t r = recv(fd, buffer + got, length - got, 0);
+        if (r <= 0) return false;
+        got += (size_t) r;
+    }
+    return true;
+}
+
+static void bench_server_send(int fd, const char* payload, size_t length){
+    unsigned char header[10];
+    size_t header_length = 2;
+
+    header[0] = 0x81;
+    if (length < 126) {
+        header[1] = (unsigned char) length;
+    } else if (length < 65536) {
+        header[1] = 126;
+        header[2] = (unsigned char) (length >> 8);
+        header[3] = (unsigned char) length;
+        header_length = 4;
+    } else {
+        int i;
+        header[1] = 127;
+        for (i = 0; i < 8; ++i) header[2 + i] = (unsigned char) ((uint64_t) length >> (56 - 8 * i));
+        header_length = 10;
+    }
+
+    send(fd, header, header_length, MSG_NOSIGNAL | MSG_MORE);
+    send(fd, payload, length, MSG_NOSIGNAL);
+}
+
+static void* bench_server_thread(void* arg){
+    bench_server* server = (bench_server*) arg;
+
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0) return NULL;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    char request[4096];
+    size_t used = 0;
+    while (used < sizeof(request) - 1) {
+        ssize_t r = recv(fd, request + used, sizeof(request) - 1 - used, 0);
+        if (r <= 0) break;
+        used += (size_t) r;
+        request[used] = 0;
+        if (strstr(request, "\r\n\r\n") != NULL) break;
+    }
+
+    char key[64] = {0};
+    char* k = strstr(request, "Sec-WebSocket-Key: ");
+    if (k != NULL) sscanf(k + strlen("Sec-WebSocket-Key: "), "%63s", key);
+
+    char accept_key[29];
+    wsNativeAcceptKey(key, accept_key);
+
+    char response[256];
+    int response_length = snprintf(response, sizeof(response),
+                                   "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                   "Sec-WebSocket-Accept: %s\r\n\r\n", accept_key);
+    send(fd, response, (size_t) response_length, MSG_NOSIGNAL);
+
+    size_t capacity = 1 << 16;
+    unsigned char* payload = malloc(capacity);
+    uint32_t received = 0;
+    unsigned char header[14];
+
+    while (bench_read_full(fd, header, 2)) {
+        uint8_t opcode = header[0] & 0x0f;
+        uint64_t length = header[1] & 0x7f;
+        int i;
+
+        if (length == 126) {
+            if (!bench_read_full(fd, header + 2, 2)) break;
+            length = (uint64_t) header[2] << 8 | header[3];
+        } else if (length == 127) {
+            if (!bench_read_full(fd, header + 2, 8)) break;
+            length = 0;
+            for (i = 0; i < 8; ++i) length = length << 8 | header[2 + i];
+        }
+
+        unsigned char mask[4];
+        if (!bench_read_full(fd, mask, 4)) break;
+
+        if (length + 1 > capacity) {
+            capacity = (size_t) length + 1;
+            payload = realloc(payload, capacity);
+        }
+        if (!bench_read_full(fd, payload, (size_t) length)) break;
+        wsNativeMask(payload, payload, (size_t) length, mask);
+
+        if (opcode == 0x8) break;
+        if (opcode != 0x1) continue;
+
+        if (server->echo) {
+            bench_server_send(fd, (char*) payload, (size_t) length);
+        } else if (++received == server->expected) {
+            bench_server_send(fd, "done", 4);
+            received = 0;
+        }
+    }
+
+    free(payload);
+    close(fd);
+
+    return NULL;
+}
+
+static bool bench_server_start(bench_server* server, pthread_t* thread){
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 || bind(server->listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 1) != 0)
+        return false;
+
+    socklen_t l = sizeof(addr);
+    getsockname(server->listen_fd, (struct sockaddr*) &addr, &l);
+    server->port = ntohs(addr.sin_port);
+
+    return pthread_create(thread, NULL, bench_server_thread, server) == 0;
+}
+
+static int bench_compare_double(const void* a, const void* b){
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static char* bench_wait_message(wsData* ws, double timeout){
+    double end = bench_wall_seconds() + timeout;
+    char* msg;
+
+    while ((msg = wsGetMsgContent(ws)) == NULL && bench_wall_seconds() < end);
+
+    return msg;
+}
+
+static void bench_transport(enum wsTransport transport, uint32_t messages, size_t size){
+    const char* name = transport == WS_TRANSPORT_NATIVE ? "native" : "nopoll";
+    uint32_t i;
+
+    char* payload = malloc(size + 1);
+    memset(payload, 'x', size);
+    payload[size] = 0;
+
+    /* throughput: the server counts the messages and answers when all arrived */
+    bench_server server = {-1, 0, false, messages};
+    pthread_t thread;
+    char port[8];
+
+    if (!bench_server_start(&server, &thread)) {
+        printf("transport %s: starting server failed\n", name);
+        free(payload);
+        return;
+    }
+    sprintf(port, "%u", server.port);
+
+    wsData* ws = wsDataConstr(false, "127.0.0.1", port, "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    if (wsSetTransport(ws, transport) != 0) {
+        printf("transport %s: not available\n", name);
+        close(server.listen_fd);
+        free(payload);
+        return;
+    }
+
+    wsInitialise(ws, false);
+    wsConnect(ws);
+
+    if (!wsIsConnectionReady(ws, 1000000)) {
+        printf("transport %s: connecting failed\n", name);
+        wsDeinitialise(ws);
+        shutdown(server.listen_fd, SHUT_RDWR);
+        close(server.listen_fd);
+        pthread_join(thread, NULL);
+        free(payload);
+        return;
+    }
+
+    double wall = bench_wall_seconds(), cpu = bench_cpu_seconds();
+    uint32_t failed = 0;
+
+    for (i = 0; i < messages; ++i)
+        if (wsSend(ws, payload, size) != 0) ++failed;
+
+    char* done = bench_wait_message(ws, 10.0);
+
+    wall = bench_wall_seconds() - wall;
+    cpu = bench_cpu_seconds() - cpu;
+
+    printf("transport %s  size %6lu  | throughput %9.0f msg/s  %8.1f MB/s  cpu %6.2f us/msg  failed %u%s\n",
+           name, (unsigned long) size, messages / wall, messages * size / wall / 1e6, 1e6 * cpu / messages, failed,
+           done == NULL ? "  (incomplete)" : "");
+
+    wsDisconnect(ws);
+    wsDeinitialise(ws);
+    pthread_join(thread, NULL);
+    close(server.listen_fd);
+
+    /* latency: round trip of a single message through the echo server */
+    server.echo = true;
+    if (!bench_server_start(&server, &thread)) {
+        free(payload);
+        return;
+    }
+    sprintf(port, "%u", server.port);
+    free(ws->connData->targetPort);
+    ws->connData->targetPort = strdup(port);
+
+    wsInitialise(ws, false);
+    wsConnect(ws);
+
+    uint32_t rounds = messages < 10000 ? messages : 10000;
+    double* rtt = malloc(rounds * sizeof(double));
+    uint32_t answered = 0;
+
+    for (i = 0; i < rounds && wsIsConnectionOK(ws); ++i) {
+        double t = bench_wall_seconds();
+        wsSend(ws, payload, size);
+        if (bench_wait_message(ws, 1.0) == NULL) break;
+        rtt[answered++] = bench_wall_seconds() - t;
+    }
+
+    if (answered > 0) {
+        qsort(rtt, answered, sizeof(double), bench_compare_double);
+        printf("transport %s  size %6lu  | round trip p50 %7.1f us  p99 %7.1f us  max %7.1f us  (%u rounds)\n",
+               name, (unsigned long) size, 1e6 * rtt[answered / 2], 1e6 * rtt[answered * 99 / 100],
+               1e6 * rtt[answered - 1], answered);
+    }
+
+    free(rtt);
+
+    wsDisconnect(ws);
+    wsDeinitialise(ws);
+    pthread_join(thread, NULL);
+    close(server.listen_fd);
+
+    wsDataDestr(ws);
+    free(payload);
+}
+
+/* initialisation of TLS connections: the first one sets up the SSL context, all others share it */
+static void bench_shared_tls(uint32_t n){
+    wsData** ws = calloc(n, sizeof(wsData*));
+    double first = 0, others = 0;
+    uint32_t i;
+
+    for (i = 0; i < n; ++i) {
+        ws[i] = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+        if (wsSetTransport(ws[i], WS_TRANSPORT_NATIVE) != 0) {
+            printf("shared tls: native transport not available\n");
+            n = i + 1;
+            break;
+        }
+
+        double t = bench_wall_seconds();
+        wsInitialise(ws[i], false);
+        t = bench_wall_seconds() - t;
+
+        if (i == 0)
+            first = t;
+        else
+            others += t;
+    }
+
+    if (n > 1)
+        printf("shared tls  %4u connections | first initialise %8.1f us  others %6.1f us  ssl contexts %u\n", n,
+               1e6 * first, 1e6 * others / (n - 1), wsSharedTLSContexts());
+
+    for (i = 0; i < n; ++i) wsDataDestr(ws[i]);
+    free(ws);
+}
+
+#ifdef WS_NATIVE_OPENSSL
+/* local TLS websocket endpoint with a throwaway certificate, answering the upgrade and waiting for the close */
+typedef struct {
+    int listen_fd;
+    uint16_t port;
+    SSL_CTX* ctx;
+} bench_tls_server;
+
+static void* bench_tls_server_thread(void* arg){
+    bench_tls_server* server = (bench_tls_server*) arg;
+    int fd;
+
+    while ((fd = accept(server->listen_fd, NULL, NULL)) >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        SSL* ssl = SSL_new(server->ctx);
+        SSL_set_fd(ssl, fd);
+
+        if (SSL_accept(ssl) == 1) {
+            char request[4096];
+            int used = 0, r;
+            while (used < (int) sizeof(request) - 1 && (r = SSL_read(ssl, request + used, (int) sizeof(request) - 1 - used)) > 0) {
+                used += r;
+                request[used] = 0;
+                if (strstr(request, "\r\n\r\n") != NULL) break;
+            }
+            request[used] = 0;
+
+            char key[64] = {0};
+            char* k = strstr(request, "Sec-WebSocket-Key: ");
+            if (k != NULL) sscanf(k + strlen("Sec-WebSocket-Key: "), "%63s", key);
+
+            char accept_key[29];
+            wsNativeAcceptKey(key, accept_key);
+
+            char response[256];
+            int response_length = snprintf(response, sizeof(response),
+                                           "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                           "Sec-WebSocket-Accept: %s\r\n\r\n", accept_key);
+            SSL_write(ssl, response, response_length);
+
+            while (SSL_read(ssl, request, sizeof(request)) > 0);
+        }
+
+        SSL_free(ssl);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+/* connect and disconnect repeatedly, full handshakes against resumed sessions */
+static void bench_tls_resumption(uint32_t rounds){
+    bench_tls_server server;
+    pthread_t thread;
+    char port[8];
+    int resumption;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    server.ctx = mockBrokerTLSContext();
+    server.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server.ctx == NULL || server.listen_fd < 0 || bind(server.listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 ||
+        listen(server.listen_fd, 16) != 0) {
+        printf("tls resumption: starting server failed\n");
+        return;
+    }
+
+    socklen_t l = sizeof(addr);
+    getsockname(server.listen_fd, (struct sockaddr*) &addr, &l);
+    server.port = ntohs(addr.sin_port);
+    sprintf(port, "%u", server.port);
+
+    pthread_create(&thread, NULL, bench_tls_server_thread, &server);
+
+    for (resumption = 0; resumption < 2; ++resumption) {
+        wsData* ws = wsDataConstr(false, "127.0.0.1", port, "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+        if (wsSetTransport(ws, WS_TRANSPORT_NATIVE) != 0) {
+            printf("tls resumption: native transport not available\n");
+            wsDataDestr(ws);
+            break;
+        }
+        wsSetTLSVerification(ws, false);
+        wsSetTLSSessionResumption(ws, resumption == 1);
+        wsInitialise(ws, false);
+
+        double* t = malloc(rounds * sizeof(double));
+        double cpu = bench_cpu_seconds();
+        uint32_t i, connected = 0;
+
+        for (i = 0; i < rounds; ++i) {
+            double start = bench_wall_seconds();
+            wsConnect(ws);
+            if (wsIsConnectionReady(ws, 1000000)) t[connected++] = bench_wall_seconds() - start;
+            wsDisconnect(ws);
+        }
+
+        cpu = bench_cpu_seconds() - cpu;
+
+        uint32_t handshakes, resumed;
+        wsGetTLSHandshakes(ws, &handshakes, &resumed);
+
+        if (connected > 0) {
+            qsort(t, connected, sizeof(double), bench_compare_double);
+            printf("tls resumption %-3s | connect p50 %7.1f us  p99 %7.1f us  cpu %7.1f us/connect (client and server)  "
+                   "handshakes %u, resumed %u\n", resumption ? "on" : "off", 1e6 * t[connected / 2],
+                   1e6 * t[connected * 99 / 100], 1e6 * cpu / rounds, handshakes, resumed);
+        }
+
+        free(t);
+        wsDeinitialise(ws);
+        wsDataDestr(ws);
+    }
+
+    shutdown(server.listen_fd, SHUT_RDWR);
+    close(server.listen_fd);
+    pthread_join(thread, NULL);
+    SSL_CTX_free(server.ctx);
+}
+#endif
+
+/* latencies of events which carry the monotonic time of their publication as data object */
+typedef struct {
+    double* latency;
+    volatile uint32_t count;
+    uint32_t capacity;
+} bench_latencies;
+
+static void bench_latency_event(mockBroker* broker, int connection, const char* msg, size_t length, void* context){
+    bench_latencies* l = (bench_latencies*) context;
+    const char* d = strstr(msg, "\"dataObject\":");
+
+    if (d != NULL && l->count < l->capacity) l->latency[l->count++] = bench_wall_seconds() - strtod(d + strlen("\"dataObject\":"), NULL);
+}
+
+/* n native clients, each in its own thread (threads == 0) or on a group of the given size, publishing every 100 ms */
+static void bench_group(uint32_t n, uint32_t threads, uint32_t rounds){
+    uint32_t i, r;
+    char mode[32];
+
+    if (threads == 0)
+        sprintf(mode, "own threads");
+    else
+        sprintf(mode, "group of %u", threads);
+
+    bench_latencies latencies = {malloc(n * rounds * sizeof(double)), 0, n * rounds};
+    mockBrokerConfig config = {0, false, false, false, NULL, bench_latency_event, &latencies};
+    mockBroker* broker = mockBrokerStart(&config);
+    char port[8];
+
+    if (broker == NULL) {
+        printf("clients %4u  %-12s | starting broker failed\n", n, mode);
+        free(latencies.latency);
+        return;
+    }
+    sprintf(port, "%u", broker->port);
+
+    msbClient** clients = calloc(n, sizeof(msbClient*));
+    msbClientGroup* group = threads > 0 ? msbClientGroupNew(threads) : NULL;
+    bool running = true;
+
+    for (i = 0; i < n && running; ++i) {
+        clients[i] = msbClientNewClient(false, "127.0.0.1", port, "127.0.0.1", "/", NULL, BENCH_UUID, "token",
+                                        "SmartObject", "bench", "bench", false, NULL, NULL, NULL);
+        if (!msbClientSetTransport(clients[i], MSB_TRANSPORT_NATIVE)) running = false;
+        msbClientAddEvent(clients[i], "Ev0", "Event", "Timestamp", MSB_NUMBER, MSB_DOUBLE, false);
+
+        if (group != NULL)
+            running = running && msbClientGroupAdd(group, clients[i]);
+        else
+            running = running && msbClientRunClientStateMachine(clients[i]) == 0;
+    }
+
+    double end = bench_wall_seconds() + 30.0;
+    while (running && broker->registered < n && bench_wall_seconds() < end) usleep(10000);
+
+    if (!running || broker->registered < n) {
+        printf("clients %4u  %-12s | only %u clients registered\n", n, mode, broker->registered);
+    } else {
+        /* let the connection phase settle before measuring the steady state */
+        usleep(500000);
+
+        double wall = bench_wall_seconds(), cpu = bench_cpu_seconds(), broker_cpu = broker->cpu;
+
+        for (r = 0; r < rounds; ++r) {
+            double next = bench_wall_seconds() + 0.1;
+            for (i = 0; i < n; ++i) {
+                double now = bench_wall_seconds();
+                msbClientPublish(clients[i], "Ev0", LOW, &now, 0, NULL);
+            }
+            while (bench_wall_seconds() < next) usleep(1000);
+        }
+
+        end = bench_wall_seconds() + 2.0;
+        while (latencies.count < n * rounds && bench_wall_seconds() < end) usleep(1000);
+
+        wall = bench_wall_seconds() - wall;
+        cpu = bench_cpu_seconds() - cpu - (broker->cpu - broker_cpu);
+
+        uint32_t count = latencies.count;
+        if (count > 0) {
+            qsort(latencies.latency, count, sizeof(double), bench_compare_double);
+            printf("clients %4u  %-12s | cpu %5.1f %%  latency p50 %8.1f us  p99 %8.1f us  max %8.1f us  (%u/%u events)\n",
+                   n, mode, 100.0 * cpu / wall, 1e6 * latencies.latency[count / 2],
+                   1e6 * latencies.latency[count * 99 / 100], 1e6 * latencies.latency[count - 1], count, n * rounds);
+        }
+    }
+
+    if (group != NULL) msbClientGroupDelete(group);
+
+    for (i = 0; i < n && clients[i] != NULL; ++i) {
+        if (group == NULL && clients[i]->thread_running) msbClientHaltClientStateMachine(clients[i]);
+        msbClientDeleteClient(clients[i]);
+    }
+
+    mockBrokerStop(broker);
+
+    free(clients);
+    free(latencies.latency);
+}
+
+/* function calls carrying the monotonic time of their sending as data object, timed when their callback runs */
+typedef struct {
+    bench_latencies latencies;
+    volatile int connection;
+} bench_receive_run;
+
+static void bench_receive_registration(mockBroker* broker, int connection, const char* uuid, void* context){
+    ((bench_receive_run*) context)->connection = connection;
+}
+
+static void bench_receive_call(void* client, void* parameters, void* context){
+    bench_latencies* l = (bench_latencies*) context;
+    json_object* data = json_object_object_get((json_object*) parameters, "dataObject");
+
+    if (data != NULL && l->count < l->capacity) l->latency[l->count++] = bench_wall_seconds() - json_object_get_double(data);
+}
+
+/* one client in its own thread, idle for two seconds and then called at random points of its cycle */
+static void bench_receive_mode(MsbTransport transport, MsbReceiveMode mode, uint16_t pause_ms, uint32_t calls){
+    const char* name = transport == MSB_TRANSPORT_NATIVE ? "native" : "nopoll";
+    const char* receive = mode == MSB_RECEIVE_CALLBACK ? "callback" : "polling";
+    bench_receive_run run = {{malloc(calls * sizeof(double)), 0, calls}, -1};
+    mockBrokerConfig config = {0, false, false, false, bench_receive_registration, NULL, &run};
+    mockBroker* broker = mockBrokerStart(&config);
+    char port[8], parameters[64];
+    uint32_t r;
+
+    if (broker == NULL) {
+        printf("receive %s %-8s pause %3u ms | starting broker failed\n", name, receive, pause_ms);
+        free(run.latencies.latency);
+        return;
+    }
+    sprintf(port, "%u", broker->port);
+
+    msbClient* client = msbClientNewClient(false, "127.0.0.1", port, "127.0.0.1", "/", NULL, BENCH_UUID, "token",
+                                           "SmartObject", "bench", "bench", false, NULL, NULL, NULL);
+    bool running = msbClientSetTransport(client, transport) && msbClientSetReceiveMode(client, mode);
+
+    msbClientSetStateMachineCyclePause(client, pause_ms);
+    msbClientAddFunction(client, "F0", "Timed", "Receives its sending time", &bench_receive_call, MSB_NUMBER, MSB_DOUBLE,
+                         false, &run.latencies);
+    running = running && msbClientRunClientStateMachine(client) == 0;
+
+    double end = bench_wall_seconds() + 10.0;
+    while (running && run.connection < 0 && bench_wall_seconds() < end) usleep(10000);
+
+    if (run.connection < 0) {
+        printf("receive %s %-8s pause %3u ms | registration failed\n", name, receive, pause_ms);
+    } else {
+        usleep(500000);
+
+        double wall = bench_wall_seconds(), cpu = bench_cpu_seconds(), broker_cpu = broker->cpu;
+        usleep(2000000);
+        wall = bench_wall_seconds() - wall;
+        cpu = bench_cpu_seconds() - cpu - (broker->cpu - broker_cpu);
+
+        for (r = 0; r < calls; ++r) {
+            sprintf(parameters, "{\"dataObject\":%.9f}", bench_wall_seconds());
+            mockBrokerCallFunction(broker, run.connection, "F0", parameters, NULL);
+
+            end = bench_wall_seconds() + 1.0;
+            while (run.latencies.count <= r && bench_wall_seconds() < end) usleep(100);
+            usleep(1000 + (r * 7919) % 20000);
+        }
+
+        uint32_t count = run.latencies.count;
+        if (count > 0) {
+            qsort(run.latencies.latency, count, sizeof(double), bench_compare_double);
+            printf("receive %s %-8s pause %3u ms | idle cpu %6.3f %%  latency p50 %8.1f us  p99 %8.1f us  max %8.1f us  (%u/%u calls)\n",
+                   name, receive, pause_ms, 100.0 * cpu / wall, 1e6 * run.latencies.latency[count / 2],
+                   1e6 * run.latencies.latency[count * 99 / 100], 1e6 * run.latencies.latency[count - 1], count, calls);
+        }
+    }
+
+    if (client->thread_running) msbClientHaltClientStateMachine(client);
+    msbClientDeleteClient(client);
+
+    mockBrokerStop(broker);
+
+    free(run.latencies.latency);
+}
+
+static size_t bench_heap_in_use(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return (size_t) mallinfo().uordblks;
+#endif
+}
+
+/* the layout msbObject had before the arena: every string, node and descriptor a heap block of its own */
+static void bench_model_scattered_add(schll_list* list, const char* id){
+    msbObjectEvent e;
+    memset(&e, 0, sizeof(e));
+
+    e.eventId = strdup(id);
+    e.name = strdup("Benchmark Event");
+    e.description = strdup("Event of the model benchmark");
+
+    json_object* dObjectRoot = json_object_new_object();
+    e.dataFormat = json_object_new_object();
+    json_object_object_add(e.dataFormat, "dataObject", dObjectRoot);
+    json_object_object_add(dObjectRoot, "type", json_object_new_string("integer"));
+    json_object_object_add(dObjectRoot, "format", json_object_new_string("int32"));
+
+    schll_addEntry(list, e.eventId, 0, &e, 1, sizeof(msbObjectEvent));
+}
+
+static double bench_model_lookups(const schll_list* list, char** ids, uint32_t n){
+    uint32_t i, found = 0;
+    double t = bench_wall_seconds();
+
+    for (i = 0; i < n; ++i)
+        if (schll_getValuePointer(list, ids[i]) != NULL) found++;
+
+    t = bench_wall_seconds() - t;
+
+    return found == n ? t : -1;
+}
+
+static void bench_object_model(uint32_t n){
+    char** ids = calloc(n, sizeof(char*));
+    uint32_t i;
+
+    for (i = 0; i < n; ++i) {
+        ids[i] = malloc(32);
+        sprintf(ids[i], "model_event_%u", i);
+    }
+    srand(42);
+    for (i = n - 1; i > 0; --i) {
+        uint32_t j = (uint32_t) rand() % (i + 1);
+        char* t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+
+    /* scattered */
+    size_t heap = bench_heap_in_use();
+    schll_list* list = schll_MakeListPointer();
+    for (i = 0; i < n; ++i) bench_model_scattered_add(list, ids[i]);
+    size_t scattered_heap = bench_heap_in_use() - heap;
+    double scattered_lookup = bench_model_lookups(list, ids, n);
+
+    double scattered_teardown = bench_wall_seconds();
+    schll_entry* entry;
+    for (entry = list->first_entry; entry != NULL; entry = entry->next_entry) {
+        msbObjectEvent* e = (msbObjectEvent*) entry->value;
+        free(e->name);
+        free(e->description);
+        json_object_put(e->dataFormat);
+        free(e->eventId);
+    }
+    schll_DeleteList(&list, 0, 1);
+    scattered_teardown = bench_wall_seconds() - scattered_teardown;
+
+    /* arena */
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, BENCH_UUID, "model", "SMART_OBJECT",
+                                              "Model Benchmark", "Model Benchmark", false, NULL, NULL, NULL);
+    heap = bench_heap_in_use();
+    size_t arena_allocated = client->msbObjectData->arena.allocated;
+    for (i = 0; i < n; ++i)
+        msbClientAddEvent(client, ids[i], "Benchmark Event", "Event of the model benchmark", MSB_INTEGER, MSB_INT32, false);
+    size_t arena_heap = bench_heap_in_use() - heap;
+    double arena_lookup = bench_model_lookups(client->msbObjectData->eventArray, ids, n);
+    arena_allocated = client->msbObjectData->arena.allocated - arena_allocated;
+    unsigned int arena_chunks = client->msbObjectData->arena.number_chunks;
+    /* the json data formats are the same in both layouts, what remains is the model data itself */
+    size_t json_heap = arena_heap - arena_allocated;
+
+    double arena_teardown = bench_wall_seconds();
+    msbObjectDestroyObject(client->msbObjectData);
+    arena_teardown = bench_wall_seconds() - arena_teardown;
+    client->msbObjectData = NULL;
+    msbClientDeleteClient(client);
+
+    printf("model %5u events | scattered %8zu B in %6u blocks  lookup %8.1f ns  teardown %7.1f us"
+           " | arena %8zu B in %3u chunks  lookup %8.1f ns  teardown %7.1f us\n",
+           n, scattered_heap - json_heap, 5 * n, 1e9 * scattered_lookup / n, 1e6 * scattered_teardown,
+           arena_allocated, arena_chunks, 1e9 * arena_lookup / n, 1e6 * arena_teardown);
+
+    for (i = 0; i < n; ++i) free(ids[i]);
+    free(ids);
+}
+
+typedef struct {
+    msbClient* client;
+    msbObjectEvent* ev;
+    json_object* root;
+    uint32_t messages;
+} bench_pool_producer;
+
+/* the application thread serialises and queues events, the state machine thread takes them out after sending */
+static void* bench_pool_producer_thread(void* arg){
+    bench_pool_producer* p = (bench_pool_producer*) arg;
+    uint32_t i;
+
+    for (i = 0; i < p->messages; ++i) {
+        while (list_count_entries(p->client->outgoing_data) >= 64) sched_yield();
+
+        size_t l;
+        char* msg = msbClientEventMessage(p->client, p->root, &l);
+        msbClientQueueEvent(p->client, p->ev, msg, l, NULL, 0);
+    }
+
+    return NULL;
+}
+
+static void bench_buffer_pool(uint32_t messages, size_t size, bool pooled){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, BENCH_UUID, "pool", "SMART_OBJECT",
+                                              "Pool Benchmark", "Pool Benchmark", false, NULL, NULL, NULL);
+    mpool* pool = client->buffer_pool;
+    uint32_t i;
+
+    if (!pooled) client->buffer_pool = NULL;
+
+    msbClientAddEvent(client, "Ev0", "Event", "Event of the pool benchmark", MSB_STRING, MSB_NONE, false);
+    msbClientAutomatBegin(client);
+
+    char* payload = malloc(size + 1);
+    memset(payload, 'x', size);
+    payload[size] = '\0';
+
+    bench_pool_producer producer = {client, schll_getValuePointer(client->msbObjectData->eventArray, "Ev0"),
+                                    json_object_new_object(), messages};
+    json_object_object_add(producer.root, "eventId", json_object_new_string("Ev0"));
+    json_object_object_add(producer.root, "dataObject", json_object_new_string(payload));
+    json_object_to_json_string(producer.root);
+
+    char* received = malloc(size + 64);
+    size_t received_l = (size_t) snprintf(received, size + 64, "C {\"functionId\":\"F0\",\"data\":\"%s\"}", payload);
+
+    double wall = bench_wall_seconds(), cpu = bench_cpu_seconds();
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, bench_pool_producer_thread, &producer);
+
+    for (i = 0; i < messages; ++i) {
+        while (list_count_entries(client->outgoing_data) == 0) sched_yield();
+        list_pop(client->outgoing_data, 0, 1);
+
+        list_add(client->incoming_data, received, 1, received_l + 1);
+        list_pop(client->incoming_data, 0, 1);
+    }
+    pthread_join(thread, NULL);
+
+    wall = bench_wall_seconds() - wall;
+    cpu = bench_cpu_seconds() - cpu;
+
+    uint64_t hits = 0, misses = 0, oversized = 0;
+    msbClientGetBufferPoolStatistics(client, &hits, &misses, &oversized);
+    if (pooled)
+        printf("buffers pooled  size %6zu | %6.2f us/msg  cpu %6.2f us/msg  hit rate %5.1f %%  (hits %" PRIu64 ", misses %" PRIu64 ", oversized %" PRIu64 ")\n",
+               size, 1e6 * wall / messages, 1e6 * cpu / messages, 100.0 * hits / (hits + misses + oversized), hits, misses, oversized);
+    else
+        printf("buffers malloc  size %6zu | %6.2f us/msg  cpu %6.2f us/msg\n", size, 1e6 * wall / messages, 1e6 * cpu / messages);
+
+    json_object_put(producer.root);
+    if (list_deleteList(client->incoming_data, 1) == EINFL_NO_ENTRIES) free(client->incoming_data);
+    if (list_deleteList(client->outgoing_data, 1) == EINFL_NO_ENTRIES) free(client->outgoing_data);
+    client->incoming_data = client->outgoing_data = NULL;
+    client->buffer_pool = pool;
+    msbClientDeleteClient(client);
+
+    free(payload);
+    free(received);
+}
+
+typedef struct {
+    msbClient* client;
+    uint32_t messages;
+    uint64_t retries;
+} bench_publisher;
+
+/* an acquisition thread publishing as fast as it can, a full queue or stage is retried */
+static void* bench_publisher_thread(void* arg){
+    bench_publisher* p = (bench_publisher*) arg;
+    uint32_t i;
+
+    for (i = 0; i < p->messages; ++i) {
+        char json[16];
+        size_t l = (size_t) snprintf(json, sizeof(json), "%u", i);
+
+        while (msbClientPublishJSONWithCompletion(p->client, "Ev0", MEDIUM, json, l, NULL, NULL) != 0) {
+            p->retries++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/* concurrent publishers on one client, the calling thread stands in for the state machine and empties the queue */
+static void bench_publish_scaling(uint32_t messages, uint32_t threads, bool staged){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, BENCH_UUID, "staging", "SMART_OBJECT",
+                                              "Staging Benchmark", "Staging Benchmark", false, NULL, NULL, NULL);
+    bench_publisher* publishers = calloc(threads, sizeof(bench_publisher));
+    pthread_t* ids = calloc(threads, sizeof(pthread_t));
+    uint64_t popped = 0, total = (uint64_t) (messages / threads) * threads, retries = 0;
+    uint32_t i;
+
+    msbClientAddEvent(client, "Ev0", "Event", "Event of the staging benchmark", MSB_INTEGER, MSB_INT32, false);
+    client->maxNumberDataOutgoing = 32768;
+    if (staged) msbClientSetPublishStaging(client, 1024);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    double wall = bench_wall_seconds(), cpu = bench_cpu_seconds();
+
+    for (i = 0; i < threads; ++i) {
+        publishers[i].client = client;
+        publishers[i].messages = messages / threads;
+        pthread_create(&ids[i], NULL, bench_publisher_thread, &publishers[i]);
+    }
+
+    /* the queue holds all stages, so merging never drops */
+    while (popped < total) {
+        bool merged = msbClientMergeStaged(client) > 0;
+
+        while (list_pop(client->outgoing_data, 0, 1) == EINFL_OK) popped++;
+
+        if (!merged) sched_yield();
+    }
+
+    for (i = 0; i < threads; ++i) {
+        pthread_join(ids[i], NULL);
+        retries += publishers[i].retries;
+    }
+
+    wall = bench_wall_seconds() - wall;
+    cpu = bench_cpu_seconds() - cpu;
+
+    printf("publishers %2u  %-7s | %7.0f k msg/s  cpu %6.2f us/msg  retries %" PRIu64 "\n", threads,
+           staged ? "staged" : "queued", total / wall / 1000, 1e6 * cpu / total, retries);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+
+    free(publishers);
+    free(ids);
+}
+
+int main(int argc, char** argv){
+
+    uint32_t messages = 100000;
+    size_t i;
+    if (argc > 1) messages = (uint32_t) strtoul(argv[1], NULL, 10);
+
+    printf("%u event messages per run\n", messages);
+
+    bench_deflate(messages, 15, true, 0);
+    bench_deflate(messages, 15, false, 0);
+    bench_deflate(messages, 12, true, 0);
+    bench_deflate(messages, 9, true, 0);
+    bench_deflate(messages, 15, true, 256);
+
+    bench_codec(&msbCodecJSON, "event", bench_event_message, messages);
+    bench_codec(&msbCodecMessagePack, "event", bench_event_message, messages);
+    bench_codec(&msbCodecJSON, "array", bench_array_message, messages / 10);
+    bench_codec(&msbCodecMessagePack, "array", bench_array_message, messages / 10);
+
+    size_t sizes[] = {64, 1024, 65536};
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        uint32_t n = sizes[i] > 4096 ? messages / 100 : messages;
+        bench_transport(WS_TRANSPORT_NOPOLL, n, sizes[i]);
+        bench_transport(WS_TRANSPORT_NATIVE, n, sizes[i]);
+    }
+
+    size_t buffer_sizes[] = {64, 1024, 16384, 131072};
+    for (i = 0; i < sizeof(buffer_sizes) / sizeof(buffer_sizes[0]); ++i) {
+        uint32_t n = buffer_sizes[i] > 4096 ? messages / 10 : messages;
+        bench_buffer_pool(n, buffer_sizes[i], false);
+        bench_buffer_pool(n, buffer_sizes[i], true);
+    }
+
+    uint32_t publishers[] = {1, 2, 4, 8, 16, 32};
+    for (i = 0; i < sizeof(publishers) / sizeof(publishers[0]); ++i) {
+        bench_publish_scaling(messages, publishers[i], false);
+        bench_publish_scaling(messages, publishers[i], true);
+    }
+
+    uint32_t models[] = {100, 1000, 5000};
+    for (i = 0; i < sizeof(models) / sizeof(models[0]); ++i) bench_object_model(models[i]);
+
+    bench_shared_tls(100);
+#ifdef WS_NATIVE_OPENSSL
+    bench_tls_resumption(200);
+#endif
+
+    uint16_t pauses[] = {10, 100};
+    for (i = 0; i < sizeof(pauses) / sizeof(pauses[0]); ++i) {
+        bench_receive_mode(MSB_TRANSPORT_NOPOLL, MSB_RECEIVE_POLLING, pauses[i], 200);
+        bench_receive_mode(MSB_TRANSPORT_NOPOLL, MSB_RECEIVE_CALLBACK, pauses[i], 200);
+        bench_receive_mode(MSB_TRANSPORT_NATIVE, MSB_RECEIVE_POLLING, pauses[i], 200);
+        bench_receive_mode(MSB_TRANSPORT_NATIVE, MSB_RECEIVE_CALLBACK, pauses[i], 200);
+    }
+
+    uint32_t clients[] = {10, 100, 1000};
+    for (i = 0; i < sizeof(clients) / sizeof(clients[0]); ++i) {
+        bench_group(clients[i], 0, 30);
+        bench_group(clients[i], 4, 30);
+    }
+
+    return 0;
+}
@@ -0,0 +1,404 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * End to end benchmark of the client against the local stand-in broker: publish throughput, latency from publishing to
+ * the broker and round trip of function calls answered with a response event, for several client counts and payload
+ * sizes. With -b it only runs the broker, so the example and other clients can be tried without an MSB.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sched.h>
+
+#include "libMsbClientC.h"
+#include "mockbroker.h"
+
+#define E2E_UUID "a209efb9-af3f-4d93-bad4-%012x"
+#define E2E_QUEUE 64
+
+typedef struct {
+    double* samples;
+    volatile uint32_t count;
+    uint32_t capacity;
+} e2e_samples;
+
+typedef struct {
+    uint32_t n;
+    int* connections;
+    volatile bool measure;
+    e2e_samples latency;
+    e2e_samples rtt;
+} e2e_run;
+
+static volatile bool e2e_stop = false;
+
+static double e2e_wall_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double e2e_cpu_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int e2e_compare_double(const void* a, const void* b){
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static void e2e_add(e2e_samples* s, double value){
+    if (s->count < s->capacity) s->samples[s->count++] = value;
+}
+
+static void e2e_print(const char* what, uint32_t n, size_t size, e2e_samples* s, uint32_t expected){
+    if (s->count == 0) {
+        printf("%-8s clients %5u  size %6zu | no samples\n", what, n, size);
+        return;
+    }
+
+    qsort(s->samples, s->count, sizeof(double), e2e_compare_double);
+    printf("%-8s clients %5u  size %6zu | p50 %8.1f us  p99 %8.1f us  max %9.1f us  (%u/%u)\n", what, n, size,
+           1e6 * s->samples[s->count / 2], 1e6 * s->samples[s->count * 99 / 100], 1e6 * s->samples[s->count - 1],
+           s->count, expected);
+}
+
+static void e2e_registration(mockBroker* broker, int connection, const char* uuid, void* context){
+    e2e_run* run = (e2e_run*) context;
+    const char* index = strrchr(uuid, '-');
+    uint32_t i = index != NULL ? (uint32_t) strtoul(index + 1, NULL, 16) : run->n;
+
+    if (i < run->n) run->connections[i] = connection;
+}
+
+/* the data object of every event is a string starting with the monotonic time it has been published or called at */
+static void e2e_event(mockBroker* broker, int connection, const char* msg, size_t length, void* context){
+    e2e_run* run = (e2e_run*) context;
+    const char* d = strstr(msg, "\"dataObject\":\"");
+
+    if (!run->measure || d == NULL) return;
+
+    double latency = e2e_wall_seconds() - strtod(d + strlen("\"dataObject\":\""), NULL);
+
+    if (strstr(msg, "\"eventId\":\"Resp\"") != NULL)
+        e2e_add(&run->rtt, latency);
+    else
+        e2e_add(&run->latency, latency);
+}
+
+static void e2e_echo(void* client, void* parameters, void* context){
+    json_object* data = json_object_object_get((json_object*) parameters, "dataObject");
+    const char* json = json_object_to_json_string_ext(data, JSON_C_TO_STRING_PLAIN);
+
+    msbClientPublishJSON((msbClient*) client, "Resp", HIGH, json, strlen(json), NULL);
+}
+
+/* a json string of the given length holding the current time and padding */
+static size_t e2e_payload(char* buffer, size_t size){
+    int l = snprintf(buffer, size + 1, "\"%.9f", e2e_wall_seconds());
+
+    if ((size_t) l + 2 > size) size = (size_t) l + 2;
+    memset(buffer + l, ' ', size - 1 - (size_t) l);
+    buffer[size - 1] = '"';
+    buffer[size] = 0;
+
+    return size;
+}
+
+static msbClient* e2e_client(const char* port, uint32_t i, size_t max_size, bool sockjs, bool tls, uint32_t window){
+    char uuid[40];
+    sprintf(uuid, E2E_UUID, i);
+
+    msbClient* client = msbClientNewClient(false, "127.0.0.1", (char*) port, "127.0.0.1", "/", NULL, uuid, "token",
+                                           "SmartObject", "e2e", "End to end benchmark client", tls, NULL, NULL, NULL);
+    if (client == NULL || !msbClientSetTransport(client, MSB_TRANSPORT_NATIVE)) return client;
+
+    if (tls) msbClientDisableHostnameVerification(client);
+    if (sockjs) {
+        msbClientSetSockJSFraming(client, true);
+        msbClientGenerateSockJSPath(client);
+    }
+
+    msbClientSetMaxMessageSize(client, (uint32_t) (2 * max_size + 1024));
+    msbClientSetFunctionCacheSize(client, 2 * E2E_QUEUE);
+    if (window > 0) msbClientSetPublishWindow(client, window);
+
+    msbClientAddEvent(client, "Ev0", "Event", "Event of the end to end benchmark", MSB_STRING, MSB_NONE, false);
+    msbClientAddEvent(client, "Resp", "Response", "Response of the end to end benchmark", MSB_STRING, MSB_NONE, false);
+    msbClientAddFunction(client, "F0", "Echo", "Answers with the data of the call", &e2e_echo, MSB_STRING, MSB_NONE,
+                         false, NULL);
+    msbClientAddResponseEventToFunction(client, "F0", "Resp");
+
+    return client;
+}
+
+/* publishing as fast as the outgoing queues take the events, counted when they arrive at the broker */
+static void e2e_throughput(mockBroker* broker, msbClient** clients, uint32_t n, size_t size, uint32_t events){
+    char* payload = malloc(size + 64);
+    uint64_t start = broker->events, bytes = broker->event_bytes;
+    uint32_t published = 0, i = 0;
+
+    double wall = e2e_wall_seconds(), cpu = e2e_cpu_seconds(), broker_cpu = broker->cpu;
+
+    while (published < events) {
+        if (list_count_entries(clients[i]->outgoing_data) < E2E_QUEUE) {
+            size_t l = e2e_payload(payload, size);
+            msbClientPublishJSON(clients[i], "Ev0", LOW, payload, l, NULL);
+            ++published;
+        } else if (i == n - 1) {
+            sched_yield();
+        }
+        i = (i + 1) % n;
+    }
+
+    double end = e2e_wall_seconds() + 30.0;
+    while (broker->events - start < events && e2e_wall_seconds() < end) usleep(100);
+
+    wall = e2e_wall_seconds() - wall;
+    cpu = e2e_cpu_seconds() - cpu - (broker->cpu - broker_cpu);
+
+    uint64_t received = broker->events - start;
+    printf("publish  clients %5u  size %6zu | %9.0f msg/s  %8.1f MB/s  cpu %7.2f us/msg  (%llu/%u)\n", n, size,
+           received / wall, (broker->event_bytes - bytes) / wall / 1e6, 1e6 * cpu / (received > 0 ? received : 1),
+           (unsigned long long) received, events);
+
+    free(payload);
+}
+
+/* every client publishes one event per round, so the latency isn't dominated by queueing */
+static void e2e_latency(e2e_run* run, msbClient** clients, uint32_t n, size_t size, uint32_t rounds){
+    char* payload = malloc(size + 64);
+    uint32_t i, r;
+
+    run->latency.count = 0;
+    run->measure = true;
+
+    for (r = 0; r < rounds && !e2e_stop; ++r) {
+        double next = e2e_wall_seconds() + 0.01;
+        for (i = 0; i < n; ++i) {
+            size_t l = e2e_payload(payload, size);
+            msbClientPublishJSON(clients[i], "Ev0", LOW, payload, l, NULL);
+        }
+        while (e2e_wall_seconds() < next) usleep(500);
+    }
+
+    double end = e2e_wall_seconds() + 2.0;
+    while (run->latency.count < n * rounds && e2e_wall_seconds() < end) usleep(1000);
+
+    run->measure = false;
+    e2e_print("latency", n, size, &run->latency, n * rounds);
+
+    free(payload);
+}
+
+/* the broker calls F0 of every client per round, the client answers with its response event */
+static void e2e_calls(mockBroker* broker, e2e_run* run, uint32_t n, size_t size, uint32_t rounds){
+    char* parameters = malloc(size + 64 + 16);
+    uint32_t i, r;
+
+    run->rtt.count = 0;
+    run->measure = true;
+
+    for (r = 0; r < rounds && !e2e_stop; ++r) {
+        for (i = 0; i < n; ++i) {
+            memcpy(parameters, "{\"dataObject\":", 14);
+            size_t l = 14 + e2e_payload(parameters + 14, size);
+            memcpy(parameters + l, "}", 2);
+            mockBrokerCallFunction(broker, run->connections[i], "F0", parameters, NULL);
+        }
+
+        double end = e2e_wall_seconds() + 1.0;
+        while (run->rtt.count < n * (r + 1) && e2e_wall_seconds() < end) usleep(100);
+    }
+
+    run->measure = false;
+    e2e_print("call", n, size, &run->rtt, n * rounds);
+
+    free(parameters);
+}
+
+static void e2e_benchmark(uint32_t n, size_t* sizes, uint32_t size_count, uint32_t events, uint32_t rounds,
+                          uint32_t threads, bool sockjs, bool tls, uint32_t window){
+    e2e_run run;
+    uint32_t i, s;
+    size_t max_size = 0;
+
+    for (s = 0; s < size_count; ++s) if (sizes[s] > max_size) max_size = sizes[s];
+
+    memset(&run, 0, sizeof(run));
+    run.n = n;
+    run.connections = malloc(n * sizeof(int));
+    for (i = 0; i < n; ++i) run.connections[i] = -1;
+    run.latency.capacity = run.rtt.capacity = n * rounds;
+    run.latency.samples = malloc(n * rounds * sizeof(double));
+    run.rtt.samples = malloc(n * rounds * sizeof(double));
+
+    mockBrokerConfig config = {0, sockjs, tls, window > 0, e2e_registration, e2e_event, &run};
+    mockBroker* broker = mockBrokerStart(&config);
+    char port[8];
+
+    if (broker == NULL) {
+        printf("clients %5u | starting broker failed\n", n);
+        free(run.connections);
+        free(run.latency.samples);
+        free(run.rtt.samples);
+        return;
+    }
+    sprintf(port, "%u", broker->port);
+
+    msbClient** clients = calloc(n, sizeof(msbClient*));
+    msbClientGroup* group = threads > 0 ? msbClientGroupNew(threads) : NULL;
+    bool running = true;
+
+    for (i = 0; i < n && running; ++i) {
+        clients[i] = e2e_client(port, i, max_size, sockjs, tls, window);
+
+        if (group != NULL)
+            running = msbClientGroupAdd(group, clients[i]);
+        else
+            running = msbClientRunClientStateMachine(clients[i]) == 0;
+    }
+
+    double end = e2e_wall_seconds() + 30.0;
+    while (running && broker->registered < n && e2e_wall_seconds() < end) usleep(10000);
+
+    if (!running || broker->registered < n) {
+        printf("clients %5u | only %u clients registered\n", n, broker->registered);
+    } else {
+        for (s = 0; s < size_count && !e2e_stop; ++s) {
+            e2e_throughput(broker, clients, n, sizes[s], events);
+            e2e_latency(&run, clients, n, sizes[s], rounds);
+            e2e_calls(broker, &run, n, sizes[s], rounds);
+        }
+    }
+
+    if (group != NULL) msbClientGroupDelete(group);
+
+    for (i = 0; i < n && clients[i] != NULL; ++i) {
+        if (group == NULL && clients[i]->thread_running) msbClientHaltClientStateMachine(clients[i]);
+        msbClientDeleteClient(clients[i]);
+    }
+
+    mockBrokerStop(broker);
+
+    free(clients);
+    free(run.connections);
+    free(run.latency.samples);
+    free(run.rtt.samples);
+}
+
+static void e2e_interrupt(int sig){
+    e2e_stop = true;
+}
+
+static void e2e_print_registration(mockBroker* broker, int connection, const char* uuid, void* context){
+    printf("registered %s\n", uuid);
+}
+
+static int e2e_broker_only(uint16_t port, bool sockjs, bool tls){
+    mockBrokerConfig config = {port, sockjs, tls, true, e2e_print_registration, NULL, NULL};
+    mockBroker* broker = mockBrokerStart(&config);
+
+    if (broker == NULL) {
+        printf("starting broker on port %u failed\n", port);
+        return 1;
+    }
+
+    printf("broker listening on %s://127.0.0.1:%u%s\n", tls ? "wss" : "ws", broker->port, sockjs ? " with SockJS framing" : "");
+    fflush(stdout);
+
+    while (!e2e_stop) sleep(1);
+
+    printf("%u registrations, %llu events, %llu function calls\n", broker->registered,
+           (unsigned long long) broker->events, (unsigned long long) broker->calls);
+    mockBrokerStop(broker);
+
+    return 0;
+}
+
+static uint32_t e2e_parse_list(const char* arg, size_t* values, uint32_t max){
+    uint32_t count = 0;
+    char* end;
+
+    while (count < max && *arg != 0) {
+        values[count++] = (size_t) strtoul(arg, &end, 10);
+        if (*end != ',') break;
+        arg = end + 1;
+    }
+
+    return count;
+}
+
+static void e2e_usage(const char* name){
+    printf("usage: %s [-c clients,...] [-s sizes,...] [-n events] [-r rounds] [-g threads] [-w window] [-j] [-t] [-b port]\n"
+           "  -c  client counts (default 1,10,100)\n"
+           "  -s  payload sizes in bytes (default 64,1024,16384)\n"
+           "  -n  events per throughput run (default 100000)\n"
+           "  -r  rounds of the latency and function call runs (default 100)\n"
+           "  -g  threads of the client group, 0 for a thread per client (default 4)\n"
+           "  -w  publish window, events are acknowledged by the broker (default 0, no acknowledgements)\n"
+           "  -j  SockJS framing\n"
+           "  -t  TLS\n"
+           "  -b  only run the broker on the given port\n", name);
+}
+
+int main(int argc, char** argv){
+    size_t clients[16] = {1, 10, 100}, sizes[16] = {64, 1024, 16384};
+    uint32_t client_count = 3, size_count = 3, events = 100000, rounds = 100, threads = 4, window = 0;
+    bool sockjs = false, tls = false, broker_only = false;
+    uint16_t port = 0;
+    int opt;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "c:s:n:r:g:w:jtb:h")) != -1) {
+        switch (opt) {
+            case 'c': client_count = e2e_parse_list(optarg, clients, 16); break;
+            case 's': size_count = e2e_parse_list(optarg, sizes, 16); break;
+            case 'n': events = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'r': rounds = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'g': threads = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'w': window = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'j': sockjs = true; break;
+            case 't': tls = true; break;
+            case 'b': broker_only = true; port = (uint16_t) strtoul(optarg, NULL, 10); break;
+            default:
+                e2e_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    signal(SIGINT, e2e_interrupt);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (broker_only) return e2e_broker_only(port, sockjs, tls);
+
+    printf("%u events per throughput run, %u rounds, %s%s%s\n", events, rounds, threads > 0 ? "client group" : "thread per client",
+           sockjs ? ", SockJS" : "", tls ? ", TLS" : "");
+
+    for (i = 0; i < client_count && !e2e_stop; ++i)
+        e2e_benchmark((uint32_t) clients[i], sizes, size_count, events, rounds, threads, sockjs, tls, window);
+
+    return 0;
+}
@@ -0,0 +1,525 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Load generator: hosts many clients with synthetic models in one process, publishing at a fixed rate and answering
+ * function calls of the local stand-in broker, and reports cpu, memory, throughput per client and latencies over time.
+ * Shows how many smart objects one gateway process can host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "libMsbClientC.h"
+#include "mockbroker.h"
+
+#define LOAD_UUID "5e1f3a20-7c4b-4d8e-9a61-%012x"
+
+typedef enum {
+    LOAD_NUMBER,
+    LOAD_STRING,
+    LOAD_ARRAY,
+    LOAD_OBJECT
+} load_shape;
+
+typedef struct {
+    double* samples;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t overflow;
+} load_samples;
+
+typedef struct {
+    uint32_t clients;
+    uint32_t events;
+    uint32_t functions;
+    double rate;
+    double call_rate;
+    load_shape shape;
+    uint32_t shape_size;
+    uint32_t threads;
+    uint32_t duration;
+    uint32_t interval;
+    bool sockjs;
+    bool tls;
+} load_config;
+
+typedef struct {
+    load_config config;
+    int* connections;
+    uint64_t* last_events;
+    pthread_mutex_t mutex;
+    load_samples latency;
+    load_samples rtt;
+    uint64_t published;
+    uint64_t dropped;
+} load_run;
+
+static volatile bool load_stop = false;
+
+static double load_wall_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double load_cpu_seconds(){
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static double load_rss_mb(){
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+
+    if (f == NULL) return 0;
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(f);
+
+    return resident * (double) sysconf(_SC_PAGESIZE) / 1e6;
+}
+
+static int load_compare_double(const void* a, const void* b){
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static void load_add(load_samples* s, double value){
+    if (s->count < s->capacity)
+        s->samples[s->count++] = value;
+    else
+        s->overflow++;
+}
+
+/* sorts and empties the samples, writes p50, p99 and max in ms */
+static uint32_t load_percentiles(load_samples* s, double* p50, double* p99, double* max){
+    uint32_t count = s->count;
+
+    *p50 = *p99 = *max = 0;
+    if (count > 0) {
+        qsort(s->samples, count, sizeof(double), load_compare_double);
+        *p50 = 1e3 * s->samples[count / 2];
+        *p99 = 1e3 * s->samples[count * 99 / 100];
+        *max = 1e3 * s->samples[count - 1];
+    }
+    s->count = 0;
+
+    return count;
+}
+
+static void load_registration(mockBroker* broker, int connection, const char* uuid, void* context){
+    load_run* run = (load_run*) context;
+    const char* index = strrchr(uuid, '-');
+    uint32_t i = index != NULL ? (uint32_t) strtoul(index + 1, NULL, 16) : run->config.clients;
+
+    if (i < run->config.clients) run->connections[i] = connection;
+}
+
+/* every data object starts with the monotonic time it has been published or called at, whatever its shape */
+static void load_event(mockBroker* broker, int connection, const char* msg, size_t length, void* context){
+    load_run* run = (load_run*) context;
+    const char* d = strstr(msg, "\"dataObject\":");
+
+    if (d == NULL) return;
+
+    d += strlen("\"dataObject\":");
+    while (*d == '"' || *d == '[' || *d == '{') d += *d == '{' ? strlen("{\"t\":") : 1;
+
+    double latency = load_wall_seconds() - strtod(d, NULL);
+
+    pthread_mutex_lock(&run->mutex);
+    if (strstr(msg, "\"eventId\":\"Resp\"") != NULL)
+        load_add(&run->rtt, latency);
+    else
+        load_add(&run->latency, latency);
+    pthread_mutex_unlock(&run->mutex);
+}
+
+static void load_function(void* client, void* parameters, void* context){
+    json_object* data = json_object_object_get((json_object*) parameters, "dataObject");
+    const char* json = json_object_to_json_string_ext(data, JSON_C_TO_STRING_PLAIN);
+
+    msbClientPublishJSON((msbClient*) client, "Resp", HIGH, json, strlen(json), NULL);
+}
+
+/* data object of the configured shape, starting with the current time */
+static size_t load_payload(const load_config* config, char* buffer, size_t size){
+    double now = load_wall_seconds();
+    size_t l = 0;
+    uint32_t i;
+
+    switch (config->shape) {
+        case LOAD_NUMBER:
+            l = (size_t) snprintf(buffer, size, "%.6f", now);
+            break;
+        case LOAD_STRING:
+            l = (size_t) snprintf(buffer, size, "\"%.6f", now);
+            while (l < config->shape_size + 1 && l < size - 2) buffer[l++] = ' ';
+            buffer[l++] = '"';
+            buffer[l] = 0;
+            break;
+        case LOAD_ARRAY:
+            l = (size_t) snprintf(buffer, size, "[%.6f", now);
+            for (i = 1; i < config->shape_size && l < size; ++i) l += (size_t) snprintf(buffer + l, size - l, ",%u", i);
+            l += (size_t) snprintf(buffer + l, size - l, "]");
+            break;
+        case LOAD_OBJECT:
+            l = (size_t) snprintf(buffer, size, "{\"t\":%.6f", now);
+            for (i = 0; i < config->shape_size && l < size; ++i)
+                l += (size_t) snprintf(buffer + l, size - l, ",\"v%u\":%u.5", i, i);
+            l += (size_t) snprintf(buffer + l, size - l, "}");
+            break;
+    }
+
+    return l;
+}
+
+static void load_add_event(msbClient* client, const load_config* config, char* eId){
+    uint32_t i;
+
+    switch (config->shape) {
+        case LOAD_NUMBER:
+            msbClientAddEvent(client, eId, eId, "Synthetic event", MSB_NUMBER, MSB_DOUBLE, false);
+            break;
+        case LOAD_STRING:
+            msbClientAddEvent(client, eId, eId, "Synthetic event", MSB_STRING, MSB_NONE, false);
+            break;
+        case LOAD_ARRAY:
+            msbClientAddEvent(client, eId, eId, "Synthetic event", MSB_NUMBER, MSB_DOUBLE, true);
+            break;
+        case LOAD_OBJECT: {
+            size_t size = 256 + 48 * (size_t) config->shape_size, l;
+            char* format = malloc(size);
+
+            l = (size_t) snprintf(format, size, "{\"dataObject\":{\"$ref\":\"#/definitions/Sample\"},\"Sample\":{"
+                                                "\"type\":\"object\",\"properties\":{\"t\":{\"type\":\"number\",\"format\":\"double\"}");
+            for (i = 0; i < config->shape_size; ++i)
+                l += (size_t) snprintf(format + l, size - l, ",\"v%u\":{\"type\":\"number\",\"format\":\"double\"}", i);
+            snprintf(format + l, size - l, "}}}");
+
+            msbClientAddEventFromString(client, eId, eId, "Synthetic event", format, false);
+            free(format);
+            break;
+        }
+    }
+}
+
+static msbClient* load_client(const load_config* config, const char* port, uint32_t index){
+    char uuid[40], id[16];
+    uint32_t i;
+
+    sprintf(uuid, LOAD_UUID, index);
+
+    msbClient* client = msbClientNewClient(false, "127.0.0.1", (char*) port, "127.0.0.1", "/", NULL, uuid, "token",
+                                           "SmartObject", "load", "Synthetic smart object", config->tls, NULL, NULL,
+                                           NULL);
+    if (client == NULL || !msbClientSetTransport(client, MSB_TRANSPORT_NATIVE)) return client;
+
+    if (config->tls) msbClientDisableHostnameVerification(client);
+    if (config->sockjs) {
+        msbClientSetSockJSFraming(client, true);
+        msbClientGenerateSockJSPath(client);
+    }
+
+    for (i = 0; i < config->events; ++i) {
+        sprintf(id, "E%u", i);
+        load_add_event(client, config, id);
+    }
+
+    msbClientAddEvent(client, "Resp", "Response", "Response to the function calls", MSB_STRING, MSB_NONE, false);
+    for (i = 0; i < config->functions; ++i) {
+        sprintf(id, "F%u", i);
+        msbClientAddFunction(client, id, id, "Synthetic function", &load_function, MSB_STRING, MSB_NONE, false, NULL);
+        msbClientAddResponseEventToFunction(client, id, "Resp");
+    }
+
+    return client;
+}
+
+static void load_report(load_run* run, mockBroker* broker, double elapsed, double interval, double cpu,
+                        double broker_cpu){
+    const load_config* config = &run->config;
+    double min = -1, max = 0, sum = 0;
+    uint32_t i, stalled = 0;
+
+    for (i = 0; i < config->clients; ++i) {
+        int c = run->connections[i];
+        uint64_t events = c >= 0 ? broker->conns[c].events : 0;
+        double r = (events - run->last_events[i]) / interval;
+
+        run->last_events[i] = events;
+        if (min < 0 || r < min) min = r;
+        if (r > max) max = r;
+        if (r == 0) stalled++;
+        sum += r;
+    }
+
+    double lp50, lp99, lmax, cp50, cp99, cmax;
+
+    pthread_mutex_lock(&run->mutex);
+    load_percentiles(&run->latency, &lp50, &lp99, &lmax);
+    uint32_t calls = load_percentiles(&run->rtt, &cp50, &cp99, &cmax);
+    pthread_mutex_unlock(&run->mutex);
+
+    printf("%6.0f s | %5u reg | cpu %6.1f %%  broker %5.1f %%  rss %8.1f MB | %9.0f ev/s  per client min %6.2f  mean %6.2f"
+           "  max %6.2f  stalled %5u | latency p50 %7.2f  p99 %7.2f  max %8.2f ms | calls %6u  p50 %7.2f  p99 %7.2f ms"
+           " | dropped %llu\n", elapsed, broker->registered, 100.0 * cpu / interval, 100.0 * broker_cpu / interval,
+           load_rss_mb(), sum, min, sum / config->clients, max, stalled, lp50, lp99, lmax, calls, cp50,
+           cp99, (unsigned long long) run->dropped);
+    fflush(stdout);
+}
+
+static void load_generate(load_run* run){
+    const load_config* config = &run->config;
+    uint32_t i;
+
+    double expected = config->clients * (config->rate + config->call_rate) * config->interval;
+    run->latency.capacity = run->rtt.capacity = (uint32_t) (2 * expected) + 1024;
+    run->latency.samples = malloc(run->latency.capacity * sizeof(double));
+    run->rtt.samples = malloc(run->rtt.capacity * sizeof(double));
+    run->connections = malloc(config->clients * sizeof(int));
+    run->last_events = calloc(config->clients, sizeof(uint64_t));
+    pthread_mutex_init(&run->mutex, NULL);
+    for (i = 0; i < config->clients; ++i) run->connections[i] = -1;
+
+    mockBrokerConfig broker_config = {0, config->sockjs, config->tls, true, load_registration, load_event, run};
+    mockBroker* broker = mockBrokerStart(&broker_config);
+    char port[8];
+
+    if (broker == NULL) {
+        printf("starting broker failed\n");
+        return;
+    }
+    sprintf(port, "%u", broker->port);
+
+    double rss = load_rss_mb(), start = load_wall_seconds();
+
+    msbClient** clients = calloc(config->clients, sizeof(msbClient*));
+    msbClientGroup* group = config->threads > 0 ? msbClientGroupNew(config->threads) : NULL;
+    bool running = true;
+
+    for (i = 0; i < config->clients && running && !load_stop; ++i) {
+        clients[i] = load_client(config, port, i);
+
+        if (group != NULL)
+            running = msbClientGroupAdd(group, clients[i]);
+        else
+            running = msbClientRunClientStateMachine(clients[i]) == 0;
+    }
+
+    double end = load_wall_seconds() + 60.0;
+    while (running && broker->registered < config->clients && load_wall_seconds() < end && !load_stop) usleep(10000);
+
+    printf("%u/%u clients registered in %.1f s, %.1f MB, %.1f kB per client\n", broker->registered, config->clients,
+           load_wall_seconds() - start, load_rss_mb() - rss, 1e3 * (load_rss_mb() - rss) / config->clients);
+    fflush(stdout);
+
+    /* events and calls become due at fractional rates, with random phases so the clients don't publish in lockstep */
+    double* publish_credit = calloc(config->clients, sizeof(double));
+    double* call_credit = calloc(config->clients, sizeof(double));
+    uint32_t* next_event = calloc(config->clients, sizeof(uint32_t));
+    char payload[65536], id[16], parameters[65536 + 32];
+
+    for (i = 0; i < config->clients; ++i) {
+        publish_credit[i] = (double) rand() / RAND_MAX;
+        call_credit[i] = (double) rand() / RAND_MAX;
+    }
+
+    start = load_wall_seconds();
+    double last = start, report = start + config->interval, cpu = load_cpu_seconds(), broker_cpu = broker->cpu;
+
+    while (running && !load_stop && last - start < config->duration) {
+        usleep(10000);
+
+        double now = load_wall_seconds(), dt = now - last;
+        last = now;
+
+        for (i = 0; i < config->clients; ++i) {
+            publish_credit[i] += config->rate * dt;
+            call_credit[i] += config->call_rate * dt;
+
+            while (publish_credit[i] >= 1 && config->events > 0) {
+                publish_credit[i] -= 1;
+                sprintf(id, "E%u", next_event[i]);
+                next_event[i] = (next_event[i] + 1) % config->events;
+
+                size_t l = load_payload(config, payload, sizeof(payload));
+                if (msbClientPublishJSONWithCompletion(clients[i], id, LOW, payload, l, NULL, NULL) == 0)
+                    run->published++;
+                else
+                    run->dropped++;
+            }
+
+            while (call_credit[i] >= 1 && config->functions > 0) {
+                call_credit[i] -= 1;
+                sprintf(id, "F%u", (uint32_t) rand() % config->functions);
+                snprintf(parameters, sizeof(parameters), "{\"dataObject\":\"%.6f\"}", load_wall_seconds());
+                mockBrokerCallFunction(broker, run->connections[i], id, parameters, NULL);
+            }
+        }
+
+        if (now >= report) {
+            double c = load_cpu_seconds(), b = broker->cpu;
+            load_report(run, broker, now - start, now - report + config->interval, c - cpu - (b - broker_cpu),
+                        b - broker_cpu);
+            cpu = c;
+            broker_cpu = b;
+            report = now + config->interval;
+        }
+    }
+
+    printf("published %llu, dropped %llu, received %llu events, %llu function calls, %llu samples not kept\n",
+           (unsigned long long) run->published, (unsigned long long) run->dropped,
+           (unsigned long long) broker->events, (unsigned long long) broker->calls,
+           (unsigned long long) (run->latency.overflow + run->rtt.overflow));
+
+    if (group != NULL) msbClientGroupDelete(group);
+
+    for (i = 0; i < config->clients && clients[i] != NULL; ++i) {
+        if (group == NULL && clients[i]->thread_running) msbClientHaltClientStateMachine(clients[i]);
+        msbClientDeleteClient(clients[i]);
+    }
+
+    mockBrokerStop(broker);
+
+    free(clients);
+    free(publish_credit);
+    free(call_credit);
+    free(next_event);
+    free(run->connections);
+    free(run->last_events);
+    free(run->latency.samples);
+    free(run->rtt.samples);
+    pthread_mutex_destroy(&run->mutex);
+}
+
+static void load_interrupt(int sig){
+    load_stop = true;
+}
+
+static bool load_parse_shape(const char* arg, load_config* config){
+    const char* size = strchr(arg, ':');
+    size_t l = size != NULL ? (size_t) (size - arg) : strlen(arg);
+
+    config->shape_size = size != NULL ? (uint32_t) strtoul(size + 1, NULL, 10) : 16;
+    if (config->shape_size > 4096) config->shape_size = 4096;
+
+    if (strncmp(arg, "number", l) == 0)
+        config->shape = LOAD_NUMBER;
+    else if (strncmp(arg, "string", l) == 0)
+        config->shape = LOAD_STRING;
+    else if (strncmp(arg, "array", l) == 0)
+        config->shape = LOAD_ARRAY;
+    else if (strncmp(arg, "object", l) == 0)
+        config->shape = LOAD_OBJECT;
+    else
+        return false;
+
+    return true;
+}
+
+static void load_usage(const char* name){
+    printf("usage: %s [-c clients] [-e events] [-f functions] [-r rate] [-k rate] [-p shape[:size]] [-g threads]\n"
+           "          [-d seconds] [-i seconds] [-j] [-t]\n"
+           "  -c  clients (default 1000)\n"
+           "  -e  events per client (default 4)\n"
+           "  -f  functions per client (default 2)\n"
+           "  -r  events published per client and second (default 1)\n"
+           "  -k  function calls per client and second (default 0.1)\n"
+           "  -p  data object: number, string:length, array:elements or object:members (default object:8)\n"
+           "  -g  threads of the client group, 0 for a thread per client (default 4)\n"
+           "  -d  duration in s (default 30)\n"
+           "  -i  report interval in s (default 1)\n"
+           "  -j  SockJS framing\n"
+           "  -t  TLS\n", name);
+}
+
+int main(int argc, char** argv){
+    load_run run;
+    load_config* config = &run.config;
+    int opt;
+
+    memset(&run, 0, sizeof(run));
+    config->clients = 1000;
+    config->events = 4;
+    config->functions = 2;
+    config->rate = 1;
+    config->call_rate = 0.1;
+    config->shape = LOAD_OBJECT;
+    config->shape_size = 8;
+    config->threads = 4;
+    config->duration = 30;
+    config->interval = 1;
+
+    while ((opt = getopt(argc, argv, "c:e:f:r:k:p:g:d:i:jth")) != -1) {
+        switch (opt) {
+            case 'c': config->clients = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'e': config->events = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'f': config->functions = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'r': config->rate = strtod(optarg, NULL); break;
+            case 'k': config->call_rate = strtod(optarg, NULL); break;
+            case 'p':
+                if (!load_parse_shape(optarg, config)) {
+                    load_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'g': config->threads = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'd': config->duration = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'i': config->interval = (uint32_t) strtoul(optarg, NULL, 10); break;
+            case 'j': config->sockjs = true; break;
+            case 't': config->tls = true; break;
+            default:
+                load_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (config->clients == 0 || config->interval == 0) {
+        load_usage(argv[0]);
+        return 1;
+    }
+
+    /* every client takes two sockets, its own and the one of the broker */
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur < 2 * (rlim_t) config->clients + 64)
+        printf("warning: only %lu file descriptors, not enough for %u clients\n", (unsigned long) rl.rlim_cur,
+               config->clients);
+
+    signal(SIGINT, load_interrupt);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("%u clients with %u events and %u functions, %.2f events and %.2f calls per client and second, %s\n",
+           config->clients, config->events, config->functions, config->rate, config->call_rate,
+           config->threads > 0 ? "client group" : "thread per client");
+
+    load_generate(&run);
+
+    return 0;
+}
@@ -0,0 +1,592 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/x509.h>
+#include <openssl/evp.h>
+#endif
+
+#include "mockbroker.h"
+#include "websocket/websocket.h"
+
+#define MOCK_BROKER_RX_SIZE 65536
+#define MOCK_BROKER_RX_MAX (64 * 1024 * 1024)
+
+static double mockBrokerThreadCPU(){
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* writes all of the data, waiting while the socket is full; the mutex of the broker has to be held */
+static bool mockBrokerWrite(mockBroker* broker, int fd, const void* data, size_t length){
+    mockBrokerConnection* c = &broker->conns[fd];
+    const char* p = (const char*) data;
+
+    while (length > 0) {
+        short wait = POLLOUT;
+        ssize_t w;
+
+#ifdef WS_NATIVE_OPENSSL
+        if (c->ssl != NULL) {
+            w = SSL_write(c->ssl, p, (int) length);
+            if (w <= 0) {
+                int e = SSL_get_error(c->ssl, (int) w);
+                if (e == SSL_ERROR_WANT_READ)
+                    wait = POLLIN;
+                else if (e != SSL_ERROR_WANT_WRITE)
+                    return false;
+            }
+        } else
+#endif
+        {
+            w = send(fd, p, length, MSG_NOSIGNAL);
+            if (w < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+        }
+
+        if (w > 0) {
+            p += w;
+            length -= (size_t) w;
+        } else {
+            struct pollfd pfd = {fd, wait, 0};
+            if (poll(&pfd, 1, 1000) <= 0) return false;
+        }
+    }
+
+    return true;
+}
+
+/* an unmasked frame, as servers send them */
+static bool mockBrokerSendFrame(mockBroker* broker, int fd, uint8_t opcode, const char* payload, size_t length){
+    unsigned char stack[512];
+    unsigned char* frame = length + 10 <= sizeof(stack) ? stack : malloc(length + 10);
+    size_t header_length = 2;
+    int i;
+
+    if (frame == NULL) return false;
+
+    frame[0] = (unsigned char) (0x80 | opcode);
+    if (length < 126) {
+        frame[1] = (unsigned char) length;
+    } else if (length < 65536) {
+        frame[1] = 126;
+        frame[2] = (unsigned char) (length >> 8);
+        frame[3] = (unsigned char) length;
+        header_length = 4;
+    } else {
+        frame[1] = 127;
+        for (i = 0; i < 8; ++i) frame[2 + i] = (unsigned char) ((uint64_t) length >> (56 - 8 * i));
+        header_length = 10;
+    }
+    memcpy(frame + header_length, payload, length);
+
+    bool ret = mockBrokerWrite(broker, fd, frame, header_length + length);
+
+    if (frame != stack) free(frame);
+
+    return ret;
+}
+
+/* a message of the MSB protocol, with SockJS framing a json array holding it as string */
+static bool mockBrokerSend(mockBroker* broker, int fd, const char* msg, size_t length){
+
+    if (!broker->config.sockjs) return mockBrokerSendFrame(broker, fd, 0x1, msg, length);
+
+    char* framed = malloc(2 * length + 6);
+    size_t i, j = 0;
+
+    if (framed == NULL) return false;
+
+    framed[j++] = 'a';
+    framed[j++] = '[';
+    framed[j++] = '"';
+    for (i = 0; i < length; ++i) {
+        if (msg[i] == '"' || msg[i] == '\\') framed[j++] = '\\';
+        framed[j++] = msg[i];
+    }
+    framed[j++] = '"';
+    framed[j++] = ']';
+
+    bool ret = mockBrokerSendFrame(broker, fd, 0x1, framed, j);
+
+    free(framed);
+
+    return ret;
+}
+
+/* the json string of a SockJS message sent by a client, unescaped in place */
+static size_t mockBrokerUnframeSockJS(char* msg, size_t length){
+    if (length < 4 || strncmp(msg, "[\"", 2) != 0 || strncmp(msg + length - 2, "\"]", 2) != 0) return length;
+
+    const char* r = msg + 2;
+    const char* end = msg + length - 2;
+    char* w = msg;
+
+    while (r < end) {
+        if (r[0] == '\\' && r + 1 < end) {
+            switch (r[1]) {
+                case 'n': *w++ = '\n'; break;
+                case 'r': *w++ = '\r'; break;
+                case 't': *w++ = '\t'; break;
+                default: *w++ = r[1]; break;
+            }
+            r += 2;
+        } else {
+            *w++ = *r++;
+        }
+    }
+    *w = 0;
+
+    return (size_t) (w - msg);
+}
+
+static void mockBrokerMessage(mockBroker* broker, int fd, char* msg, size_t length){
+    mockBrokerConnection* c = &broker->conns[fd];
+
+    if (broker->config.sockjs) length = mockBrokerUnframeSockJS(msg, length);
+
+    if (length > 2 && strncmp(msg, "R ", 2) == 0) {
+        const char* u = strstr(msg, "\"uuid\"");
+        if (u != NULL && (u = strchr(u + 6, '"')) != NULL) {
+            size_t l = strcspn(u + 1, "\"");
+            if (l >= sizeof(c->uuid)) l = sizeof(c->uuid) - 1;
+            memcpy(c->uuid, u + 1, l);
+            c->uuid[l] = 0;
+        }
+
+        mockBrokerSend(broker, fd, "IO_REGISTERED", strlen("IO_REGISTERED"));
+        broker->registered++;
+
+        if (broker->config.on_registration != NULL)
+            broker->config.on_registration(broker, fd, c->uuid, broker->config.context);
+    } else if (length > 2 && strncmp(msg, "E ", 2) == 0) {
+        c->events++;
+        broker->events++;
+        broker->event_bytes += length;
+
+        if (broker->config.acknowledge) mockBrokerSend(broker, fd, "IO_PUBLISHED", strlen("IO_PUBLISHED"));
+
+        if (broker->config.on_event != NULL) broker->config.on_event(broker, fd, msg + 2, length - 2, broker->config.context);
+    }
+}
+
+static bool mockBrokerUpgrade(mockBroker* broker, int fd, mockBrokerConnection* c, size_t* start){
+    c->rx[c->used] = 0;
+    char* end = strstr((char*) c->rx, "\r\n\r\n");
+    if (end == NULL) return c->used < c->capacity - 1;
+
+    char key[64] = {0};
+    char* k = strstr((char*) c->rx, "Sec-WebSocket-Key: ");
+    if (k != NULL) sscanf(k + strlen("Sec-WebSocket-Key: "), "%63s", key);
+
+    char accept_key[29];
+    wsNativeAcceptKey(key, accept_key);
+
+    char response[256];
+    int response_length = snprintf(response, sizeof(response),
+                                   "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                   "Sec-WebSocket-Accept: %s\r\n\r\n", accept_key);
+    if (!mockBrokerWrite(broker, fd, response, (size_t) response_length)) return false;
+
+    if (broker->config.sockjs && !mockBrokerSendFrame(broker, fd, 0x1, "o", 1)) return false;
+    if (!mockBrokerSend(broker, fd, "IO_CONNECTED", strlen("IO_CONNECTED"))) return false;
+
+    c->upgraded = true;
+    *start = (size_t) (end + 4 - (char*) c->rx);
+
+    return true;
+}
+
+/* returns false if the connection has to be closed */
+static bool mockBrokerParse(mockBroker* broker, int fd){
+    mockBrokerConnection* c = &broker->conns[fd];
+    size_t start = 0;
+
+    if (!c->upgraded) {
+        if (!mockBrokerUpgrade(broker, fd, c, &start)) return false;
+        if (!c->upgraded) return true;
+    }
+
+    while (c->used - start >= 6) {
+        unsigned char* h = c->rx + start;
+        uint8_t opcode = h[0] & 0x0f;
+        uint64_t length = h[1] & 0x7f;
+        size_t header_length = 2;
+        int i;
+
+        if (length == 126) {
+            header_length = 4;
+            if (c->used - start < header_length + 4) break;
+            length = (uint64_t) h[2] << 8 | h[3];
+        } else if (length == 127) {
+            header_length = 10;
+            if (c->used - start < header_length + 4) break;
+            length = 0;
+            for (i = 0; i < 8; ++i) length = length << 8 | h[2 + i];
+        }
+
+        if (header_length + 4 + length >= MOCK_BROKER_RX_MAX) return false;
+
+        if (c->used - start < header_length + 4 + length) {
+            /* the buffer grows for messages which don't fit */
+            size_t needed = header_length + 4 + (size_t) length + 1;
+            if (needed > c->capacity) {
+                unsigned char* rx = realloc(c->rx, needed);
+                if (rx == NULL) return false;
+                c->rx = rx;
+                c->capacity = needed;
+                h = c->rx + start;
+            }
+            break;
+        }
+
+        unsigned char* payload = h + header_length + 4;
+        wsNativeMask(payload, payload, (size_t) length, h + header_length);
+
+        /* messages of the client are never fragmented */
+        if (opcode == 0x8) {
+            mockBrokerSendFrame(broker, fd, 0x8, (char*) payload, length < 2 ? (size_t) length : 2);
+            return false;
+        } else if (opcode == 0x9) {
+            mockBrokerSendFrame(broker, fd, 0xA, (char*) payload, (size_t) length);
+        } else if (opcode == 0x1) {
+            char last = (char) payload[length];
+            payload[length] = 0;
+            mockBrokerMessage(broker, fd, (char*) payload, (size_t) length);
+            payload[length] = (unsigned char) last;
+        }
+
+        start += header_length + 4 + (size_t) length;
+    }
+
+    memmove(c->rx, c->rx + start, c->used - start);
+    c->used -= start;
+
+    return true;
+}
+
+static void mockBrokerClose(mockBroker* broker, int epfd, int fd){
+    mockBrokerConnection* c = &broker->conns[fd];
+
+    if (epfd >= 0) epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+
+#ifdef WS_NATIVE_OPENSSL
+    if (c->ssl != NULL) SSL_free(c->ssl);
+    c->ssl = NULL;
+#endif
+
+    close(fd);
+    free(c->rx);
+    c->rx = NULL;
+    broker->connections--;
+}
+
+static bool mockBrokerAccept(mockBroker* broker, int epfd, int fd){
+    mockBrokerConnection* c = &broker->conns[fd];
+    struct epoll_event ev;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(c, 0, sizeof(mockBrokerConnection));
+
+#ifdef WS_NATIVE_OPENSSL
+    if (broker->ctx != NULL) {
+        /* the handshake is done blocking, which is good enough for a local broker */
+        struct timeval tv = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        c->ssl = SSL_new(broker->ctx);
+        SSL_set_fd(c->ssl, fd);
+        if (SSL_accept(c->ssl) != 1) {
+            SSL_free(c->ssl);
+            c->ssl = NULL;
+            return false;
+        }
+    }
+#endif
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    c->capacity = MOCK_BROKER_RX_SIZE;
+    c->rx = malloc(c->capacity);
+    broker->connections++;
+
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+    return true;
+}
+
+/* reads everything available, returns false if the connection has been closed */
+static bool mockBrokerRead(mockBroker* broker, int fd){
+    mockBrokerConnection* c = &broker->conns[fd];
+
+    for (;;) {
+        ssize_t r;
+
+        if (c->used == c->capacity - 1) {
+            if (c->capacity >= MOCK_BROKER_RX_MAX) return false;
+            unsigned char* rx = realloc(c->rx, 2 * c->capacity);
+            if (rx == NULL) return false;
+            c->rx = rx;
+            c->capacity *= 2;
+        }
+
+#ifdef WS_NATIVE_OPENSSL
+        if (c->ssl != NULL) {
+            r = SSL_read(c->ssl, c->rx + c->used, (int) (c->capacity - 1 - c->used));
+            if (r <= 0) return SSL_get_error(c->ssl, (int) r) == SSL_ERROR_WANT_READ;
+        } else
+#endif
+        {
+            r = recv(fd, c->rx + c->used, c->capacity - 1 - c->used, 0);
+            if (r == 0) return false;
+            if (r < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+
+        c->used += (size_t) r;
+        if (!mockBrokerParse(broker, fd)) return false;
+    }
+}
+
+static void* mockBrokerThread(void* arg){
+    mockBroker* broker = (mockBroker*) arg;
+    struct epoll_event ev, events[64];
+
+    int epfd = epoll_create1(0);
+    ev.events = EPOLLIN;
+    ev.data.fd = broker->listen_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, broker->listen_fd, &ev);
+
+    while (!broker->stop) {
+        int n = epoll_wait(epfd, events, 64, 50), e;
+
+        for (e = 0; e < n; ++e) {
+            int fd = events[e].data.fd;
+
+            pthread_mutex_lock(&broker->mutex);
+
+            if (fd == broker->listen_fd) {
+                int c;
+                while ((c = accept(broker->listen_fd, NULL, NULL)) >= 0) {
+                    if (c >= broker->conn_count || !mockBrokerAccept(broker, epfd, c)) close(c);
+                }
+            } else if (broker->conns[fd].rx != NULL && !mockBrokerRead(broker, fd)) {
+                mockBrokerClose(broker, epfd, fd);
+            }
+
+            pthread_mutex_unlock(&broker->mutex);
+        }
+
+        broker->cpu = mockBrokerThreadCPU();
+    }
+
+    int fd;
+    pthread_mutex_lock(&broker->mutex);
+    for (fd = 0; fd < broker->conn_count; ++fd)
+        if (broker->conns[fd].rx != NULL) mockBrokerClose(broker, -1, fd);
+    pthread_mutex_unlock(&broker->mutex);
+
+    close(epfd);
+
+    return NULL;
+}
+
+#ifdef WS_NATIVE_OPENSSL
+SSL_CTX* mockBrokerTLSContext(){
+    EVP_PKEY* key = NULL;
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+    if (kctx == NULL || EVP_PKEY_keygen_init(kctx) != 1 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) != 1 || EVP_PKEY_keygen(kctx, &key) != 1) {
+        EVP_PKEY_CTX_free(kctx);
+        return NULL;
+    }
+    EVP_PKEY_CTX_free(kctx);
+
+    X509* cert = X509_new();
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, (const unsigned char*) "127.0.0.1",
+                               -1, -1, 0);
+    X509_set_issuer_name(cert, X509_get_subject_name(cert));
+    X509_sign(cert, key, EVP_sha256());
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    if (ctx != NULL && (SSL_CTX_use_certificate(ctx, cert) != 1 || SSL_CTX_use_PrivateKey(ctx, key) != 1)) {
+        SSL_CTX_free(ctx);
+        ctx = NULL;
+    }
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+
+    return ctx;
+}
+#endif
+
+mockBroker* mockBrokerStart(const mockBrokerConfig* config){
+    mockBroker* broker = calloc(1, sizeof(mockBroker));
+    if (broker == NULL) return NULL;
+
+    broker->config = *config;
+    broker->listen_fd = -1;
+
+#ifdef WS_NATIVE_OPENSSL
+    if (config->tls && (broker->ctx = mockBrokerTLSContext()) == NULL) {
+        free(broker);
+        return NULL;
+    }
+#else
+    if (config->tls) {
+        free(broker);
+        return NULL;
+    }
+#endif
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&broker->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+
+    broker->conn_count = (int) (rl.rlim_cur < 65536 ? rl.rlim_cur : 65536);
+    broker->conns = calloc((size_t) broker->conn_count, sizeof(mockBrokerConnection));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(config->port);
+
+    int one = 1;
+    broker->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (broker->listen_fd >= 0) setsockopt(broker->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    if (broker->conns == NULL || broker->listen_fd < 0 ||
+        bind(broker->listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 || listen(broker->listen_fd, 1024) != 0) {
+        if (broker->listen_fd >= 0) close(broker->listen_fd);
+        broker->listen_fd = -1;
+        mockBrokerStop(broker);
+        return NULL;
+    }
+    fcntl(broker->listen_fd, F_SETFL, fcntl(broker->listen_fd, F_GETFL) | O_NONBLOCK);
+
+    socklen_t l = sizeof(addr);
+    getsockname(broker->listen_fd, (struct sockaddr*) &addr, &l);
+    broker->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&broker->thread, NULL, mockBrokerThread, broker) != 0) {
+        close(broker->listen_fd);
+        broker->listen_fd = -1;
+        mockBrokerStop(broker);
+        return NULL;
+    }
+
+    return broker;
+}
+
+void mockBrokerStop(mockBroker* broker){
+
+    if (broker == NULL) return;
+
+    if (broker->listen_fd >= 0) {
+        broker->stop = true;
+        pthread_join(broker->thread, NULL);
+        close(broker->listen_fd);
+    }
+
+#ifdef WS_NATIVE_OPENSSL
+    if (broker->ctx != NULL) SSL_CTX_free(broker->ctx);
+#endif
+
+    pthread_mutex_destroy(&broker->mutex);
+    free(broker->conns);
+    free(broker);
+}
+
+static bool mockBrokerSendTo(mockBroker* broker, int connection, const char* msg, size_t length){
+    bool ret = false;
+
+    pthread_mutex_lock(&broker->mutex);
+    if (connection >= 0 && connection < broker->conn_count && broker->conns[connection].rx != NULL)
+        ret = mockBrokerSend(broker, connection, msg, length);
+    pthread_mutex_unlock(&broker->mutex);
+
+    return ret;
+}
+
+bool mockBrokerCallFunction(mockBroker* broker, int connection, const char* functionId, const char* parameters,
+                            const char* correlationId){
+    char stack[512];
+    const char* uuid = connection >= 0 && connection < broker->conn_count ? broker->conns[connection].uuid : "";
+    size_t size = strlen(uuid) + strlen(functionId) + strlen(parameters) + (correlationId != NULL ? strlen(correlationId) : 0) + 96;
+    char* msg = size <= sizeof(stack) ? stack : malloc(size);
+
+    if (msg == NULL) return false;
+
+    int l = snprintf(msg, size, "C {\"uuid\":\"%s\",\"functionId\":\"%s\",\"functionParameters\":%s", uuid, functionId,
+                     parameters);
+    if (correlationId != NULL) l += snprintf(msg + l, size - (size_t) l, ",\"correlationId\":\"%s\"", correlationId);
+    l += snprintf(msg + l, size - (size_t) l, "}");
+
+    bool ret = mockBrokerSendTo(broker, connection, msg, (size_t) l);
+    if (ret) broker->calls++;
+
+    if (msg != stack) free(msg);
+
+    return ret;
+}
+
+bool mockBrokerConfigure(mockBroker* broker, int connection, const char* parameters){
+    const char* uuid = connection >= 0 && connection < broker->conn_count ? broker->conns[connection].uuid : "";
+    size_t size = strlen(uuid) + strlen(parameters) + 32;
+    char* msg = malloc(size);
+
+    if (msg == NULL) return false;
+
+    int l = snprintf(msg, size, "K {\"uuid\":\"%s\",\"parameters\":%s}", uuid, parameters);
+
+    bool ret = mockBrokerSendTo(broker, connection, msg, (size_t) l);
+
+    free(msg);
+
+    return ret;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 The msb-client-websocket-c contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file mockbroker.h
+ * @brief Local stand-in for the websocket interface of the MSB, for benchmarks and tests without a running MSB
+ *
+ * The broker accepts websocket connections on the loopback interface and speaks the client side of the MSB protocol:
+ * it greets with IO_CONNECTED, answers registrations (R) with IO_REGISTERED and events (E) with IO_PUBLISHED, and sends
+ * function calls (C) and configuration changes (K). Messages are sent plain or with SockJS framing, optionally over TLS
+ * with a throwaway self signed certificate. It doesn't check self descriptions or event data.
+ */
+
+#ifndef MOCKBROKER_H
+#define MOCKBROKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef WS_NATIVE_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
+typedef struct mockBroker mockBroker;
+
+/**
+ * @brief configuration of the broker
+ */
+typedef struct {
+	uint16_t port;/**< port to listen on, 0 for any free one */
+	bool sockjs;/**< SockJS framing, the clients have to use it as well */
+	bool tls;/**< TLS with a self signed certificate, only with WS_NATIVE_OPENSSL */
+	bool acknowledge;/**< answer events with IO_PUBLISHED */
+	void (*on_registration)(mockBroker* broker, int connection, const char* uuid, void* context);/**< called for every registration, may be NULL */
+	void (*on_event)(mockBroker* broker, int connection, const char* msg, size_t length, void* context);/**< called with the json of every event, may be NULL */
+	void* context;/**< passed to the callbacks */
+} mockBrokerConfig;
+
+/**
+ * @brief connection of a client, indexed by its socket
+ */
+typedef struct {
+	unsigned char* rx;/**< received data which hasn't been processed yet, NULL if the connection isn't open */
+	size_t used;/**< bytes in rx */
+	size_t capacity;/**< size of rx */
+	bool upgraded;/**< websocket handshake done */
+	char uuid[40];/**< uuid of the registered client, empty before the registration */
+	uint64_t events;/**< events received */
+#ifdef WS_NATIVE_OPENSSL
+	SSL* ssl;/**< TLS session, NULL without TLS */
+#endif
+} mockBrokerConnection;
+
+/**
+ * @brief running broker
+ */
+struct mockBroker {
+	mockBrokerConfig config;/**< configuration */
+	int listen_fd;/**< listening socket */
+	uint16_t port;/**< port the broker listens on */
+	pthread_t thread;/**< thread serving the connections */
+	pthread_mutex_t mutex;/**< serialises the use of the connections, recursive so callbacks may send */
+	volatile bool stop;/**< ends the thread */
+	mockBrokerConnection* conns;/**< connections indexed by socket */
+	int conn_count;/**< size of conns */
+	volatile uint32_t connections;/**< open connections */
+	volatile uint32_t registered;/**< registrations received */
+	volatile uint64_t events;/**< events received */
+	volatile uint64_t event_bytes;/**< length of the events received */
+	volatile uint64_t calls;/**< function calls sent */
+	volatile double cpu;/**< cpu time used by the broker thread in s */
+#ifdef WS_NATIVE_OPENSSL
+	SSL_CTX* ctx;/**< TLS context, NULL without TLS */
+#endif
+};
+
+/**
+ * @brief Start a broker in a thread of its own
+ *
+ * @param config Configuration, copied
+ *
+ * @return Pointer to the broker, NULL if it couldn't be started
+ */
+mockBroker* mockBrokerStart(const mockBrokerConfig* config);
+
+/**
+ * @brief Stop a broker, close all connections and free it
+ *
+ * @param broker Pointer to the broker
+ */
+void mockBrokerStop(mockBroker* broker);
+
+/**
+ * @brief Send a function call to a registered client
+ *
+ * @param broker Pointer to the broker
+ * @param connection Connection of the client, as passed to on_registration
+ * @param functionId Id of the function
+ * @param parameters Json text of the function parameters, e.g. {"dataObject":1}
+ * @param correlationId Correlation id, may be NULL
+ *
+ * @return true if the call has been sent
+ */
+bool mockBrokerCallFunction(mockBroker* broker, int connection, const char* functionId, const char* parameters,
+							const char* correlationId);
+
+/**
+ * @brief Send a configuration change to a registered client
+ *
+ * @param broker Pointer to the broker
+ * @param connection Connection of the client, as passed to on_registration
+ * @param parameters Json text of the parameters, e.g. {"p1":{"type":"INTEGER","format":"INT32","value":3}}
+ *
+ * @return true if the change has been sent
+ */
+bool mockBrokerConfigure(mockBroker* broker, int connection, const char* parameters);
+
+#ifdef WS_NATIVE_OPENSSL
+/**
+ * @brief Create a TLS server context with a self signed certificate for 127.0.0.1, valid for an hour
+ *
+ * @return Pointer to the context, NULL on failure
+ */
+SSL_CTX* mockBrokerTLSContext();
+#endif
+
+#endif /* MOCKBROKER_H */
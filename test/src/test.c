@@ -20,9 +20,45 @@
 #include <unistd.h>
 
 #include "libMsbClientC.h"
+#include "MsbClientC_internal.h"
 #include "rest.c"
 #include "sput-1.4.0/sput.h"
 #include "integration_flow.h"
+#include "websocket/deflate.h"
+#include "websocket/native.h"
+#include "websocket/websocket.h"
+
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <dirent.h>
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+/* counts the allocations of the whole process while test_count_mallocs is set */
+#define TEST_MALLOC_HOOK
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t number, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static volatile bool test_count_mallocs = false;
+static volatile unsigned long test_mallocs = 0;
+
+void* malloc(size_t size){
+    if (test_count_mallocs) test_mallocs++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t number, size_t size){
+    if (test_count_mallocs) test_mallocs++;
+    return __libc_calloc(number, size);
+}
+
+void* realloc(void* ptr, size_t size){
+    if (test_count_mallocs) test_mallocs++;
+    return __libc_realloc(ptr, size);
+}
+#endif
 
 static FILE* debug_fPtr = NULL;
 static const char* debug_fName = "debugOutput";
@@ -247,9 +283,1504 @@ static void test_helper_schll(){
     }
 }
 
+static void test_helper_mpool(){
+    mpool* pool = mpool_makePoolPointer(2);
+
+    sput_fail_if(pool == NULL, "Test if pool was created");
+
+    char* a = mpool_alloc(pool, 100);
+    char* b = mpool_alloc(pool, 200);
+    sput_fail_unless(a != NULL && b != NULL && pool->misses == 2 && pool->hits == 0, "Test if empty pool takes buffers from the heap");
+
+    mpool_free(pool, a);
+    char* c = mpool_alloc(pool, 256);
+    sput_fail_unless(c == a && pool->hits == 1, "Test if a free buffer of the size class is reused");
+
+    char* d = mpool_alloc(pool, 1 << 20);
+    sput_fail_unless(d != NULL && pool->oversized == 1, "Test if oversized buffers fall back to the heap");
+    memset(d, 0, 1 << 20);
+
+    list_list* list = list_makeListPointer();
+    list->pool = pool;
+    sput_fail_unless(list_add(list, "pooled", 1, 7) == EINFL_OK, "Test if pooled list takes a copy");
+    sput_fail_unless(strcmp(list_getValueFirstPointer(list), "pooled") == 0, "Test if pooled copy is correct");
+    sput_fail_unless(list_pop(list, 0, 1) == EINFL_OK, "Test if pooled entry can be popped");
+    sput_fail_unless(pool->number_free[0] == 2, "Test if entry and value went back to the pool");
+    list_deleteList(list, 1);
+    free(list);
+
+    mpool_free(pool, b);
+    mpool_free(pool, c);
+    mpool_free(pool, d);
+    mpool_deletePool(pool);
+
+    /* the second buffer comes out of the thread's cache, without the pool */
+    pool = mpool_makePoolPointer(2);
+    mpool_setThreadCached(pool, true);
+    a = mpool_alloc(pool, 100);
+    mpool_free(pool, a);
+    b = mpool_alloc(pool, 100);
+    sput_fail_unless(pool->hits >= 1 && pool->hits + pool->misses == 2, "Test if allocations out of a thread cache count as hits");
+    mpool_free(pool, b);
+    mpool_deletePool(pool);
+
+    /* two entries with their values use up the reserved buffers, a copy for a replacement can't be taken then */
+    static char memory[4 * 256] __attribute__((aligned(16)));
+    list_entry* tracker = NULL;
+
+    pool = mpool_makePoolPointer(4);
+    sput_fail_unless(mpool_reserveSize(sizeof(list_entry), 4) <= sizeof(memory), "Test if reserved memory is large enough");
+    mpool_reserve(pool, memory, sizeof(list_entry), 4);
+    list = list_makeListPointer();
+    list->pool = pool;
+    list_add(list, "first", 1, 6);
+    list_addTracked(list, "second", 1, 7, &tracker);
+    sput_fail_unless(mpool_alloc(pool, 7) == NULL, "Test if pool without heap runs dry");
+    sput_fail_unless(list_replaceTracked(list, &tracker, "third", 1, 6, 1) == EINFL_NULL_VALUE, "Test if replacement fails on a dry pool");
+    sput_fail_unless(tracker != NULL && strcmp(tracker->value, "second") == 0, "Test if entry keeps its value on a dry pool");
+    list_deleteList(list, 1);
+    mpool_deletePool(pool);
+}
+
 #define initialisation                                      \
 
 
+static void test_websocket_deflate(){
+    wsDeflate d;
+    memset(&d, 0, sizeof(wsDeflate));
+
+    wsDeflateConfigure(&d, true, 12, true, 32);
+
+    char* offer = wsDeflateOffer(&d);
+    sput_fail_unless(offer != NULL && strstr(offer, "permessage-deflate; client_max_window_bits=12") == offer, "Test if extension is offered");
+    free(offer);
+
+    sput_fail_unless(wsDeflateAccept(&d, "permessage-deflate; client_max_window_bits=13") == -1, "Test if larger client window is rejected");
+    sput_fail_unless(wsDeflateAccept(&d, "permessage-deflate; unknown_param") == -1, "Test if unknown parameter is rejected");
+    sput_fail_unless(wsDeflateAccept(&d, "permessage-deflate; client_max_window_bits=10; server_max_window_bits=15") == 0 && d.negotiated, "Test if extension is negotiated");
+    sput_fail_unless(d.negotiated_client_max_window_bits == 10 && !d.negotiated_client_no_context_takeover, "Test if negotiated parameters are applied");
+    sput_fail_unless(d.client_max_window_bits == 12, "Test if the configured parameters are kept for the next offer");
+
+    wsDeflate off;
+    memset(&off, 0, sizeof(wsDeflate));
+    sput_fail_unless(wsDeflateAccept(&off, "permessage-deflate") == -1 && !off.negotiated, "Test if an extension that hasn't been offered is rejected");
+
+    const char* msg = "{\"uuid\":\"a209efb9-af3f-4d93-bad4-05215a983164\",\"eventId\":\"Ev1\",\"priority\":1,\"dataObject\":42}";
+    unsigned char* comp;
+    char* decomp;
+    size_t comp_length, decomp_length;
+    int i;
+
+    sput_fail_unless(wsDeflateCompress(&d, "{}", 2, &comp, &comp_length) == 0 && comp == NULL, "Test if message below threshold is not compressed");
+
+    /* compressing and decompressing with the same context mirrors the peer, the second message is smaller because the context is kept */
+    size_t first_length = 0;
+    for (i = 0; i < 2; ++i) {
+        sput_fail_unless(wsDeflateCompress(&d, msg, strlen(msg), &comp, &comp_length) == 1, "Test if message is compressed");
+        if (i == 0) first_length = comp_length;
+        else sput_fail_unless(comp_length < first_length, "Test if context takeover shrinks repeated messages");
+
+        sput_fail_unless(wsDeflateDecompress(&d, comp, comp_length, &decomp, &decomp_length, 0) == 0, "Test if message is decompressed");
+        sput_fail_unless(decomp_length == strlen(msg) && strcmp(decomp, msg) == 0, "Test if round trip is lossless");
+
+        free(comp);
+        free(decomp);
+    }
+
+    sput_fail_unless(wsDeflateCompress(&d, msg, strlen(msg), &comp, &comp_length) == 1, "Test if message is compressed");
+    sput_fail_unless(wsDeflateDecompress(&d, comp, comp_length, &decomp, &decomp_length, 16) == -1, "Test if maximum message size is enforced");
+    free(comp);
+
+    sput_fail_unless(d.messages_compressed == 3 && d.messages_uncompressed == 1, "Test if messages are counted");
+    sput_fail_unless(d.wire_bytes_sent < d.raw_bytes_sent, "Test if bytes on wire are counted");
+
+    /* a peer may end a message with a final block, the inflater must stop there and start over with the next one */
+    for (i = 0; i < 2; ++i) {
+        unsigned char final[256];
+        z_stream z;
+        memset(&z, 0, sizeof(z));
+        deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -WS_DEFLATE_MAX_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY);
+        z.next_in = (Bytef*) msg;
+        z.avail_in = (uInt) strlen(msg);
+        z.next_out = final;
+        z.avail_out = sizeof(final);
+        deflate(&z, Z_FINISH);
+        comp_length = sizeof(final) - z.avail_out;
+        deflateEnd(&z);
+
+        sput_fail_unless(wsDeflateDecompress(&d, final, comp_length, &decomp, &decomp_length, 0) == 0
+                         && decomp_length == strlen(msg) && strcmp(decomp, msg) == 0, "Test if a message with a final block is decompressed");
+        free(decomp);
+    }
+
+    wsDeflateReset(&d);
+}
+
+static void test_websocket_native(){
+#ifdef WS_NATIVE_AVAILABLE
+    char accept[29];
+    wsNativeAcceptKey("dGhlIHNhbXBsZSBub25jZQ==", accept);
+    sput_fail_unless(strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0, "Test if Sec-WebSocket-Accept matches RFC 6455 example");
+
+    const unsigned char mask[4] = {0x37, 0xfa, 0x21, 0x3d};
+    unsigned char plain[37], masked[37], unmasked[37];
+    int i;
+    for (i = 0; i < 37; ++i) plain[i] = (unsigned char) (i * 7);
+
+    wsNativeMask(masked, plain, sizeof(masked), mask);
+
+    bool ok = true;
+    for (i = 0; i < 37; ++i) ok = ok && masked[i] == (plain[i] ^ mask[i % 4]);
+    sput_fail_unless(ok, "Test if vectorized masking matches bytewise masking");
+
+    wsNativeMask(unmasked, masked, sizeof(unmasked), mask);
+    sput_fail_unless(memcmp(unmasked, plain, sizeof(plain)) == 0, "Test if masking is reversible");
+#endif
+}
+
+#ifdef WS_NATIVE_AVAILABLE
+/* the test plays the broker on sv[1], the transport is connected to sv[0]; with epoll the socket is watched by the
+ * transport's epoll instance, otherwise the instance is closed and the socket is read directly */
+static void test_native_open(wsNative* n, int sv[2], bool epoll) {
+    bool paired = socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) == 0;
+
+    sput_fail_unless(paired, "Test if the socket pair has been created");
+
+    if (!paired) {
+        sv[0] = sv[1] = -1;
+        return;
+    }
+
+    if (epoll) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        epoll_ctl(n->epfd, EPOLL_CTL_ADD, sv[0], &ev);
+        n->epoll_events = EPOLLIN;
+    } else if (n->epfd >= 0) {
+        close(n->epfd);
+        n->epfd = -1;
+    }
+
+    n->fd = sv[0];
+    n->state = WSN_OPEN;
+}
+
+/* the client is registered on the connection right away */
+static void test_client_native_open(msbClient* client, int sv[2], bool epoll) {
+    test_native_open(((wsData*) client->websocketData)->native, sv, epoll);
+
+    client->currentStatusAutomat = REGISTERED;
+    client->statusAutomatChange = REGISTERED;
+}
+
+static void test_native_close(wsNative* n, int sv[2]) {
+    n->state = WSN_CLOSED;
+    n->fd = -1;
+
+    if (n->epfd >= 0 && sv[0] >= 0) epoll_ctl(n->epfd, EPOLL_CTL_DEL, sv[0], NULL);
+
+    if (sv[0] >= 0) close(sv[0]);
+    if (sv[1] >= 0) close(sv[1]);
+}
+#endif
+
+static void test_websocket_lent_messages(){
+#ifdef WS_NATIVE_AVAILABLE
+    wsData* ws = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    unsigned char frames[] = {0x81, 3, 'o', 'n', 'e', 0x81, 3, 't', 'w', 'o', 0x81, 5, 't', 'h', 'r', 'e', 'e'};
+    void* first = NULL;
+    void* second = NULL;
+    void* third = NULL;
+    size_t length = 0;
+    bool binary = true;
+    int sv[2];
+
+    wsSetTransport(ws, WS_TRANSPORT_NATIVE);
+    wsInitialise(ws, false);
+
+    wsNative* n = ws->native;
+    test_native_open(n, sv, false);
+
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if the frames have been written");
+
+    char* one = wsTakeMsg(ws, &length, &binary, &first);
+    sput_fail_unless(one != NULL && strcmp(one, "one") == 0 && length == 3 && !binary && first == one && n->msg == NULL,
+                     "Test if the message buffer is handed over");
+
+    char* two = wsTakeMsg(ws, &length, &binary, &second);
+    sput_fail_unless(two != NULL && strcmp(two, "two") == 0 && second == NULL && strcmp(one, "one") == 0,
+                     "Test if a second message is only valid until the next call while the first one is held");
+
+    wsReleaseMsg(ws, first);
+    char* three = wsTakeMsg(ws, &length, &binary, &third);
+    sput_fail_unless(three != NULL && strcmp(three, "three") == 0 && third == three && n->msg_lent == three,
+                     "Test if the buffer is handed over again once it has been released");
+
+    wsReleaseMsg(ws, third);
+    sput_fail_unless(n->msg == three && n->msg_lent == NULL, "Test if the released buffer is reused");
+
+    test_native_close(n, sv);
+
+    wsDataDestr(ws);
+#endif
+}
+
+#define TEST_MASKED_FRAMES 40
+
+static void test_websocket_masking_keys(){
+#ifdef WS_NATIVE_AVAILABLE
+    wsData* ws = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    unsigned char wire[TEST_MASKED_FRAMES * 10];
+    uint32_t masks[TEST_MASKED_FRAMES];
+    bool sent = true, distinct = true;
+    int sv[2];
+    int i, j;
+
+    wsSetTransport(ws, WS_TRANSPORT_NATIVE);
+    wsInitialise(ws, false);
+
+    wsNative* n = ws->native;
+    test_native_open(n, sv, false);
+
+    /* more keys than the random pool holds at once */
+    for (i = 0; i < TEST_MASKED_FRAMES; ++i) sent = sent && wsNativeSend(n, WS_OPCODE_TEXT, "ping", 4) == 0;
+    sput_fail_unless(sent && read(sv[1], wire, sizeof(wire)) == sizeof(wire), "Test if the masked frames have been sent");
+
+    for (i = 0; i < TEST_MASKED_FRAMES; ++i) {
+        memcpy(&masks[i], &wire[i * 10 + 2], 4);
+        for (j = 0; j < i; ++j) distinct = distinct && masks[i] != masks[j];
+    }
+    sput_fail_unless(distinct, "Test if every frame has its own masking key");
+
+    test_native_close(n, sv);
+
+    wsDataDestr(ws);
+#endif
+}
+
+static void test_websocket_send_backpressure(){
+#ifdef WS_NATIVE_AVAILABLE
+    wsData* ws = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    unsigned char incoming[] = {0x81, 2, 'h', 'i'};
+    unsigned char sink[65536];
+    size_t size = 262144, received = 0;
+    char* payload = malloc(size);
+    int sv[2], sndbuf = 4096, i;
+
+    wsSetTransport(ws, WS_TRANSPORT_NATIVE);
+    wsInitialise(ws, false);
+
+    wsNative* n = ws->native;
+    test_native_open(n, sv, true);
+    setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    memset(payload, 'x', size);
+
+    /* readable data must neither keep the blocked write spinning nor end it */
+    sput_fail_unless(write(sv[1], incoming, sizeof(incoming)) == sizeof(incoming), "Test if a frame has been written");
+    sput_fail_unless(wsNativeSend(n, WS_OPCODE_TEXT, payload, size) == 0 && n->tx_pending > 0 && n->state == WSN_OPEN,
+                     "Test if a frame the full socket doesn't take is kept pending");
+    sput_fail_unless(wsNativeSend(n, WS_OPCODE_TEXT, "next", 4) == -1 && n->state == WSN_OPEN,
+                     "Test if the next frame would block without closing the connection");
+
+    for (i = 0; i < 100000 && (n->tx_pending > 0 || received < size + 14); ++i) {
+        ssize_t r = read(sv[1], sink, sizeof(sink));
+        if (r > 0) received += (size_t) r;
+        wsNativeGetMsgContent(n);
+    }
+    sput_fail_unless(n->tx_pending == 0 && received == size + 14 && n->state == WSN_OPEN,
+                     "Test if the pending frame has been written completely");
+
+    test_native_close(n, sv);
+    free(payload);
+
+    wsDataDestr(ws);
+#endif
+}
+
+static void test_websocket_protocol_errors(){
+#ifdef WS_NATIVE_AVAILABLE
+    wsData* ws = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    /* RSV1 on a continuation, a fragmented ping and a ping of 126 bytes */
+    unsigned char rsv1_continuation[] = {0x01, 1, 'a', 0xC0, 1, 'b'};
+    unsigned char fragmented_ping[] = {0x09, 0};
+    unsigned char oversized_ping[130] = {0x89, 126, 0, 126};
+    const unsigned char* frames[] = {rsv1_continuation, fragmented_ping, oversized_ping};
+    size_t lengths[] = {sizeof(rsv1_continuation), sizeof(fragmented_ping), sizeof(oversized_ping)};
+    unsigned char close_frame[8];
+    int sv[2], i;
+
+    wsSetTransport(ws, WS_TRANSPORT_NATIVE);
+    wsInitialise(ws, false);
+
+    wsNative* n = ws->native;
+
+    for (i = 0; i < 3; ++i) {
+        test_native_open(n, sv, false);
+
+        sput_fail_unless(write(sv[1], frames[i], lengths[i]) == (ssize_t) lengths[i], "Test if the frame has been written");
+        while (n->state == WSN_OPEN && wsNativeGetMsgContent(n) != NULL);
+
+        /* the close frame is masked, its status code follows the four byte mask */
+        bool closed = read(sv[1], close_frame, sizeof(close_frame)) == 8 && close_frame[0] == 0x88 && close_frame[1] == 0x82;
+        sput_fail_unless(closed && n->state == WSN_CLOSED && (close_frame[6] ^ close_frame[2]) == 0x03
+                         && (close_frame[7] ^ close_frame[3]) == 0xEA, "Test if the protocol error closes with 1002");
+
+        close(sv[1]);
+    }
+
+    wsDataDestr(ws);
+#endif
+}
+
+static void test_websocket_shared(){
+    wsData* a = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+    wsData* b = wsDataConstr(false, "127.0.0.1", "8085", "127.0.0.1", "/", NULL, false, NULL, NULL, NULL, NULL);
+
+    wsInitialise(a, false);
+    wsInitialise(b, false);
+    sput_fail_unless(a->wsCtx != NULL && a->wsCtx == b->wsCtx, "Test if connections share the nopoll context");
+
+    wsDeinitialise(a);
+    sput_fail_unless(b->wsCtx != NULL && a->wsCtx == NULL, "Test if the nopoll context survives the deinitialisation of one connection");
+    wsDeinitialise(b);
+
+    wsDataDestr(a);
+    wsDataDestr(b);
+
+#if defined(WS_NATIVE_AVAILABLE) && defined(WS_NATIVE_OPENSSL)
+    uint32_t contexts = wsSharedTLSContexts();
+
+    a = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+    b = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+    wsSetTransport(a, WS_TRANSPORT_NATIVE);
+    wsSetTransport(b, WS_TRANSPORT_NATIVE);
+
+    wsInitialise(a, false);
+    wsInitialise(b, false);
+    sput_fail_unless(a->native->ssl_ctx != NULL && a->native->ssl_ctx == b->native->ssl_ctx, "Test if TLS connections with the same certificates share the SSL context");
+    sput_fail_unless(wsSharedTLSContexts() == contexts + 1, "Test if one SSL context has been created");
+
+    wsDataDestr(a);
+    sput_fail_unless(wsSharedTLSContexts() == contexts + 1, "Test if the SSL context survives the destruction of one connection");
+    wsDataDestr(b);
+    sput_fail_unless(wsSharedTLSContexts() == contexts, "Test if the SSL context is released with its last connection");
+
+    a = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, "/nonexistent/ca.pem", NULL);
+    wsSetTransport(a, WS_TRANSPORT_NATIVE);
+
+    wsInitialise(a, false);
+    sput_fail_unless(a->status != WSD_INITIALISED && a->native->ssl_ctx == NULL && wsSharedTLSContexts() == contexts,
+                     "Test if a missing CA certificate fails the initialisation");
+    wsDataDestr(a);
+#endif
+}
+
+static void test_websocket_tls_resumption(){
+    wsData* a = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+    wsData* b = wsDataConstr(false, "127.0.0.1", "8084", "127.0.0.1", "/", NULL, true, NULL, NULL, NULL, NULL);
+    uint32_t handshakes = 1, resumed = 1;
+
+    sput_fail_unless(a->tls_resumption, "Test if TLS session resumption is enabled by default");
+
+    wsGetTLSHandshakes(a, &handshakes, &resumed);
+    sput_fail_unless(handshakes == 0 && resumed == 0, "Test if no TLS handshake has been counted");
+
+    wsSetTLSSessionResumption(a, false);
+    wsCopySettings(b, a);
+    sput_fail_unless(!b->tls_resumption, "Test if TLS session resumption setting is kept on address change");
+
+#ifdef WS_NATIVE_AVAILABLE
+    wsSetTransport(a, WS_TRANSPORT_NATIVE);
+    wsSetTLSVerification(a, false);
+    wsCopySettings(b, a);
+    sput_fail_unless(!a->tls_verify && !a->native->tls_verify && !b->tls_verify,
+                     "Test if TLS verification of the native transport is kept on address change");
+#endif
+
+    wsDataDestr(a);
+    wsDataDestr(b);
+}
+
+static msbClientGroup* test_group_removing = NULL;
+static msbClient* test_group_client = NULL;
+static pthread_t test_group_main;
+static volatile int test_group_removed = 0;
+
+/* the state machine's debug output is a callback on the group thread, where the client removes itself */
+static int test_group_remove_debug(const char* format, ...){
+    if (test_group_removed == 0 && !pthread_equal(pthread_self(), test_group_main)) {
+        test_group_removed = 1;
+        test_group_removed = msbClientGroupRemove(test_group_removing, test_group_client) ? 2 : 3;
+    }
+    return 0;
+}
+
+static void test_client_group(){
+    msbClientGroup* group = msbClientGroupNew(2);
+#ifdef __linux__
+    sput_fail_unless(group != NULL, "Test if client group has been created");
+
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+
+    sput_fail_unless(msbClientGroupAdd(group, client), "Test if client has been added to the group");
+    sput_fail_unless(!msbClientGroupAdd(group, client), "Test if client cannot be added twice");
+    sput_fail_unless(msbClientRunClientStateMachine(client) != 0, "Test if grouped client cannot run in its own thread");
+
+    usleep(200000);
+
+    sput_fail_unless(msbClientGroupRemove(group, client), "Test if client has been removed from the group");
+    sput_fail_unless(client->group_slot == NULL && client->currentStatusAutomat == CLOSED, "Test if removed client has been stopped");
+
+    test_group_removing = group;
+    test_group_client = client;
+    test_group_main = pthread_self();
+    msbClientSetDebug(client, true);
+    msbClientSetDebugFunction(client, test_group_remove_debug);
+    msbClientGroupAdd(group, client);
+
+    int i;
+    for (i = 0; i < 100 && (test_group_removed != 2 || client->currentStatusAutomat != CLOSED); ++i) usleep(10000);
+    sput_fail_unless(test_group_removed == 2 && client->group_slot == NULL && client->currentStatusAutomat == CLOSED,
+                     "Test if a callback of the group thread can remove its own client");
+
+    msbClientDeleteClient(client);
+#endif
+    msbClientGroupDelete(group);
+}
+
+static void test_thread_config(){
+#ifdef __linux__
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    msbThreadConfig config;
+    pthread_attr_t attr;
+    cpu_set_t cpus;
+    size_t stack = 0;
+    char name[16] = {0};
+
+    memset(&config, 0, sizeof(config));
+    config.policy = MSB_SCHED_FIFO;
+    config.priority = 1000;
+    sput_fail_unless(!msbClientSetThreadConfig(client, &config), "Test if an invalid priority is refused");
+
+    config.policy = MSB_SCHED_OTHER;
+    config.priority = 0;
+    config.cpu_mask = 1;
+    config.stack_size = 512 * 1024;
+    snprintf(config.name, sizeof(config.name), "msb-test");
+    sput_fail_unless(msbClientSetThreadConfig(client, &config), "Test if the thread configuration has been set");
+
+    sput_fail_unless(msbClientRunClientStateMachine(client) == 0, "Test if the configured thread has been started");
+    sput_fail_unless(!msbClientSetThreadConfig(client, &config), "Test if the configuration is refused while running");
+
+    pthread_getname_np(client->thread, name, sizeof(name));
+    pthread_getaffinity_np(client->thread, sizeof(cpus), &cpus);
+    if (pthread_getattr_np(client->thread, &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &stack);
+        pthread_attr_destroy(&attr);
+    }
+    sput_fail_unless(strcmp(name, "msb-test") == 0 && CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus) && stack >= 512 * 1024,
+                     "Test if name, affinity and stack size have been applied");
+
+    msbClientHaltClientStateMachine(client);
+    msbClientDeleteClient(client);
+
+    snprintf(config.name, sizeof(config.name), "msb-group-loop");
+    msbClientGroup* group = msbClientGroupNewConfigured(2, &config);
+    sput_fail_unless(group != NULL, "Test if a configured client group has been created");
+    if (group != NULL) {
+        /* the threads of the group aren't accessible, they are found by name */
+        bool named = false;
+        DIR* tasks = opendir("/proc/self/task");
+        struct dirent* task;
+        while (tasks != NULL && (task = readdir(tasks)) != NULL) {
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/self/task/%s/comm", task->d_name);
+            char line[32];
+            FILE* comm = fopen(path, "r");
+            if (comm == NULL) continue;
+            if (fgets(line, sizeof(line), comm) != NULL && strcmp(line, "msb-group-loo-1\n") == 0) named = true;
+            fclose(comm);
+        }
+        if (tasks != NULL) closedir(tasks);
+        sput_fail_unless(named, "Test if the group threads are named by index");
+    }
+    msbClientGroupDelete(group);
+#endif
+}
+
+static void test_object_arena(){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    msbObject* object = client->msbObjectData;
+    char id[32];
+    int i;
+    int32_t value = 1;
+
+    for (i = 0; i < 500; ++i) {
+        sprintf(id, "arena_event_%d", i);
+        msbClientAddEvent(client, id, "Arena Event", "Event of the arena test", MSB_INTEGER, MSB_INT32, false);
+        sprintf(id, "arena_function_%d", i);
+        msbClientAddFunction(client, id, "Arena Function", "Function of the arena test", NULL, MSB_STRING, MSB_NONE, false, NULL);
+    }
+    msbClientAddConfigParam(client, "arena_param", MSB_INTEGER, MSB_INT32, &value);
+    msbClientAddResponseEventToFunction(client, "arena_function_7", "arena_event_7");
+
+    sput_fail_unless(object->eventArray->number_entries == 500 && object->functionArray->number_entries == 500, "Test if all model entries have been added");
+    sput_fail_unless(object->arena.number_chunks < 20 && object->arena.used <= object->arena.allocated, "Test if the model lives in a few arena chunks");
+
+    schll_entry* entry = object->eventArray->first_entry;
+    sput_fail_unless((char*) entry->value == (char*) (entry + 1), "Test if descriptor follows its list node");
+
+    msbObjectEvent* e = (msbObjectEvent*) schll_getValuePointer(object->eventArray, "arena_event_499");
+    sput_fail_unless(e != NULL && strcmp(e->eventId, "arena_event_499") == 0, "Test if arena event can be looked up");
+
+    size_t used = object->arena.used;
+    msbClientAddEvent(client, "arena_event_0", "Arena Event", "Duplicate", MSB_INTEGER, MSB_INT32, false);
+    sput_fail_unless(object->arena.used == used && object->eventArray->number_entries == 500, "Test if a duplicate takes no arena memory");
+
+    msbClientRemoveEvent(client, "arena_event_7");
+    msbClientRemoveFunction(client, "arena_function_7");
+    msbClientRemoveConfigParam(client, "arena_param");
+    sput_fail_unless(schll_getValuePointer(object->eventArray, "arena_event_7") == NULL
+                     && schll_getValuePointer(object->functionArray, "arena_function_7") == NULL
+                     && object->configParamArray->number_entries == 0, "Test if arena entries can be removed");
+
+    msbClientChangeSelfDescription(client, NULL, NULL, NULL, "Arena Service Renamed", NULL);
+    sput_fail_unless(strcmp(object->objectInfo.service_name, "Arena Service Renamed") == 0, "Test if self description can be changed");
+
+    used = object->arena.used;
+    for (i = 0; i < 100; ++i)
+        msbClientChangeSelfDescription(client, NULL, NULL, NULL, i % 2 ? "Arena Service Renamed" : "Arena", i % 2 ? "Changed" : NULL);
+    sput_fail_unless(strcmp(object->objectInfo.service_name, "Arena Service Renamed") == 0
+                     && strcmp(object->objectInfo.service_description, "Changed") == 0, "Test if self description can be changed repeatedly");
+    sput_fail_unless(object->arena.used == used, "Test if repeated self description changes reuse their memory");
+
+    msbClientDeleteClient(client);
+}
+
+static void test_static_memory(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    size_t size = 1 << 20;
+    void* region = NULL;
+    int sv[2];
+    int i;
+
+    sput_fail_unless(posix_memalign(&region, 16, size) == 0, "Test if static region has been allocated");
+    sput_fail_unless(!msbClientUseStaticMemory(client, region, 4096, 2048), "Test if a too small region is refused");
+    sput_fail_unless(msbClientUseStaticMemory(client, region, size, 2048), "Test if client takes the static region");
+    sput_fail_unless(!msbClientUseStaticMemory(client, region, size, 2048), "Test if static region cannot be set twice");
+
+    msbClientAddEvent(client, "static_int", "Static Event", "Event of the static memory test", MSB_INTEGER, MSB_INT32, false);
+    msbClientAddEvent(client, "static_string", "Static Event", "Event of the static memory test", MSB_STRING, MSB_NONE, false);
+    msbClientAddEvent(client, "static_doubles", "Static Event", "Event of the static memory test", MSB_NUMBER, MSB_DOUBLE, true);
+    sput_fail_unless(client->msbObjectData->arena.region != NULL && client->msbObjectData->eventArray->number_entries == 3, "Test if the model lives in the static region");
+
+    uint32_t incoming = client->maxNumberDataIncoming, outgoing = client->maxNumberDataOutgoing;
+    msbClientSetEventCacheSize(client, incoming + 1);
+    msbClientSetFunctionCacheSize(client, outgoing + 1);
+    sput_fail_unless(client->maxNumberDataIncoming == incoming && client->maxNumberDataOutgoing == outgoing, "Test if the queues can't outgrow the static region");
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    sput_fail_unless(n != NULL && n->static_buffers, "Test if native transport uses static buffers");
+
+    unsigned char* rx = n->rx;
+    msbClientChangeURL(client, "ws://127.0.0.1:8085/other", NULL, false, NULL, NULL, NULL);
+    n = ((wsData*) client->websocketData)->native;
+    sput_fail_unless(n != NULL && n->static_buffers && n->rx == rx, "Test if a new url keeps the static buffers");
+
+    test_client_native_open(client, sv, false);
+
+    int32_t value = 42;
+    double values[3] = {1.5, 2, -0.25};
+    uint32_t delay;
+
+#ifdef TEST_MALLOC_HOOK
+    test_mallocs = 0;
+    test_count_mallocs = true;
+#endif
+    msbClientPublish(client, "static_int", MEDIUM, &value, 0, NULL);
+    msbClientPublish(client, "static_string", HIGH, "quote \" backslash \\", 0, TESTCORRELATIONID);
+    msbClientPublish(client, "static_doubles", LOW, values, 3, NULL);
+    msbClientPublishEmpty(client, "static_int", MEDIUM, NULL);
+#ifdef TEST_MALLOC_HOOK
+    test_count_mallocs = false;
+    sput_fail_unless(test_mallocs == 0, "Test if publishing with static memory doesn't allocate");
+#endif
+
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 4, "Test if events have been queued");
+
+    json_object* ev = json_tokener_parse((char*) list_getValueFirstPointer(client->outgoing_data) + 2);
+    sput_fail_unless(ev != NULL && json_object_get_int(json_object_object_get(ev, "dataObject")) == 42
+                     && strcmp(json_object_get_string(json_object_object_get(ev, "uuid")), test_var_UUID) == 0, "Test if static event message is valid");
+    json_object_put(ev);
+
+    ev = json_tokener_parse((char*) client->outgoing_data->first_entry->next_entry->value + 2);
+    sput_fail_unless(ev != NULL && strcmp(json_object_get_string(json_object_object_get(ev, "dataObject")), "quote \" backslash \\") == 0, "Test if static event string is escaped");
+    json_object_put(ev);
+    ev = json_tokener_parse((char*) client->outgoing_data->first_entry->next_entry->next_entry->value + 2);
+    json_object* arr = json_object_object_get(ev, "dataObject");
+    sput_fail_unless(arr != NULL && json_object_array_length(arr) == 3 && json_object_get_double(json_object_array_get_idx(arr, 2)) == -0.25, "Test if static event array is valid");
+    json_object_put(ev);
+
+    const char frames[] = {(char) 0x81, 4, 'p', 'i', 'n', 'g', (char) 0x81, 12, 'I', 'O', '_', 'P', 'U', 'B', 'L', 'I', 'S', 'H', 'E', 'D'};
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if server frames have been written");
+
+#ifdef TEST_MALLOC_HOOK
+    test_mallocs = 0;
+    test_count_mallocs = true;
+#endif
+    for (i = 0; i < 10; ++i) msbClientAutomatStep(client, &delay);
+#ifdef TEST_MALLOC_HOOK
+    test_count_mallocs = false;
+    sput_fail_unless(test_mallocs == 0, "Test if sending and receiving with static memory doesn't allocate");
+#endif
+
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 0 && list_count_entries(client->incoming_data) == 0, "Test if all messages have been processed");
+
+    unsigned char wire[4096];
+    ssize_t r = read(sv[1], wire, sizeof(wire));
+    sput_fail_unless(r > 0 && wire[0] == 0x81 && (wire[1] & 0x80), "Test if masked text frames have been sent");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+    free(region);
+#endif
+}
+
+static int test_completions_sent = 0;
+static int test_completions_dropped = 0;
+
+static void test_completion_callback(void* client, msbPublishCompletion* completion, PublishStatus status){
+    if (status == MSB_PUBLISH_SENT)
+        ++test_completions_sent;
+    else
+        ++test_completions_dropped;
+}
+
+static void test_heartbeat_interval(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    unsigned char rx[64];
+    uint32_t delay;
+    int sv[2];
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientSetHeartbeatInterval(client, 60000);
+    msbClientAutomatBegin(client);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    msbClientAutomatStep(client, &delay);
+    ssize_t got = read(sv[1], rx, sizeof(rx));
+    sput_fail_unless(got == 6 && rx[0] == 0x89 && client->last_heartbeat != 0, "Test if the first cycle sends a ping");
+
+    msbClientAutomatStep(client, &delay);
+    got = read(sv[1], rx, sizeof(rx));
+    sput_fail_unless(got < 0, "Test if no ping is sent before the interval has passed");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
+static void test_publish_completion(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    msbPublishCompletion completions[4];
+    int sv[2];
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        completions[i].callback = test_completion_callback;
+        completions[i].context = NULL;
+    }
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "completion", "Completion Event", "Event of the completion test", MSB_INTEGER, MSB_INT32, false);
+    msbClientSetEventOverflowPolicy(client, "completion", MSB_OVERFLOW_DROP_OLDEST);
+    msbClientSetFunctionCacheSize(client, 2);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    sput_fail_unless(msbClientPublishJSONWithCompletion(client, "unknown", MEDIUM, "1", 1, NULL, &completions[0]) == -1, "Test if publishing to an unknown event fails");
+
+    sput_fail_unless(msbClientPublishJSONWithCompletion(client, "completion", MEDIUM, "1", 1, NULL, &completions[0]) == 0
+                     && msbClientPublishJSONWithCompletion(client, "completion", MEDIUM, "2", 1, NULL, &completions[1]) == 0
+                     && msbClientPublishJSONWithCompletion(client, "completion", MEDIUM, "3", 1, NULL, &completions[2]) == 0, "Test if messages with completion have been queued");
+    sput_fail_unless(test_completions_dropped == 1 && test_completions_sent == 0, "Test if the completion of a dropped message has been called");
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    uint32_t delay;
+    for (i = 0; i < 4; ++i) msbClientAutomatStep(client, &delay);
+
+    sput_fail_unless(test_completions_sent == 2 && list_count_entries(client->outgoing_data) == 0, "Test if completions of sent messages have been called");
+
+    client->currentStatusAutomat = CONNECTING;
+    msbClientPublishJSONWithCompletion(client, "completion", MEDIUM, "4", 1, NULL, &completions[3]);
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    sput_fail_unless(test_completions_dropped == 2 && test_completions_sent == 2, "Test if completions of queued messages are called at the end");
+
+    msbClientDeleteClient(client);
+#endif
+}
+
+static int test_acknowledgements[4];
+
+static void test_acknowledgement_callback(void* client, msbPublishCompletion* completion, PublishStatus status){
+    ++test_acknowledgements[status];
+}
+
+static void test_publish_acknowledgements(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    msbPublishCompletion completions[4];
+    msbPublishStatistics stats;
+    unsigned char acks[] = {0x81, 12, 'I', 'O', '_', 'P', 'U', 'B', 'L', 'I', 'S', 'H', 'E', 'D',
+                            0x81, 26, 'N', 'I', 'O', '_', 'E', 'V', 'E', 'N', 'T', '_', 'F', 'O', 'R', 'W', 'A', 'R', 'D', 'I', 'N', 'G', '_', 'E', 'R', 'R', 'O', 'R'};
+    int sv[2];
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        completions[i].callback = test_acknowledgement_callback;
+        completions[i].context = NULL;
+    }
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "acknowledged", "Acknowledged Event", "Event of the acknowledgement test", MSB_INTEGER, MSB_INT32, false);
+    client->thread_running = true;
+    sput_fail_unless(!msbClientSetPublishWindow(client, 2), "Test if the publish window can't be set while the state machine runs");
+    client->thread_running = false;
+    sput_fail_unless(msbClientSetPublishWindow(client, 2), "Test if the publish window has been set");
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    for (i = 0; i < 4; ++i) msbClientPublishJSONWithCompletion(client, "acknowledged", MEDIUM, "1", 1, NULL, &completions[i]);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    uint32_t delay;
+    for (i = 0; i < 4; ++i) msbClientAutomatStep(client, &delay);
+
+    msbClientGetPublishStatistics(client, &stats);
+    sput_fail_unless(stats.sent == 2 && stats.in_flight == 2 && list_count_entries(client->outgoing_data) == 2
+                     && test_acknowledgements[MSB_PUBLISH_SENT] == 0, "Test if the publish window holds back further messages");
+
+    sput_fail_unless(write(sv[1], acks, sizeof(acks)) == sizeof(acks), "Test if the acknowledgements have been written");
+    for (i = 0; i < 4; ++i) msbClientAutomatStep(client, &delay);
+
+    msbClientGetPublishStatistics(client, &stats);
+    sput_fail_unless(test_acknowledgements[MSB_PUBLISH_ACKNOWLEDGED] == 1 && test_acknowledgements[MSB_PUBLISH_REJECTED] == 1,
+                     "Test if the answers of the broker have been correlated");
+    sput_fail_unless(stats.sent == 4 && stats.in_flight == 2 && stats.acknowledged == 1 && stats.rejected == 1
+                     && stats.latency_min <= stats.latency_max && stats.latency_sum >= stats.latency_max, "Test the acknowledgement statistics");
+
+    /* the answers to the third and fourth message don't come, the fifth one waits for them */
+    msbClientPublishJSONWithCompletion(client, "acknowledged", MEDIUM, "1", 1, NULL, &completions[0]);
+    msbClientSetPublishTimeout(client, 1);
+    usleep(5000);
+    for (i = 0; i < 2; ++i) msbClientAutomatStep(client, &delay);
+
+    msbClientGetPublishStatistics(client, &stats);
+    sput_fail_unless(test_acknowledgements[MSB_PUBLISH_DROPPED] == 2 && stats.timeouts == 1 && stats.lost == 2
+                     && stats.sent == 5 && stats.in_flight == 1 && list_count_entries(client->outgoing_data) == 0,
+                     "Test if missing acknowledgements time out and free the window");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientGetPublishStatistics(client, &stats);
+    sput_fail_unless(test_acknowledgements[MSB_PUBLISH_DROPPED] == 3 && stats.lost == 3 && stats.in_flight == 0,
+                     "Test if unacknowledged messages are dropped at the end");
+
+    msbClientDeleteClient(client);
+#endif
+}
+
+static void test_event_filter(){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    double absolute[] = {20.0, 20.3, 20.6, 20.7, 21.2, 21.2};
+    double percent[] = {100.0, 105.0, 111.0, 115.0, 122.5};
+    json_bool state[] = {true, true, false, false, true};
+    int32_t counts[] = {1, 2, 3};
+    msbObjectEvent* ev;
+    int i;
+
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "absolute", "Absolute Deadband", "Event of the filter test", MSB_NUMBER, MSB_DOUBLE, false);
+    msbClientAddEvent(client, "percent", "Percent Deadband", "Event of the filter test", MSB_NUMBER, MSB_DOUBLE, false);
+    msbClientAddEvent(client, "state", "Change Only", "Event of the filter test", MSB_BOOL, MSB_NONE, false);
+    msbClientAddEvent(client, "counts", "Heartbeat", "Event of the filter test", MSB_INTEGER, MSB_INT32, true);
+    msbClientSetEventFilter(client, "absolute", MSB_FILTER_DEADBAND_ABSOLUTE, 0.5, 0);
+    msbClientSetEventFilter(client, "percent", MSB_FILTER_DEADBAND_PERCENT, 10, 0);
+    msbClientSetEventFilter(client, "state", MSB_FILTER_ON_CHANGE, 0, 0);
+    msbClientSetEventFilter(client, "counts", MSB_FILTER_ON_CHANGE, 0, 60);
+
+    msbClientPublish(client, "absolute", MEDIUM, &absolute[0], 0, NULL);
+    sput_fail_unless(client->events_filtered == 0, "Test if nothing is filtered before the client can queue messages");
+
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    for (i = 0; i < 6; ++i) msbClientPublish(client, "absolute", MEDIUM, &absolute[i], 0, NULL);
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 3 && client->events_filtered == 3,
+                     "Test if the absolute deadband follows the last published value");
+
+    for (i = 0; i < 5; ++i) msbClientPublish(client, "percent", MEDIUM, &percent[i], 0, NULL);
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 6 && client->events_filtered == 5,
+                     "Test if the percent deadband relates to the last published value");
+
+    for (i = 0; i < 5; ++i) msbClientPublish(client, "state", MEDIUM, &state[i], 0, NULL);
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 9 && client->events_filtered == 7,
+                     "Test if unchanged booleans are suppressed");
+
+    msbClientPublish(client, "counts", MEDIUM, counts, 3, NULL);
+    msbClientPublish(client, "counts", MEDIUM, counts, 3, NULL);
+    schll_getValue(client->msbObjectData->eventArray, (void**) &ev, "counts");
+    ev->filter_published -= 61000000;
+    msbClientPublish(client, "counts", MEDIUM, counts, 3, NULL);
+    counts[2] = 4;
+    msbClientPublish(client, "counts", MEDIUM, counts, 3, NULL);
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 12 && client->events_filtered == 8,
+                     "Test if unchanged arrays are republished after the heartbeat");
+
+    /* 21.2 is the reference, 25.0 is refused by the full queue and mustn't replace it */
+    double refused = 25.0, again = 25.1;
+    client->maxNumberDataOutgoing = 12;
+    msbClientPublish(client, "absolute", MEDIUM, &refused, 0, NULL);
+    client->maxNumberDataOutgoing = 13;
+    msbClientPublish(client, "absolute", MEDIUM, &again, 0, NULL);
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 13 && client->events_filtered == 8,
+                     "Test if a value refused by the full queue doesn't become the reference");
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+}
+
+#define TEST_FILTER_THREADS 4
+#define TEST_FILTER_ROUNDS 1000
+
+static pthread_barrier_t test_filter_barrier;
+
+/* every round all threads publish the same value at once, right after the filter has been reset */
+static void* test_event_filter_thread(void* arg){
+    msbClient* client = (msbClient*) arg;
+    int32_t value = 7;
+    int i;
+
+    for (i = 0; i < TEST_FILTER_ROUNDS; ++i) {
+        pthread_barrier_wait(&test_filter_barrier);
+        msbClientPublish(client, "shared", MEDIUM, &value, 0, NULL);
+        pthread_barrier_wait(&test_filter_barrier);
+    }
+
+    return NULL;
+}
+
+static void test_event_filter_threads(){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    pthread_t threads[TEST_FILTER_THREADS];
+    bool once = true;
+    int i;
+
+    msbClientInitialise(client, false);
+    msbClientSetFunctionCacheSize(client, TEST_FILTER_ROUNDS);
+    msbClientAddEvent(client, "shared", "Shared Event", "Event of the filter test", MSB_INTEGER, MSB_INT32, false);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    pthread_barrier_init(&test_filter_barrier, NULL, TEST_FILTER_THREADS + 1);
+    for (i = 0; i < TEST_FILTER_THREADS; ++i) pthread_create(&threads[i], NULL, test_event_filter_thread, client);
+
+    for (i = 0; i < TEST_FILTER_ROUNDS; ++i) {
+        msbClientSetEventFilter(client, "shared", MSB_FILTER_ON_CHANGE, 0, 0);
+        pthread_barrier_wait(&test_filter_barrier);
+        pthread_barrier_wait(&test_filter_barrier);
+        once = once && list_count_entries(client->outgoing_data) == (uint32_t) i + 1;
+    }
+
+    for (i = 0; i < TEST_FILTER_THREADS; ++i) pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&test_filter_barrier);
+
+    sput_fail_unless(once && client->events_filtered == (TEST_FILTER_THREADS - 1) * TEST_FILTER_ROUNDS,
+                     "Test if threads publishing the same value pass the filter once");
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+}
+
+static void test_incoming_backpressure(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    unsigned char frames[3 * 14];
+    uint32_t delay;
+    int sv[2];
+    int i, pending = 0;
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    client->maxNumberDataIncoming = 4;
+    msbClientSetReceiveBudget(client, 1, 0);
+    sput_fail_unless(!msbClientSetIncomingBackpressure(client, true, 4), "Test if the low watermark has to be below the queue size");
+    msbClientAutomatBegin(client);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    for (i = 0; i < 3; ++i) {
+        frames[14 * i] = 0x81;
+        frames[14 * i + 1] = 12;
+        memcpy(frames + 14 * i + 2, "IO_PUBLISHED", 12);
+    }
+
+    /* without backpressure a full queue discards what arrives */
+    for (i = 0; i < 4; ++i) list_add(client->incoming_data, "IO_PUBLISHED", 1, 13);
+    sput_fail_unless(write(sv[1], frames, 14) == 14, "Test if a message has been written");
+    msbClientAutomatStep(client, &delay);
+    sput_fail_unless(client->incoming_dropped == 1 && list_count_entries(client->incoming_data) == 3,
+                     "Test if a message arriving at the full queue is dropped");
+    while (list_count_entries(client->incoming_data) > 0) msbClientAutomatStep(client, &delay);
+
+    /* with backpressure it stays in the socket until the queue is down to the low watermark */
+    sput_fail_unless(msbClientSetIncomingBackpressure(client, true, 1), "Test if backpressure has been enabled");
+    for (i = 0; i < 4; ++i) list_add(client->incoming_data, "IO_PUBLISHED", 1, 13);
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if messages have been written");
+
+    for (i = 0; i < 3; ++i) msbClientAutomatStep(client, &delay);
+    ioctl(sv[0], FIONREAD, &pending);
+    sput_fail_unless(client->incoming_paused && client->incoming_pauses == 1 && pending == sizeof(frames)
+                     && list_count_entries(client->incoming_data) == 1, "Test if reading pauses while the queue is above the low watermark");
+
+    for (i = 0; i < 8; ++i) msbClientAutomatStep(client, &delay);
+    ioctl(sv[0], FIONREAD, &pending);
+    sput_fail_unless(!client->incoming_paused && pending == 0 && list_count_entries(client->incoming_data) == 0
+                     && client->incoming_dropped == 1, "Test if reading resumes and nothing is dropped");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
+static void test_receive_budget(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    unsigned char frames[10 * 14];
+    msbReceiveStatistics statistics;
+    uint32_t delay;
+    int sv[2];
+    int i, pending = 0;
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    sput_fail_unless(!msbClientSetReceiveBudget(client, 0, 0), "Test if the message budget must not be 0");
+    msbClientAutomatBegin(client);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    for (i = 0; i < 10; ++i) {
+        frames[14 * i] = 0x81;
+        frames[14 * i + 1] = 12;
+        memcpy(frames + 14 * i + 2, "IO_PUBLISHED", 12);
+    }
+
+    /* the default budget drains the burst in one cycle */
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if messages have been written");
+    msbClientAutomatStep(client, &delay);
+    ioctl(sv[0], FIONREAD, &pending);
+    msbClientGetReceiveStatistics(client, &statistics);
+    sput_fail_unless(pending == 0 && list_count_entries(client->incoming_data) == 0, "Test if the burst has been drained in one cycle");
+    sput_fail_unless(statistics.wakeups == 1 && statistics.messages == 10 && statistics.max_per_wakeup == 10
+                     && statistics.per_wakeup[3] == 1 && statistics.budget_exhausted == 0, "Test if the cycle has been counted");
+
+    /* a smaller one spreads it over several cycles */
+    sput_fail_unless(msbClientSetReceiveBudget(client, 4, 0), "Test if the budget has been set");
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if messages have been written");
+    msbClientAutomatStep(client, &delay);
+    msbClientGetReceiveStatistics(client, &statistics);
+    sput_fail_unless(statistics.messages == 14 && statistics.budget_exhausted == 1, "Test if a cycle stops at the message budget");
+    for (i = 0; i < 3; ++i) msbClientAutomatStep(client, &delay);
+    msbClientGetReceiveStatistics(client, &statistics);
+    sput_fail_unless(statistics.wakeups == 4 && statistics.messages == 20 && statistics.budget_exhausted == 2
+                     && statistics.per_wakeup[2] == 2 && statistics.per_wakeup[1] == 1, "Test if the cycles have been counted");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
+static void test_receive_callback(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    unsigned char frames[3 * 14];
+    uint32_t delay;
+    int sv[2];
+    int i;
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAutomatBegin(client);
+
+    wsData* ws = (wsData*) client->websocketData;
+    wsNative* n = ws->native;
+    test_client_native_open(client, sv, true);
+
+    for (i = 0; i < 3; ++i) {
+        frames[14 * i] = 0x81;
+        frames[14 * i + 1] = 12;
+        memcpy(frames + 14 * i + 2, "IO_PUBLISHED", 12);
+    }
+
+    sput_fail_unless(wsDispatchMsgs(ws, 0, 10) == -1, "Test if messages are only dispatched in callback mode");
+    sput_fail_unless(msbClientSetReceiveMode(client, MSB_RECEIVE_CALLBACK) && ws->onMsg != NULL,
+                     "Test if the handler has been set");
+    sput_fail_unless(wsDispatchMsgs(ws, 1000, 10) == 0, "Test if waiting without messages times out");
+
+    sput_fail_unless(write(sv[1], frames, sizeof(frames)) == sizeof(frames), "Test if messages have been written");
+    sput_fail_unless(wsDispatchMsgs(ws, 100000, 2) == 2 && list_count_entries(client->incoming_data) == 2,
+                     "Test if the messages have been handed to the incoming queue");
+    sput_fail_unless(wsDispatchMsgs(ws, 100000, 10) == 1 && list_count_entries(client->incoming_data) == 3,
+                     "Test if buffered messages are handed over without waiting");
+
+    msbClientAutomatStep(client, &delay);
+    sput_fail_unless(list_count_entries(client->incoming_data) == 0, "Test if the handed over messages have been processed");
+
+    sput_fail_unless(msbClientSetReceiveMode(client, MSB_RECEIVE_POLLING) && ws->onMsg == NULL,
+                     "Test if polling has been restored");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
+typedef struct {
+    msbClient* client;
+    const char* values[3];
+} test_staging_publisher;
+
+static void* test_staging_thread(void* arg){
+    test_staging_publisher* p = (test_staging_publisher*) arg;
+    int i;
+
+    for (i = 0; i < 3; ++i) msbClientPublishJSON(p->client, "staged", MEDIUM, p->values[i], 2, NULL);
+
+    return NULL;
+}
+
+static void test_publish_staging(){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    test_staging_publisher publishers[2] = {{client, {"10", "11", "12"}}, {client, {"20", "21", "22"}}};
+    static char region[1024] __attribute__((aligned(16)));
+    pthread_t threads[2];
+    int i, next[2] = {0, 0};
+    bool ordered = true;
+
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "staged", "Staged Event", "Event of the staging test", MSB_INTEGER, MSB_INT32, false);
+    sput_fail_unless(msbClientSetPublishStaging(client, 8) && client->buffer_pool->thread_cached,
+                     "Test if staging has been enabled");
+    sput_fail_unless(!msbClientUseStaticMemory(client, region, sizeof(region), 256), "Test if static memory is refused with staging");
+
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    for (i = 0; i < 2; ++i) pthread_create(&threads[i], NULL, test_staging_thread, &publishers[i]);
+    for (i = 0; i < 2; ++i) pthread_join(threads[i], NULL);
+
+    msbPublishCompletion completion = {test_completion_callback, NULL};
+    int dropped = test_completions_dropped;
+
+    for (i = 0; i < 8; ++i) msbClientPublishJSON(client, "staged", MEDIUM, "30", 2, NULL);
+    sput_fail_unless(msbClientPublishJSONWithCompletion(client, "staged", MEDIUM, "31", 2, NULL, &completion) == -1
+                     && test_completions_dropped == dropped + 1,
+                     "Test if publishing fails once the thread's stage is full and the completion reports it");
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 0 && client->stages != NULL,
+                     "Test if the messages wait in the stages of their threads");
+
+    sput_fail_unless(msbClientMergeStaged(client) == 14 && list_count_entries(client->outgoing_data) == 14,
+                     "Test if the stages have been merged into the outgoing queue");
+
+    list_entry* e;
+    for (e = client->outgoing_data->first_entry; e != NULL; e = e->next_entry) {
+        const char* data = strstr((const char*) e->value, "\"dataObject\":");
+        int value = data != NULL ? atoi(data + 13) : 0;
+        if (value >= 10 && value < 30) {
+            int t = value / 10 - 1;
+            if (value % 10 != next[t]++) ordered = false;
+        }
+    }
+    sput_fail_unless(ordered && next[0] == 3 && next[1] == 3, "Test if the messages of each thread keep their order");
+
+    client->maxNumberDataOutgoing = 14;
+    sput_fail_unless(msbClientPublishJSONWithCompletion(client, "staged", MEDIUM, "33", 2, NULL, &completion) == 0
+                     && msbClientMergeStaged(client) == 1 && list_count_entries(client->outgoing_data) == 14
+                     && test_completions_dropped == dropped + 2,
+                     "Test if the completion of a staged message refused by the full queue reports it as dropped");
+
+    msbPublishStage* stage;
+    uint32_t staged = 0;
+    msbClientPublishJSON(client, "staged", MEDIUM, "32", 2, NULL);
+    msbClientAutomatEnd(client);
+    for (stage = client->stages; stage != NULL; stage = stage->next) staged += stage->count;
+    sput_fail_unless(staged == 0 && client->outgoing_data == NULL, "Test if staged messages are merged at the end");
+
+    msbClientDeleteClient(client);
+}
+
+typedef struct {
+    const char* data;
+    size_t length;
+    size_t position;
+} test_stream_source;
+
+static size_t test_stream_read(void* context, char* buffer, size_t size){
+    test_stream_source* source = (test_stream_source*) context;
+    size_t length = source->length - source->position < size ? source->length - source->position : size;
+
+    memcpy(buffer, source->data + source->position, length);
+    source->position += length;
+
+    return length;
+}
+
+static void test_publish_stream(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    size_t data_length = 150000;
+    char* data = (char*) malloc(data_length);
+    unsigned char* rx = (unsigned char*) malloc(4 * 65536);
+    char* message = (char*) malloc(data_length + 1024);
+    size_t message_length = 0;
+    test_stream_source source = {data, data_length, 0};
+    msbPublishStream stream = {{test_completion_callback, NULL}, test_stream_read, &source};
+    int fragments = 0;
+    bool opcodes = true;
+    bool finished = false;
+    uint32_t delay;
+    int sv[2];
+    int i;
+
+    memset(data, 'x', data_length);
+    memcpy(data, "{\"image\":\"", 10);
+    memcpy(data + data_length - 2, "\"}", 2);
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "streamed", "Streamed Event", "Event of the stream test", MSB_STRING, MSB_NONE, false);
+    msbClientAddEvent(client, "following", "Following Event", "Event of the stream test", MSB_INTEGER, MSB_INT32, false);
+
+    sput_fail_unless(msbClientPublishStream(client, "streamed", MEDIUM, NULL, NULL) == -1, "Test if a stream is required");
+
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+    test_completions_sent = 0;
+    sput_fail_unless(msbClientPublishStream(client, "streamed", MEDIUM, &stream, NULL) == 0
+                     && msbClientPublishJSONWithCompletion(client, "following", MEDIUM, "7", 1, NULL, NULL) == 0,
+                     "Test if the stream and a following event have been queued");
+    sput_fail_unless(list_getKindFirst(client->outgoing_data) != 0 && client->outgoing_data->first_entry->next_entry->kind == 0,
+                     "Test if only the envelope is queued as stream");
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    /* every cycle sends one frame, which is read and unmasked before the next one */
+    for (i = 0; i < 8 && !finished; ++i) {
+        msbClientAutomatStep(client, &delay);
+
+        ssize_t got = read(sv[1], rx, 4 * 65536);
+        if (got < 6) continue;
+
+        size_t header = (rx[1] & 0x7f) == 127 ? 14 : (rx[1] & 0x7f) == 126 ? 8 : 6;
+        size_t length = rx[1] & 0x7f;
+        size_t j;
+
+        if (header > 6) for (length = 0, j = 2; j < header - 4; ++j) length = length << 8 | rx[j];
+        if (got != (ssize_t) (header + length) || message_length + length > data_length + 1024) {
+            opcodes = false;
+            break;
+        }
+        for (j = 0; j < length; ++j) message[message_length++] = rx[header + j] ^ rx[header - 4 + j % 4];
+
+        finished = (rx[0] & 0x80) != 0;
+        if ((rx[0] & 0x0f) != (fragments == 0 ? 0x01 : 0x00) || (finished && test_completions_sent != 1)) opcodes = false;
+        ++fragments;
+    }
+    message[message_length] = 0;
+
+    sput_fail_unless(opcodes && finished && fragments == 5, "Test if the event has been sent as fragmented text message");
+    sput_fail_unless(message_length > data_length && strncmp(message, "E {", 3) == 0
+                     && strstr(message, "\"eventId\":\"streamed\"") != NULL
+                     && strstr(message, "\"dataObject\":{\"image\":\"xxx") != NULL
+                     && strcmp(message + message_length - 3, "\"}}") == 0,
+                     "Test if the fragments make up the event");
+
+    msbClientAutomatStep(client, &delay);
+    ssize_t got = read(sv[1], rx, 4 * 65536);
+    sput_fail_unless(got > 6 && rx[0] == 0x81 && list_count_entries(client->outgoing_data) == 0,
+                     "Test if the following event has been sent after the stream");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+
+    free(data);
+    free(rx);
+    free(message);
+#endif
+}
+
+/* unmasks the payloads of the client frames in rx up to the final one, gives the length of the message */
+static size_t test_unmask_message(const unsigned char* rx, size_t rx_length, char* message, bool* complete){
+    size_t position = 0, message_length = 0, j;
+
+    *complete = false;
+    while (position + 6 <= rx_length && !*complete) {
+        size_t header = (rx[position + 1] & 0x7f) == 127 ? 14 : (rx[position + 1] & 0x7f) == 126 ? 8 : 6;
+        size_t length = rx[position + 1] & 0x7f;
+
+        if (header > 6) for (length = 0, j = 2; j < header - 4; ++j) length = length << 8 | rx[position + j];
+        if (position + header + length > rx_length) break;
+        for (j = 0; j < length; ++j)
+            message[message_length++] = rx[position + header + j] ^ rx[position + header - 4 + j % 4];
+
+        *complete = (rx[position] & 0x80) != 0;
+        position += header + length;
+    }
+    message[message_length] = 0;
+
+    return message_length;
+}
+
+static void test_publish_stream_blocked(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    size_t data_length = 150000, rx_size = data_length + 4096, rx_length = 0, message_length;
+    char* data = (char*) malloc(data_length);
+    unsigned char* rx = (unsigned char*) malloc(rx_size);
+    char* message = (char*) malloc(rx_size);
+    test_stream_source source = {data, data_length, 0};
+    msbPublishStream stream = {{test_completion_callback, NULL}, test_stream_read, &source};
+    bool complete = false;
+    uint32_t delay;
+    size_t j;
+    int sv[2], sndbuf = 4096, i;
+
+    /* every fragment has its own letters, so a lost one can't go unnoticed */
+    for (j = 0; j < data_length; ++j) data[j] = (char) ('a' + (j / 1000) % 26);
+    memcpy(data, "{\"image\":\"", 10);
+    memcpy(data + data_length - 2, "\"}", 2);
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "streamed", "Streamed Event", "Event of the stream test", MSB_STRING, MSB_NONE, false);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+    test_completions_sent = 0;
+    msbClientPublishStream(client, "streamed", MEDIUM, &stream, NULL);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, true);
+    setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    /* the envelope, a fragment the full socket only takes in part and one that can't be sent at all */
+    for (i = 0; i < 3; ++i) msbClientAutomatStep(client, &delay);
+    sput_fail_unless(client->stream == &stream && client->stream_pending > 0 && n->state == WSN_OPEN,
+                     "Test if the fragment that couldn't be sent is kept");
+
+    for (i = 0; i < 1000 && (test_completions_sent == 0 || n->tx_pending > 0); ++i) {
+        ssize_t got = read(sv[1], rx + rx_length, rx_size - rx_length);
+        if (got > 0) rx_length += (size_t) got;
+        msbClientAutomatStep(client, &delay);
+    }
+    while (rx_length < rx_size) {
+        ssize_t got = read(sv[1], rx + rx_length, rx_size - rx_length);
+        if (got <= 0) break;
+        rx_length += (size_t) got;
+    }
+
+    message_length = test_unmask_message(rx, rx_length, message, &complete);
+
+    const char* object = strstr(message, "\"dataObject\":");
+    sput_fail_unless(complete && test_completions_sent == 1 && client->stream_pending == 0 && object != NULL
+                     && message + message_length - (object + 13) == (ptrdiff_t) data_length + 1
+                     && memcmp(object + 13, data, data_length) == 0,
+                     "Test if no fragment has been lost while the socket was full");
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+
+    free(data);
+    free(rx);
+    free(message);
+#endif
+}
+
+static void test_publish_stream_sockjs(){
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    /* pretty printed json, its line breaks and tabs have to be escaped in the SockJS string */
+    const char* data = "{\n\t\"text\": \"a\\\"b\",\r\n\t\"n\": 1\f}";
+    test_stream_source source = {data, strlen(data), 0};
+    msbPublishStream stream = {{test_completion_callback, NULL}, test_stream_read, &source};
+    unsigned char rx[4096];
+    char message[4096];
+    size_t rx_length = 0;
+    bool complete = false;
+    uint32_t delay;
+    int sv[2], i;
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientSetSockJSFraming(client, true);
+    msbClientAddEvent(client, "streamed", "Streamed Event", "Event of the stream test", MSB_STRING, MSB_NONE, false);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+    msbClientPublishStream(client, "streamed", MEDIUM, &stream, NULL);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    for (i = 0; i < 4; ++i) {
+        msbClientAutomatStep(client, &delay);
+        ssize_t got = read(sv[1], rx + rx_length, sizeof(rx) - rx_length);
+        if (got > 0) rx_length += (size_t) got;
+    }
+    test_unmask_message(rx, rx_length, message, &complete);
+
+    json_object* frame = json_tokener_parse(message);
+    const char* text = frame != NULL && json_object_is_type(frame, json_type_array)
+                       ? json_object_get_string(json_object_array_get_idx(frame, 0)) : NULL;
+    sput_fail_unless(complete && strchr(message, '\n') == NULL && strchr(message, '\f') == NULL && text != NULL
+                     && strstr(text, "\"dataObject\":") != NULL && strstr(text, data) != NULL,
+                     "Test if control characters of the fragments are escaped in the SockJS frame");
+    json_object_put(frame);
+
+    /* a whole message takes the same escaping */
+    msbClientPublishJSON(client, "streamed", MEDIUM, data, strlen(data), NULL);
+    rx_length = 0;
+    for (i = 0; i < 2; ++i) {
+        msbClientAutomatStep(client, &delay);
+        ssize_t got = read(sv[1], rx + rx_length, sizeof(rx) - rx_length);
+        if (got > 0) rx_length += (size_t) got;
+    }
+    test_unmask_message(rx, rx_length, message, &complete);
+
+    frame = json_tokener_parse(message);
+    text = frame != NULL && json_object_is_type(frame, json_type_array)
+           ? json_object_get_string(json_object_array_get_idx(frame, 0)) : NULL;
+    sput_fail_unless(complete && strchr(message, '\n') == NULL && strchr(message, '\f') == NULL && text != NULL
+                     && strstr(text, data) != NULL, "Test if control characters of a message are escaped in the SockJS frame");
+    json_object_put(frame);
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
+static char test_codec_parameters[64];
+
+static void test_codec_function(void* client, void* params, void* context){
+    snprintf(test_codec_parameters, sizeof(test_codec_parameters), "%s", json_object_to_json_string((json_object*) params));
+}
+
+static void test_message_codec(){
+    const char* msg = "E {\"uuid\":\"a\",\"eventId\":\"e\",\"dataObject\":{\"v\":[1,-200,70000,3.5,0.1,1e300,true,null,\"x\\\"y\\u00e9\"]},\"priority\":2}";
+    const char* expected = "E {\"uuid\":\"a\",\"eventId\":\"e\",\"dataObject\":{\"v\":[1,-200,70000,3.5,0.1,1e+300,true,null,\"x\\\"y\xc3\xa9\"]},\"priority\":2}";
+    msbCodecBuffer frame = {NULL, 0, 0};
+    msbCodecBuffer decoded = {NULL, 0, 0};
+
+    sput_fail_unless(msbCodecMessagePack.encode(msg, strlen(msg), &frame) == 1 && frame.data[0] == 'E'
+                     && frame.used < strlen(msg), "Test if a message is encoded into a shorter binary frame");
+    sput_fail_unless(msbCodecMessagePack.decode(frame.data, frame.used, &decoded) == 0 && strcmp(decoded.data, expected) == 0
+                     && decoded.used == strlen(expected), "Test if the binary frame is decoded back into the message");
+
+    decoded.used = 0;
+    sput_fail_unless(msbCodecMessagePack.decode(frame.data, frame.used - 1, &decoded) == -1, "Test if a truncated frame is refused");
+
+    frame.used = 0;
+    sput_fail_unless(msbCodecMessagePack.encode("E {\"a\":", 7, &frame) == 0 && msbCodecMessagePack.encode("pong", 4, &frame) == 0,
+                     "Test if other texts are sent unchanged");
+
+    free(frame.data);
+    free(decoded.data);
+
+#ifdef WS_NATIVE_AVAILABLE
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    const char* call = "C {\"uuid\":\"a\",\"functionId\":\"codec_function\",\"functionParameters\":{\"dataObject\":\"x\"}}";
+    unsigned char rx[256];
+    msbCodecBuffer call_frame = {NULL, 0, 0};
+    msbCodecBuffer event = {NULL, 0, 0};
+    int sv[2];
+    int i;
+
+    msbClientSetTransport(client, MSB_TRANSPORT_NATIVE);
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "encoded", "Encoded Event", "Event of the codec test", MSB_INTEGER, MSB_INT32, false);
+    msbClientAddFunction(client, "codec_function", "Codec Function", "Function of the codec test", test_codec_function, MSB_STRING, MSB_NONE, false, NULL);
+    sput_fail_unless(msbClientSetCodec(client, &msbCodecMessagePack), "Test if the codec has been set");
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+    msbClientPublishJSONWithCompletion(client, "encoded", MEDIUM, "42", 2, NULL, NULL);
+
+    wsNative* n = ((wsData*) client->websocketData)->native;
+    test_client_native_open(client, sv, false);
+
+    uint32_t delay;
+    for (i = 0; i < 2; ++i) msbClientAutomatStep(client, &delay);
+
+    ssize_t got = read(sv[1], rx, sizeof(rx));
+    size_t header = got > 8 && (rx[1] & 0x7f) == 126 ? 8 : 6;
+    size_t length = got > 8 ? (header == 8 ? ((size_t) rx[2] << 8 | rx[3]) : rx[1] & 0x7f) : 0;
+    for (i = 0; i < (int) length && header + i < (size_t) got; ++i) rx[header + i] ^= rx[header - 4 + i % 4];
+    sput_fail_unless(got == (ssize_t) (header + length) && rx[0] == 0x82 && rx[header] == 'E'
+                     && msbCodecMessagePack.decode((const char*) rx + header, length, &event) == 0
+                     && strstr(event.data, "\"eventId\":\"encoded\"") != NULL && strstr(event.data, "\"dataObject\":42") != NULL,
+                     "Test if the event has been sent as binary frame");
+
+    msbCodecMessagePack.encode(call, strlen(call), &call_frame);
+    rx[0] = 0x82;
+    rx[1] = (unsigned char) call_frame.used;
+    memcpy(rx + 2, call_frame.data, call_frame.used);
+    sput_fail_unless(write(sv[1], rx, 2 + call_frame.used) == (ssize_t) (2 + call_frame.used), "Test if the function call has been written");
+    for (i = 0; i < 2; ++i) msbClientAutomatStep(client, &delay);
+
+    sput_fail_unless(strcmp(test_codec_parameters, "{ \"dataObject\": \"x\" }") == 0, "Test if the binary function call has been decoded");
+
+    free(call_frame.data);
+    free(event.data);
+
+    test_native_close(n, sv);
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+#endif
+}
+
 static void test_initialisation(){
     //test_var_msbClient = msbClientNewClientURL(test_var_websocketAdress, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
     test_var_msbClient = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
@@ -822,6 +2353,72 @@ static void test_event_queue(){
 
 }
 
+static void test_event_overflow_policy(){
+
+    msbClientSetFunctionCacheSize(test_var_msbClient, 5);
+
+    int32_t value = 1;
+    msbClientSetEventOverflowPolicy(test_var_msbClient, "Ev1", MSB_OVERFLOW_COALESCE);
+    msbClientPublish(test_var_msbClient, "Ev1", MEDIUM, &value, 0, NULL);
+    value = 2;
+    msbClientPublish(test_var_msbClient, "Ev1", MEDIUM, &value, 0, NULL);
+
+    sput_fail_unless(list_count_entries(test_var_msbClient->outgoing_data) == 4, "Test if event of same id was coalesced");
+    json_object* last = json_tokener_parse((char*)list_getValueLastPointer(test_var_msbClient->outgoing_data) + 2);
+    sput_fail_unless(json_object_get_int(json_object_object_get(last, "dataObject")) == 2, "Test if coalesced event has newest value");
+    json_object_put(last);
+
+    msbClientPublishEmpty(test_var_msbClient, "Ev0", MEDIUM, NULL);
+    msbClientPublishEmpty(test_var_msbClient, "Ev0", MEDIUM, NULL);
+
+    sput_fail_unless(list_count_entries(test_var_msbClient->outgoing_data) == 5, "Test if newest event was dropped");
+
+    msbClientSetEventOverflowPolicy(test_var_msbClient, "Ev2", MSB_OVERFLOW_DROP_OLDEST);
+    msbClientPublish(test_var_msbClient, "Ev2", MEDIUM, TESTDATAOBJECT, 0, NULL);
+
+    sput_fail_unless(list_count_entries(test_var_msbClient->outgoing_data) == 5, "Test if oldest event was dropped");
+    sput_fail_unless(strstr(list_getValueLastPointer(test_var_msbClient->outgoing_data), TESTDATAOBJECT) != NULL, "Test if newest event was queued");
+
+    const char* text = "\"" TESTDATAOBJECT "\" is not part of the data";
+    msbClientPublishJSON(test_var_msbClient, "Ev2", MEDIUM, text, strlen(TESTDATAOBJECT) + 2, NULL);
+    last = json_tokener_parse((char*)list_getValueLastPointer(test_var_msbClient->outgoing_data) + 2);
+    sput_fail_unless(last != NULL && strcmp(json_object_get_string(json_object_object_get(last, "dataObject")), TESTDATAOBJECT) == 0, "Test if json text has been published as it is");
+    json_object_put(last);
+
+    uint64_t hits = 0, misses = 0, oversized = 0;
+    msbClientGetBufferPoolStatistics(test_var_msbClient, &hits, &misses, &oversized);
+    sput_fail_unless(hits > 0 && oversized == 0, "Test if dropped and replaced messages have been reused by the buffer pool");
+
+    msbClientSetEventOverflowPolicy(test_var_msbClient, "Ev1", MSB_OVERFLOW_DROP_NEWEST);
+    msbClientSetEventOverflowPolicy(test_var_msbClient, "Ev2", MSB_OVERFLOW_DROP_NEWEST);
+    msbClientSetFunctionCacheSize(test_var_msbClient, 100);
+}
+
+static void test_coalesce_completion(){
+    msbClient* client = msbClientNewClientURL("ws://127.0.0.1:8085", NULL, test_var_UUID, test_var_TOKEN, test_var_CLASS, test_var_NAME, test_var_DESCRIPTION, 0, NULL, NULL, NULL);
+    msbPublishCompletion completion = {test_completion_callback, NULL};
+    const char* values[] = {"0", "1", "2", "3", "4"};
+    int i;
+
+    msbClientInitialise(client, false);
+    msbClientAddEvent(client, "coalesced", "Coalesced Event", "Event of the coalescing test", MSB_INTEGER, MSB_INT32, false);
+    msbClientSetEventOverflowPolicy(client, "coalesced", MSB_OVERFLOW_COALESCE);
+    msbClientAutomatBegin(client);
+    msbClientEnableEventCache(client);
+
+    for (i = 0; i < 5; ++i)
+        msbClientPublishJSONWithCompletion(client, "coalesced", MEDIUM, values[i], 1, NULL, i == 2 ? &completion : NULL);
+
+    list_entry* third = client->outgoing_data->first_entry->next_entry->next_entry;
+    sput_fail_unless(list_count_entries(client->outgoing_data) == 4 && third->tag == &completion
+                     && strstr((char*) third->value, "\"dataObject\":2") != NULL, "Test if the message with completion hasn't been replaced");
+    sput_fail_unless(third->next_entry->tag == NULL && strstr((char*) third->next_entry->value, "\"dataObject\":4") != NULL,
+                     "Test if later messages are coalesced behind it");
+
+    msbClientAutomatEnd(client);
+    msbClientDeleteClient(client);
+}
+
 static void test_verify_client(){
 
     char* post;
@@ -1072,6 +2669,33 @@ int test(bool unit_tests, bool integration_tests, char* websocketAdress, char* r
         sput_enter_suite("MSB.Client.Websocket.C.Test.Unit");
         sput_run_test(test_helper_einfl);
         sput_run_test(test_helper_schll);
+        sput_run_test(test_helper_mpool);
+        sput_run_test(test_websocket_deflate);
+        sput_run_test(test_websocket_native);
+        sput_run_test(test_websocket_lent_messages);
+        sput_run_test(test_websocket_masking_keys);
+        sput_run_test(test_websocket_send_backpressure);
+        sput_run_test(test_websocket_protocol_errors);
+        sput_run_test(test_websocket_shared);
+        sput_run_test(test_websocket_tls_resumption);
+        sput_run_test(test_client_group);
+        sput_run_test(test_thread_config);
+        sput_run_test(test_object_arena);
+        sput_run_test(test_static_memory);
+        sput_run_test(test_heartbeat_interval);
+        sput_run_test(test_publish_completion);
+        sput_run_test(test_coalesce_completion);
+        sput_run_test(test_publish_acknowledgements);
+        sput_run_test(test_message_codec);
+        sput_run_test(test_event_filter);
+        sput_run_test(test_event_filter_threads);
+        sput_run_test(test_publish_stream);
+        sput_run_test(test_publish_stream_blocked);
+        sput_run_test(test_publish_stream_sockjs);
+        sput_run_test(test_publish_staging);
+        sput_run_test(test_incoming_backpressure);
+        sput_run_test(test_receive_budget);
+        sput_run_test(test_receive_callback);
         sput_run_test(test_string_functions);
         sput_run_test(test_initialisation);
 
@@ -1083,6 +2707,7 @@ int test(bool unit_tests, bool integration_tests, char* websocketAdress, char* r
         sleep(3);
 
         sput_run_test(test_event_queue);
+        sput_run_test(test_event_overflow_policy);
         sput_run_test(test_stop_client);
     }
 